@@ -0,0 +1,179 @@
+#include "cli_commands.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+namespace {
+std::string formatStatsRow(const std::string& name, const std::string& calls, const std::string& errors,
+                           const std::string& warnings, const std::string& mean, const std::string& p50,
+                           const std::string& p95, const std::string& p99, const std::string& max) {
+    char line[512];
+    std::snprintf(line, sizeof(line), "%-28s %8s %7s %7s %9s %9s %9s %9s %9s", name.c_str(), calls.c_str(),
+                  errors.c_str(), warnings.c_str(), mean.c_str(), p50.c_str(), p95.c_str(), p99.c_str(), max.c_str());
+    return line;
+}
+} // namespace
+
+const std::vector<OptionSpec>& CliStatsCommand::getOptions() const {
+    static const std::vector<OptionSpec> options = {
+        {"sort", OptionSpec::Type::String, "Order rows by name, calls, errors, mean, p95 or max (default: name)."},
+        {"top", OptionSpec::Type::Integer, "Show only the first n rows."},
+        {"reset", OptionSpec::Type::Flag, "Clear all counters after reporting them."},
+    };
+    return options;
+}
+
+std::string CliStatsCommand::formatDuration(std::chrono::nanoseconds duration) {
+    char text[32];
+    double nanos = static_cast<double>(duration.count());
+    if (nanos < 1e6) {
+        std::snprintf(text, sizeof(text), "%.0fus", nanos / 1e3);
+    } else if (nanos < 1e9) {
+        std::snprintf(text, sizeof(text), "%.1fms", nanos / 1e6);
+    } else {
+        std::snprintf(text, sizeof(text), "%.2fs", nanos / 1e9);
+    }
+    return text;
+}
+
+CommandResult CliStatsCommand::execute(const std::vector<std::string>& args) {
+    CommandContext context;
+    return executeWithContext(args, context);
+}
+
+CommandResult CliStatsCommand::executeWithContext(const std::vector<std::string>& args, CommandContext& context) {
+    std::vector<CommandStats> stats;
+    if (args.empty()) {
+        stats = CppEngine.getMetrics().snapshot();
+    } else {
+        std::string commandName;
+        for (const std::string& word : args) {
+            commandName += (commandName.empty() ? "" : " ") + word;
+        }
+        stats.push_back(CppEngine.getMetrics().snapshot(commandName));
+        if (stats.back().invocations == 0) {
+            return CommandResult(CommandResult::Status::Warning, "No executions recorded for: " + commandName);
+        }
+    }
+
+    std::string sortKey = context.options.getString("sort").value_or("name");
+    auto byKey = [&sortKey](const CommandStats& a, const CommandStats& b) {
+        if (sortKey == "calls") return a.invocations > b.invocations;
+        if (sortKey == "errors") return a.errors > b.errors;
+        if (sortKey == "mean") return a.meanTime() > b.meanTime();
+        if (sortKey == "p95") return a.percentile(95) > b.percentile(95);
+        if (sortKey == "max") return a.maxTime > b.maxTime;
+        return a.name < b.name;
+    };
+    if (sortKey != "name" && sortKey != "calls" && sortKey != "errors" && sortKey != "mean" && sortKey != "p95" &&
+        sortKey != "max") {
+        return CommandResult(CommandResult::Status::Error, "cli stats: unknown sort key: " + sortKey);
+    }
+    std::stable_sort(stats.begin(), stats.end(), byKey);
+
+    long long top = context.options.getInteger("top").value_or(0);
+    if (top > 0 && static_cast<size_t>(top) < stats.size()) {
+        stats.resize(static_cast<size_t>(top));
+    }
+
+    context.emit(StructuredData(formatStatsRow("COMMAND", "CALLS", "ERRORS", "WARNS", "MEAN", "P50", "P95", "P99", "MAX")));
+    for (const CommandStats& entry : stats) {
+        if (!context.emit(StructuredData(formatStatsRow(
+                entry.name, std::to_string(entry.invocations), std::to_string(entry.errors),
+                std::to_string(entry.warnings), formatDuration(entry.meanTime()), formatDuration(entry.percentile(50)),
+                formatDuration(entry.percentile(95)), formatDuration(entry.percentile(99)),
+                formatDuration(entry.maxTime))))) {
+            break;
+        }
+    }
+
+    if (context.options.getFlag("reset")) {
+        CppEngine.getMetrics().reset();
+    }
+    return CommandResult(CommandResult::Status::Success,
+                         "Execution stats for " + std::to_string(stats.size()) + " command(s).");
+}
+
+const std::vector<OptionSpec>& CliHistoryCommand::getOptions() const {
+    static const std::vector<OptionSpec> options = {
+        {"limit", OptionSpec::Type::Integer, "Show at most the n newest matching entries (default: 50)."},
+        {"clear", OptionSpec::Type::Flag, "Delete the history, including the history file."},
+    };
+    return options;
+}
+
+CommandResult CliHistoryCommand::execute(const std::vector<std::string>& args) {
+    CommandContext context;
+    return executeWithContext(args, context);
+}
+
+CommandResult CliHistoryCommand::executeWithContext(const std::vector<std::string>& args, CommandContext& context) {
+    HistoryManager& history = CppEngine.getHistory();
+    if (context.options.getFlag("clear")) {
+        history.clear();
+        return CommandResult(CommandResult::Status::Success, "History cleared.");
+    }
+
+    std::string query;
+    for (const std::string& word : args) {
+        query += (query.empty() ? "" : " ") + word;
+    }
+    long long limit = context.options.getInteger("limit").value_or(50);
+    std::vector<std::pair<size_t, std::string>> matches = history.find(query, limit > 0 ? static_cast<size_t>(limit) : 0);
+
+    // find() returns newest first; print oldest first like a shell's history listing.
+    for (auto it = matches.rbegin(); it != matches.rend(); ++it) {
+        char number[16];
+        std::snprintf(number, sizeof(number), "%5zu  ", it->first);
+        if (!context.emit(StructuredData(number + it->second))) {
+            break;
+        }
+    }
+    return CommandResult(CommandResult::Status::Success, std::to_string(matches.size()) + " history entr" +
+                         (matches.size() == 1 ? "y." : "ies."));
+}
+
+const std::vector<OptionSpec>& CliCacheCommand::getOptions() const {
+    static const std::vector<OptionSpec> options = {
+        {"clear", OptionSpec::Type::Flag, "Drop every cached result."},
+    };
+    return options;
+}
+
+CommandResult CliCacheCommand::execute(const std::vector<std::string>& args) {
+    CommandContext context;
+    return executeWithContext(args, context);
+}
+
+CommandResult CliCacheCommand::executeWithContext(const std::vector<std::string>& args, CommandContext& context) {
+    if (!args.empty()) {
+        return CommandResult(CommandResult::Status::Error, "Usage: " + getHelp());
+    }
+    ResultCache& cache = CppEngine.getResultCache();
+    if (context.options.getFlag("clear")) {
+        cache.clear();
+        return CommandResult(CommandResult::Status::Success, "Result cache cleared.");
+    }
+
+    ResultCache::Stats stats = cache.getStats();
+    std::map<std::string, StructuredData> record = {
+        {"entries", stats.entries},
+        {"hits", stats.hits},
+        {"misses", stats.misses},
+        {"stores", stats.stores},
+        {"invalidations", stats.invalidations},
+    };
+    return CommandResult(CommandResult::Status::Success,
+                         std::to_string(stats.entries) + " cached result(s); " + std::to_string(stats.hits) + " hit(s), " +
+                         std::to_string(stats.misses) + " miss(es), " + std::to_string(stats.invalidations) +
+                         " invalidated.",
+                         StructuredData(std::move(record)));
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
@@ -0,0 +1,75 @@
+#ifndef WAVE_CORE_CLI_CLI_COMMANDS_HPP
+#define WAVE_CORE_CLI_CLI_COMMANDS_HPP
+
+#include "cli_engine.hpp"
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Commands about the CLI engine itself. They are not registered by CLIEngine; Core registers them
+// under the "cli" command group during initialization.
+
+// cli stats [<command>] [--sort name|calls|errors|mean|p95|max] [--top <n>] [--reset]
+// One row per executed command: calls, errors, warnings, mean/p50/p95/p99/max latency.
+class CliStatsCommand : public ICommand {
+public:
+    explicit CliStatsCommand(CLIEngine& engine) : CppEngine(engine) {}
+
+    std::string getName() const override { return "cli stats"; }
+    std::string getHelp() const override {
+        return "cli stats [<command>] [--sort name|calls|errors|mean|p95|max] [--top <n>] [--reset] - "
+               "per-command execution counts and latencies.";
+    }
+    const std::vector<OptionSpec>& getOptions() const override;
+    CommandResult execute(const std::vector<std::string>& args) override;
+    CommandResult executeWithContext(const std::vector<std::string>& args, CommandContext& context) override;
+
+    // Compact duration rendering used in the table, e.g. "850us", "12.4ms", "3.20s".
+    static std::string formatDuration(std::chrono::nanoseconds duration);
+
+private:
+    CLIEngine& CppEngine;
+};
+
+// cli history [<text>] [--limit <n>] [--clear]
+// Lists interactive history entries (numbered for "!<n>"), newest last; <text> filters by substring.
+class CliHistoryCommand : public ICommand {
+public:
+    explicit CliHistoryCommand(CLIEngine& engine) : CppEngine(engine) {}
+
+    std::string getName() const override { return "cli history"; }
+    std::string getHelp() const override {
+        return "cli history [<text>] [--limit <n>] [--clear] - shows (or clears) the command history.";
+    }
+    const std::vector<OptionSpec>& getOptions() const override;
+    CommandResult execute(const std::vector<std::string>& args) override;
+    CommandResult executeWithContext(const std::vector<std::string>& args, CommandContext& context) override;
+
+private:
+    CLIEngine& CppEngine;
+};
+
+// cli cache [--clear]
+// Result cache statistics (entries, hits, misses, stores, invalidations) as a record.
+class CliCacheCommand : public ICommand {
+public:
+    explicit CliCacheCommand(CLIEngine& engine) : CppEngine(engine) {}
+
+    std::string getName() const override { return "cli cache"; }
+    std::string getHelp() const override {
+        return "cli cache [--clear] - shows (or clears) the cached results of cacheable commands.";
+    }
+    const std::vector<OptionSpec>& getOptions() const override;
+    CommandResult execute(const std::vector<std::string>& args) override;
+    CommandResult executeWithContext(const std::vector<std::string>& args, CommandContext& context) override;
+
+private:
+    CLIEngine& CppEngine;
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_CLI_COMMANDS_HPP
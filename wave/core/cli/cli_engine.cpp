@@ -1,86 +1,821 @@
 #include "cli_engine.hpp"
+#include "output_formatter.hpp"
 #include <iostream> // For std::cout, std::cin in startInteractiveSession
-#include <sstream>  // For std::istringstream in parseCommandLine
 #include <algorithm> // For std::remove if needed (not for map directly)
+#include <thread>    // For std::thread::hardware_concurrency
+#include <iterator>  // For std::istreambuf_iterator in executeScript
 
 namespace wave {
 namespace core {
 namespace cli {
 
-CLIEngine::CLIEngine() {
-    // Constructor, if any specific initialization is needed for CppCommandRegistry or mutexes.
-    // For now, default member initialization is sufficient.
+namespace {
+size_t defaultAsyncWorkerCount() {
+    // Commands are mostly I/O or module bound; a small fixed pool keeps a burst of slow
+    // commands from oversubscribing the machine.
+    size_t hw = std::thread::hardware_concurrency();
+    return std::max<size_t>(2, std::min<size_t>(hw == 0 ? 2 : hw, 8));
+}
+const size_t DEFAULT_ASYNC_QUEUE_CAPACITY = 256;
+
+const char* const DEFAULT_OUTPUT_FORMAT = "text";
+
+// Messages of async executions that never ran; executeScript recognizes them.
+const std::string COMMAND_REJECTED_MESSAGE = "Command rejected: command queue is full or the CLI engine is shutting down.";
+const std::string COMMAND_CANCELLED_MESSAGE = "Command cancelled before execution.";
+
+// Innermost CommandOwnerScope of the thread.
+thread_local const CommandOwnerScope* currentOwnerScope = nullptr;
+
+// A command registered inside a CommandOwnerScope. Everything that would call into the owner's
+// code outside an execution was read at registration.
+class OwnedCommand : public ICommand {
+public:
+    OwnedCommand(std::shared_ptr<ICommand> target, const CommandOwnerScope& scope)
+        : CppTarget(std::move(target)), CppOwner(scope.owner()), CppPin(scope.pin()), CppName(CppTarget->getName()),
+          CppOptions(CppTarget->getOptions()), CppCachePolicy(CppTarget->getCachePolicy()),
+          CppMaxConcurrency(CppTarget->getMaxConcurrency()) {}
+
+    const std::string& owner() const { return CppOwner; }
+    const ICommand* target() const { return CppTarget.get(); }
+
+    CommandResult execute(const std::vector<std::string>& args) override {
+        std::shared_ptr<void> pin = CppPin();
+        return pin ? CppTarget->execute(args) : unavailable();
+    }
+    CommandResult executeWithContext(const std::vector<std::string>& args, CommandContext& context) override {
+        std::shared_ptr<void> pin = CppPin();
+        return pin ? CppTarget->executeWithContext(args, context) : unavailable();
+    }
+    std::string getHelp() const override {
+        std::shared_ptr<void> pin = CppPin();
+        return pin ? CppTarget->getHelp() : CppName + " - unavailable: " + unavailableReason();
+    }
+    std::string getName() const override { return CppName; }
+    size_t getMaxConcurrency() const override { return CppMaxConcurrency; }
+    const std::vector<OptionSpec>& getOptions() const override { return CppOptions; }
+    const CachePolicy& getCachePolicy() const override { return CppCachePolicy; }
+
+private:
+    std::shared_ptr<ICommand> CppTarget;
+    std::string CppOwner;
+    CommandOwnerScope::Pin CppPin;
+    std::string CppName;
+    std::vector<OptionSpec> CppOptions;
+    CachePolicy CppCachePolicy;
+    size_t CppMaxConcurrency;
+
+    std::string unavailableReason() const {
+        return "module '" + CppOwner + "' is not loaded or is being replaced.";
+    }
+    CommandResult unavailable() const {
+        return CommandResult(CommandResult::Status::Error, "Command '" + CppName + "' is unavailable: " + unavailableReason());
+    }
+};
+
+// ScriptSummary as {"succeeded":..,"warnings":..,"failed":..,"skipped":..,"statements":[...]}.
+void writeScriptSummary(const ScriptSummary& summary, ValueWriter& writer) {
+    writer.beginObject(5);
+    writer.key("succeeded");
+    writer.unsignedInteger(summary.succeeded);
+    writer.key("warnings");
+    writer.unsignedInteger(summary.warnings);
+    writer.key("failed");
+    writer.unsignedInteger(summary.failed);
+    writer.key("skipped");
+    writer.unsignedInteger(summary.skipped);
+    writer.key("statements");
+    writer.beginArray(summary.statements.size());
+    for (const ScriptStatementResult& statement : summary.statements) {
+        writer.beginObject(4);
+        writer.key("line");
+        writer.unsignedInteger(statement.lineNumber);
+        writer.key("command");
+        writer.string(statement.commandLine);
+        writer.key("status");
+        writer.string(CommandResult::statusToString(statement.result.status));
+        writer.key("message");
+        writer.string(statement.result.message);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+// Passes rows through to the execution's sink and keeps copies for the result cache.
+class RecordingOutputSink : public IOutputSink {
+public:
+    RecordingOutputSink(IOutputSink* downstream, size_t maxRows) : CppDownstream(downstream), CppMaxRows(maxRows) {}
+
+    bool write(StructuredData row) override {
+        if (CppComplete && CppRows.size() < CppMaxRows) {
+            CppRows.push_back(row);
+        } else {
+            CppComplete = false; // Too big to cache
+        }
+        if (!CppDownstream->write(std::move(row))) {
+            CppComplete = false; // The consumer stopped early: the rows are only a prefix
+            return false;
+        }
+        return true;
+    }
+
+    bool isComplete() const { return CppComplete; }
+    std::vector<StructuredData> takeRows() { return std::move(CppRows); }
+
+private:
+    IOutputSink* CppDownstream;
+    size_t CppMaxRows;
+    std::vector<StructuredData> CppRows;
+    bool CppComplete = true;
+};
+
+std::string cacheKeyFor(const std::string& commandName, const std::vector<std::string>& args, const ParsedOptions& options) {
+    std::string key = commandName;
+    // Length-prefixed: a quoted argument may itself contain '\n' or '\x1f'.
+    for (const std::string& arg : args) {
+        key += '\n';
+        key += std::to_string(arg.size());
+        key += ':';
+        key += arg;
+    }
+    key += '\x1f';
+    key += options.toString();
+    return key;
+}
+
+// Hands the rows collected for a non-streaming caller over in the result. Data the command also
+// returned is kept after them, as a pipeline sees it: a vector as one row per element, anything
+// else as one row.
+void attachCollectedRows(CommandResult& result, std::vector<StructuredData>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    if (result.data.has_value()) {
+        StructuredData data = std::move(*result.data);
+        if (data.type() == typeid(std::vector<StructuredData>)) {
+            for (StructuredData& row : std::any_cast<std::vector<StructuredData>&>(data)) {
+                rows.push_back(std::move(row));
+            }
+        } else {
+            rows.push_back(std::move(data));
+        }
+    }
+    result.data = StructuredData(std::move(rows));
+}
+
+std::unique_ptr<OutputFormatterRegistry> makeOutputFormatters() {
+    auto formatters = std::make_unique<OutputFormatterRegistry>();
+    formatters->registerValueType<ScriptSummary>(writeScriptSummary);
+    return formatters;
+}
+} // namespace
+
+CLIEngine::CLIEngine()
+    : CppCommandRegistry(std::make_shared<CommandTrie>()),
+      CppAsyncWorkerCount(defaultAsyncWorkerCount()), CppAsyncQueueCapacity(DEFAULT_ASYNC_QUEUE_CAPACITY),
+      CppOutputFormatters(makeOutputFormatters()), CppDefaultOutputFormat(DEFAULT_OUTPUT_FORMAT) {
+}
+
+CLIEngine::CLIEngine(size_t asyncWorkerCount, size_t asyncQueueCapacity)
+    : CppCommandRegistry(std::make_shared<CommandTrie>()),
+      CppAsyncWorkerCount(asyncWorkerCount == 0 ? defaultAsyncWorkerCount() : asyncWorkerCount),
+      CppAsyncQueueCapacity(asyncQueueCapacity == 0 ? DEFAULT_ASYNC_QUEUE_CAPACITY : asyncQueueCapacity),
+      CppOutputFormatters(makeOutputFormatters()), CppDefaultOutputFormat(DEFAULT_OUTPUT_FORMAT) {
 }
 
 CLIEngine::~CLIEngine() {
-    // Destructor. Since CLIEngine does not own the ICommand pointers,
-    // it should NOT delete them here. Callers are responsible for command object lifetimes.
-    // If there were any resources owned by CLIEngine (e.g., dynamically allocated commands
-    // if ownership model changes), they would be cleaned up here.
-    std::lock_guard<std::mutex> lock(CppRegistryMutex);
-    CppCommandRegistry.clear(); // Clear the map, but again, does not delete ICommand objects.
+    // Stop invalidation callbacks first; they reference this engine.
+    std::map<std::string, std::function<void()>> cacheTopics;
+    {
+        std::lock_guard<std::mutex> lock(CppCacheTopicsMutex);
+        cacheTopics.swap(CppCacheTopics);
+    }
+    for (auto& topic : cacheTopics) {
+        if (topic.second) {
+            topic.second();
+        }
+    }
+
+    // Let in-flight asynchronous commands finish before the registry goes away.
+    // Anything still waiting for a concurrency slot is resolved with an error below.
+    if (CppCommandPool) {
+        CppCommandPool->shutdown();
+    }
+    {
+        std::lock_guard<std::mutex> lock(CppAsyncMutex);
+        for (auto& pair : CppDeferredInvocations) {
+            for (auto& invocation : pair.second) {
+                invocation->complete(CommandResult(CommandResult::Status::Error,
+                    "Command not executed: CLI engine is shutting down."));
+            }
+        }
+        CppDeferredInvocations.clear();
+    }
+
+    // Raw-pointer registrations are non-owning and are NOT deleted here; shared registrations are
+    // released when the last snapshot referencing them goes away.
 }
 
-// Helper to parse command line.
-// Splits by space. First word is command, rest are args.
-// Handles simple cases, not advanced quoting or escaping.
-bool CLIEngine::parseCommandLine(const std::string& commandLine, std::string& commandName, std::vector<std::string>& args) const {
-    args.clear();
-    commandName.clear();
+namespace {
+std::string joinCandidates(const std::vector<std::string>& candidates) {
+    std::string joined;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (i > 0) joined += ", ";
+        joined += candidates[i];
+    }
+    return joined;
+}
 
-    std::istringstream iss(commandLine);
-    std::string token;
+// Best-effort "--output" lookup in a line that did not resolve, so its error is still reported in
+// the requested format.
+void findOutputFormat(const std::vector<std::string_view>& words, std::string& outputFormat) {
+    for (size_t i = 0; i < words.size() && words[i] != "--"; ++i) {
+        if (words[i] == "--output" && i + 1 < words.size()) {
+            outputFormat = std::string(words[i + 1]);
+        } else if (words[i].substr(0, 9) == "--output=") {
+            outputFormat = std::string(words[i].substr(9));
+        }
+    }
+}
+} // namespace
 
-    if (!(iss >> commandName)) {
-        return false; // Empty command line or failed to read command name
+std::optional<CommandResult> CLIEngine::resolveCommand(const std::string& commandLine, std::string& commandName,
+                                                  std::vector<std::string>& args, ParsedOptions& options,
+                                                  std::shared_ptr<ICommand>& command, std::string& outputFormat,
+                                                  RowPipeline& pipeline) const {
+    command = nullptr;
+    if (commandLine.empty()) {
+        return CommandResult(CommandResult::Status::Error, "Command line cannot be empty.");
     }
 
-    while (iss >> token) {
-        args.push_back(token);
+    // "cmd | op | op": the command is the first stage. Lines without '|' skip the split.
+    std::string_view commandText = commandLine;
+    std::vector<std::string_view> stages;
+    std::string parseError;
+    if (commandLine.find('|') != std::string::npos) {
+        if (!InputParser::splitPipeline(commandLine, stages, &parseError)) {
+            return CommandResult(CommandResult::Status::Error, "Failed to parse command line: " + parseError);
+        }
+        commandText = stages[0];
     }
-    return true;
+
+    // Tokens are views into commandLine (or into scratch when unescaped), so only the
+    // arguments finally handed to the command are copied.
+    std::vector<std::string_view> words;
+    std::string scratch;
+    if (!InputParser::tokenize(commandText, words, scratch, &parseError)) {
+        return CommandResult(CommandResult::Status::Error, "Failed to parse command line: " + parseError);
+    }
+    if (words.empty()) {
+        return CommandResult(CommandResult::Status::Error, "Failed to parse command line.");
+    }
+
+    // Never blocked by registration: the snapshot is immutable once published, and the
+    // matched command is returned as a shared_ptr that outlives a concurrent unregister.
+    CommandTrie::Match match = registrySnapshot()->match(words);
+    if (match.status != CommandTrie::Match::Status::Found) {
+        findOutputFormat(words, outputFormat);
+    }
+
+    switch (match.status) {
+        case CommandTrie::Match::Status::Found:
+            break;
+        case CommandTrie::Match::Status::Ambiguous:
+            return CommandResult(CommandResult::Status::Error,
+                                 "Ambiguous command: " + std::string(words[match.wordsConsumed]) + " (candidates: " + joinCandidates(match.candidates) + ")");
+        case CommandTrie::Match::Status::Incomplete:
+            return CommandResult(CommandResult::Status::Error,
+                                 "Incomplete command: " + match.canonicalName + " (expected one of: " + joinCandidates(match.candidates) + ")");
+        default:
+            return CommandResult(CommandResult::Status::Error, "Command not found: " + std::string(words[0]));
+    }
+
+    std::vector<std::string_view> rest(words.begin() + match.wordsConsumed, words.end());
+    const std::vector<OptionSpec>& specs = match.command->getOptions();
+    if (auto error = takeOutputOption(match.canonicalName, specs, rest, outputFormat)) {
+        return error;
+    }
+    if (specs.empty()) {
+        args.assign(rest.begin(), rest.end());
+    } else {
+        std::string optionError;
+        if (!ParsedOptions::parse(specs, rest, options, args, optionError)) {
+            return CommandResult(CommandResult::Status::Error, match.canonicalName + ": " + optionError);
+        }
+    }
+
+    for (size_t i = 1; i < stages.size(); ++i) {
+        if (auto error = appendPipelineStage(stages[i], pipeline, outputFormat)) {
+            return error;
+        }
+    }
+
+    command = match.command;
+    commandName = std::move(match.canonicalName);
+    return std::nullopt;
+}
+
+std::optional<CommandResult> CLIEngine::takeOutputOption(const std::string& owner, const std::vector<OptionSpec>& specs,
+                                                         std::vector<std::string_view>& words,
+                                                         std::string& outputFormat) const {
+    // "--output <format>" is an engine option available to every command (and pipeline operator)
+    // that does not declare an "output" option of its own. Like other options it is not
+    // recognised after "--".
+    bool ownsOutput = std::any_of(specs.begin(), specs.end(), [](const OptionSpec& spec) { return spec.name == "output"; });
+    if (ownsOutput) {
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < words.size() && words[i] != "--"; ++i) {
+        std::string_view word = words[i];
+        size_t consumed = 1;
+        if (word == "--output") {
+            if (i + 1 >= words.size()) {
+                return CommandResult(CommandResult::Status::Error, owner + ": --output requires a value");
+            }
+            outputFormat = std::string(words[i + 1]);
+            consumed = 2;
+        } else if (word.substr(0, 9) == "--output=") {
+            outputFormat = std::string(word.substr(9));
+        } else {
+            continue;
+        }
+        if (!CppOutputFormatters->hasFormatter(outputFormat)) {
+            return CommandResult(CommandResult::Status::Error, "Unknown output format: " + outputFormat +
+                                 " (available: " + joinCandidates(CppOutputFormatters->getFormatterNames()) + ")");
+        }
+        words.erase(words.begin() + i, words.begin() + i + consumed);
+        --i;
+    }
+    return std::nullopt;
+}
+
+std::optional<CommandResult> CLIEngine::appendPipelineStage(std::string_view stage, RowPipeline& pipeline,
+                                                            std::string& outputFormat) const {
+    std::vector<std::string_view> words;
+    std::string scratch;
+    std::string parseError;
+    if (!InputParser::tokenize(stage, words, scratch, &parseError) || words.empty()) {
+        return CommandResult(CommandResult::Status::Error, "Failed to parse pipeline stage: " + parseError);
+    }
+    std::string name(words[0]);
+    std::shared_ptr<const PipelineOperator> op = CppPipelineOperators.find(name);
+    if (!op) {
+        return CommandResult(CommandResult::Status::Error, "Unknown pipeline operator: " + name +
+                             " (available: " + joinCandidates(CppPipelineOperators.getOperatorNames()) + ")");
+    }
+
+    std::vector<std::string_view> rest(words.begin() + 1, words.end());
+    if (auto error = takeOutputOption(name, op->options, rest, outputFormat)) {
+        return error;
+    }
+    std::vector<std::string> args;
+    ParsedOptions options;
+    std::string error;
+    if (!ParsedOptions::parse(op->options, rest, options, args, error)) {
+        return CommandResult(CommandResult::Status::Error, name + ": " + error);
+    }
+    std::unique_ptr<RowFilter> filter = op->create(args, options, *CppOutputFormatters, error);
+    if (!filter) {
+        return CommandResult(CommandResult::Status::Error, name + ": " + error);
+    }
+    pipeline.append(std::move(filter));
+    return std::nullopt;
+}
+
+CommandResult CLIEngine::invokeCommand(const std::string& commandName, ICommand& command,
+                                       const std::vector<std::string>& args, CommandContext& context,
+                                       RowPipeline& pipeline) {
+    // Pipeline filters sit between the command and the caller's sink for this execution only.
+    IOutputSink* sink = context.output;
+    if (sink) {
+        sink->begin(context.outputFormat);
+    }
+    if (!pipeline.empty() && sink) {
+        context.output = pipeline.connect(sink);
+    }
+
+    // Cacheable commands are answered from the cache when possible; otherwise their rows are
+    // recorded on the way to the pipeline so the run can be cached.
+    const CachePolicy& cachePolicy = command.getCachePolicy();
+    bool cacheable = cachePolicy.isCacheable() && sink;
+    std::string cacheKey;
+    std::shared_ptr<const ResultCache::Entry> cached;
+    ResultCache::Ticket cacheTicket;
+    if (cacheable) {
+        cacheKey = cacheKeyFor(commandName, args, context.options);
+        cached = CppResultCache.lookup(cacheKey);
+        if (!cached) {
+            subscribeCacheTopics(cachePolicy);
+            cacheTicket = CppResultCache.begin(cachePolicy);
+        }
+    }
+
+    // Executed outside the registry lock: ICommand::execute is independent of the registry
+    // and may itself register or unregister commands.
+    auto started = std::chrono::steady_clock::now();
+    CommandResult result(CommandResult::Status::Error, "");
+    try {
+        if (cached) {
+            for (const StructuredData& row : cached->rows) {
+                if (!context.emit(row)) {
+                    break;
+                }
+            }
+            result = *cached->result;
+        } else if (cacheable) {
+            RecordingOutputSink recorder(context.output, CppResultCache.getMaxRowsPerEntry());
+            IOutputSink* target = context.output;
+            context.output = &recorder;
+            result = command.executeWithContext(args, context);
+            context.output = target;
+            if (result.status == CommandResult::Status::Success && recorder.isComplete() &&
+                !context.cancellation.isCancelled()) {
+                CppResultCache.store(cacheKey, cachePolicy, cacheTicket,
+                                     ResultCache::Entry{std::make_shared<const CommandResult>(result), recorder.takeRows()});
+            }
+        } else {
+            result = command.executeWithContext(args, context);
+        }
+        if (!pipeline.empty() && sink) {
+            // Data returned instead of emitted flows through the pipeline too: a vector as one row
+            // per element, anything else as a single row.
+            if (result.data.has_value()) {
+                StructuredData data = std::move(*result.data);
+                result.data.reset();
+                if (data.type() == typeid(std::vector<StructuredData>)) {
+                    for (StructuredData& row : std::any_cast<std::vector<StructuredData>&>(data)) {
+                        if (!context.output->write(std::move(row))) {
+                            break;
+                        }
+                    }
+                } else {
+                    context.output->write(std::move(data));
+                }
+            }
+            pipeline.finish();
+        }
+    } catch (const std::exception& e) {
+        result = CommandResult(CommandResult::Status::Error, "Command execution failed with exception: " + std::string(e.what()));
+    } catch (...) {
+        result = CommandResult(CommandResult::Status::Error, "Command execution failed with unknown exception.");
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+    context.output = sink;
+
+    CommandOutcome outcome = CommandOutcome::Success;
+    if (result.status == CommandResult::Status::Error) {
+        outcome = CommandOutcome::Error;
+    } else if (result.status == CommandResult::Status::Warning) {
+        outcome = CommandOutcome::Warning;
+    }
+    CppMetrics.record(commandName, outcome, elapsed);
+
+    int64_t slowThreshold = CppSlowCommandThresholdNanos.load(std::memory_order_relaxed);
+    if (slowThreshold > 0 && elapsed.count() >= slowThreshold) {
+        SlowCommandCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(CppSlowCommandMutex);
+            callback = CppSlowCommandCallback;
+        }
+        if (callback) {
+            try {
+                callback(commandName, args, elapsed);
+            } catch (...) {
+                // Reporting must never change the command's result.
+            }
+        }
+    }
+    return result;
+}
+
+void CLIEngine::setCacheTopicSubscriber(CacheTopicSubscriber subscriber) {
+    std::lock_guard<std::mutex> subscribing(CppCacheSubscribeMutex);
+    std::map<std::string, std::function<void()>> previous;
+    std::vector<std::string> topics;
+    {
+        std::lock_guard<std::mutex> lock(CppCacheTopicsMutex);
+        CppCacheTopicSubscriber = subscriber;
+        for (auto& topic : CppCacheTopics) {
+            previous[topic.first] = std::move(topic.second);
+            topic.second = nullptr;
+            topics.push_back(topic.first);
+        }
+    }
+    for (auto& topic : previous) {
+        if (topic.second) {
+            topic.second();
+        }
+    }
+    if (subscriber) {
+        for (const std::string& topic : topics) {
+            std::function<void()> unsubscribe = subscriber(topic, [this, topic]() { CppResultCache.invalidate(topic); });
+            std::lock_guard<std::mutex> lock(CppCacheTopicsMutex);
+            CppCacheTopics[topic] = std::move(unsubscribe);
+        }
+    }
+    // Events published while no subscription was in place went unseen: drop what they may have
+    // made stale, and keep runs that overlapped the switch from being stored.
+    for (const std::string& topic : topics) {
+        CppResultCache.invalidate(topic);
+    }
+}
+
+void CLIEngine::subscribeCacheTopics(const CachePolicy& policy) {
+    // Topics are subscribed the first time a command using them runs. A topic is entered in
+    // CppCacheTopics only once its subscription is in place, and callers return from here (and
+    // take their cache ticket) only after that, so no execution is cached without seeing its
+    // invalidations. The subscriber is called under CppCacheSubscribeMutex but not under
+    // CppCacheTopicsMutex: an event bus may deliver events while subscribing.
+    auto allKnown = [this, &policy]() {
+        for (const std::string& topic : policy.invalidatedBy) {
+            if (CppCacheTopics.find(topic) == CppCacheTopics.end()) {
+                return false;
+            }
+        }
+        return true;
+    };
+    {
+        std::lock_guard<std::mutex> lock(CppCacheTopicsMutex);
+        if (allKnown()) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> subscribing(CppCacheSubscribeMutex);
+    std::vector<std::string> added;
+    CacheTopicSubscriber subscriber;
+    {
+        std::lock_guard<std::mutex> lock(CppCacheTopicsMutex);
+        for (const std::string& topic : policy.invalidatedBy) {
+            if (CppCacheTopics.find(topic) == CppCacheTopics.end() &&
+                std::find(added.begin(), added.end(), topic) == added.end()) {
+                added.push_back(topic);
+            }
+        }
+        subscriber = CppCacheTopicSubscriber;
+    }
+    for (const std::string& topic : added) {
+        std::function<void()> unsubscribe;
+        if (subscriber) {
+            unsubscribe = subscriber(topic, [this, topic]() { CppResultCache.invalidate(topic); });
+        }
+        std::lock_guard<std::mutex> lock(CppCacheTopicsMutex);
+        CppCacheTopics[topic] = std::move(unsubscribe);
+    }
+}
+
+void CLIEngine::setSlowCommandThreshold(std::chrono::milliseconds threshold, SlowCommandCallback callback) {
+    std::lock_guard<std::mutex> lock(CppSlowCommandMutex);
+    CppSlowCommandCallback = std::move(callback);
+    int64_t nanos = CppSlowCommandCallback ? std::chrono::duration_cast<std::chrono::nanoseconds>(threshold).count() : 0;
+    CppSlowCommandThresholdNanos.store(std::max<int64_t>(nanos, 0), std::memory_order_relaxed);
 }
 
 CommandResult CLIEngine::executeCommand(const std::string& commandLine) {
+    CommandContext context;
+    return executeCommand(commandLine, context);
+}
+
+CommandResult CLIEngine::executeCommand(const std::string& commandLine, IOutputSink& sink) {
+    CommandContext context;
+    context.output = &sink;
+    return executeCommand(commandLine, context);
+}
+
+CommandResult CLIEngine::executeCommand(const std::string& commandLine, CommandContext& context) {
     std::string commandName;
     std::vector<std::string> args;
+    std::shared_ptr<ICommand> command;
+    RowPipeline pipeline;
 
-    if (commandLine.empty()) {
-        return CommandResult(CommandResult::Status::Error, "Command line cannot be empty.");
+    if (auto error = resolveCommand(commandLine, commandName, args, context.options, command, context.outputFormat,
+                                    pipeline)) {
+        return *error;
     }
 
-    if (!parseCommandLine(commandLine, commandName, args)) {
-        return CommandResult(CommandResult::Status::Error, "Failed to parse command line.");
+    if (context.output) {
+        return invokeCommand(commandName, *command, args, context, pipeline);
+    }
+
+    // Rows streamed by the command are collected so callers of the non-streaming API still see them.
+    CollectingOutputSink collector;
+    context.output = &collector;
+    CommandResult result = invokeCommand(commandName, *command, args, context, pipeline);
+    context.output = nullptr;
+    attachCollectedRows(result, collector.rows());
+    return result;
+}
+
+CommandResult CLIEngine::executeCommand(const std::string& commandLine, std::ostream& out, const std::string& defaultFormat) {
+    CommandContext context;
+    std::string commandName;
+    std::vector<std::string> args;
+    std::shared_ptr<ICommand> command;
+    RowPipeline pipeline;
+    std::optional<CommandResult> error =
+        resolveCommand(commandLine, commandName, args, context.options, command, context.outputFormat, pipeline);
+
+    std::string format = !context.outputFormat.empty() ? context.outputFormat
+                       : !defaultFormat.empty()        ? defaultFormat
+                                                       : getDefaultOutputFormat();
+    std::unique_ptr<OutputFormatter> formatter = CppOutputFormatters->create(format, out);
+    if (!formatter) {
+        formatter = CppOutputFormatters->create(DEFAULT_OUTPUT_FORMAT, out);
+        if (!error) {
+            error = CommandResult(CommandResult::Status::Error, "Unknown output format: " + format +
+                                  " (available: " + joinCandidates(CppOutputFormatters->getFormatterNames()) + ")");
+        }
+    }
+    if (error) {
+        formatter->finish(*error);
+        return *error;
+    }
+
+    context.output = formatter.get();
+    CommandResult result = invokeCommand(commandName, *command, args, context, pipeline);
+    context.output = nullptr;
+    formatter->finish(result);
+    return result;
+}
+
+bool CLIEngine::setDefaultOutputFormat(const std::string& format) {
+    if (!CppOutputFormatters->hasFormatter(format)) {
+        return false;
     }
+    std::lock_guard<std::mutex> lock(CppDefaultOutputFormatMutex);
+    CppDefaultOutputFormat = format;
+    return true;
+}
 
-    ICommand* command = nullptr;
+std::string CLIEngine::getDefaultOutputFormat() const {
+    std::lock_guard<std::mutex> lock(CppDefaultOutputFormatMutex);
+    return CppDefaultOutputFormat;
+}
+
+AsyncCommandHandle CLIEngine::executeCommandAsync(const std::string& commandLine) {
+    return executeCommandAsync(commandLine, CommandContext());
+}
+
+AsyncCommandHandle CLIEngine::executeCommandAsync(const std::string& commandLine, CommandContext context,
+                                                  CommandCompletionCallback onComplete) {
+    AsyncCommandHandle handle;
+    auto invocation = std::make_shared<AsyncInvocation>();
+    invocation->context = std::move(context);
+    if (!invocation->context.output) {
+        invocation->context.output = &invocation->collector;
+    }
+    invocation->onComplete = std::move(onComplete);
+    handle.cancellation = invocation->context.cancellation;
+    handle.result = invocation->promise.get_future();
+
+    if (auto error = resolveCommand(commandLine, invocation->commandName, invocation->args,
+                                    invocation->context.options, invocation->command,
+                                    invocation->context.outputFormat, invocation->pipeline)) {
+        invocation->complete(*error);
+        return handle;
+    }
+    handle.outputFormat = invocation->context.outputFormat;
+    startAsync(invocation);
+    return handle;
+}
+
+CommandStreamHandle CLIEngine::executeCommandStreaming(const std::string& commandLine, size_t bufferRows) {
+    CommandStreamHandle handle;
+    auto invocation = std::make_shared<AsyncInvocation>();
+    handle.rows = std::make_shared<CommandOutputStream>(bufferRows);
+    invocation->stream = handle.rows;
+    invocation->context.cancellation = handle.cancellation;
+    invocation->context.output = invocation->stream.get();
+    handle.result = invocation->promise.get_future();
+
+    if (auto error = resolveCommand(commandLine, invocation->commandName, invocation->args,
+                                    invocation->context.options, invocation->command,
+                                    invocation->context.outputFormat, invocation->pipeline)) {
+        invocation->complete(*error);
+        return handle;
+    }
+    startAsync(invocation);
+    return handle;
+}
+
+// Takes a concurrency slot for the invocation's command, or parks it until one frees up. At most
+// the pool's queue capacity of invocations wait per command; more are rejected.
+void CLIEngine::startAsync(const std::shared_ptr<AsyncInvocation>& invocation) {
+    size_t limit = invocation->command->getMaxConcurrency();
+    bool rejected = false;
     {
-        std::lock_guard<std::mutex> lock(CppRegistryMutex);
-        auto it = CppCommandRegistry.find(commandName);
-        if (it != CppCommandRegistry.end()) {
-            command = it->second;
+        std::lock_guard<std::mutex> lock(CppAsyncMutex);
+        size_t& inFlight = CppInFlightCounts[invocation->commandName];
+        if (limit > 0 && inFlight >= limit) {
+            std::deque<std::shared_ptr<AsyncInvocation>>& deferred = CppDeferredInvocations[invocation->commandName];
+            if (deferred.size() >= CppAsyncQueueCapacity) {
+                rejected = true;
+            } else {
+                deferred.push_back(invocation);
+                return;
+            }
         } else {
-            // Check for a generic "help" command if the specific command is not found
-            // and the requested command was "help" itself with arguments.
-            // Or, provide a list of commands.
-            // For now, simple "command not found".
-            return CommandResult(CommandResult::Status::Error, "Command not found: " + commandName);
+            ++inFlight;
         }
     }
+    if (rejected) {
+        invocation->complete(CommandResult(CommandResult::Status::Error, "Command rejected: " +
+            std::to_string(CppAsyncQueueCapacity) + " executions of '" + invocation->commandName +
+            "' are already waiting for a concurrency slot."));
+        return;
+    }
+    dispatchAsync(invocation);
+}
+
+CommandThreadPool& CLIEngine::commandPool() {
+    std::call_once(CppCommandPoolInit, [this]() {
+        CppCommandPool = std::make_unique<CommandThreadPool>(CppAsyncWorkerCount, CppAsyncQueueCapacity);
+    });
+    return *CppCommandPool;
+}
 
-    // Execute command outside the lock if possible, unless command execution itself needs
-    // to interact with the registry in a complex way. ICommand::execute is independent.
-    if (command) {
-        try {
-            return command->execute(args);
-        } catch (const std::exception& e) {
-            return CommandResult(CommandResult::Status::Error, "Command execution failed with exception: " + std::string(e.what()));
-        } catch (...) {
-            return CommandResult(CommandResult::Status::Error, "Command execution failed with unknown exception.");
+// Hands an invocation that already holds a concurrency slot to the pool.
+// If the pool rejects it, the invocation fails and its slot passes to the next deferred one.
+void CLIEngine::dispatchAsync(const std::shared_ptr<AsyncInvocation>& invocation) {
+    std::shared_ptr<AsyncInvocation> current = invocation;
+    while (current) {
+        if (commandPool().submit([this, current]() { runAsync(current); })) {
+            return;
         }
+        current->complete(CommandResult(CommandResult::Status::Error,
+            COMMAND_REJECTED_MESSAGE));
+        current = releaseAsyncSlot(current->commandName);
     }
-    // Should not be reached if logic is correct, but as a fallback:
-    return CommandResult(CommandResult::Status::Error, "Internal error: Command pointer was null after lookup.");
+}
+
+void CLIEngine::runAsync(const std::shared_ptr<AsyncInvocation>& invocation) {
+    if (invocation->context.cancellation.isCancelled() || (invocation->stream && invocation->stream->isCancelled())) {
+        invocation->complete(CommandResult(CommandResult::Status::Error, COMMAND_CANCELLED_MESSAGE));
+    } else {
+        CommandResult result = invokeCommand(invocation->commandName, *invocation->command, invocation->args,
+                                             invocation->context, invocation->pipeline);
+        attachCollectedRows(result, invocation->collector.rows());
+        invocation->complete(std::move(result));
+    }
+    std::shared_ptr<AsyncInvocation> next = releaseAsyncSlot(invocation->commandName);
+    if (next) {
+        dispatchAsync(next);
+    }
+}
+
+// Frees one concurrency slot for commandName. If an invocation is waiting for that command,
+// the slot is transferred to it and it is returned for dispatch.
+std::shared_ptr<CLIEngine::AsyncInvocation> CLIEngine::releaseAsyncSlot(const std::string& commandName) {
+    std::lock_guard<std::mutex> lock(CppAsyncMutex);
+    auto deferredIt = CppDeferredInvocations.find(commandName);
+    if (deferredIt != CppDeferredInvocations.end() && !deferredIt->second.empty()) {
+        std::shared_ptr<AsyncInvocation> next = deferredIt->second.front();
+        deferredIt->second.pop_front();
+        if (deferredIt->second.empty()) {
+            CppDeferredInvocations.erase(deferredIt);
+        }
+        return next; // Slot handed over; in-flight count unchanged.
+    }
+    auto countIt = CppInFlightCounts.find(commandName);
+    if (countIt != CppInFlightCounts.end()) {
+        if (countIt->second > 1) {
+            --countIt->second;
+        } else {
+            CppInFlightCounts.erase(countIt);
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const CommandTrie> CLIEngine::registrySnapshot() const {
+    // C++17 atomic shared_ptr access. Not wait-free: libstdc++ guards the pointer copy with a mutex
+    // from a global pool, held only for the copy itself. Readers never wait for a writer that is
+    // building the next snapshot, as that happens under CppRegistryMutex before the store.
+    return std::atomic_load(&CppCommandRegistry);
+}
+
+CommandOwnerScope::CommandOwnerScope(std::string owner, Pin pin)
+    : CppOwner(std::move(owner)), CppPin(std::move(pin)), CppOuter(currentOwnerScope) {
+    currentOwnerScope = this;
+}
+
+CommandOwnerScope::~CommandOwnerScope() {
+    currentOwnerScope = CppOuter;
+}
+
+const CommandOwnerScope* CommandOwnerScope::current() {
+    return currentOwnerScope;
+}
+
+bool CLIEngine::updateRegistry(const std::function<bool(CommandTrie&)>& edit) {
+    std::lock_guard<std::mutex> lock(CppRegistryMutex);
+    auto next = std::make_shared<CommandTrie>(*registrySnapshot()); // O(1): nodes are shared
+    if (!edit(*next)) {
+        return false;
+    }
+    std::atomic_store(&CppCommandRegistry, std::shared_ptr<const CommandTrie>(std::move(next)));
+    return true;
 }
 
 // Registers a command with the given name.
@@ -91,41 +826,199 @@ void CLIEngine::registerCommand(const std::string& name, ICommand* command) {
         // For now, silently ignore null command pointers.
         return;
     }
-    if (name.empty()) {
-        // Optionally log an error: command name cannot be empty
-        // Or return a CommandResult indicating failure if this method were to return one.
+    // Non-owning handle: the no-op deleter leaves the object to the caller.
+    registerCommand(name, std::shared_ptr<ICommand>(command, [](ICommand*) {}));
+}
+
+void CLIEngine::registerCommand(const std::string& name, std::shared_ptr<ICommand> command) {
+    if (!command || name.empty()) {
         return;
     }
-
-    std::lock_guard<std::mutex> lock(CppRegistryMutex);
-    if (CppCommandRegistry.find(name) == CppCommandRegistry.end()) {
-        CppCommandRegistry[name] = command;
-    } else {
-        // Command with this name already registered.
-        // Current behavior: do nothing (ignore the new command).
-        // Alternative: throw, log a warning, or replace existing.
-        // For now, this matches the previous logic of not overwriting.
+    const CommandOwnerScope* scope = CommandOwnerScope::current();
+    if (!scope) {
+        // A command already registered under this path is kept; the new one is ignored.
+        updateRegistry([&](CommandTrie& registry) { return registry.insert(name, std::move(command)); });
+        return;
+    }
+    auto owned = std::make_shared<OwnedCommand>(std::move(command), *scope);
+    bool replaced = false;
+    updateRegistry([&](CommandTrie& registry) {
+        // The same owner's command under this path is replaced (a hot reloaded module's new
+        // instance); anyone else's is kept, as above.
+        std::shared_ptr<ICommand> existing = registry.find(name);
+        auto* previous = dynamic_cast<OwnedCommand*>(existing.get());
+        if (previous && previous->owner() == owned->owner()) {
+            replaced = registry.erase(name, existing.get());
+        }
+        return registry.insert(name, owned) || replaced;
+    });
+    if (replaced) {
+        CppResultCache.clear(); // Results of the old instance's command
     }
 }
 
 
 void CLIEngine::unregisterCommand(const std::string& name) {
     if (name.empty()) return;
+    // Executions that already resolved the command keep their own reference to it.
+    if (updateRegistry([&](CommandTrie& registry) { return registry.erase(name); })) {
+        CppResultCache.clear(); // A command registered later under the name must not see old results
+    }
+}
 
-    std::lock_guard<std::mutex> lock(CppRegistryMutex);
-    CppCommandRegistry.erase(name);
+bool CLIEngine::unregisterCommand(const std::string& name, const ICommand& expected) {
+    bool removed = updateRegistry([&](CommandTrie& registry) {
+        // A command registered in a CommandOwnerScope is bound wrapped; 'expected' is the one inside.
+        const ICommand* bound = &expected;
+        std::shared_ptr<ICommand> current = registry.find(name);
+        auto* owned = dynamic_cast<const OwnedCommand*>(current.get());
+        if (owned && owned->target() == &expected) {
+            bound = current.get();
+        }
+        return registry.erase(name, bound);
+    });
+    if (!removed) {
+        return false;
+    }
+    CppResultCache.clear();
+    return true;
+}
+
+std::shared_ptr<ICommand> CLIEngine::findCommand(const std::string& name) const {
+    return registrySnapshot()->find(name);
+}
+
+bool CLIEngine::registerAlias(const std::string& alias, const std::string& target) {
+    return updateRegistry([&](CommandTrie& registry) { return registry.addAlias(alias, target); });
+}
+
+bool CLIEngine::unregisterAlias(const std::string& alias) {
+    return updateRegistry([&](CommandTrie& registry) { return registry.removeAlias(alias); });
+}
+
+std::vector<std::pair<std::string, std::string>> CLIEngine::getAliases() const {
+    return registrySnapshot()->listAliases();
+}
+
+std::vector<std::string> CLIEngine::getCompletions(const std::string& partialLine) const {
+    return registrySnapshot()->complete(partialLine);
 }
 
 std::vector<std::string> CLIEngine::getRegisteredCommands() const {
-    std::lock_guard<std::mutex> lock(CppRegistryMutex);
-    std::vector<std::string> commandNames;
-    for (const auto& pair : CppCommandRegistry) {
-        commandNames.push_back(pair.first);
-    }
-    return commandNames;
+    return registrySnapshot()->listCommands();
 }
 
 
+CommandResult CLIEngine::executeScript(std::istream& script, const ScriptOptions& options) {
+    // Read and split the whole script once; statements are views into this buffer.
+    std::string text((std::istreambuf_iterator<char>(script)), std::istreambuf_iterator<char>());
+    std::vector<InputParser::Statement> statements;
+    std::string parseError;
+    if (!InputParser::splitStatements(text, statements, &parseError)) {
+        return CommandResult(CommandResult::Status::Error, "Failed to parse script: " + parseError);
+    }
+
+    ScriptSummary summary;
+    summary.statements.reserve(statements.size());
+    bool stopped = false;
+
+    auto record = [&](const InputParser::Statement& statement, CommandResult result) {
+        switch (result.status) {
+            case CommandResult::Status::Success: ++summary.succeeded; break;
+            case CommandResult::Status::Warning: ++summary.warnings; break;
+            default: ++summary.failed; break;
+        }
+        if (result.status == CommandResult::Status::Error && options.stopOnError) {
+            stopped = true;
+        }
+        summary.statements.push_back(ScriptStatementResult{statement.lineNumber, std::string(statement.text), std::move(result)});
+    };
+
+    auto writeParallelTranscript = [&](const AsyncCommandHandle& handle, const CommandResult& result) {
+        std::string format = handle.outputFormat;
+        if (format.empty()) {
+            format = options.outputFormat.empty() ? getDefaultOutputFormat() : options.outputFormat;
+        }
+        std::unique_ptr<OutputFormatter> formatter = CppOutputFormatters->create(format, *options.transcript);
+        if (!formatter) {
+            formatter = CppOutputFormatters->create(DEFAULT_OUTPUT_FORMAT, *options.transcript);
+        }
+        formatter->finish(result);
+    };
+
+    size_t index = 0;
+    while (index < statements.size() && !stopped) {
+        if (statements[index].text == "wait") {
+            ++index;
+            continue;
+        }
+        if (!options.parallel) {
+            const InputParser::Statement& statement = statements[index++];
+            if (options.transcript) {
+                record(statement, executeCommand(std::string(statement.text), *options.transcript, options.outputFormat));
+            } else {
+                record(statement, executeCommand(std::string(statement.text)));
+            }
+            continue;
+        }
+
+        // Parallel mode: submit everything up to the next barrier, bounded by the room left in the
+        // pool's queue (waiting for some if there is none), then collect the results in script
+        // order. Rows are collected into each result's data and written with it, so the transcript
+        // stays in script order.
+        size_t room = std::max<size_t>(commandPool().waitForSpace(), 1); // 0: shutting down, let it fail
+        std::vector<std::pair<size_t, AsyncCommandHandle>> wave;
+        while (index < statements.size() && statements[index].text != "wait" && wave.size() < room) {
+            wave.emplace_back(index, executeCommandAsync(std::string(statements[index].text)));
+            ++index;
+        }
+        bool cancelled = false;
+        for (auto& entry : wave) {
+            CommandResult result = entry.second.result.get();
+            // Other work may have filled the queue since the wave was sized: wait for room and retry.
+            while (result.status == CommandResult::Status::Error && result.message == COMMAND_REJECTED_MESSAGE &&
+                   !stopped && commandPool().waitForSpace() > 0) {
+                entry.second = executeCommandAsync(std::string(statements[entry.first].text));
+                result = entry.second.result.get();
+            }
+            if (cancelled && result.status == CommandResult::Status::Error && result.message == COMMAND_CANCELLED_MESSAGE) {
+                ++summary.skipped; // Never started
+                continue;
+            }
+            if (options.transcript) {
+                writeParallelTranscript(entry.second, result);
+            }
+            record(statements[entry.first], std::move(result));
+            if (stopped && !cancelled) {
+                cancelled = true;
+                for (auto& other : wave) {
+                    other.second.cancellation.cancel();
+                }
+            }
+        }
+    }
+
+    for (; index < statements.size(); ++index) {
+        if (statements[index].text != "wait") {
+            ++summary.skipped;
+        }
+    }
+    if (options.transcript) {
+        options.transcript->flush();
+    }
+
+    size_t executed = summary.succeeded + summary.warnings + summary.failed;
+    CommandResult::Status status = summary.failed > 0 ? CommandResult::Status::Error
+                                 : summary.warnings > 0 ? CommandResult::Status::Warning
+                                 : CommandResult::Status::Success;
+    std::string message = "Script executed " + std::to_string(executed) + " statement(s): " +
+                          std::to_string(summary.succeeded) + " succeeded, " +
+                          std::to_string(summary.warnings) + " warning(s), " +
+                          std::to_string(summary.failed) + " failed, " +
+                          std::to_string(summary.skipped) + " skipped.";
+    return CommandResult(status, message, StructuredData(std::move(summary)));
+}
+
 void CLIEngine::startInteractiveSession() {
     std::string line;
     std::cout << "Wave CLI Engine Interactive Mode. Type 'exitcli' to quit." << std::endl; // Added exit command info
@@ -149,29 +1042,45 @@ void CLIEngine::startInteractiveSession() {
         // Trim leading/trailing whitespace from line for "exitcli" check
         line.erase(0, line.find_first_not_of(" \t\n\r\f\v"));
         line.erase(line.find_last_not_of(" \t\n\r\f\v") + 1);
+        if (line.empty()) { // Whitespace only
+            continue;
+        }
 
         if (line == "exitcli") { // Special command to exit interactive mode
             std::cout << "Exiting interactive session." << std::endl;
             break;
         }
 
-        CommandResult result = executeCommand(line);
-        
-        std::cout << "[" << CommandResult::statusToString(result.status) << "] "
-                  << result.message << std::endl;
-        
-        if (result.data.has_value()) {
-            // Try to print data if it's a string, for demonstration
-            try {
-                if (result.data.value().type() == typeid(std::string)) {
-                    std::cout << "Data: " << std::any_cast<std::string>(result.data.value()) << std::endl;
-                } else if (result.data.value().type() == typeid(const char*)) {
-                     std::cout << "Data: " << std::any_cast<const char*>(result.data.value()) << std::endl;
-                }
-                // Add more types if needed for interactive display
-            } catch (const std::bad_any_cast& e) {
-                std::cout << "Data: (Opaque/Cannot display type)" << std::endl;
+        // Line-mode stand-in for tab completion: "clipboard sh?" lists the matching next words.
+        if (line.back() == '?' && line[0] != '!') {
+            line.pop_back();
+            for (const auto& candidate : getCompletions(line)) {
+                std::cout << "  " << candidate << '\n';
+            }
+            std::cout.flush();
+            continue;
+        }
+
+        // History references ("!!", "!12", "!?text", ...) are replaced by the entry and echoed.
+        if (line[0] == '!') {
+            std::string historyError;
+            std::optional<std::string> expanded = CppHistory.expand(line, &historyError);
+            if (!expanded) {
+                std::cout << "[Error] " << historyError << std::endl;
+                continue;
             }
+            line = *expanded;
+            std::cout << line << '\n';
+        }
+        CppHistory.add(line);
+
+        // Rows are printed as they are emitted, then the status line (text format) or the final
+        // record of the selected format. Formats without a status report it on stderr.
+        std::string format = getDefaultOutputFormat();
+        CommandResult result = executeCommand(line, std::cout, format);
+        std::unique_ptr<OutputFormatter> probe = CppOutputFormatters->create(format, std::cerr);
+        if (probe && !probe->includesStatus()) {
+            std::cerr << "[" << CommandResult::statusToString(result.status) << "] " << result.message << std::endl;
         }
     }
 }
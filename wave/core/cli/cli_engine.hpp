@@ -10,6 +10,21 @@
 #include <iostream> // For startInteractiveSession
 #include <sstream>  // For command parsing
 #include <algorithm> // For std::remove for unregister by pointer (if needed)
+#include <atomic>
+#include <future>   // For executeCommandAsync
+#include <memory>
+#include <deque>
+#include <functional>
+#include <cstdint>
+
+#include "command_pool.hpp"
+#include "output_stream.hpp"
+#include "command_trie.hpp"
+#include "input_parser.hpp"
+#include "command_metrics.hpp"
+#include "history_manager.hpp"
+#include "row_pipeline.hpp"
+#include "result_cache.hpp"
 
 namespace wave {
 namespace core {
@@ -43,6 +58,45 @@ struct CommandResult {
     }
 };
 
+// Cooperative cancellation flag shared between a caller and a running command.
+// Copies share the same state, so the caller keeps one copy and the command polls another.
+class CancellationToken {
+public:
+    CancellationToken() : CppCancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() { CppCancelled->store(true, std::memory_order_release); }
+    bool isCancelled() const { return CppCancelled->load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> CppCancelled;
+};
+
+// State that outlives a single command: one per interactive console or remote connection.
+struct SessionState {
+    uint64_t id = 0;
+    std::string origin; // Where the session comes from, e.g. "console" or "unix:/run/launcher.sock"
+    std::mutex mutex;   // Guards values; commands of one session may run on different threads
+    std::map<std::string, std::any> values; // Command-defined per-session values
+};
+
+// Per-invocation state handed to commands that opt into executeWithContext().
+struct CommandContext {
+    CancellationToken cancellation;
+    std::shared_ptr<SessionState> session; // Null for one-off programmatic calls
+    ParsedOptions options;         // Typed values for the options declared by ICommand::getOptions()
+    std::string outputFormat;      // Format requested with "--output <name>"; empty if none
+    IOutputSink* output = nullptr; // Row sink for streaming output; null when nobody consumes rows.
+
+    // Streams one result row to the caller. Returns false when the command should stop producing
+    // (no consumer, consumer went away, or the invocation was cancelled).
+    bool emit(StructuredData row) {
+        if (!output || cancellation.isCancelled()) {
+            return false;
+        }
+        return output->write(std::move(row));
+    }
+};
+
 // Interface for executable commands
 class ICommand {
 public:
@@ -50,24 +104,217 @@ public:
     virtual CommandResult execute(const std::vector<std::string>& args) = 0;
     virtual std::string getHelp() const = 0;
     virtual std::string getName() const = 0; // Useful for a generic help command
+
+    // Context-aware entry point used by CLIEngine. Long-running commands override this
+    // to poll context.cancellation; the default simply forwards to execute(args).
+    virtual CommandResult executeWithContext(const std::vector<std::string>& args, CommandContext& context) {
+        (void)context;
+        return execute(args);
+    }
+
+    // Maximum number of concurrent asynchronous executions of this command. 0 means unlimited.
+    // Extra requests are queued in FIFO order until a running instance finishes.
+    virtual size_t getMaxConcurrency() const { return 0; }
+
+    // Options this command accepts (--name, --name=value, --name value). When the list is non-empty
+    // CLIEngine validates and converts them into CommandContext::options and passes only the
+    // positional arguments to the command; otherwise every token is passed through unchanged.
+    virtual const std::vector<OptionSpec>& getOptions() const {
+        static const std::vector<OptionSpec> noOptions;
+        return noOptions;
+    }
+
+    // Read-only commands whose output depends only on their arguments and on state announced by
+    // events (module lists, stats) may return a cacheable policy. CLIEngine then answers repeated
+    // calls with the same arguments and options from its ResultCache, replaying the emitted rows,
+    // until the TTL passes or one of the topics is invalidated. Only Success results of complete
+    // runs are cached. The default is not cacheable.
+    virtual const CachePolicy& getCachePolicy() const {
+        static const CachePolicy notCacheable;
+        return notCacheable;
+    }
+};
+
+// Invoked once with the final result of an asynchronous execution, on the thread that finished it.
+using CommandCompletionCallback = std::function<void(const CommandResult&)>;
+
+// Handle returned by CLIEngine::executeCommandAsync.
+struct AsyncCommandHandle {
+    std::future<CommandResult> result;
+    CancellationToken cancellation; // Call cancellation.cancel() to request the command to stop.
+    std::string outputFormat;       // The line's "--output" format; empty if it has none
+};
+
+// Options for CLIEngine::executeScript.
+struct ScriptOptions {
+    bool stopOnError = true;  // Skip the remaining statements after the first Error result
+    // Run statements concurrently on the command pool. A statement consisting of the single word
+    // "wait" is a barrier: everything before it finishes before anything after it starts. With
+    // stopOnError, statements running alongside the failing one are cancelled: those that have
+    // not started count as skipped, those already running finish (or stop) and are reported.
+    bool parallel = false;
+    std::ostream* transcript = nullptr; // If set, receives each statement's rows and status line
+    // Output format of the transcript (see OutputFormatterRegistry); empty uses the engine default.
+    // A statement's own "--output" wins.
+    std::string outputFormat;
+};
+
+// Outcome of one script statement.
+struct ScriptStatementResult {
+    size_t lineNumber;
+    std::string commandLine;
+    CommandResult result;
+};
+
+// Summary stored in CommandResult::data by CLIEngine::executeScript.
+struct ScriptSummary {
+    size_t succeeded = 0;
+    size_t warnings = 0;
+    size_t failed = 0;
+    size_t skipped = 0;
+    std::vector<ScriptStatementResult> statements; // Executed statements, in script order
+};
+
+// Handle returned by CLIEngine::executeCommandStreaming.
+// Read rows until rows->read() returns std::nullopt, then collect the final result.
+// Destroying the handle cancels the stream so an abandoned reader never blocks the producer.
+struct CommandStreamHandle {
+    std::shared_ptr<CommandOutputStream> rows;
+    std::future<CommandResult> result;
+    CancellationToken cancellation;
+
+    CommandStreamHandle() = default;
+    CommandStreamHandle(CommandStreamHandle&&) = default;
+    CommandStreamHandle& operator=(CommandStreamHandle&&) = default;
+    ~CommandStreamHandle() {
+        if (rows) {
+            rows->cancel();
+        }
+    }
+};
+
+class OutputFormatterRegistry;
+
+// Ties the commands registered on this thread, while the scope lives, to an owner whose code can
+// go away, such as a module library (Core opens one around every in-process module's initialize()).
+// Such a command is registered wrapped: each execution first calls pin() and holds what it returns
+// until the execution ends, so the owner is not unloaded under a running command; a null pin fails
+// the execution instead. The command's name, options, cache policy and concurrency limit are read
+// once, at registration. Inside a scope, registering a name the same owner already registered
+// replaces that command: that is how a hot reloaded module's new instance takes over the old
+// instance's commands. The old instance must then remove the commands it still has with
+// CLIEngine::unregisterCommand(name, *command), never by name alone, or it removes the new ones.
+class CommandOwnerScope {
+public:
+    using Pin = std::function<std::shared_ptr<void>()>;
+
+    CommandOwnerScope(std::string owner, Pin pin);
+    ~CommandOwnerScope();
+    CommandOwnerScope(const CommandOwnerScope&) = delete;
+    CommandOwnerScope& operator=(const CommandOwnerScope&) = delete;
+
+    const std::string& owner() const { return CppOwner; }
+    const Pin& pin() const { return CppPin; }
+
+    // The innermost scope open on this thread, or null.
+    static const CommandOwnerScope* current();
+
+private:
+    std::string CppOwner;
+    Pin CppPin;
+    const CommandOwnerScope* CppOuter;
 };
 
+// Connects the result cache to an event source. Called once per invalidation topic with a callback
+// that invalidates it; returns a function that cancels that subscription.
+using CacheTopicSubscriber = std::function<std::function<void()>(const std::string& topic, std::function<void()> invalidate)>;
+
+// Called for executions that took at least the configured slow-command threshold.
+using SlowCommandCallback = std::function<void(const std::string& commandName, const std::vector<std::string>& args,
+                                               std::chrono::nanoseconds elapsed)>;
+
 // Command Registry and Execution Engine
 class CLIEngine {
 public:
     CLIEngine();
+    // asyncWorkerCount / asyncQueueCapacity bound the pool used by executeCommandAsync.
+    CLIEngine(size_t asyncWorkerCount, size_t asyncQueueCapacity);
     ~CLIEngine();
 
     // Executes a command line string.
-    // Parses the string into command name and arguments, then executes.
+    // Parses the string into command name and arguments, then executes. The line may be a pipeline,
+    // "command args | operator args | ...", whose operators filter the command's rows in-process
+    // (see getPipelineOperators()); this holds for every execute* method.
     CommandResult executeCommand(const std::string& commandLine);
 
+    // Executes a command line on the engine's bounded command pool and returns immediately.
+    // Parse and lookup errors, a full queue, or cancellation before start resolve the future with
+    // an Error result; the future never throws. Commands honouring per-command concurrency limits
+    // (ICommand::getMaxConcurrency) are queued until a slot frees up; once as many executions of the
+    // command are waiting as the pool's queue holds, further ones are rejected with an Error.
+    AsyncCommandHandle executeCommandAsync(const std::string& commandLine);
+
+    // Asynchronous execution with a caller-prepared context (session, output sink, cancellation).
+    // If context.output is null, rows are collected into the result data. onComplete, if set, runs
+    // after the future is resolved; handle.cancellation is context.cancellation.
+    AsyncCommandHandle executeCommandAsync(const std::string& commandLine, CommandContext context,
+                                           CommandCompletionCallback onComplete = nullptr);
+
+    // Synchronous execution with a caller-prepared context. Options are filled in by the engine;
+    // if context.output is null, emitted rows are collected into the result data. Data the command
+    // returned as well follows the rows there: a vector as one row per element, else as one row.
+    CommandResult executeCommand(const std::string& commandLine, CommandContext& context);
+
+    // Executes a command synchronously, delivering rows emitted by the command to 'sink' as they
+    // are produced instead of collecting them in CommandResult::data.
+    CommandResult executeCommand(const std::string& commandLine, IOutputSink& sink);
+
+    // Executes a command synchronously and writes its rows and final result to 'out' in an output
+    // format: the one the command line asks for with "--output <name>", else defaultFormat, else
+    // the engine default. Rows are encoded as they are emitted; nothing is buffered. Parse errors
+    // and unknown formats are reported in the selected format too (text if that is the unknown one).
+    CommandResult executeCommand(const std::string& commandLine, std::ostream& out,
+                                 const std::string& defaultFormat = std::string());
+
+    // Executes a command on the command pool and streams its rows through a bounded buffer of
+    // 'bufferRows' entries. The producer blocks while the buffer is full (flow control).
+    CommandStreamHandle executeCommandStreaming(const std::string& commandLine, size_t bufferRows = 64);
+
     // Registers a command. The engine does NOT take ownership of the ICommand pointer.
     // The caller is responsible for managing the lifetime of the command object.
+    // name may contain several words ("clipboard show history"); each word is one level of the
+    // command hierarchy, and any leading words of a command line that match it select the command.
     void registerCommand(const std::string& name, ICommand* command);
 
+    // Registers a shared command. The engine keeps a reference for as long as the command is
+    // registered and for the duration of every execution that resolved it, so unregistering (or
+    // a module dropping its own reference) while the command runs is safe.
+    void registerCommand(const std::string& name, std::shared_ptr<ICommand> command);
+
     // Unregisters a command by its name.
     void unregisterCommand(const std::string& name);
+    // Unregisters name only while it is bound to 'expected', leaving a command someone else
+    // registered under the same name alone. Returns true if it was removed. Modules use this form
+    // in shutdown() (see CommandOwnerScope); 'expected' is the command they registered.
+    bool unregisterCommand(const std::string& name, const ICommand& expected);
+
+    // The command registered under exactly this name (no prefixes or aliases), or null.
+    std::shared_ptr<ICommand> findCommand(const std::string& name) const;
+
+    // Adds an alias for a command or command group, e.g. registerAlias("cb", "clipboard").
+    // Returns false if the target does not exist or the alias is already in use.
+    bool registerAlias(const std::string& alias, const std::string& target);
+    bool unregisterAlias(const std::string& alias);
+    std::vector<std::pair<std::string, std::string>> getAliases() const; // (alias, target)
+
+    // Next-word completion candidates for a partially typed command line (interactive tab
+    // completion, GUI autocomplete). Words already typed may be aliases or unambiguous prefixes.
+    std::vector<std::string> getCompletions(const std::string& partialLine) const;
+
+    // Executes a script: statements separated by ';' or newlines, '#' comment lines ignored.
+    // The script is read and split once up front. The returned status is Error if any statement
+    // failed, Warning if any warned, Success otherwise; data holds a ScriptSummary.
+    CommandResult executeScript(std::istream& script, const ScriptOptions& options = ScriptOptions());
 
     // Starts a simple interactive command line session. (Optional)
     void startInteractiveSession();
@@ -75,16 +322,135 @@ public:
     // Gets a list of registered command names
     std::vector<std::string> getRegisteredCommands() const;
 
+    // Invocation counts, outcomes and latency histograms per canonical command name. Every execution
+    // of a resolved command is recorded (sync, async, streaming, scripts, remote sessions); lines
+    // that fail to parse or resolve are not.
+    CommandMetrics& getMetrics() { return CppMetrics; }
+    const CommandMetrics& getMetrics() const { return CppMetrics; }
+
+    // Command history of the interactive session. Lines typed at the prompt are recorded (after
+    // "!" reference expansion); programmatic, script and remote executions are not.
+    HistoryManager& getHistory() { return CppHistory; }
+
+    // Output formats for "--output" (text, json, tsv, binary, plus any registered later) and the
+    // value encoders they share. Commands returning custom data types register them here.
+    OutputFormatterRegistry& getOutputFormatters() { return *CppOutputFormatters; }
+    const OutputFormatterRegistry& getOutputFormatters() const { return *CppOutputFormatters; }
+    // Operators usable after '|' in a command line ("log tail | grep Loader | head 20"): grep, head,
+    // sort, count, uniq, plus any registered later. See PipelineOperatorRegistry.
+    PipelineOperatorRegistry& getPipelineOperators() { return CppPipelineOperators; }
+
+    // Results of commands with a cacheable ICommand::getCachePolicy().
+    ResultCache& getResultCache() { return CppResultCache; }
+    // Drops cached results that depend on topic. Normally driven by the subscriber below.
+    void invalidateCachedResults(const std::string& topic) { CppResultCache.invalidate(topic); }
+    // Subscribes every invalidation topic used by cacheable commands (now and later) through
+    // subscriber, e.g. to EventBus. Without one, only TTLs and invalidateCachedResults() apply.
+    void setCacheTopicSubscriber(CacheTopicSubscriber subscriber);
+
+    // Format used when a command line has no "--output". "text" unless changed; returns false
+    // (and keeps the current one) for an unknown format.
+    bool setDefaultOutputFormat(const std::string& format);
+    std::string getDefaultOutputFormat() const;
+
+    // Reports executions taking at least 'threshold' to callback, on the executing thread.
+    // A zero threshold or a null callback turns slow-command reporting off.
+    void setSlowCommandThreshold(std::chrono::milliseconds threshold, SlowCommandCallback callback);
 
 private:
-    // CommandRegistry: Using a map to store commands by name.
-    // The ICommand pointers are not owned by CLIEngine.
-    std::map<std::string, ICommand*> CppCommandRegistry; // Renamed
-    mutable std::mutex CppRegistryMutex; // Renamed, mutable for getRegisteredCommands
-
-    // Helper to parse command line.
-    // Returns true if parsing is successful, populates commandName and args.
-    bool parseCommandLine(const std::string& commandLine, std::string& commandName, std::vector<std::string>& args) const;
+    // CommandRegistry: word-level trie of multi-part command names and aliases.
+    // Commands are shared: a snapshot keeps its commands alive, so one unregistered while it
+    // executes is destroyed only when the last snapshot holding it goes.
+    // Readers atomically load the current immutable snapshot and never wait on CppRegistryMutex;
+    // each registry change builds a new snapshot (path copy) and publishes it atomically. The load
+    // and store themselves share only the library's brief lock around the pointer copy.
+    std::shared_ptr<const CommandTrie> CppCommandRegistry;
+    std::mutex CppRegistryMutex; // Serializes writers only
+
+    std::shared_ptr<const CommandTrie> registrySnapshot() const;
+    // Applies edit to a copy of the current snapshot and publishes it if edit returns true.
+    bool updateRegistry(const std::function<bool(CommandTrie&)>& edit);
+
+    // Asynchronous execution state. The pool is created on first use so purely synchronous
+    // users of the engine never start worker threads.
+    struct AsyncInvocation {
+        std::shared_ptr<ICommand> command;
+        std::string commandName;
+        std::vector<std::string> args;
+        CommandContext context;
+        std::promise<CommandResult> promise;
+        std::shared_ptr<CommandOutputStream> stream; // Set for executeCommandStreaming; closed on completion.
+        CollectingOutputSink collector;              // Rows of non-streaming async calls end up in result data.
+        CommandCompletionCallback onComplete;
+        RowPipeline pipeline;                        // Filters after '|', if any.
+
+        void complete(CommandResult result) {
+            if (onComplete) {
+                // The callback must see the result before the future is released to a waiter that may
+                // destroy the objects it references.
+                try { onComplete(result); } catch (...) {}
+            }
+            promise.set_value(std::move(result));
+            if (stream) {
+                stream->close();
+            }
+        }
+    };
+    std::unique_ptr<CommandThreadPool> CppCommandPool;
+    std::once_flag CppCommandPoolInit;
+    size_t CppAsyncWorkerCount;
+    size_t CppAsyncQueueCapacity;
+    std::mutex CppAsyncMutex; // Guards the two maps below.
+    std::map<std::string, size_t> CppInFlightCounts; // Running async invocations per command name.
+    std::map<std::string, std::deque<std::shared_ptr<AsyncInvocation>>> CppDeferredInvocations; // Waiting for a concurrency slot; at most CppAsyncQueueCapacity per command.
+
+    // Tokenizes commandLine (see InputParser) and looks the command up; commandName receives the
+    // canonical command path, args the positional arguments following it, options the values of
+    // the options the command declares, outputFormat the value of a "--output" option (unless the
+    // command declares an option of that name itself) and pipeline the filters of any "| operator"
+    // stages. On failure returns the error result to report.
+    std::optional<CommandResult> resolveCommand(const std::string& commandLine, std::string& commandName,
+                                                std::vector<std::string>& args, ParsedOptions& options,
+                                                std::shared_ptr<ICommand>& command, std::string& outputFormat,
+                                                RowPipeline& pipeline) const;
+    // Removes "--output <format>" from words (before any "--") unless specs declare "output".
+    std::optional<CommandResult> takeOutputOption(const std::string& owner, const std::vector<OptionSpec>& specs,
+                                                  std::vector<std::string_view>& words, std::string& outputFormat) const;
+    // Parses one "operator args..." stage and appends its filter.
+    std::optional<CommandResult> appendPipelineStage(std::string_view stage, RowPipeline& pipeline,
+                                                     std::string& outputFormat) const;
+
+    HistoryManager CppHistory;
+
+    std::unique_ptr<OutputFormatterRegistry> CppOutputFormatters;
+
+    ResultCache CppResultCache;
+    std::mutex CppCacheSubscribeMutex; // Held while subscribing topics; taken before CppCacheTopicsMutex
+    std::mutex CppCacheTopicsMutex; // Guards the two members below; never held while subscribing
+    CacheTopicSubscriber CppCacheTopicSubscriber;
+    std::map<std::string, std::function<void()>> CppCacheTopics; // Topic -> unsubscribe (empty if not subscribed)
+    void subscribeCacheTopics(const CachePolicy& policy);
+    PipelineOperatorRegistry CppPipelineOperators;
+    mutable std::mutex CppDefaultOutputFormatMutex;
+    std::string CppDefaultOutputFormat;
+
+    // Execution metrics and slow-command reporting.
+    CommandMetrics CppMetrics;
+    std::atomic<int64_t> CppSlowCommandThresholdNanos{0}; // 0 = off; checked without locking
+    std::mutex CppSlowCommandMutex;                         // Guards CppSlowCommandCallback
+    SlowCommandCallback CppSlowCommandCallback;
+
+    // Runs a resolved command, converting exceptions into Error results, and records its metrics.
+    // The command's rows (and returned data) pass through pipeline on their way to context.output.
+    CommandResult invokeCommand(const std::string& commandName, ICommand& command,
+                                const std::vector<std::string>& args, CommandContext& context,
+                                RowPipeline& pipeline);
+
+    CommandThreadPool& commandPool();
+    void dispatchAsync(const std::shared_ptr<AsyncInvocation>& invocation);
+    void runAsync(const std::shared_ptr<AsyncInvocation>& invocation);
+    std::shared_ptr<AsyncInvocation> releaseAsyncSlot(const std::string& commandName);
+    void startAsync(const std::shared_ptr<AsyncInvocation>& invocation);
 };
 
 } // namespace cli
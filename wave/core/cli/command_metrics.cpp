@@ -0,0 +1,143 @@
+#include "command_metrics.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+std::chrono::nanoseconds CommandStats::meanTime() const {
+    if (invocations == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::nanoseconds(totalTime.count() / static_cast<int64_t>(invocations));
+}
+
+std::chrono::nanoseconds CommandStats::percentile(double percent) const {
+    uint64_t total = 0;
+    for (uint64_t count : histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    percent = std::min(100.0, std::max(0.0, percent));
+    // Rank of the requested sample, 1-based: the smallest bucket whose cumulative count reaches it.
+    uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total) + 0.5);
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        cumulative += histogram[i];
+        if (cumulative >= rank) {
+            if (i >= BUCKET_BOUNDS_US.size()) {
+                return maxTime;
+            }
+            // A bucket bound can overstate the slowest sample it holds; never report more than max.
+            return std::min<std::chrono::nanoseconds>(std::chrono::microseconds(BUCKET_BOUNDS_US[i]), maxTime);
+        }
+    }
+    return maxTime;
+}
+
+void CommandMetrics::record(const std::string& commandName, CommandOutcome outcome, std::chrono::nanoseconds elapsed) {
+    Entry* entry = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(CppEntriesMutex);
+        auto it = CppEntries.find(commandName);
+        if (it != CppEntries.end()) {
+            entry = it->second.get();
+        }
+    }
+    if (!entry) {
+        std::unique_lock<std::shared_mutex> lock(CppEntriesMutex);
+        std::unique_ptr<Entry>& slot = CppEntries[commandName];
+        if (!slot) {
+            slot = std::make_unique<Entry>();
+        }
+        entry = slot.get();
+    }
+    // Entries are never erased (reset() zeroes them), so the pointer stays valid without the lock.
+
+    int64_t nanos = std::max<int64_t>(0, elapsed.count());
+    entry->invocations.fetch_add(1, std::memory_order_relaxed);
+    if (outcome == CommandOutcome::Error) {
+        entry->errors.fetch_add(1, std::memory_order_relaxed);
+    } else if (outcome == CommandOutcome::Warning) {
+        entry->warnings.fetch_add(1, std::memory_order_relaxed);
+    }
+    entry->totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    int64_t previousMax = entry->maxNanos.load(std::memory_order_relaxed);
+    while (nanos > previousMax &&
+           !entry->maxNanos.compare_exchange_weak(previousMax, nanos, std::memory_order_relaxed)) {
+    }
+
+    uint64_t micros = static_cast<uint64_t>(nanos / 1000);
+    size_t bucket = static_cast<size_t>(
+        std::lower_bound(CommandStats::BUCKET_BOUNDS_US.begin(), CommandStats::BUCKET_BOUNDS_US.end(), micros) -
+        CommandStats::BUCKET_BOUNDS_US.begin());
+    entry->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+CommandStats CommandMetrics::toStats(const std::string& name, const Entry& entry) {
+    CommandStats stats;
+    stats.name = name;
+    stats.invocations = entry.invocations.load(std::memory_order_relaxed);
+    stats.errors = entry.errors.load(std::memory_order_relaxed);
+    stats.warnings = entry.warnings.load(std::memory_order_relaxed);
+    stats.totalTime = std::chrono::nanoseconds(entry.totalNanos.load(std::memory_order_relaxed));
+    stats.maxTime = std::chrono::nanoseconds(entry.maxNanos.load(std::memory_order_relaxed));
+    stats.histogram.reserve(entry.buckets.size());
+    for (const auto& bucket : entry.buckets) {
+        stats.histogram.push_back(bucket.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+std::vector<CommandStats> CommandMetrics::snapshot() const {
+    std::vector<CommandStats> all;
+    {
+        std::shared_lock<std::shared_mutex> lock(CppEntriesMutex);
+        all.reserve(CppEntries.size());
+        for (const auto& entry : CppEntries) {
+            CommandStats stats = toStats(entry.first, *entry.second);
+            if (stats.invocations > 0) {
+                all.push_back(std::move(stats));
+            }
+        }
+    }
+    std::sort(all.begin(), all.end(), [](const CommandStats& a, const CommandStats& b) { return a.name < b.name; });
+    return all;
+}
+
+CommandStats CommandMetrics::snapshot(const std::string& commandName) const {
+    std::shared_lock<std::shared_mutex> lock(CppEntriesMutex);
+    auto it = CppEntries.find(commandName);
+    if (it == CppEntries.end()) {
+        CommandStats empty;
+        empty.name = commandName;
+        empty.histogram.assign(CommandStats::BUCKET_BOUNDS_US.size() + 1, 0);
+        return empty;
+    }
+    return toStats(it->first, *it->second);
+}
+
+void CommandMetrics::reset() {
+    // Zeroes in place instead of erasing: record() may hold an Entry pointer outside the lock.
+    std::unique_lock<std::shared_mutex> lock(CppEntriesMutex);
+    for (auto& entry : CppEntries) {
+        Entry& e = *entry.second;
+        e.invocations.store(0, std::memory_order_relaxed);
+        e.errors.store(0, std::memory_order_relaxed);
+        e.warnings.store(0, std::memory_order_relaxed);
+        e.totalNanos.store(0, std::memory_order_relaxed);
+        e.maxNanos.store(0, std::memory_order_relaxed);
+        for (auto& bucket : e.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
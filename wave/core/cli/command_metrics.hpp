@@ -0,0 +1,83 @@
+#ifndef WAVE_CORE_CLI_COMMAND_METRICS_HPP
+#define WAVE_CORE_CLI_COMMAND_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// How an execution ended (mirrors CommandResult::Status without depending on cli_engine.hpp).
+enum class CommandOutcome { Success, Warning, Error };
+
+// Point-in-time copy of one command's counters.
+struct CommandStats {
+    // Upper bounds (inclusive, microseconds) of the latency histogram buckets. One more bucket
+    // after the last bound counts everything slower.
+    static constexpr std::array<uint64_t, 17> BUCKET_BOUNDS_US = {
+        50, 100, 250, 500,
+        1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+        1000000, 2500000, 5000000, 10000000,
+    };
+
+    std::string name; // Canonical command path, e.g. "clipboard show"
+    uint64_t invocations = 0;
+    uint64_t errors = 0;
+    uint64_t warnings = 0;
+    std::chrono::nanoseconds totalTime{0};
+    std::chrono::nanoseconds maxTime{0};
+    std::vector<uint64_t> histogram; // BUCKET_BOUNDS_US.size() + 1 counts
+
+    std::chrono::nanoseconds meanTime() const;
+    // Upper bound of the bucket holding the given percentile (0..100); maxTime for the last bucket.
+    std::chrono::nanoseconds percentile(double percent) const;
+};
+
+// Per-command invocation counts, outcome counts and latency histograms.
+// record() is called on every execution from any thread: existing entries are updated with relaxed
+// atomics under a shared lock, so concurrent executions only contend when a command runs for the
+// first time.
+class CommandMetrics {
+public:
+    CommandMetrics() = default;
+    CommandMetrics(const CommandMetrics&) = delete;
+    CommandMetrics& operator=(const CommandMetrics&) = delete;
+
+    void record(const std::string& commandName, CommandOutcome outcome, std::chrono::nanoseconds elapsed);
+
+    // Stats of every command executed since construction or the last reset(), sorted by name.
+    std::vector<CommandStats> snapshot() const;
+    // Stats of one command; invocations == 0 if it never ran.
+    CommandStats snapshot(const std::string& commandName) const;
+
+    void reset();
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> invocations{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> warnings{0};
+        std::atomic<int64_t> totalNanos{0};
+        std::atomic<int64_t> maxNanos{0};
+        std::array<std::atomic<uint64_t>, CommandStats::BUCKET_BOUNDS_US.size() + 1> buckets{};
+    };
+
+    mutable std::shared_mutex CppEntriesMutex;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> CppEntries;
+
+    static CommandStats toStats(const std::string& name, const Entry& entry);
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_COMMAND_METRICS_HPP
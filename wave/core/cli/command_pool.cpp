@@ -0,0 +1,84 @@
+#include "command_pool.hpp"
+
+namespace wave {
+namespace core {
+namespace cli {
+
+CommandThreadPool::CommandThreadPool(size_t workerCount, size_t queueCapacity)
+    : CppQueueCapacity(queueCapacity == 0 ? 1 : queueCapacity), CppStopping(false) {
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+    CppWorkers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        CppWorkers.emplace_back(&CommandThreadPool::workerLoop, this);
+    }
+}
+
+CommandThreadPool::~CommandThreadPool() {
+    shutdown();
+}
+
+bool CommandThreadPool::submit(Task task) {
+    if (!task) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(CppQueueMutex);
+        if (CppStopping || CppQueue.size() >= CppQueueCapacity) {
+            return false;
+        }
+        CppQueue.push_back(std::move(task));
+    }
+    CppQueueCondition.notify_one();
+    return true;
+}
+
+size_t CommandThreadPool::waitForSpace() {
+    std::unique_lock<std::mutex> lock(CppQueueMutex);
+    CppSpaceCondition.wait(lock, [this]() { return CppStopping || CppQueue.size() < CppQueueCapacity; });
+    return CppStopping ? 0 : CppQueueCapacity - CppQueue.size();
+}
+
+void CommandThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(CppQueueMutex);
+        if (CppStopping) {
+            return;
+        }
+        CppStopping = true;
+    }
+    CppQueueCondition.notify_all();
+    CppSpaceCondition.notify_all();
+    for (auto& worker : CppWorkers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void CommandThreadPool::workerLoop() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(CppQueueMutex);
+            CppQueueCondition.wait(lock, [this]() { return CppStopping || !CppQueue.empty(); });
+            if (CppQueue.empty()) {
+                return; // Stopping and nothing left to run.
+            }
+            task = std::move(CppQueue.front());
+            CppQueue.pop_front();
+        }
+        CppSpaceCondition.notify_all();
+        // Tasks are expected to handle their own exceptions (CLIEngine wraps every command),
+        // but a stray throw must not kill the worker thread.
+        try {
+            task();
+        } catch (...) {
+        }
+    }
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
@@ -0,0 +1,56 @@
+#ifndef WAVE_CORE_CLI_COMMAND_POOL_HPP
+#define WAVE_CORE_CLI_COMMAND_POOL_HPP
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Bounded worker pool used by CLIEngine for asynchronous command execution.
+// A fixed number of worker threads drain a FIFO queue with a fixed capacity,
+// so a burst of slow commands cannot spawn unbounded threads or memory.
+class CommandThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    CommandThreadPool(size_t workerCount, size_t queueCapacity);
+    ~CommandThreadPool(); // Runs the tasks already queued, then joins the workers.
+
+    // Queues a task for execution.
+    // Returns false if the queue is full or the pool is shutting down; the task is not run in that case.
+    bool submit(Task task);
+
+    // Blocks until the queue has room for at least one task and returns the number of free
+    // slots, or 0 once the pool is shutting down. Another thread may take the room first.
+    size_t waitForSpace();
+
+    // Stops accepting new tasks, finishes queued tasks and joins all workers. Idempotent.
+    void shutdown();
+
+    size_t getWorkerCount() const { return CppWorkers.size(); }
+    size_t getQueueCapacity() const { return CppQueueCapacity; }
+
+private:
+    std::vector<std::thread> CppWorkers;
+    std::deque<Task> CppQueue;
+    size_t CppQueueCapacity;
+    bool CppStopping;
+    std::mutex CppQueueMutex;
+    std::condition_variable CppQueueCondition;
+    std::condition_variable CppSpaceCondition; // Notified when a worker takes a task off the queue
+
+    void workerLoop();
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_COMMAND_POOL_HPP
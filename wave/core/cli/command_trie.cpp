@@ -0,0 +1,419 @@
+#include "command_trie.hpp"
+
+namespace wave {
+namespace core {
+namespace cli {
+
+namespace {
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Bounds alias-to-alias expansion; addAlias stores canonical targets, so one hop is the norm.
+const int MAX_ALIAS_HOPS = 8;
+} // namespace
+
+struct CommandTrie::ChildMap::Entry {
+    std::string word;
+    NodePtr child;
+    size_t priority; // A hash of the word: the shape depends on the words only, never on history
+    EntryPtr left;
+    EntryPtr right;
+};
+
+CommandTrie::NodePtr CommandTrie::ChildMap::find(std::string_view word) const {
+    const Entry* entry = CppRoot.get();
+    while (entry) {
+        int order = word.compare(entry->word);
+        if (order == 0) {
+            return entry->child;
+        }
+        entry = order < 0 ? entry->left.get() : entry->right.get();
+    }
+    return nullptr;
+}
+
+std::pair<CommandTrie::ChildMap::EntryPtr, CommandTrie::ChildMap::EntryPtr>
+CommandTrie::ChildMap::split(const EntryPtr& tree, std::string_view word) {
+    if (!tree) {
+        return {};
+    }
+    auto copy = std::make_shared<Entry>(*tree);
+    if (std::string_view(tree->word) < word) {
+        auto parts = split(tree->right, word);
+        copy->right = std::move(parts.first);
+        return {std::move(copy), std::move(parts.second)};
+    }
+    auto parts = split(tree->left, word);
+    copy->left = std::move(parts.second);
+    return {std::move(parts.first), std::move(copy)};
+}
+
+CommandTrie::ChildMap::EntryPtr CommandTrie::ChildMap::merge(const EntryPtr& low, const EntryPtr& high) {
+    if (!low || !high) {
+        return low ? low : high;
+    }
+    if (low->priority >= high->priority) {
+        auto copy = std::make_shared<Entry>(*low);
+        copy->right = merge(low->right, high);
+        return copy;
+    }
+    auto copy = std::make_shared<Entry>(*high);
+    copy->left = merge(low, high->left);
+    return copy;
+}
+
+void CommandTrie::ChildMap::set(std::string_view word, NodePtr child) {
+    // low < word <= rest; the smallest string after word is word + '\0', so 'same' is just word.
+    auto [low, rest] = split(CppRoot, word);
+    std::string after(word);
+    after.push_back('\0');
+    EntryPtr high = split(rest, after).second;
+    auto entry = std::make_shared<Entry>(Entry{std::string(word), std::move(child), std::hash<std::string_view>{}(word),
+                                               nullptr, nullptr});
+    CppRoot = merge(merge(low, entry), high);
+}
+
+void CommandTrie::ChildMap::erase(std::string_view word) {
+    auto [low, rest] = split(CppRoot, word);
+    std::string after(word);
+    after.push_back('\0');
+    CppRoot = merge(low, split(rest, after).second);
+}
+
+bool CommandTrie::ChildMap::visitFrom(const Entry* tree, std::string_view prefix, const Visitor& visit) {
+    // In order from the first word not below prefix; words sharing the prefix are contiguous there.
+    if (!tree) {
+        return true;
+    }
+    if (std::string_view(tree->word) >= prefix) {
+        if (!visitFrom(tree->left.get(), prefix, visit)) {
+            return false;
+        }
+        if (!startsWith(tree->word, prefix) || !visit(tree->word, tree->child)) {
+            return false;
+        }
+    }
+    return visitFrom(tree->right.get(), prefix, visit);
+}
+
+void CommandTrie::ChildMap::forEachWithPrefix(std::string_view prefix, const Visitor& visit) const {
+    visitFrom(CppRoot.get(), prefix, visit);
+}
+
+CommandTrie::CommandTrie() : CppRoot(std::make_shared<Node>()), CppCommandCount(0) {}
+
+CommandTrie::~CommandTrie() = default;
+
+std::vector<std::string_view> CommandTrie::splitWords(std::string_view text) {
+    std::vector<std::string_view> words;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && isSpace(text[i])) ++i;
+        size_t start = i;
+        while (i < text.size() && !isSpace(text[i])) ++i;
+        if (i > start) {
+            words.push_back(text.substr(start, i - start));
+        }
+    }
+    return words;
+}
+
+std::string CommandTrie::joinWords(const std::vector<std::string>& words) {
+    std::string joined;
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (i > 0) joined += ' ';
+        joined += words[i];
+    }
+    return joined;
+}
+
+CommandTrie::NodePtr CommandTrie::updatePath(const NodePtr& node, const std::vector<std::string_view>& words,
+                                             size_t index, const LeafEdit& apply, bool createMissing) {
+    std::shared_ptr<Node> copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+    if (index == words.size()) {
+        return apply(*copy) ? copy : nullptr;
+    }
+
+    NodePtr child = copy->children.find(words[index]);
+    if (child) {
+        if (index + 1 < words.size() && !child->aliasTarget.empty()) {
+            return nullptr; // Paths never continue below an alias
+        }
+    } else if (!createMissing) {
+        return nullptr;
+    }
+
+    NodePtr updated = updatePath(child, words, index + 1, apply, createMissing);
+    if (!updated) {
+        return nullptr;
+    }
+    if (updated->isEmpty()) {
+        if (child) copy->children.erase(words[index]); // Prune nodes left without content
+    } else {
+        copy->children.set(words[index], std::move(updated));
+    }
+    return copy;
+}
+
+bool CommandTrie::editLeaf(const std::vector<std::string_view>& words, const LeafEdit& apply, bool createMissing) {
+    if (words.empty()) {
+        return false;
+    }
+    NodePtr updated = updatePath(CppRoot, words, 0, apply, createMissing);
+    if (!updated) {
+        return false;
+    }
+    CppRoot = std::move(updated);
+    return true;
+}
+
+bool CommandTrie::insert(const std::string& path, std::shared_ptr<ICommand> command) {
+    if (!command) {
+        return false;
+    }
+    bool inserted = editLeaf(splitWords(path), [&command](Node& leaf) {
+        if (leaf.command || !leaf.aliasTarget.empty()) {
+            return false;
+        }
+        leaf.command = std::move(command);
+        return true;
+    }, true);
+    if (inserted) ++CppCommandCount;
+    return inserted;
+}
+
+bool CommandTrie::erase(const std::string& path, const ICommand* expected) {
+    bool erased = editLeaf(splitWords(path), [expected](Node& leaf) {
+        if (!leaf.command || (expected && leaf.command.get() != expected)) {
+            return false;
+        }
+        leaf.command.reset();
+        return true;
+    }, false);
+    if (erased) --CppCommandCount;
+    return erased;
+}
+
+std::shared_ptr<ICommand> CommandTrie::find(const std::string& path) const {
+    std::vector<std::string> words;
+    for (std::string_view word : splitWords(path)) {
+        words.emplace_back(word);
+    }
+    const Node* node = words.empty() ? nullptr : findExact(words);
+    return node ? node->command : nullptr;
+}
+
+bool CommandTrie::addAlias(const std::string& alias, const std::string& target) {
+    std::vector<std::string_view> targetViews = splitWords(target);
+    if (targetViews.empty()) {
+        return false;
+    }
+
+    // Store the canonical target so lookups expand an alias in a single hop.
+    // Prefix matching is fine for resolving the target, but the alias itself must be new.
+    std::vector<std::string> canonicalTarget;
+    const Node* targetNode = CppRoot.get();
+    for (std::string_view word : targetViews) {
+        if (!step(targetNode, canonicalTarget, word, nullptr)) {
+            return false;
+        }
+    }
+    return editLeaf(splitWords(alias), [&canonicalTarget](Node& leaf) {
+        if (leaf.command || !leaf.children.empty() || !leaf.aliasTarget.empty()) {
+            return false; // Path already names a command, command group or alias
+        }
+        leaf.aliasTarget = std::move(canonicalTarget);
+        return true;
+    }, true);
+}
+
+bool CommandTrie::removeAlias(const std::string& alias) {
+    return editLeaf(splitWords(alias), [](Node& leaf) {
+        if (leaf.aliasTarget.empty()) {
+            return false;
+        }
+        leaf.aliasTarget.clear();
+        return true;
+    }, false);
+}
+
+const CommandTrie::Node* CommandTrie::findChild(const Node& node, std::string_view word, std::string& key,
+                                                std::vector<std::string>* ambiguous) {
+    if (const NodePtr& exact = node.children.find(word)) {
+        key = std::string(word);
+        return exact.get();
+    }
+    // Two children sharing the prefix settle it, unless the caller wants every candidate.
+    std::vector<std::string> names;
+    const Node* first = nullptr;
+    node.children.forEachWithPrefix(word, [&](const std::string& name, const NodePtr& child) {
+        if (!first) {
+            first = child.get();
+        }
+        names.push_back(name);
+        return ambiguous || names.size() < 2;
+    });
+    if (names.size() == 1) {
+        key = std::move(names[0]);
+        return first;
+    }
+    if (ambiguous && !names.empty()) {
+        *ambiguous = std::move(names);
+    }
+    return nullptr;
+}
+
+const CommandTrie::Node* CommandTrie::findExact(const std::vector<std::string>& words) const {
+    const Node* node = CppRoot.get();
+    for (const std::string& word : words) {
+        node = node->children.find(word).get();
+        if (!node) {
+            return nullptr;
+        }
+    }
+    return node;
+}
+
+bool CommandTrie::step(const Node*& node, std::vector<std::string>& path, std::string_view word,
+                       std::vector<std::string>* ambiguous) const {
+    std::string key;
+    const Node* child = findChild(*node, word, key, ambiguous);
+    if (!child) {
+        return false;
+    }
+    int hops = 0;
+    while (!child->aliasTarget.empty()) {
+        if (++hops > MAX_ALIAS_HOPS) {
+            return false;
+        }
+        path = child->aliasTarget;
+        child = findExact(child->aliasTarget);
+        if (!child) {
+            return false; // Target was unregistered after the alias was created
+        }
+    }
+    if (hops == 0) {
+        path.push_back(std::move(key));
+    }
+    node = child;
+    return true;
+}
+
+CommandTrie::Match CommandTrie::match(const std::vector<std::string_view>& words) const {
+    Match result;
+    const Node* node = CppRoot.get();
+    std::vector<std::string> path;
+    std::vector<std::string> ambiguous;
+
+    size_t i = 0;
+    for (; i < words.size(); ++i) {
+        if (!step(node, path, words[i], &ambiguous)) {
+            break;
+        }
+        ambiguous.clear();
+        if (node->command) {
+            result.status = Match::Status::Found;
+            result.command = node->command;
+            result.canonicalName = joinWords(path);
+            result.wordsConsumed = i + 1;
+        }
+    }
+
+    if (result.status == Match::Status::Found) {
+        return result;
+    }
+    if (!ambiguous.empty()) {
+        result.status = Match::Status::Ambiguous;
+        result.wordsConsumed = i; // The word that stopped the walk
+        result.candidates = std::move(ambiguous);
+    } else if (node != CppRoot.get()) {
+        result.status = Match::Status::Incomplete;
+        result.canonicalName = joinWords(path);
+        node->children.forEachWithPrefix("", [&result](const std::string& word, const NodePtr&) {
+            result.candidates.push_back(word);
+            return true;
+        });
+    }
+    return result;
+}
+
+std::vector<std::string> CommandTrie::complete(std::string_view partialLine) const {
+    std::vector<std::string_view> words = splitWords(partialLine);
+    std::string_view prefix;
+    if (!partialLine.empty() && !isSpace(partialLine.back()) && !words.empty()) {
+        prefix = words.back();
+        words.pop_back();
+    }
+
+    const Node* node = CppRoot.get();
+    std::vector<std::string> path;
+    for (std::string_view word : words) {
+        if (!step(node, path, word, nullptr)) {
+            return {};
+        }
+    }
+
+    std::vector<std::string> candidates;
+    node->children.forEachWithPrefix(prefix, [&candidates](const std::string& word, const NodePtr&) {
+        candidates.push_back(word);
+        return true;
+    });
+    return candidates;
+}
+
+void CommandTrie::collectCommands(const Node& node, std::string& prefix, std::vector<std::string>& out) {
+    node.children.forEachWithPrefix("", [&prefix, &out](const std::string& word, const NodePtr& child) {
+        if (!child->aliasTarget.empty()) {
+            return true;
+        }
+        size_t previousLength = prefix.size();
+        if (!prefix.empty()) prefix += ' ';
+        prefix += word;
+        if (child->command) {
+            out.push_back(prefix);
+        }
+        collectCommands(*child, prefix, out);
+        prefix.resize(previousLength);
+        return true;
+    });
+}
+
+void CommandTrie::collectAliases(const Node& node, std::string& prefix,
+                                 std::vector<std::pair<std::string, std::string>>& out) {
+    node.children.forEachWithPrefix("", [&prefix, &out](const std::string& word, const NodePtr& child) {
+        size_t previousLength = prefix.size();
+        if (!prefix.empty()) prefix += ' ';
+        prefix += word;
+        if (!child->aliasTarget.empty()) {
+            out.emplace_back(prefix, joinWords(child->aliasTarget));
+        } else {
+            collectAliases(*child, prefix, out);
+        }
+        prefix.resize(previousLength);
+        return true;
+    });
+}
+
+std::vector<std::string> CommandTrie::listCommands() const {
+    std::vector<std::string> commands;
+    commands.reserve(CppCommandCount);
+    std::string prefix;
+    collectCommands(*CppRoot, prefix, commands);
+    return commands;
+}
+
+std::vector<std::pair<std::string, std::string>> CommandTrie::listAliases() const {
+    std::vector<std::pair<std::string, std::string>> aliases;
+    std::string prefix;
+    collectAliases(*CppRoot, prefix, aliases);
+    return aliases;
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
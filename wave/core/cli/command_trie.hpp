@@ -0,0 +1,150 @@
+#ifndef WAVE_CORE_CLI_COMMAND_TRIE_HPP
+#define WAVE_CORE_CLI_COMMAND_TRIE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <utility>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+class ICommand;
+
+// Word-level trie of registered commands.
+// A command path is a whitespace separated sequence of words ("clipboard show history"); every
+// word is one trie level, so dispatch cost depends on the number of words typed, not on the
+// number of registered commands. Children are kept sorted, which gives unambiguous-prefix matching
+// and completion with a single ordered search per level.
+//
+// The trie is persistent: nodes are immutable and shared between copies, copying a trie is O(1)
+// and a mutation only clones the nodes on the path it changes. The children of a node are a
+// persistent search tree of their own, so a mutation clones O(log children) entries per level and
+// shares the rest; registering N commands is O(N log N), not O(N^2). CLIEngine relies on this to
+// publish a new registry snapshot per registration while readers keep using the old one.
+class CommandTrie {
+public:
+    struct Match {
+        enum class Status {
+            Found,      // command/canonicalName/wordsConsumed are valid
+            NotFound,   // No registered command matches the leading words
+            Ambiguous,  // A word is a prefix of several children; see candidates
+            Incomplete  // Words name a command group, not a command; see candidates
+        };
+
+        Status status = Status::NotFound;
+        std::shared_ptr<ICommand> command; // Keeps the command alive while the caller uses it
+        std::string canonicalName;         // Full registered path, aliases and prefixes expanded
+        size_t wordsConsumed = 0;          // Leading words that selected the command; the rest are arguments.
+                                           // For Ambiguous, the words before the ambiguous one
+        std::vector<std::string> candidates;
+    };
+
+    CommandTrie();
+    ~CommandTrie();
+    CommandTrie(const CommandTrie&) = default;            // Shares all nodes
+    CommandTrie& operator=(const CommandTrie&) = default;
+
+    // Registers command under path. Returns false if path is empty, already registered,
+    // or passes through an alias.
+    bool insert(const std::string& path, std::shared_ptr<ICommand> command);
+
+    // Removes the command registered under the exact path. Returns false if there was none. With
+    // 'expected', the command is only removed if it is that one.
+    bool erase(const std::string& path, const ICommand* expected = nullptr);
+
+    // The command registered under the exact path (no prefixes or aliases), or null.
+    std::shared_ptr<ICommand> find(const std::string& path) const;
+
+    // Makes alias (one or more words) resolve to the node at target, including its subcommands:
+    // with alias "cb" -> "clipboard", "cb show history" dispatches like "clipboard show history".
+    // The target must already exist and the alias path must be unused.
+    bool addAlias(const std::string& alias, const std::string& target);
+    bool removeAlias(const std::string& alias);
+
+    // Longest-match dispatch over the leading words of a command line.
+    // Each word matches a child exactly, or as an unambiguous prefix of one child.
+    Match match(const std::vector<std::string_view>& words) const;
+
+    // Candidates for the next word of a partially typed line. If the line does not end in
+    // whitespace its last word is treated as the prefix being completed.
+    std::vector<std::string> complete(std::string_view partialLine) const;
+
+    std::vector<std::string> listCommands() const; // Canonical paths, depth-first in sorted word order
+    std::vector<std::pair<std::string, std::string>> listAliases() const; // (alias, target), sorted
+    size_t size() const { return CppCommandCount; }
+
+    static std::vector<std::string_view> splitWords(std::string_view text);
+
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // Children of a node by word: a treap whose entries are immutable and shared between copies.
+    // Copying is O(1); set() and erase() clone only the O(log n) entries on their search path.
+    class ChildMap {
+    public:
+        // Called per child in word order; returns false to stop.
+        using Visitor = std::function<bool(const std::string& word, const NodePtr& child)>;
+
+        NodePtr find(std::string_view word) const;
+        void set(std::string_view word, NodePtr child); // Inserts or replaces
+        void erase(std::string_view word);
+        bool empty() const { return !CppRoot; }
+        // Visits the children whose word starts with prefix; all of them for an empty prefix.
+        void forEachWithPrefix(std::string_view prefix, const Visitor& visit) const;
+
+    private:
+        struct Entry;
+        using EntryPtr = std::shared_ptr<const Entry>;
+        EntryPtr CppRoot;
+
+        // Splits tree into the entries before word and those from word on.
+        static std::pair<EntryPtr, EntryPtr> split(const EntryPtr& tree, std::string_view word);
+        // Joins two trees; every word in 'low' sorts before every word in 'high'.
+        static EntryPtr merge(const EntryPtr& low, const EntryPtr& high);
+        static bool visitFrom(const Entry* tree, std::string_view prefix, const Visitor& visit);
+    };
+
+    struct Node {
+        std::shared_ptr<ICommand> command;
+        std::vector<std::string> aliasTarget; // Non-empty marks an alias leaf
+        ChildMap children;
+
+        bool isEmpty() const { return !command && aliasTarget.empty() && children.empty(); }
+    };
+
+    NodePtr CppRoot;
+    size_t CppCommandCount;
+
+    // Path-copying updates. 'apply' edits a private copy of the node at the end of words; it returns
+    // false to abort. The result is the new subtree root, or nullptr if nothing changed.
+    using LeafEdit = std::function<bool(Node&)>;
+    static NodePtr updatePath(const NodePtr& node, const std::vector<std::string_view>& words, size_t index,
+                              const LeafEdit& apply, bool createMissing);
+
+    // Finds the child for word: exact match first, then unique prefix.
+    // On ambiguity returns nullptr and fills ambiguous (if given) with the competing names.
+    static const Node* findChild(const Node& node, std::string_view word, std::string& key,
+                                 std::vector<std::string>* ambiguous);
+    // Follows exact words from the root, expanding aliases. Returns nullptr if any word is missing.
+    const Node* findExact(const std::vector<std::string>& words) const;
+    // Walks one word, expanding aliases; updates node and canonical path.
+    bool step(const Node*& node, std::vector<std::string>& path, std::string_view word,
+              std::vector<std::string>* ambiguous) const;
+
+    static void collectCommands(const Node& node, std::string& prefix, std::vector<std::string>& out);
+    static void collectAliases(const Node& node, std::string& prefix,
+                               std::vector<std::pair<std::string, std::string>>& out);
+    static std::string joinWords(const std::vector<std::string>& words);
+    bool editLeaf(const std::vector<std::string_view>& words, const LeafEdit& apply, bool createMissing);
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_COMMAND_TRIE_HPP
@@ -0,0 +1,358 @@
+#include "history_manager.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+namespace {
+const size_t TAIL_READ_CHUNK = 64 * 1024;
+
+bool isBlank(const std::string& line) {
+    return line.find_first_not_of(" \t\r\n") == std::string::npos;
+}
+} // namespace
+
+HistoryManager::HistoryManager(size_t maxItems)
+    : CppEnabled(true), CppMaxItems(maxItems == 0 ? 1 : maxItems), CppLoaded(true), CppFileLines(0) {
+}
+
+void HistoryManager::setEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppEnabled = enabled;
+}
+
+bool HistoryManager::isEnabled() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppEnabled;
+}
+
+void HistoryManager::setMaxItems(size_t maxItems) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppMaxItems = maxItems == 0 ? 1 : maxItems;
+    trimToCapacity();
+}
+
+size_t HistoryManager::getMaxItems() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppMaxItems;
+}
+
+void HistoryManager::setHistoryFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (path == CppFilePath) {
+        return;
+    }
+    CppFilePath = path;
+    CppEntries.clear();
+    CppIndex.clear();
+    CppFileLines = 0;
+    CppLoaded = path.empty(); // Read lazily on first use
+}
+
+std::string HistoryManager::getHistoryFile() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppFilePath;
+}
+
+bool HistoryManager::isLoaded() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppLoaded;
+}
+
+void HistoryManager::ensureLoaded() {
+    if (!CppLoaded) {
+        CppLoaded = true;
+        loadTail();
+    }
+}
+
+void HistoryManager::loadTail() {
+    std::ifstream file(CppFilePath, std::ios::binary);
+    if (!file.is_open()) {
+        return; // No history yet
+    }
+    file.seekg(0, std::ios::end);
+    std::streamoff position = file.tellg();
+    if (position <= 0) {
+        return;
+    }
+
+    // Walk backwards chunk by chunk, newest line first, until max-items distinct lines are found.
+    // 'partial' holds the beginning of a line whose start lies in an earlier chunk.
+    std::vector<std::string> newestFirst;
+    std::unordered_set<std::string> seen;
+    std::string partial;
+    std::vector<char> chunk;
+    size_t linesRead = 0;
+    auto takeLine = [&](std::string line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (isBlank(line)) {
+            return;
+        }
+        ++linesRead;
+        if (seen.insert(line).second) {
+            newestFirst.push_back(std::move(line));
+        }
+    };
+
+    while (position > 0 && newestFirst.size() < CppMaxItems) {
+        std::streamoff length = std::min<std::streamoff>(position, static_cast<std::streamoff>(TAIL_READ_CHUNK));
+        position -= length;
+        chunk.resize(static_cast<size_t>(length));
+        file.seekg(position);
+        file.read(chunk.data(), length);
+
+        std::string text(chunk.data(), chunk.size());
+        text += partial;
+        size_t end = text.size();
+        size_t newline;
+        while (newestFirst.size() < CppMaxItems && end > 0 &&
+               (newline = text.rfind('\n', end - 1)) != std::string::npos) {
+            takeLine(text.substr(newline + 1, end - newline - 1));
+            end = newline;
+        }
+        partial = text.substr(0, end);
+    }
+    bool readWholeFile = position == 0 && newestFirst.size() < CppMaxItems;
+    if (readWholeFile) {
+        takeLine(partial); // First line of the file
+    }
+
+    for (auto it = newestFirst.rbegin(); it != newestFirst.rend(); ++it) {
+        CppIndex.insert(*it);
+        CppEntries.push_back(std::move(*it));
+    }
+    // If the file was not read to its start it holds more than we kept: compact on the next add.
+    CppFileLines = readWholeFile ? linesRead : 2 * CppMaxItems + 1;
+}
+
+void HistoryManager::appendToFile(const std::string& line) {
+    if (CppFilePath.empty()) {
+        return;
+    }
+    if (++CppFileLines > 2 * CppMaxItems) {
+        rewriteFile();
+        return;
+    }
+    std::ofstream file(CppFilePath, std::ios::app | std::ios::binary);
+    if (file.is_open()) {
+        file << line << '\n';
+    }
+}
+
+void HistoryManager::rewriteFile() {
+    // Write to a temporary file and rename it over the old one so a crash never truncates history.
+    std::string temporaryPath = CppFilePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc | std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        for (const std::string& entry : CppEntries) {
+            file << entry << '\n';
+        }
+        if (!file.good()) {
+            std::remove(temporaryPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), CppFilePath.c_str()) == 0) {
+        CppFileLines = CppEntries.size();
+    } else {
+        std::remove(temporaryPath.c_str());
+    }
+}
+
+void HistoryManager::trimToCapacity() {
+    while (CppEntries.size() > CppMaxItems) {
+        CppIndex.erase(CppEntries.front());
+        CppEntries.pop_front();
+    }
+}
+
+void HistoryManager::insertNewest(std::string line) {
+    if (CppIndex.count(line) != 0) {
+        CppEntries.erase(std::find(CppEntries.begin(), CppEntries.end(), line));
+    } else {
+        CppIndex.insert(line);
+    }
+    CppEntries.push_back(std::move(line));
+    trimToCapacity();
+}
+
+bool HistoryManager::add(const std::string& line) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (!CppEnabled || isBlank(line)) {
+        return false;
+    }
+    std::string entry = line;
+    std::replace(entry.begin(), entry.end(), '\n', ' ');
+    std::replace(entry.begin(), entry.end(), '\r', ' ');
+
+    ensureLoaded();
+    if (!CppEntries.empty() && CppEntries.back() == entry) {
+        return false;
+    }
+    insertNewest(std::move(entry));
+    appendToFile(CppEntries.back()); // Compaction rewrites the entries, which already include this one
+    return true;
+}
+
+size_t HistoryManager::size() {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ensureLoaded();
+    return CppEntries.size();
+}
+
+std::vector<std::string> HistoryManager::entries() {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ensureLoaded();
+    return std::vector<std::string>(CppEntries.begin(), CppEntries.end());
+}
+
+std::optional<std::string> HistoryManager::at(size_t number) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ensureLoaded();
+    if (number == 0 || number > CppEntries.size()) {
+        return std::nullopt;
+    }
+    return CppEntries[number - 1];
+}
+
+std::optional<size_t> HistoryManager::searchBackward(std::string_view query, size_t before) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ensureLoaded();
+    for (size_t i = std::min(before, CppEntries.size()); i > 0; --i) {
+        if (CppEntries[i - 1].find(query) != std::string::npos) {
+            return i - 1;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::pair<size_t, std::string>> HistoryManager::find(std::string_view query, size_t limit) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ensureLoaded();
+    std::vector<std::pair<size_t, std::string>> matches;
+    for (size_t i = CppEntries.size(); i > 0 && (limit == 0 || matches.size() < limit); --i) {
+        if (CppEntries[i - 1].find(query) != std::string::npos) {
+            matches.emplace_back(i, CppEntries[i - 1]);
+        }
+    }
+    return matches;
+}
+
+std::optional<std::string> HistoryManager::expand(const std::string& line, std::string* error) {
+    if (line.size() < 2 || line[0] != '!') {
+        return line;
+    }
+    std::string reference = line.substr(1);
+    auto fail = [error, &line]() -> std::optional<std::string> {
+        if (error) {
+            *error = "History reference not found: " + line;
+        }
+        return std::nullopt;
+    };
+
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ensureLoaded();
+    if (CppEntries.empty()) {
+        return fail();
+    }
+    if (reference == "!") {
+        return CppEntries.back();
+    }
+
+    bool negative = reference[0] == '-';
+    std::string digits = negative ? reference.substr(1) : reference;
+    if (!digits.empty() && digits.find_first_not_of("0123456789") == std::string::npos) {
+        size_t n = digits.size() > 9 ? 0 : static_cast<size_t>(std::stoul(digits));
+        if (n == 0 || n > CppEntries.size()) {
+            return fail();
+        }
+        return negative ? CppEntries[CppEntries.size() - n] : CppEntries[n - 1];
+    }
+
+    bool contains = reference[0] == '?';
+    std::string text = contains ? reference.substr(1) : reference;
+    for (auto it = CppEntries.rbegin(); it != CppEntries.rend(); ++it) {
+        if (contains ? it->find(text) != std::string::npos : it->compare(0, text.size(), text) == 0) {
+            return *it;
+        }
+    }
+    return fail();
+}
+
+void HistoryManager::clear() {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppEntries.clear();
+    CppIndex.clear();
+    CppLoaded = true;
+    CppFileLines = 0;
+    if (!CppFilePath.empty()) {
+        std::ofstream truncate(CppFilePath, std::ios::trunc);
+    }
+}
+
+HistorySearch::HistorySearch(HistoryManager& history) : CppHistory(history) {
+}
+
+std::optional<std::string> HistorySearch::searchFrom(size_t before) {
+    std::optional<size_t> index = CppHistory.searchBackward(CppQuery, before);
+    if (!index) {
+        return std::nullopt;
+    }
+    std::optional<std::string> entry = CppHistory.at(*index + 1);
+    if (entry) {
+        CppMatchIndex = index;
+    }
+    return entry;
+}
+
+std::optional<std::string> HistorySearch::type(std::string_view characters) {
+    for (char c : characters) {
+        CppUndo.emplace_back(CppQuery.size(), CppMatchIndex);
+        CppQuery += c;
+    }
+    if (CppCurrent && CppCurrent->find(CppQuery) != std::string::npos) {
+        return CppCurrent; // Still matches: stay on it
+    }
+    // Entries newer than the current match did not contain the shorter query, so they cannot
+    // contain this one either; continue from the match (inclusive) toward older entries.
+    size_t before = CppMatchIndex ? *CppMatchIndex + 1 : CppHistory.size();
+    CppCurrent = searchFrom(before);
+    return CppCurrent;
+}
+
+std::optional<std::string> HistorySearch::backspace() {
+    if (CppUndo.empty()) {
+        return CppCurrent;
+    }
+    CppQuery.resize(CppUndo.back().first);
+    CppMatchIndex = CppUndo.back().second;
+    CppUndo.pop_back();
+    CppCurrent = CppMatchIndex ? CppHistory.at(*CppMatchIndex + 1) : std::nullopt;
+    return CppCurrent;
+}
+
+std::optional<std::string> HistorySearch::next() {
+    if (CppQuery.empty()) {
+        return std::nullopt;
+    }
+    size_t before = CppMatchIndex ? *CppMatchIndex : CppHistory.size();
+    std::optional<std::string> older = searchFrom(before);
+    if (older) {
+        CppCurrent = older;
+    }
+    return older;
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
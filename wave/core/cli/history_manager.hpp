@@ -0,0 +1,121 @@
+#ifndef WAVE_CORE_CLI_HISTORY_MANAGER_HPP
+#define WAVE_CORE_CLI_HISTORY_MANAGER_HPP
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Command history of the interactive CLI, optionally backed by a persistent file.
+//
+// The newest max-items distinct lines are kept in memory, oldest first. Adding a line that is
+// already present moves it to the newest position, so every entry is unique. The history file is
+// append-only: one line per add(), and it is rewritten only when it has grown to more than twice
+// max-items lines. It is not read until the history is first used, and then only from the end,
+// so a large file does not slow down startup.
+//
+// Entries are numbered from 1 (oldest) for display and for "!<n>" references. All methods are
+// thread-safe.
+class HistoryManager {
+public:
+    explicit HistoryManager(size_t maxItems = 500);
+
+    // Disabled history ignores add(); existing entries stay readable. Enabled by default.
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    // Shrinks the in-memory history immediately if needed. 0 is treated as 1.
+    void setMaxItems(size_t maxItems);
+    size_t getMaxItems() const;
+
+    // Sets the persistent history file. An empty path keeps history in memory only.
+    // Changing the path discards the in-memory entries; the new file is loaded on first use.
+    void setHistoryFile(const std::string& path);
+    std::string getHistoryFile() const;
+
+    // Records a command line. Returns false if it was ignored: history disabled, blank line, or the
+    // same as the newest entry. Embedded newlines are stored as spaces.
+    bool add(const std::string& line);
+
+    size_t size();
+    std::vector<std::string> entries(); // Oldest first
+    // Entry by 1-based number; nullopt if out of range.
+    std::optional<std::string> at(size_t number);
+
+    // Index (0-based, oldest first) of the newest entry before 'before' that contains query.
+    // Pass size() to search from the newest entry.
+    std::optional<size_t> searchBackward(std::string_view query, size_t before);
+    // Up to 'limit' (0 = all) entries containing query, newest first, with their 1-based numbers.
+    std::vector<std::pair<size_t, std::string>> find(std::string_view query, size_t limit = 0);
+
+    // Resolves a history reference at the start of a line:
+    //   !!        newest entry             !<n>    entry number n
+    //   !-<n>     n-th newest entry        !?text  newest entry containing text
+    //   !prefix   newest entry starting with prefix
+    // Lines not starting with '!' are returned unchanged. Returns nullopt (and sets *error) if the
+    // reference matches nothing.
+    std::optional<std::string> expand(const std::string& line, std::string* error = nullptr);
+
+    // Empties the in-memory history and truncates the history file.
+    void clear();
+
+    // True once the history file has been read (or there is none). For tests and diagnostics.
+    bool isLoaded() const;
+
+private:
+    mutable std::mutex CppMutex;
+    bool CppEnabled;
+    size_t CppMaxItems;
+    std::string CppFilePath;
+    bool CppLoaded;
+    size_t CppFileLines; // Lines in the file as far as we know; triggers compaction
+    std::deque<std::string> CppEntries;
+    std::unordered_set<std::string> CppIndex; // Same strings as CppEntries, for de-duplication
+
+    void ensureLoaded();
+    void loadTail(); // Reads newest distinct lines from the end of the file
+    void appendToFile(const std::string& line);
+    void rewriteFile();
+    void trimToCapacity();
+    void insertNewest(std::string line);
+};
+
+// Incremental reverse search (Ctrl-R style) over a HistoryManager.
+// Each typed character narrows the query and keeps the current match while it still matches;
+// next() steps to older matches; backspace() returns to the match shown before the last character.
+class HistorySearch {
+public:
+    explicit HistorySearch(HistoryManager& history);
+
+    std::optional<std::string> type(std::string_view characters);
+    std::optional<std::string> backspace();
+    std::optional<std::string> next();
+
+    const std::string& query() const { return CppQuery; }
+    std::optional<std::string> current() const { return CppCurrent; }
+
+private:
+    HistoryManager& CppHistory;
+    std::string CppQuery;
+    std::optional<size_t> CppMatchIndex;
+    std::optional<std::string> CppCurrent;
+    // (query length, match index) before each typed character, for backspace().
+    std::vector<std::pair<size_t, std::optional<size_t>>> CppUndo;
+
+    std::optional<std::string> searchFrom(size_t before);
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_HISTORY_MANAGER_HPP
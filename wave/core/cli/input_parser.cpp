@@ -0,0 +1,367 @@
+#include "input_parser.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+namespace {
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+} // namespace
+
+bool InputParser::tokenize(std::string_view line, std::vector<std::string_view>& tokens,
+                           std::string& scratch, std::string* error) {
+    tokens.clear();
+    scratch.clear();
+    // Unescaped text is never longer than the input, so this single reservation keeps every
+    // view into scratch valid while we keep appending.
+    scratch.reserve(line.size());
+
+    size_t i = 0;
+    const size_t n = line.size();
+    while (i < n) {
+        while (i < n && isSpace(line[i])) ++i;
+        if (i >= n) break;
+
+        size_t tokenStart = i;
+        size_t scratchStart = std::string::npos; // Set once the token needs rewriting
+        while (i < n && !isSpace(line[i])) {
+            char c = line[i];
+            if (c != '"' && c != '\'' && c != '\\') {
+                if (scratchStart != std::string::npos) scratch.push_back(c);
+                ++i;
+                continue;
+            }
+            if (scratchStart == std::string::npos) {
+                scratchStart = scratch.size();
+                scratch.append(line.data() + tokenStart, i - tokenStart);
+            }
+            if (c == '\\') {
+                if (i + 1 >= n) {
+                    if (error) *error = "Dangling escape at end of line.";
+                    return false;
+                }
+                scratch.push_back(line[i + 1]);
+                i += 2;
+                continue;
+            }
+            // Quoted section.
+            size_t quoteColumn = i;
+            ++i;
+            bool closed = false;
+            while (i < n) {
+                char q = line[i];
+                if (q == c) { closed = true; ++i; break; }
+                if (c == '"' && q == '\\' && i + 1 < n) {
+                    char e = line[i + 1];
+                    switch (e) {
+                        case 'n': scratch.push_back('\n'); break;
+                        case 't': scratch.push_back('\t'); break;
+                        case '"': case '\\': scratch.push_back(e); break;
+                        default: scratch.push_back('\\'); scratch.push_back(e); break;
+                    }
+                    i += 2;
+                    continue;
+                }
+                scratch.push_back(q);
+                ++i;
+            }
+            if (!closed) {
+                if (error) *error = "Unterminated quote starting at column " + std::to_string(quoteColumn + 1) + ".";
+                return false;
+            }
+        }
+        if (scratchStart == std::string::npos) {
+            tokens.push_back(line.substr(tokenStart, i - tokenStart));
+        } else {
+            tokens.push_back(std::string_view(scratch.data() + scratchStart, scratch.size() - scratchStart));
+        }
+    }
+    return true;
+}
+
+std::string InputParser::quote(std::string_view token) {
+    bool plain = !token.empty();
+    for (char c : token) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u < 0x20 || u == 0x7f || c == ' ' || c == '"' || c == '\'' || c == '\\' || c == ';' || c == '|' || c == '#') {
+            plain = false;
+            break;
+        }
+    }
+    if (plain) {
+        return std::string(token);
+    }
+    std::string quoted;
+    quoted.reserve(token.size() + 2);
+    quoted += '"';
+    for (char c : token) {
+        switch (c) {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default: quoted += c; break;
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
+bool InputParser::splitStatements(std::string_view script, std::vector<Statement>& statements, std::string* error) {
+    statements.clear();
+    size_t line = 1;
+    size_t start = 0;
+    size_t startLine = 1;
+    char quote = 0;
+    bool escaped = false;
+    bool inComment = false;
+    bool atStatementStart = true;
+
+    auto flush = [&](size_t end) {
+        std::string_view text = script.substr(start, end - start);
+        while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+        while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+        if (!text.empty()) {
+            statements.push_back(Statement{text, startLine});
+        }
+    };
+
+    for (size_t i = 0; i < script.size(); ++i) {
+        char c = script[i];
+        if (inComment) {
+            if (c == '\n') {
+                inComment = false;
+                ++line;
+                start = i + 1;
+                startLine = line;
+            }
+            continue;
+        }
+        if (escaped) {
+            escaped = false;
+            if (c == '\n') ++line;
+            continue;
+        }
+        if (c == '\\' && quote != '\'') {
+            escaped = true;
+            atStatementStart = false;
+            continue;
+        }
+        if (quote) {
+            if (c == quote) quote = 0;
+            if (c == '\n') ++line;
+            continue;
+        }
+        if (atStatementStart && isSpace(c) && c != '\n') {
+            continue;
+        }
+        if (atStatementStart && c == '#') {
+            inComment = true;
+            continue;
+        }
+        if (c == ';' || c == '\n') {
+            flush(i);
+            if (c == '\n') ++line;
+            start = i + 1;
+            startLine = line;
+            atStatementStart = true;
+            continue;
+        }
+        atStatementStart = false;
+        if (c == '"' || c == '\'') {
+            quote = c;
+        }
+    }
+    if (quote) {
+        if (error) *error = "Unterminated quote in statement starting on line " + std::to_string(startLine) + ".";
+        return false;
+    }
+    if (!inComment) {
+        flush(script.size());
+    }
+    return true;
+}
+
+bool InputParser::splitPipeline(std::string_view line, std::vector<std::string_view>& stages, std::string* error) {
+    stages.clear();
+    size_t start = 0;
+    char quote = 0;
+
+    auto flush = [&](size_t end) {
+        std::string_view text = line.substr(start, end - start);
+        while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+        while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+        if (text.empty()) {
+            if (error) *error = "Empty pipeline stage.";
+            return false;
+        }
+        stages.push_back(text);
+        return true;
+    };
+
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\\' && quote != '\'') {
+            ++i; // The escaped character never ends a stage or a quote
+            continue;
+        }
+        if (quote) {
+            if (c == quote) quote = 0;
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '|') {
+            if (!flush(i)) {
+                return false;
+            }
+            start = i + 1;
+        }
+    }
+    if (quote) {
+        if (error) *error = "Unterminated quote.";
+        return false;
+    }
+    return flush(line.size());
+}
+
+TokenizedLine::TokenizedLine(std::string line) : CppStorage(std::make_unique<Storage>()) {
+    CppStorage->line = std::move(line);
+    CppStorage->ok = InputParser::tokenize(CppStorage->line, CppStorage->tokens, CppStorage->scratch, &CppStorage->error);
+}
+
+bool ParsedOptions::getFlag(const std::string& name) const {
+    auto it = CppValues.find(name);
+    if (it == CppValues.end() || it->second.type() != typeid(bool)) return false;
+    return std::any_cast<bool>(it->second);
+}
+
+std::optional<std::string> ParsedOptions::getString(const std::string& name) const {
+    auto it = CppValues.find(name);
+    if (it == CppValues.end() || it->second.type() != typeid(std::string)) return std::nullopt;
+    return std::any_cast<const std::string&>(it->second);
+}
+
+std::optional<long long> ParsedOptions::getInteger(const std::string& name) const {
+    auto it = CppValues.find(name);
+    if (it == CppValues.end() || it->second.type() != typeid(long long)) return std::nullopt;
+    return std::any_cast<long long>(it->second);
+}
+
+std::optional<double> ParsedOptions::getNumber(const std::string& name) const {
+    auto it = CppValues.find(name);
+    if (it == CppValues.end()) return std::nullopt;
+    if (it->second.type() == typeid(double)) return std::any_cast<double>(it->second);
+    if (it->second.type() == typeid(long long)) return static_cast<double>(std::any_cast<long long>(it->second));
+    return std::nullopt;
+}
+
+std::string ParsedOptions::toString() const {
+    std::string text;
+    for (const auto& entry : CppValues) {
+        if (!text.empty()) text += '\0';
+        text += entry.first;
+        text += '=';
+        const std::any& value = entry.second;
+        if (value.type() == typeid(bool)) {
+            text += std::any_cast<bool>(value) ? "true" : "false";
+        } else if (value.type() == typeid(long long)) {
+            text += std::to_string(std::any_cast<long long>(value));
+        } else if (value.type() == typeid(double)) {
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.17g", std::any_cast<double>(value));
+            text += number;
+        } else if (value.type() == typeid(std::string)) {
+            text += std::any_cast<const std::string&>(value);
+        }
+    }
+    return text;
+}
+
+bool ParsedOptions::parse(const std::vector<OptionSpec>& specs, const std::vector<std::string_view>& tokens,
+                          ParsedOptions& options, std::vector<std::string>& positional, std::string& error) {
+    positional.clear();
+    bool optionsEnded = false;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        std::string_view token = tokens[i];
+        if (optionsEnded || token.size() < 3 || token.compare(0, 2, "--") != 0) {
+            if (!optionsEnded && token == "--") {
+                optionsEnded = true;
+                continue;
+            }
+            positional.emplace_back(token);
+            continue;
+        }
+
+        std::string_view body = token.substr(2);
+        size_t eq = body.find('=');
+        std::string_view name = body.substr(0, eq);
+        const OptionSpec* spec = nullptr;
+        for (const auto& candidate : specs) {
+            if (candidate.name == name) { spec = &candidate; break; }
+        }
+        if (!spec) {
+            error = "Unknown option: --" + std::string(name);
+            return false;
+        }
+
+        std::optional<std::string> value;
+        if (eq != std::string_view::npos) {
+            value = std::string(body.substr(eq + 1));
+        } else if (spec->type != OptionSpec::Type::Flag) {
+            if (i + 1 >= tokens.size()) {
+                error = "Missing value for option --" + spec->name;
+                return false;
+            }
+            value = std::string(tokens[++i]);
+        }
+
+        switch (spec->type) {
+            case OptionSpec::Type::Flag:
+                if (!value || *value == "true" || *value == "1" || *value == "yes" || *value == "on") {
+                    options.CppValues[spec->name] = true;
+                } else if (*value == "false" || *value == "0" || *value == "no" || *value == "off") {
+                    options.CppValues[spec->name] = false;
+                } else {
+                    error = "Invalid boolean for option --" + spec->name + ": " + *value;
+                    return false;
+                }
+                break;
+            case OptionSpec::Type::String:
+                options.CppValues[spec->name] = *value;
+                break;
+            case OptionSpec::Type::Integer: {
+                errno = 0;
+                char* end = nullptr;
+                long long parsed = std::strtoll(value->c_str(), &end, 10);
+                if (value->empty() || *end != '\0' || errno == ERANGE) {
+                    error = "Invalid integer for option --" + spec->name + ": " + *value;
+                    return false;
+                }
+                options.CppValues[spec->name] = parsed;
+                break;
+            }
+            case OptionSpec::Type::Number: {
+                errno = 0;
+                char* end = nullptr;
+                double parsed = std::strtod(value->c_str(), &end);
+                if (value->empty() || *end != '\0' || errno == ERANGE) {
+                    error = "Invalid number for option --" + spec->name + ": " + *value;
+                    return false;
+                }
+                options.CppValues[spec->name] = parsed;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
@@ -0,0 +1,124 @@
+#ifndef WAVE_CORE_CLI_INPUT_PARSER_HPP
+#define WAVE_CORE_CLI_INPUT_PARSER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <optional>
+#include <any>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Splits command lines into tokens in a single pass.
+//
+// Quoting rules:
+//   * Unquoted whitespace separates tokens.
+//   * "double quotes" group text; inside them \" \\ \n \t are escapes.
+//   * 'single quotes' group text literally.
+//   * Outside quotes a backslash makes the next character literal.
+//   * Quoted parts may be glued to unquoted text: --name="hello world" is one token.
+class InputParser {
+public:
+    // One statement of a script, as a view into the script text.
+    struct Statement {
+        std::string_view text;
+        size_t lineNumber; // 1-based line on which the statement starts
+    };
+
+    // Tokenizes line into tokens. Tokens that contain no quotes or escapes are views into line;
+    // tokens that had to be unescaped are views into scratch, which is reserved up front so it
+    // never reallocates. The views stay valid while both line and scratch are alive and unmodified.
+    // Returns false on malformed input (e.g. an unterminated quote) and describes it in error.
+    static bool tokenize(std::string_view line, std::vector<std::string_view>& tokens,
+                         std::string& scratch, std::string* error = nullptr);
+
+    // Splits a script into statements separated by unquoted ';' or newlines, following the same
+    // quoting rules as tokenize(). Blank statements and '#' comment lines are dropped, and each
+    // statement is trimmed. Returns false on an unterminated quote.
+    static bool splitStatements(std::string_view script, std::vector<Statement>& statements,
+                                std::string* error = nullptr);
+
+    // Splits a command line into pipeline stages at unquoted '|' characters, following the same
+    // quoting rules as tokenize(). Stages are trimmed views into line; a line without '|' yields
+    // one stage. Returns false on an empty stage ("a || b", "| a") or an unterminated quote.
+    static bool splitPipeline(std::string_view line, std::vector<std::string_view>& stages,
+                              std::string* error = nullptr);
+
+    // The inverse of tokenize() for one token: returns text that tokenize() reads back as exactly
+    // 'token'. Plain words come back unchanged; anything else is double-quoted, with newlines and
+    // tabs written as \n and \t so the result stays on one line. Other control characters are
+    // kept as they are inside the quotes. Use it to build a command line from arguments.
+    static std::string quote(std::string_view token);
+};
+
+// Owning variant of InputParser::tokenize: keeps its own copy of the line, so the token views
+// remain valid for the lifetime of the object (including after a move).
+class TokenizedLine {
+public:
+    explicit TokenizedLine(std::string line);
+
+    bool ok() const { return CppStorage->ok; }
+    const std::string& error() const { return CppStorage->error; }
+    const std::vector<std::string_view>& tokens() const { return CppStorage->tokens; }
+    const std::string& line() const { return CppStorage->line; }
+
+private:
+    struct Storage {
+        std::string line;
+        std::string scratch;
+        std::vector<std::string_view> tokens;
+        std::string error;
+        bool ok = false;
+    };
+    std::unique_ptr<Storage> CppStorage; // Heap storage keeps views stable across moves
+};
+
+// Declaration of a named option a command accepts, as --name, --name=value or --name value.
+struct OptionSpec {
+    enum class Type {
+        Flag,    // --name (true) or --name=true|false
+        String,
+        Integer,
+        Number
+    };
+
+    std::string name; // Without the leading dashes
+    Type type;
+    std::string help;
+
+    OptionSpec(std::string n, Type t, std::string h = "")
+        : name(std::move(n)), type(t), help(std::move(h)) {}
+};
+
+// Typed option values for one invocation, filled by CLIEngine from the command's OptionSpecs.
+class ParsedOptions {
+public:
+    bool has(const std::string& name) const { return CppValues.count(name) != 0; }
+    bool getFlag(const std::string& name) const;
+    std::optional<std::string> getString(const std::string& name) const;
+    std::optional<long long> getInteger(const std::string& name) const;
+    std::optional<double> getNumber(const std::string& name) const;
+    bool empty() const { return CppValues.empty(); }
+    // Canonical NUL-separated "name=value" list, sorted by name: equal exactly for equal option
+    // values (used for cache keys).
+    std::string toString() const;
+
+    // Separates option tokens from positional arguments according to specs.
+    // "--" ends option processing. Returns false with error set for unknown options, missing
+    // values or values that do not convert to the declared type.
+    static bool parse(const std::vector<OptionSpec>& specs, const std::vector<std::string_view>& tokens,
+                      ParsedOptions& options, std::vector<std::string>& positional, std::string& error);
+
+private:
+    std::map<std::string, std::any> CppValues; // bool, std::string, long long or double per spec type
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_INPUT_PARSER_HPP
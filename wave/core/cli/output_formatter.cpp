@@ -0,0 +1,560 @@
+#include "output_formatter.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+namespace {
+const char* const OPAQUE_TEXT = "(Opaque/Cannot display type)";
+
+// Compact JSON. Strings are assumed to be UTF-8 and passed through apart from the escapes JSON requires.
+class JsonValueWriter : public ValueWriter {
+public:
+    explicit JsonValueWriter(std::ostream& out, bool opaqueAsText = false) : CppOut(out), CppOpaqueAsText(opaqueAsText) {}
+
+    void null() override { separate(); CppOut << "null"; }
+    void boolean(bool value) override { separate(); CppOut << (value ? "true" : "false"); }
+    void integer(long long value) override { separate(); CppOut << value; }
+    void unsignedInteger(unsigned long long value) override { separate(); CppOut << value; }
+    void number(double value) override {
+        separate();
+        if (!std::isfinite(value)) {
+            CppOut << "null"; // JSON has no NaN or infinity
+            return;
+        }
+        // Shortest of %.15g / %.17g that reads back as the same double.
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.15g", value);
+        if (std::strtod(text, nullptr) != value) {
+            std::snprintf(text, sizeof(text), "%.17g", value);
+        }
+        CppOut << text;
+    }
+    void string(std::string_view value) override { separate(); writeString(value); }
+    void beginArray(size_t) override { separate(); CppOut << '['; CppLevels.push_back(true); }
+    void endArray() override { CppOut << ']'; CppLevels.pop_back(); }
+    void beginObject(size_t) override { separate(); CppOut << '{'; CppLevels.push_back(true); }
+    void key(std::string_view name) override {
+        if (!CppLevels.back()) {
+            CppOut << ',';
+        }
+        CppLevels.back() = false;
+        writeString(name);
+        CppOut << ':';
+        CppAfterKey = true;
+    }
+    void endObject() override { CppOut << '}'; CppLevels.pop_back(); }
+    void opaque(const std::type_info& type) override {
+        if (CppOpaqueAsText) {
+            string(OPAQUE_TEXT);
+        } else {
+            ValueWriter::opaque(type);
+        }
+    }
+
+    static void escape(std::ostream& out, std::string_view value) {
+        for (char c : value) {
+            switch (c) {
+                case '"':  out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                case '\r': out << "\\r"; break;
+                case '\t': out << "\\t"; break;
+                case '\b': out << "\\b"; break;
+                case '\f': out << "\\f"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char code[8];
+                        std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+                        out << code;
+                    } else {
+                        out << c;
+                    }
+            }
+        }
+    }
+
+private:
+    std::ostream& CppOut;
+    bool CppOpaqueAsText;
+    std::vector<bool> CppLevels; // Per open array/object: no element written yet
+    bool CppAfterKey = false;
+
+    // Writes the ',' between array elements. Object members get theirs from key().
+    void separate() {
+        if (CppAfterKey) {
+            CppAfterKey = false;
+            return;
+        }
+        if (CppLevels.empty()) {
+            return;
+        }
+        if (!CppLevels.back()) {
+            CppOut << ',';
+        }
+        CppLevels.back() = false;
+    }
+
+    void writeString(std::string_view value) {
+        CppOut << '"';
+        escape(CppOut, value);
+        CppOut << '"';
+    }
+};
+
+// CBOR (RFC 8949) with definite lengths.
+class CborValueWriter : public ValueWriter {
+public:
+    explicit CborValueWriter(std::ostream& out) : CppOut(out) {}
+
+    void null() override { CppOut.put(static_cast<char>(0xf6)); }
+    void boolean(bool value) override { CppOut.put(static_cast<char>(value ? 0xf5 : 0xf4)); }
+    void integer(long long value) override {
+        if (value >= 0) {
+            head(0, static_cast<unsigned long long>(value));
+        } else {
+            head(1, static_cast<unsigned long long>(-(value + 1)));
+        }
+    }
+    void unsignedInteger(unsigned long long value) override { head(0, value); }
+    void number(double value) override {
+        unsigned long long bits;
+        static_assert(sizeof(bits) == sizeof(value), "IEEE 754 double expected");
+        std::memcpy(&bits, &value, sizeof(bits));
+        CppOut.put(static_cast<char>(0xfb));
+        writeBigEndian(bits, 8);
+    }
+    void string(std::string_view value) override {
+        head(3, value.size());
+        CppOut.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+    void beginArray(size_t count) override { head(4, count); }
+    void endArray() override {}
+    void beginObject(size_t count) override { head(5, count); }
+    void key(std::string_view name) override { string(name); }
+    void endObject() override {}
+
+private:
+    std::ostream& CppOut;
+
+    void head(unsigned major, unsigned long long value) {
+        unsigned char type = static_cast<unsigned char>(major << 5);
+        if (value < 24) {
+            CppOut.put(static_cast<char>(type | value));
+        } else if (value <= 0xff) {
+            CppOut.put(static_cast<char>(type | 24));
+            writeBigEndian(value, 1);
+        } else if (value <= 0xffff) {
+            CppOut.put(static_cast<char>(type | 25));
+            writeBigEndian(value, 2);
+        } else if (value <= 0xffffffffULL) {
+            CppOut.put(static_cast<char>(type | 26));
+            writeBigEndian(value, 4);
+        } else {
+            CppOut.put(static_cast<char>(type | 27));
+            writeBigEndian(value, 8);
+        }
+    }
+
+    void writeBigEndian(unsigned long long value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            CppOut.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+};
+
+// Splits one row into TSV cells: the elements (or members) of a top-level array (object), or the
+// value itself. Nested containers become compact JSON inside their cell.
+class TsvRowWriter : public ValueWriter {
+public:
+    std::vector<std::string> keys;  // Member names when the row is an object
+    std::vector<std::string> cells;
+    bool isObject = false;
+
+    void null() override { CppNested ? CppNested->null() : cell(""); }
+    void boolean(bool value) override { CppNested ? CppNested->boolean(value) : cell(value ? "true" : "false"); }
+    void integer(long long value) override { CppNested ? CppNested->integer(value) : cell(std::to_string(value)); }
+    void unsignedInteger(unsigned long long value) override {
+        CppNested ? CppNested->unsignedInteger(value) : cell(std::to_string(value));
+    }
+    void number(double value) override {
+        if (CppNested) {
+            CppNested->number(value);
+            return;
+        }
+        std::ostringstream text;
+        JsonValueWriter(text).number(value);
+        cell(text.str());
+    }
+    void string(std::string_view value) override { CppNested ? CppNested->string(value) : cell(value); }
+    void beginArray(size_t count) override { beginContainer(false, count); }
+    void endArray() override { endContainer(); }
+    void beginObject(size_t count) override { beginContainer(true, count); }
+    void key(std::string_view name) override {
+        if (CppNested) {
+            CppNested->key(name);
+        } else {
+            keys.emplace_back(name);
+        }
+    }
+    void endObject() override { endContainer(); }
+    void opaque(const std::type_info&) override { CppNested ? CppNested->string(OPAQUE_TEXT) : cell(OPAQUE_TEXT); }
+
+    static std::string escapeCell(std::string_view value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (char c : value) {
+            switch (c) {
+                case '\t': escaped += "\\t"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\r': escaped += "\\r"; break;
+                case '\\': escaped += "\\\\"; break;
+                default:   escaped += c; break;
+            }
+        }
+        return escaped;
+    }
+
+private:
+    int CppDepth = 0;                  // Open containers, including the row itself
+    std::vector<bool> CppNestedKinds;  // Open containers inside a cell: true = object
+    std::ostringstream CppNestedText;
+    std::unique_ptr<JsonValueWriter> CppNested;
+
+    void cell(std::string_view text) { cells.push_back(escapeCell(text)); }
+
+    void beginContainer(bool object, size_t count) {
+        if (CppDepth++ == 0) {
+            isObject = object;
+            return;
+        }
+        if (!CppNested) {
+            CppNestedText.str("");
+            CppNested = std::make_unique<JsonValueWriter>(CppNestedText, true);
+        }
+        CppNestedKinds.push_back(object);
+        object ? CppNested->beginObject(count) : CppNested->beginArray(count);
+    }
+
+    void endContainer() {
+        if (--CppDepth == 0) {
+            return;
+        }
+        bool object = CppNestedKinds.back();
+        CppNestedKinds.pop_back();
+        object ? CppNested->endObject() : CppNested->endArray();
+        if (CppNestedKinds.empty()) {
+            cell(CppNestedText.str());
+            CppNested.reset();
+        }
+    }
+};
+
+class TextFormatter : public OutputFormatter {
+public:
+    using OutputFormatter::OutputFormatter;
+
+    void finish(const CommandResult& result) override {
+        CppOut << "[" << CommandResult::statusToString(result.status) << "] " << result.message << '\n';
+        if (result.data.has_value()) {
+            CppOut << "Data: " << CppRegistry.toText(*result.data) << '\n';
+        }
+        CppOut.flush();
+    }
+
+protected:
+    void writeRow(const StructuredData& row) override { CppOut << CppRegistry.toText(row) << '\n'; }
+};
+
+class JsonFormatter : public OutputFormatter {
+public:
+    using OutputFormatter::OutputFormatter;
+
+    void finish(const CommandResult& result) override {
+        JsonValueWriter writer(CppOut);
+        writer.beginObject(result.data.has_value() ? 4 : 3);
+        writer.key("type");
+        writer.string("result");
+        writer.key("status");
+        writer.string(CommandResult::statusToString(result.status));
+        writer.key("message");
+        writer.string(result.message);
+        if (result.data.has_value()) {
+            writer.key("data");
+            CppRegistry.writeValue(*result.data, writer);
+        }
+        writer.endObject();
+        CppOut << '\n';
+        CppOut.flush();
+    }
+
+protected:
+    void writeRow(const StructuredData& row) override {
+        JsonValueWriter writer(CppOut);
+        writer.beginObject(2);
+        writer.key("type");
+        writer.string("row");
+        writer.key("value");
+        CppRegistry.writeValue(row, writer);
+        writer.endObject();
+        CppOut << '\n';
+    }
+};
+
+class TsvFormatter : public OutputFormatter {
+public:
+    using OutputFormatter::OutputFormatter;
+
+    void finish(const CommandResult& result) override {
+        if (result.data.has_value()) {
+            if (result.data->type() == typeid(std::vector<StructuredData>)) {
+                for (const StructuredData& row : std::any_cast<const std::vector<StructuredData>&>(*result.data)) {
+                    writeRow(row);
+                }
+            } else {
+                writeRow(*result.data);
+            }
+        }
+        CppOut.flush();
+    }
+
+    bool includesStatus() const override { return false; }
+
+protected:
+    void writeRow(const StructuredData& row) override {
+        TsvRowWriter cells;
+        CppRegistry.writeValue(row, cells);
+        if (!cells.isObject) {
+            writeLine(cells.cells);
+            return;
+        }
+        // Object rows: the first one fixes the columns; later rows are aligned to them.
+        if (!CppHeaderWritten) {
+            CppHeader = cells.keys;
+            std::vector<std::string> header;
+            for (const std::string& name : CppHeader) {
+                header.push_back(TsvRowWriter::escapeCell(name));
+            }
+            writeLine(header);
+            CppHeaderWritten = true;
+        }
+        std::vector<std::string> aligned(CppHeader.size());
+        for (size_t i = 0; i < cells.keys.size() && i < cells.cells.size(); ++i) {
+            for (size_t column = 0; column < CppHeader.size(); ++column) {
+                if (CppHeader[column] == cells.keys[i]) {
+                    aligned[column] = std::move(cells.cells[i]);
+                    break;
+                }
+            }
+        }
+        writeLine(aligned);
+    }
+
+private:
+    bool CppHeaderWritten = false;
+    std::vector<std::string> CppHeader;
+
+    void writeLine(const std::vector<std::string>& cells) {
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (i > 0) {
+                CppOut << '\t';
+            }
+            CppOut << cells[i];
+        }
+        CppOut << '\n';
+    }
+};
+
+class BinaryFormatter : public OutputFormatter {
+public:
+    using OutputFormatter::OutputFormatter;
+
+    void finish(const CommandResult& result) override {
+        CborValueWriter writer(CppOut);
+        writer.beginObject(result.data.has_value() ? 4 : 3);
+        writer.key("type");
+        writer.string("result");
+        writer.key("status");
+        writer.string(CommandResult::statusToString(result.status));
+        writer.key("message");
+        writer.string(result.message);
+        if (result.data.has_value()) {
+            writer.key("data");
+            CppRegistry.writeValue(*result.data, writer);
+        }
+        writer.endObject();
+        CppOut.flush();
+    }
+
+protected:
+    void writeRow(const StructuredData& row) override {
+        CborValueWriter writer(CppOut);
+        writer.beginObject(2);
+        writer.key("type");
+        writer.string("row");
+        writer.key("value");
+        CppRegistry.writeValue(row, writer);
+        writer.endObject();
+    }
+};
+
+template <typename Formatter>
+OutputFormatterRegistry::Factory makeFactory() {
+    return [](std::ostream& out, const OutputFormatterRegistry& registry) -> std::unique_ptr<OutputFormatter> {
+        return std::make_unique<Formatter>(out, registry);
+    };
+}
+} // namespace
+
+OutputFormatter::OutputFormatter(std::ostream& out, const OutputFormatterRegistry& registry)
+    : CppOut(out), CppRegistry(registry) {
+}
+
+bool OutputFormatter::write(StructuredData row) {
+    writeRow(row);
+    return static_cast<bool>(CppOut);
+}
+
+OutputFormatterRegistry::OutputFormatterRegistry()
+    : CppValueVisitors(std::make_shared<const VisitorMap>()) {
+    CppFormatters["text"] = makeFactory<TextFormatter>();
+    CppFormatters["json"] = makeFactory<JsonFormatter>();
+    CppFormatters["tsv"] = makeFactory<TsvFormatter>();
+    CppFormatters["binary"] = makeFactory<BinaryFormatter>();
+
+    registerValueType<std::string>([](const std::string& value, ValueWriter& writer) { writer.string(value); });
+    registerValueType<const char*>([](const char* const& value, ValueWriter& writer) {
+        value ? writer.string(value) : writer.null();
+    });
+    registerValueType<bool>([](const bool& value, ValueWriter& writer) { writer.boolean(value); });
+    registerValueType<int>([](const int& value, ValueWriter& writer) { writer.integer(value); });
+    registerValueType<long>([](const long& value, ValueWriter& writer) { writer.integer(value); });
+    registerValueType<long long>([](const long long& value, ValueWriter& writer) { writer.integer(value); });
+    registerValueType<unsigned>([](const unsigned& value, ValueWriter& writer) { writer.unsignedInteger(value); });
+    registerValueType<unsigned long>([](const unsigned long& value, ValueWriter& writer) { writer.unsignedInteger(value); });
+    registerValueType<unsigned long long>([](const unsigned long long& value, ValueWriter& writer) {
+        writer.unsignedInteger(value);
+    });
+    registerValueType<float>([](const float& value, ValueWriter& writer) { writer.number(value); });
+    registerValueType<double>([](const double& value, ValueWriter& writer) { writer.number(value); });
+    registerValueType<std::vector<std::string>>([](const std::vector<std::string>& values, ValueWriter& writer) {
+        writer.beginArray(values.size());
+        for (const std::string& value : values) {
+            writer.string(value);
+        }
+        writer.endArray();
+    });
+    registerValueType<std::map<std::string, std::string>>(
+        [](const std::map<std::string, std::string>& values, ValueWriter& writer) {
+            writer.beginObject(values.size());
+            for (const auto& entry : values) {
+                writer.key(entry.first);
+                writer.string(entry.second);
+            }
+            writer.endObject();
+        });
+    // Containers of StructuredData recurse through the registry, so they pick up visitors that are
+    // registered later as well.
+    registerValueType<std::vector<StructuredData>>([this](const std::vector<StructuredData>& values, ValueWriter& writer) {
+        writer.beginArray(values.size());
+        for (const StructuredData& value : values) {
+            writeValue(value, writer);
+        }
+        writer.endArray();
+    });
+    registerValueType<std::map<std::string, StructuredData>>(
+        [this](const std::map<std::string, StructuredData>& values, ValueWriter& writer) {
+            writer.beginObject(values.size());
+            for (const auto& entry : values) {
+                writer.key(entry.first);
+                writeValue(entry.second, writer);
+            }
+            writer.endObject();
+        });
+}
+
+bool OutputFormatterRegistry::registerFormatter(const std::string& name, Factory factory) {
+    if (name.empty() || !factory) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(CppFormattersMutex);
+    return CppFormatters.emplace(name, std::move(factory)).second;
+}
+
+bool OutputFormatterRegistry::hasFormatter(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(CppFormattersMutex);
+    return CppFormatters.count(name) != 0;
+}
+
+std::vector<std::string> OutputFormatterRegistry::getFormatterNames() const {
+    std::shared_lock<std::shared_mutex> lock(CppFormattersMutex);
+    std::vector<std::string> names;
+    for (const auto& entry : CppFormatters) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+std::unique_ptr<OutputFormatter> OutputFormatterRegistry::create(const std::string& name, std::ostream& out) const {
+    Factory factory;
+    {
+        std::shared_lock<std::shared_mutex> lock(CppFormattersMutex);
+        auto it = CppFormatters.find(name);
+        if (it == CppFormatters.end()) {
+            return nullptr;
+        }
+        factory = it->second;
+    }
+    return factory(out, *this);
+}
+
+void OutputFormatterRegistry::registerValueVisitor(std::type_index type, ValueVisitor visitor) {
+    // Copy-on-write: writeValue() runs for every value of every row and only loads the snapshot.
+    std::lock_guard<std::mutex> lock(CppValueVisitorsWriteMutex);
+    auto updated = std::make_shared<VisitorMap>(*std::atomic_load(&CppValueVisitors));
+    (*updated)[type] = std::move(visitor);
+    std::atomic_store(&CppValueVisitors, std::shared_ptr<const VisitorMap>(std::move(updated)));
+}
+
+void OutputFormatterRegistry::writeValue(const StructuredData& value, ValueWriter& writer) const {
+    if (!value.has_value()) {
+        writer.null();
+        return;
+    }
+    std::shared_ptr<const VisitorMap> visitors = std::atomic_load(&CppValueVisitors);
+    auto it = visitors->find(std::type_index(value.type()));
+    if (it == visitors->end()) {
+        writer.opaque(value.type());
+        return;
+    }
+    it->second(value, writer);
+}
+
+std::string OutputFormatterRegistry::toText(const StructuredData& value) const {
+    if (value.type() == typeid(std::string)) {
+        return std::any_cast<const std::string&>(value);
+    }
+    if (value.type() == typeid(const char*)) {
+        const char* text = std::any_cast<const char*>(value);
+        return text ? text : "";
+    }
+    std::shared_ptr<const VisitorMap> visitors = std::atomic_load(&CppValueVisitors);
+    if (value.has_value() && visitors->find(std::type_index(value.type())) == visitors->end()) {
+        return OPAQUE_TEXT;
+    }
+    std::ostringstream text;
+    JsonValueWriter writer(text, true);
+    writeValue(value, writer);
+    return text.str();
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
@@ -0,0 +1,126 @@
+#ifndef WAVE_CORE_CLI_OUTPUT_FORMATTER_HPP
+#define WAVE_CORE_CLI_OUTPUT_FORMATTER_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <vector>
+
+#include "cli_engine.hpp"
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Receives a structured value as a sequence of events (scalars, arrays, objects), so encoders can
+// write straight to their stream without building an intermediate document. Array and object
+// sizes are announced up front because the binary encoding needs them.
+class ValueWriter {
+public:
+    virtual ~ValueWriter() = default;
+
+    virtual void null() = 0;
+    virtual void boolean(bool value) = 0;
+    virtual void integer(long long value) = 0;
+    virtual void unsignedInteger(unsigned long long value) = 0;
+    virtual void number(double value) = 0;
+    virtual void string(std::string_view value) = 0;
+    virtual void beginArray(size_t count) = 0;
+    virtual void endArray() = 0;
+    virtual void beginObject(size_t count) = 0;
+    virtual void key(std::string_view name) = 0; // Before each object member
+    virtual void endObject() = 0;
+
+    // A value of a type nobody registered. Encoders write null by default.
+    virtual void opaque(const std::type_info& type) {
+        (void)type;
+        null();
+    }
+};
+
+class OutputFormatterRegistry;
+
+// Streaming encoder for one command execution. It is the execution's row sink: each emitted row
+// is encoded and written to the stream immediately. finish() writes the final result.
+class OutputFormatter : public IOutputSink {
+public:
+    OutputFormatter(std::ostream& out, const OutputFormatterRegistry& registry);
+
+    bool write(StructuredData row) override; // Encodes the row; false once the stream failed
+
+    virtual void finish(const CommandResult& result) = 0;
+
+    // False for formats that carry only data (tsv); callers then report the status out of band.
+    virtual bool includesStatus() const { return true; }
+
+protected:
+    std::ostream& CppOut;
+    const OutputFormatterRegistry& CppRegistry;
+
+    virtual void writeRow(const StructuredData& row) = 0;
+};
+
+// Named output formats plus the table of value types they know how to encode.
+//
+// Built-in formats:
+//   text    rows as plain lines (strings verbatim, other values as compact JSON), then
+//           "[Status] message" and "Data: ..." as in the interactive session
+//   json    JSON Lines: {"type":"row","value":...} per row, then
+//           {"type":"result","status":...,"message":...,"data":...}
+//   tsv     one line per row; object rows get a header line from the first row's keys; no status
+//   binary  the json records as a CBOR sequence (RFC 8949 / RFC 8742)
+//
+// Built-in value types: std::string, const char*, bool, integral and floating types,
+// std::vector<StructuredData>, std::vector<std::string>, std::map<std::string, StructuredData>,
+// std::map<std::string, std::string>. Commands returning their own types register a visitor with
+// registerValueType<T>(). All methods are thread-safe.
+class OutputFormatterRegistry {
+public:
+    using Factory = std::function<std::unique_ptr<OutputFormatter>(std::ostream& out, const OutputFormatterRegistry& registry)>;
+    using ValueVisitor = std::function<void(const StructuredData& value, ValueWriter& writer)>;
+
+    OutputFormatterRegistry();
+
+    // Returns false if a format with that name exists already.
+    bool registerFormatter(const std::string& name, Factory factory);
+    bool hasFormatter(const std::string& name) const;
+    std::vector<std::string> getFormatterNames() const;
+    // nullptr for an unknown name.
+    std::unique_ptr<OutputFormatter> create(const std::string& name, std::ostream& out) const;
+
+    // Teaches every format to encode values of type T. Replaces an earlier visitor for T.
+    template <typename T>
+    void registerValueType(std::function<void(const T& value, ValueWriter& writer)> visitor) {
+        registerValueVisitor(std::type_index(typeid(T)),
+            [visitor](const StructuredData& value, ValueWriter& writer) { visitor(std::any_cast<const T&>(value), writer); });
+    }
+    void registerValueVisitor(std::type_index type, ValueVisitor visitor);
+
+    // Feeds value to writer; empty values become null, unknown types writer.opaque().
+    void writeValue(const StructuredData& value, ValueWriter& writer) const;
+
+    // Rendering used by line-oriented outputs (text format, remote sessions): strings verbatim,
+    // anything else as compact JSON, unknown types as "(Opaque/Cannot display type)".
+    std::string toText(const StructuredData& value) const;
+
+private:
+    using VisitorMap = std::map<std::type_index, ValueVisitor>;
+
+    mutable std::shared_mutex CppFormattersMutex;
+    std::map<std::string, Factory> CppFormatters;
+    // Immutable snapshot, replaced atomically on registration (like the command registry).
+    std::shared_ptr<const VisitorMap> CppValueVisitors;
+    std::mutex CppValueVisitorsWriteMutex;
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_OUTPUT_FORMATTER_HPP
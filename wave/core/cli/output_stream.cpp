@@ -0,0 +1,80 @@
+#include "output_stream.hpp"
+
+namespace wave {
+namespace core {
+namespace cli {
+
+CommandOutputStream::CommandOutputStream(size_t capacity)
+    : CppCapacity(capacity == 0 ? 1 : capacity), CppClosed(false), CppCancelled(false) {
+}
+
+bool CommandOutputStream::write(StructuredData row) {
+    std::unique_lock<std::mutex> lock(CppStreamMutex);
+    CppNotFull.wait(lock, [this]() { return CppCancelled || CppClosed || CppRows.size() < CppCapacity; });
+    if (CppCancelled || CppClosed) {
+        return false;
+    }
+    CppRows.push_back(std::move(row));
+    lock.unlock();
+    CppNotEmpty.notify_one();
+    return true;
+}
+
+void CommandOutputStream::close() {
+    {
+        std::lock_guard<std::mutex> lock(CppStreamMutex);
+        CppClosed = true;
+    }
+    CppNotEmpty.notify_all();
+    CppNotFull.notify_all();
+}
+
+std::optional<StructuredData> CommandOutputStream::read() {
+    std::unique_lock<std::mutex> lock(CppStreamMutex);
+    CppNotEmpty.wait(lock, [this]() { return CppCancelled || CppClosed || !CppRows.empty(); });
+    if (CppCancelled || CppRows.empty()) {
+        return std::nullopt;
+    }
+    StructuredData row = std::move(CppRows.front());
+    CppRows.pop_front();
+    lock.unlock();
+    CppNotFull.notify_one();
+    return row;
+}
+
+std::optional<StructuredData> CommandOutputStream::readFor(std::chrono::milliseconds timeout, bool& finished) {
+    std::unique_lock<std::mutex> lock(CppStreamMutex);
+    bool ready = CppNotEmpty.wait_for(lock, timeout, [this]() { return CppCancelled || CppClosed || !CppRows.empty(); });
+    finished = false;
+    if (!ready) {
+        return std::nullopt;
+    }
+    if (CppCancelled || CppRows.empty()) {
+        finished = true;
+        return std::nullopt;
+    }
+    StructuredData row = std::move(CppRows.front());
+    CppRows.pop_front();
+    lock.unlock();
+    CppNotFull.notify_one();
+    return row;
+}
+
+void CommandOutputStream::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(CppStreamMutex);
+        CppCancelled = true;
+        CppRows.clear();
+    }
+    CppNotEmpty.notify_all();
+    CppNotFull.notify_all();
+}
+
+bool CommandOutputStream::isCancelled() const {
+    std::lock_guard<std::mutex> lock(CppStreamMutex);
+    return CppCancelled;
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
@@ -0,0 +1,87 @@
+#ifndef WAVE_CORE_CLI_OUTPUT_STREAM_HPP
+#define WAVE_CORE_CLI_OUTPUT_STREAM_HPP
+
+#include <any>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <string>
+#include <chrono>
+#include <vector>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Same alias as in cli_engine.hpp; rows written by commands are arbitrary structured values.
+using StructuredData = std::any;
+
+// Destination for incremental command output (one row at a time).
+// Commands reach the sink for the current invocation through CommandContext::emit().
+class IOutputSink {
+public:
+    virtual ~IOutputSink() = default;
+
+    // Delivers one row. May block while the consumer catches up (flow control).
+    // Returns false once the consumer no longer wants rows; the command should stop producing.
+    virtual bool write(StructuredData row) = 0;
+
+    // Called once per execution, before the first row, with the format requested through
+    // "--output <name>" (empty when none was given). Sinks that encode rows themselves, such as
+    // remote sessions, pick their encoder here; the default ignores it.
+    virtual void begin(const std::string& outputFormat) { (void)outputFormat; }
+};
+
+// Sink that keeps every row in memory. Used by CLIEngine::executeCommand(line) so callers of the
+// non-streaming API still receive streamed rows, as a std::vector<StructuredData> in CommandResult::data.
+class CollectingOutputSink : public IOutputSink {
+public:
+    bool write(StructuredData row) override {
+        CppRows.push_back(std::move(row));
+        return true;
+    }
+    std::vector<StructuredData>& rows() { return CppRows; }
+
+private:
+    std::vector<StructuredData> CppRows;
+};
+
+// Bounded single-producer/single-consumer row queue connecting a command running on the
+// command pool to the reader holding the CommandStreamHandle. write() blocks when the buffer
+// is full, so memory stays bounded by the capacity no matter how many rows a command produces.
+class CommandOutputStream : public IOutputSink {
+public:
+    explicit CommandOutputStream(size_t capacity);
+
+    // Producer side.
+    bool write(StructuredData row) override;
+    void close(); // No more rows will be written. Idempotent.
+
+    // Consumer side.
+    // Blocks until a row is available. Returns std::nullopt once the stream is closed and drained.
+    std::optional<StructuredData> read();
+    // Like read(), but gives up after timeout. 'finished' is set when nullopt means end of stream.
+    std::optional<StructuredData> readFor(std::chrono::milliseconds timeout, bool& finished);
+    // Reader is no longer interested: pending and future writes return false. Idempotent.
+    void cancel();
+
+    bool isCancelled() const;
+    size_t getCapacity() const { return CppCapacity; }
+
+private:
+    const size_t CppCapacity;
+    std::deque<StructuredData> CppRows;
+    bool CppClosed;
+    bool CppCancelled;
+    mutable std::mutex CppStreamMutex;
+    std::condition_variable CppNotEmpty;
+    std::condition_variable CppNotFull;
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_OUTPUT_STREAM_HPP
@@ -0,0 +1,177 @@
+#include "remote_protocol.hpp"
+
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+namespace wave {
+namespace core {
+namespace cli {
+
+std::string RemoteEndpoint::toUri() const {
+    if (kind == Kind::Unix) {
+        return "unix:" + path;
+    }
+    return "tcp://" + host + ":" + std::to_string(port);
+}
+
+bool parseRemoteUri(const std::string& uri, RemoteEndpoint& endpoint, std::string* error) {
+    auto fail = [error, &uri](const std::string& reason) {
+        if (error) {
+            *error = "Invalid listen URI '" + uri + "': " + reason;
+        }
+        return false;
+    };
+
+    if (uri.rfind("unix:", 0) == 0) {
+        std::string path = uri.substr(5);
+        if (path.rfind("//", 0) == 0) {
+            path.erase(0, 2); // unix:///run/x.sock -> /run/x.sock
+        }
+        if (path.empty()) {
+            return fail("missing socket path");
+        }
+#ifdef __linux__
+        if (path.size() >= sizeof(sockaddr_un::sun_path)) {
+            return fail("socket path is too long");
+        }
+#endif
+        endpoint = RemoteEndpoint();
+        endpoint.kind = RemoteEndpoint::Kind::Unix;
+        endpoint.path = path;
+        return true;
+    }
+
+    if (uri.rfind("tcp://", 0) == 0) {
+        std::string hostPort = uri.substr(6);
+        size_t colon = hostPort.rfind(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == hostPort.size()) {
+            return fail("expected tcp://<host>:<port>");
+        }
+        std::string host = hostPort.substr(0, colon);
+        std::string portText = hostPort.substr(colon + 1);
+        unsigned long port = 0;
+        for (char c : portText) {
+            if (c < '0' || c > '9') {
+                return fail("port is not a number");
+            }
+            port = port * 10 + static_cast<unsigned long>(c - '0');
+            if (port > 65535) {
+                return fail("port is out of range");
+            }
+        }
+        if (host == "localhost") {
+            host = "127.0.0.1";
+        }
+#ifdef __linux__
+        in_addr address;
+        if (inet_pton(AF_INET, host.c_str(), &address) != 1) {
+            return fail("host must be an IPv4 address");
+        }
+        // Sessions are not authenticated, so they must not be reachable from other machines.
+        if ((ntohl(address.s_addr) >> 24) != 127) {
+            return fail("host must be a loopback address (127.x.x.x): remote CLI sessions are not authenticated");
+        }
+#endif
+        endpoint = RemoteEndpoint();
+        endpoint.kind = RemoteEndpoint::Kind::Tcp;
+        endpoint.host = host;
+        endpoint.port = static_cast<uint16_t>(port);
+        return true;
+    }
+
+    return fail("expected unix:<path> or tcp://<host>:<port>");
+}
+
+std::string escapeRemotePayload(std::string_view payload) {
+    std::string escaped;
+    escaped.reserve(payload.size());
+    for (char c : payload) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default:   escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+std::string unescapeRemotePayload(std::string_view payload) {
+    std::string text;
+    text.reserve(payload.size());
+    for (size_t i = 0; i < payload.size(); ++i) {
+        if (payload[i] != '\\' || i + 1 == payload.size()) {
+            text += payload[i];
+            continue;
+        }
+        char next = payload[++i];
+        switch (next) {
+            case 'n': text += '\n'; break;
+            case 'r': text += '\r'; break;
+            default:  text += next; break; // "\\\\" and anything unexpected: keep the character
+        }
+    }
+    return text;
+}
+
+void appendRemoteFrame(std::string& out, char kind, std::string_view payload) {
+    out += kind;
+    out += ' ';
+    out += escapeRemotePayload(payload);
+    out += '\n';
+}
+
+int connectRemoteEndpoint(const RemoteEndpoint& endpoint, std::string* error) {
+#ifdef __linux__
+    int fd = -1;
+    int rc = -1;
+    if (endpoint.kind == RemoteEndpoint::Kind::Unix) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0) {
+            sockaddr_un address;
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, endpoint.path.c_str(), sizeof(address.sun_path) - 1);
+            rc = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        }
+    } else {
+        fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0) {
+            sockaddr_in address;
+            std::memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_port = htons(endpoint.port);
+            inet_pton(AF_INET, endpoint.host.c_str(), &address.sin_addr);
+            rc = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        }
+    }
+    if (fd < 0 || rc < 0) {
+        if (error) {
+            *error = "Cannot connect to " + endpoint.toUri() + ": " + std::strerror(errno);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    return fd;
+#else
+    (void)endpoint;
+    if (error) {
+        *error = "Remote CLI connections are only supported on Linux.";
+    }
+    return -1;
+#endif
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
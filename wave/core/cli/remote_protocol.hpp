@@ -0,0 +1,66 @@
+#ifndef WAVE_CORE_CLI_REMOTE_PROTOCOL_HPP
+#define WAVE_CORE_CLI_REMOTE_PROTOCOL_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Line protocol spoken by RemoteCLIServer and the launcher-cli client.
+//
+// The client sends one command line per '\n'-terminated line. The server answers each command with
+// zero or more frames, always finished by exactly one status frame:
+//
+//   R <row>               one streamed row (CommandContext::emit)
+//   D <data>              CommandResult::data, if any: strings verbatim, other values as compact
+//                         JSON (OutputFormatterRegistry::toText)
+//   O <bytes>             output of a command run with "--output <format>" other than text: the
+//                         bytes that format produced (json records, tsv lines with their header,
+//                         CBOR...), to be written out verbatim with no newline added. Such a command
+//                         sends its rows and data this way instead of as R and D frames.
+//   S <Status> <message>  final status: Success, Warning or Error
+//
+// Frames are single lines; '\\', '\n' and '\r' inside payloads are escaped as "\\\\", "\\n", "\\r".
+// Commands of one connection run one at a time in the order sent, so a client may pipeline lines.
+// "exit" or "quit" ends the session after its status frame.
+const char REMOTE_FRAME_ROW = 'R';
+const char REMOTE_FRAME_DATA = 'D';
+const char REMOTE_FRAME_OUTPUT = 'O';
+const char REMOTE_FRAME_STATUS = 'S';
+
+// Longest command line a server accepts; longer lines close the session with an error.
+const size_t REMOTE_MAX_LINE_LENGTH = 64 * 1024;
+
+// Parsed form of a listen_uri value: "unix:/path/to/socket" or "tcp://<loopback ipv4>:<port>".
+struct RemoteEndpoint {
+    enum class Kind { Unix, Tcp };
+    Kind kind = Kind::Unix;
+    std::string path;     // Unix socket path
+    std::string host;     // TCP loopback address 127.x.x.x ("localhost" is accepted for 127.0.0.1)
+    uint16_t port = 0;    // TCP port; 0 lets the server pick one
+
+    std::string toUri() const;
+};
+
+// Returns false (and sets *error, if given) for anything but the two supported forms, and for TCP
+// hosts outside the loopback network.
+bool parseRemoteUri(const std::string& uri, RemoteEndpoint& endpoint, std::string* error = nullptr);
+
+std::string escapeRemotePayload(std::string_view payload);
+std::string unescapeRemotePayload(std::string_view payload);
+
+// Appends "<kind> <escaped payload>\n" to out.
+void appendRemoteFrame(std::string& out, char kind, std::string_view payload);
+
+// Client helper: opens a blocking stream socket connected to endpoint.
+// Returns the file descriptor, or -1 (and sets *error) on failure.
+int connectRemoteEndpoint(const RemoteEndpoint& endpoint, std::string* error = nullptr);
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_REMOTE_PROTOCOL_HPP
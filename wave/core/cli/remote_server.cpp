@@ -0,0 +1,608 @@
+#include "remote_server.hpp"
+#include "output_formatter.hpp"
+
+#include <condition_variable>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <sstream>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+namespace wave {
+namespace core {
+namespace cli {
+
+namespace {
+// Pending output per session above which emit() blocks until the client reads.
+const size_t OUTPUT_HIGH_WATER_MARK = 1024 * 1024;
+// Pipelined command lines buffered per session before the server stops reading from it.
+const size_t MAX_PENDING_LINES = 256;
+
+void appendStatusFrame(std::string& out, const CommandResult& result) {
+    appendRemoteFrame(out, REMOTE_FRAME_STATUS, CommandResult::statusToString(result.status) + " " + result.message);
+}
+} // namespace
+
+// eventfd used to wake the IO thread. Owned jointly by the server and by every command in flight, so a
+// command finishing after stop() signals a closed (-1) descriptor instead of a dangling server.
+struct RemoteCLIServer::Wakeup {
+    std::mutex mutex;
+    int fd = -1;
+
+    void signal() {
+#ifdef __linux__
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd >= 0) {
+            uint64_t one = 1;
+            ssize_t written = ::write(fd, &one, sizeof(one));
+            (void)written; // EAGAIN only means a wakeup is already pending.
+        }
+#endif
+    }
+};
+
+// One client connection. It is also the output sink of the command it is running.
+struct RemoteCLIServer::Session : public IOutputSink {
+    int fd = -1;
+    std::shared_ptr<SessionState> state;
+    std::shared_ptr<Wakeup> wakeup;
+    const OutputFormatterRegistry* formatters = nullptr; // Renders rows as text lines, or per "--output"
+
+    // IO thread only.
+    std::string input;
+    uint32_t interest = 0; // Events currently registered with epoll
+
+    // Shared with the command running on the engine pool.
+    std::mutex mutex;
+    std::condition_variable drained;
+    std::string output;                // Encoded frames not yet written to the socket
+    std::deque<std::string> pending;   // Command lines waiting for the previous one to finish
+    bool busy = false;                 // A command of this session is executing
+    bool closeAfterFlush = false;      // "exit" or a protocol error: close once output is written
+    bool inputClosed = false;          // The client half-closed: finish its lines, then close
+    bool closed = false;
+    CancellationToken running;
+
+    // Running command only (begin, write, then its completion callback). Set for "--output <format>"
+    // other than text: rows and the final record are encoded by that formatter and sent as O frames.
+    std::unique_ptr<OutputFormatter> encoder;
+    std::ostringstream encoded;
+
+    void begin(const std::string& outputFormat) override {
+        encoder.reset();
+        if (!outputFormat.empty() && outputFormat != "text") {
+            encoder = formatters->create(outputFormat, encoded);
+        }
+    }
+
+    // Hands back what the encoder wrote since the last call.
+    std::string takeEncoded() {
+        std::string bytes = encoded.str();
+        encoded.str(std::string());
+        return bytes;
+    }
+
+    bool write(StructuredData row) override {
+        char kind = REMOTE_FRAME_ROW;
+        std::string text;
+        if (encoder) {
+            // A tsv header comes out with the first object row, so it reaches the client first.
+            encoder->write(std::move(row));
+            kind = REMOTE_FRAME_OUTPUT;
+            text = takeEncoded();
+        } else {
+            text = formatters->toText(row);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this]() { return closed || output.size() < OUTPUT_HIGH_WATER_MARK; });
+        if (closed) {
+            return false;
+        }
+        if (text.empty() && kind == REMOTE_FRAME_OUTPUT) {
+            return true;
+        }
+        // Only the first frame needs a wakeup: the IO thread flushes everything pending, and keeps
+        // EPOLLOUT armed while anything is left over.
+        bool wasEmpty = output.empty();
+        appendRemoteFrame(output, kind, text);
+        lock.unlock();
+        if (wasEmpty) {
+            wakeup->signal();
+        }
+        return true;
+    }
+};
+
+RemoteCLIServer::RemoteCLIServer(CLIEngine& engine, size_t maxSessions)
+    : CppEngine(engine), CppMaxSessions(maxSessions == 0 ? 1 : maxSessions), CppListenFd(-1), CppEpollFd(-1),
+      CppRunning(false), CppStopping(false), CppSessionCount(0), CppNextSessionId(1) {
+}
+
+RemoteCLIServer::~RemoteCLIServer() {
+    stop();
+}
+
+std::string RemoteCLIServer::getListenUri() const {
+    std::lock_guard<std::mutex> lock(CppControlMutex);
+    return CppRunning.load() ? CppEndpoint.toUri() : std::string();
+}
+
+#ifdef __linux__
+
+bool RemoteCLIServer::start(const std::string& listenUri, std::string* error) {
+    std::lock_guard<std::mutex> lock(CppControlMutex);
+    auto fail = [this, error](const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        closeListener();
+        if (CppEpollFd >= 0) {
+            ::close(CppEpollFd);
+            CppEpollFd = -1;
+        }
+        if (CppWakeup && CppWakeup->fd >= 0) {
+            ::close(CppWakeup->fd);
+        }
+        CppWakeup.reset();
+        return false;
+    };
+
+    if (CppRunning.load()) {
+        if (error) {
+            *error = "Remote CLI server is already listening on " + CppEndpoint.toUri();
+        }
+        return false;
+    }
+    if (!parseRemoteUri(listenUri, CppEndpoint, error)) {
+        return false;
+    }
+
+    if (CppEndpoint.kind == RemoteEndpoint::Kind::Unix) {
+        // Replace a socket left behind by a previous run, but never delete anything else.
+        struct stat existing;
+        if (::lstat(CppEndpoint.path.c_str(), &existing) == 0) {
+            if (!S_ISSOCK(existing.st_mode)) {
+                return fail("Cannot listen on " + CppEndpoint.path + ": path exists and is not a socket");
+            }
+            ::unlink(CppEndpoint.path.c_str());
+        }
+        CppListenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (CppListenFd < 0) {
+            return fail(std::string("socket() failed: ") + std::strerror(errno));
+        }
+        // Bound inside a fresh 0700 directory, restricted to 0600, then moved into place: the socket
+        // is never reachable with the umask's permissions, as it would be between bind() and chmod().
+        std::string stagingDir = CppEndpoint.path + ".XXXXXX";
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (stagingDir.size() + 2 >= sizeof(address.sun_path)) {
+            return fail("Cannot listen on " + CppEndpoint.path + ": socket path is too long");
+        }
+        if (!::mkdtemp(&stagingDir[0])) {
+            return fail("Cannot create a directory next to " + CppEndpoint.path + ": " + std::strerror(errno));
+        }
+        std::string stagedPath = stagingDir + "/s";
+        std::strncpy(address.sun_path, stagedPath.c_str(), sizeof(address.sun_path) - 1);
+        int stageErrno = 0;
+        std::string stageStep;
+        if (::bind(CppListenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            stageErrno = errno;
+            stageStep = "Cannot bind ";
+        } else if (::chmod(stagedPath.c_str(), 0600) < 0 ||
+                   ::rename(stagedPath.c_str(), CppEndpoint.path.c_str()) < 0) {
+            stageErrno = errno;
+            stageStep = "Cannot move the socket to ";
+            ::unlink(stagedPath.c_str());
+        }
+        ::rmdir(stagingDir.c_str());
+        if (stageErrno != 0) {
+            ::close(CppListenFd);
+            CppListenFd = -1; // Nothing was created at the path; closeListener must not unlink it.
+            return fail(stageStep + CppEndpoint.toUri() + ": " + std::strerror(stageErrno));
+        }
+    } else {
+        CppListenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (CppListenFd < 0) {
+            return fail(std::string("socket() failed: ") + std::strerror(errno));
+        }
+        int reuse = 1;
+        ::setsockopt(CppListenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(CppEndpoint.port);
+        inet_pton(AF_INET, CppEndpoint.host.c_str(), &address.sin_addr);
+        if (::bind(CppListenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            return fail("Cannot bind " + CppEndpoint.toUri() + ": " + std::strerror(errno));
+        }
+        socklen_t length = sizeof(address);
+        if (::getsockname(CppListenFd, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+            CppEndpoint.port = ntohs(address.sin_port); // Resolve port 0
+        }
+    }
+
+    if (::listen(CppListenFd, SOMAXCONN) < 0) {
+        return fail("listen() failed: " + std::string(std::strerror(errno)));
+    }
+
+    CppEpollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    CppWakeup = std::make_shared<Wakeup>();
+    CppWakeup->fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (CppEpollFd < 0 || CppWakeup->fd < 0) {
+        return fail("Cannot create epoll/eventfd descriptors: " + std::string(std::strerror(errno)));
+    }
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = CppListenFd;
+    ::epoll_ctl(CppEpollFd, EPOLL_CTL_ADD, CppListenFd, &event);
+    event.data.fd = CppWakeup->fd;
+    ::epoll_ctl(CppEpollFd, EPOLL_CTL_ADD, CppWakeup->fd, &event);
+
+    CppStopping.store(false);
+    CppRunning.store(true, std::memory_order_release);
+    CppIoThread = std::thread(&RemoteCLIServer::ioLoop, this);
+    return true;
+}
+
+void RemoteCLIServer::stop() {
+    std::lock_guard<std::mutex> lock(CppControlMutex);
+    if (!CppRunning.load()) {
+        return;
+    }
+    CppStopping.store(true);
+    CppWakeup->signal();
+    if (CppIoThread.joinable()) {
+        CppIoThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> wakeupLock(CppWakeup->mutex);
+        ::close(CppWakeup->fd);
+        CppWakeup->fd = -1;
+    }
+    CppWakeup.reset();
+    ::close(CppEpollFd);
+    CppEpollFd = -1;
+    closeListener();
+    CppRunning.store(false, std::memory_order_release);
+}
+
+void RemoteCLIServer::closeListener() {
+    if (CppListenFd < 0) {
+        return;
+    }
+    ::close(CppListenFd);
+    CppListenFd = -1;
+    if (CppEndpoint.kind == RemoteEndpoint::Kind::Unix) {
+        ::unlink(CppEndpoint.path.c_str());
+    }
+}
+
+void RemoteCLIServer::ioLoop() {
+    std::vector<epoll_event> events(64);
+    while (!CppStopping.load()) {
+        int count = ::epoll_wait(CppEpollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        bool woken = false;
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == CppListenFd) {
+                acceptSessions();
+                continue;
+            }
+            if (fd == CppWakeup->fd) {
+                uint64_t value;
+                ssize_t readBytes = ::read(fd, &value, sizeof(value));
+                (void)readBytes;
+                woken = true;
+                continue;
+            }
+            auto it = CppSessions.find(fd);
+            if (it == CppSessions.end()) {
+                continue; // Closed earlier in this batch
+            }
+            std::shared_ptr<Session> session = it->second;
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                closeSession(session); // Gone both ways (a half-close only reads as EOF)
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                readSession(session);
+            }
+            if (events[i].events & EPOLLOUT) {
+                flushSession(session);
+            }
+        }
+
+        if (woken) {
+            // Completions and rows from the command pool: write what they produced and start the
+            // next pipelined command. Iterate over a copy, closing a session erases it from the map.
+            std::vector<std::shared_ptr<Session>> sessions;
+            sessions.reserve(CppSessions.size());
+            for (const auto& entry : CppSessions) {
+                sessions.push_back(entry.second);
+            }
+            for (const auto& session : sessions) {
+                dispatchNext(session);
+                flushSession(session);
+            }
+        }
+    }
+
+    while (!CppSessions.empty()) {
+        closeSession(CppSessions.begin()->second);
+    }
+}
+
+void RemoteCLIServer::acceptSessions() {
+    while (true) {
+        int fd = ::accept4(CppListenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return; // EAGAIN, or a resource error (EMFILE...) that retrying now would not fix
+        }
+
+        if (CppSessions.size() >= CppMaxSessions) {
+            std::string rejection;
+            appendRemoteFrame(rejection, REMOTE_FRAME_STATUS, "Error Too many remote CLI sessions.");
+            ssize_t sent = ::send(fd, rejection.data(), rejection.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            (void)sent;
+            ::close(fd);
+            continue;
+        }
+
+        auto session = std::make_shared<Session>();
+        session->fd = fd;
+        session->wakeup = CppWakeup;
+        session->formatters = &CppEngine.getOutputFormatters();
+        session->state = std::make_shared<SessionState>();
+        session->state->id = CppNextSessionId++;
+        session->state->origin = CppEndpoint.toUri();
+        session->interest = EPOLLIN;
+
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = session->interest;
+        event.data.fd = fd;
+        if (::epoll_ctl(CppEpollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        CppSessions[fd] = session;
+        CppSessionCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RemoteCLIServer::readSession(const std::shared_ptr<Session>& session) {
+    char buffer[16 * 1024];
+    bool endOfInput = false;
+    while (true) {
+        ssize_t received = ::recv(session->fd, buffer, sizeof(buffer), 0);
+        if (received == 0) {
+            // The client is done sending but may still be reading: its lines run, and the session
+            // closes once their output is written (see flushSession).
+            endOfInput = true;
+            break;
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            closeSession(session);
+            return;
+        }
+        session->input.append(buffer, static_cast<size_t>(received));
+        if (static_cast<size_t>(received) < sizeof(buffer)) {
+            break;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(session->mutex);
+    size_t start = 0;
+    size_t newline;
+    while (!session->closeAfterFlush && (newline = session->input.find('\n', start)) != std::string::npos) {
+        std::string line = session->input.substr(start, newline - start);
+        start = newline + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.find_first_not_of(" \t") != std::string::npos) {
+            session->pending.push_back(std::move(line));
+        }
+    }
+    session->input.erase(0, start);
+    if (endOfInput) {
+        session->inputClosed = true;
+        // A last line without its newline still counts.
+        if (!session->closeAfterFlush && session->input.size() <= REMOTE_MAX_LINE_LENGTH &&
+            session->input.find_first_not_of(" \t\r") != std::string::npos) {
+            if (session->input.back() == '\r') {
+                session->input.pop_back();
+            }
+            session->pending.push_back(std::move(session->input));
+            session->input.clear();
+        }
+    }
+    if (session->input.size() > REMOTE_MAX_LINE_LENGTH && !session->closeAfterFlush) {
+        appendRemoteFrame(session->output, REMOTE_FRAME_STATUS, "Error Command line too long.");
+        session->closeAfterFlush = true;
+    }
+    if (session->closeAfterFlush) {
+        session->input.clear();
+    }
+    lock.unlock();
+
+    dispatchNext(session);
+    flushSession(session);
+}
+
+void RemoteCLIServer::dispatchNext(const std::shared_ptr<Session>& session) {
+    std::string line;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->busy || session->closed || session->closeAfterFlush || session->pending.empty()) {
+            return;
+        }
+        line = std::move(session->pending.front());
+        session->pending.pop_front();
+
+        if (line == "exit" || line == "quit") {
+            appendRemoteFrame(session->output, REMOTE_FRAME_STATUS, "Success Session closed.");
+            session->closeAfterFlush = true;
+            session->pending.clear();
+            return;
+        }
+        session->busy = true;
+        session->running = CancellationToken();
+    }
+
+    CommandContext context;
+    context.cancellation = session->running;
+    context.session = session->state;
+    context.output = session.get();
+    // The callback may run right here (resolution errors) or on a pool worker; either way it only
+    // queues output and wakes the IO thread, which then dispatches the next pipelined line.
+    CppEngine.executeCommandAsync(line, std::move(context), [session](const CommandResult& result) {
+        // Encoded before busy is cleared: the encoder belongs to this command until then.
+        std::string encoded;
+        bool formatted = session->encoder != nullptr;
+        if (formatted) {
+            session->encoder->finish(result);
+            encoded = session->takeEncoded();
+            session->encoder.reset();
+        }
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->busy = false;
+            if (session->closed) {
+                return;
+            }
+            if (formatted) {
+                if (!encoded.empty()) {
+                    appendRemoteFrame(session->output, REMOTE_FRAME_OUTPUT, encoded);
+                }
+            } else if (result.data.has_value()) {
+                // Rendered like the interactive session's "Data:" line.
+                appendRemoteFrame(session->output, REMOTE_FRAME_DATA, session->formatters->toText(*result.data));
+            }
+            appendStatusFrame(session->output, result);
+        }
+        session->wakeup->signal();
+    });
+}
+
+void RemoteCLIServer::flushSession(const std::shared_ptr<Session>& session) {
+    bool failed = false;
+    bool finished = false;
+    uint32_t interest = 0;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->closed) {
+            return;
+        }
+        size_t written = 0;
+        while (written < session->output.size()) {
+            ssize_t sent = ::send(session->fd, session->output.data() + written, session->output.size() - written,
+                                  MSG_NOSIGNAL);
+            if (sent > 0) {
+                written += static_cast<size_t>(sent);
+            } else if (sent < 0 && errno == EINTR) {
+                continue;
+            } else {
+                failed = sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK;
+                break;
+            }
+        }
+        session->output.erase(0, written);
+        session->drained.notify_all();
+
+        finished = (session->closeAfterFlush || (session->inputClosed && session->pending.empty())) &&
+                   session->output.empty() && !session->busy;
+        if (!session->closeAfterFlush && !session->inputClosed && session->pending.size() < MAX_PENDING_LINES) {
+            interest |= EPOLLIN;
+        }
+        if (!session->output.empty()) {
+            interest |= EPOLLOUT;
+        }
+    }
+
+    if (failed || finished) {
+        closeSession(session);
+        return;
+    }
+    if (interest != session->interest) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = interest;
+        event.data.fd = session->fd;
+        ::epoll_ctl(CppEpollFd, EPOLL_CTL_MOD, session->fd, &event);
+        session->interest = interest;
+    }
+}
+
+void RemoteCLIServer::closeSession(const std::shared_ptr<Session>& session) {
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->closed) {
+            return;
+        }
+        session->closed = true;
+        session->running.cancel();
+        session->pending.clear();
+        session->output.clear();
+    }
+    session->drained.notify_all(); // Unblocks a command waiting in write(); it sees 'closed'.
+    ::epoll_ctl(CppEpollFd, EPOLL_CTL_DEL, session->fd, nullptr);
+    ::close(session->fd);
+    CppSessions.erase(session->fd);
+    CppSessionCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+#else // !__linux__
+
+bool RemoteCLIServer::start(const std::string& listenUri, std::string* error) {
+    (void)listenUri;
+    if (error) {
+        *error = "The remote CLI server is only supported on Linux.";
+    }
+    return false;
+}
+
+void RemoteCLIServer::stop() {}
+void RemoteCLIServer::ioLoop() {}
+void RemoteCLIServer::acceptSessions() {}
+void RemoteCLIServer::readSession(const std::shared_ptr<Session>&) {}
+void RemoteCLIServer::flushSession(const std::shared_ptr<Session>&) {}
+void RemoteCLIServer::dispatchNext(const std::shared_ptr<Session>&) {}
+void RemoteCLIServer::closeSession(const std::shared_ptr<Session>&) {}
+void RemoteCLIServer::closeListener() {}
+
+#endif // __linux__
+
+} // namespace cli
+} // namespace core
+} // namespace wave
@@ -0,0 +1,85 @@
+#ifndef WAVE_CORE_CLI_REMOTE_SERVER_HPP
+#define WAVE_CORE_CLI_REMOTE_SERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "cli_engine.hpp"
+#include "remote_protocol.hpp"
+
+namespace wave {
+namespace core {
+namespace cli {
+
+// Serves CLIEngine to other processes over a local socket (see remote_protocol.hpp for the wire format).
+//
+// A single IO thread multiplexes the listening socket and every session with epoll; commands run on
+// the engine's async pool, so a slow command never stalls other sessions. Each connection gets its own
+// SessionState, executes its commands one at a time in order, and receives rows as they are emitted:
+// as text frames by default, or encoded by the formatter a command selects with "--output <format>".
+// A session whose client reads slowly blocks its command's emit() once ~1 MiB of output is pending,
+// and a disconnect cancels the command in flight. A client that only half-closes (shuts down its
+// sending side) still gets the replies to the lines it sent; the session closes after the last one.
+//
+// Unix sockets are created with mode 0600. TCP has no authentication, so only loopback addresses
+// are accepted.
+// Only available on Linux; start() fails elsewhere.
+class RemoteCLIServer {
+public:
+    explicit RemoteCLIServer(CLIEngine& engine, size_t maxSessions = 64);
+    ~RemoteCLIServer(); // Calls stop().
+
+    RemoteCLIServer(const RemoteCLIServer&) = delete;
+    RemoteCLIServer& operator=(const RemoteCLIServer&) = delete;
+
+    // Binds listenUri ("unix:/path" or "tcp://127.0.0.1:port") and starts the IO thread.
+    // A stale Unix socket file at the path is replaced. Returns false and sets *error on failure.
+    bool start(const std::string& listenUri, std::string* error = nullptr);
+
+    // Closes the listener and all sessions (cancelling their running commands) and joins the IO
+    // thread. Commands that ignore cancellation finish on the engine pool; their output is dropped.
+    void stop();
+
+    bool isRunning() const { return CppRunning.load(std::memory_order_acquire); }
+    // Bound address; for "tcp://...:0" this carries the port actually chosen.
+    std::string getListenUri() const;
+    size_t getSessionCount() const { return CppSessionCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Wakeup;
+    struct Session;
+
+    CLIEngine& CppEngine;
+    size_t CppMaxSessions;
+    RemoteEndpoint CppEndpoint;
+    int CppListenFd;
+    int CppEpollFd;
+    std::shared_ptr<Wakeup> CppWakeup; // Shared with in-flight commands, which may outlive the server
+    std::thread CppIoThread;
+    std::atomic<bool> CppRunning;
+    std::atomic<bool> CppStopping;
+    std::atomic<size_t> CppSessionCount;
+    uint64_t CppNextSessionId;
+    std::map<int, std::shared_ptr<Session>> CppSessions; // Owned by the IO thread
+    mutable std::mutex CppControlMutex;                  // Serializes start()/stop()
+
+    void ioLoop();
+    void acceptSessions();
+    void readSession(const std::shared_ptr<Session>& session);
+    void flushSession(const std::shared_ptr<Session>& session);
+    void dispatchNext(const std::shared_ptr<Session>& session);
+    void closeSession(const std::shared_ptr<Session>& session);
+    void closeListener();
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_REMOTE_SERVER_HPP
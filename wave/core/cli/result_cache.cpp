@@ -0,0 +1,114 @@
+#include "result_cache.hpp"
+
+#include <algorithm>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+ResultCache::ResultCache(size_t maxEntries, size_t maxRowsPerEntry)
+    : CppMaxEntries(maxEntries == 0 ? 1 : maxEntries), CppMaxRowsPerEntry(maxRowsPerEntry) {
+}
+
+std::shared_ptr<const ResultCache::Entry> ResultCache::lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    auto it = CppEntries.find(key);
+    if (it == CppEntries.end()) {
+        ++CppStats.misses;
+        return nullptr;
+    }
+    if (it->second.expires && *it->second.expires <= Clock::now()) {
+        CppEntries.erase(it);
+        ++CppStats.misses;
+        return nullptr;
+    }
+    ++CppStats.hits;
+    return it->second.entry;
+}
+
+ResultCache::Ticket ResultCache::begin(const CachePolicy& policy) {
+    Ticket ticket;
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ticket.epoch = CppEpoch;
+    ticket.generations.reserve(policy.invalidatedBy.size());
+    for (const std::string& topic : policy.invalidatedBy) {
+        auto it = CppTopicGenerations.find(topic);
+        ticket.generations.push_back(it == CppTopicGenerations.end() ? 0 : it->second);
+    }
+    return ticket;
+}
+
+void ResultCache::store(const std::string& key, const CachePolicy& policy, const Ticket& ticket, Entry entry) {
+    if (entry.rows.size() > CppMaxRowsPerEntry || !policy.isCacheable()) {
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (ticket.epoch != CppEpoch) {
+        return;
+    }
+    for (size_t i = 0; i < policy.invalidatedBy.size() && i < ticket.generations.size(); ++i) {
+        auto it = CppTopicGenerations.find(policy.invalidatedBy[i]);
+        if ((it == CppTopicGenerations.end() ? 0 : it->second) != ticket.generations[i]) {
+            return; // Invalidated while the command ran: the result may already be stale
+        }
+    }
+
+    if (CppEntries.find(key) == CppEntries.end() && CppEntries.size() >= CppMaxEntries) {
+        evictOne(now);
+    }
+    Stored& stored = CppEntries[key];
+    stored.entry = std::make_shared<const Entry>(std::move(entry));
+    stored.expires = policy.ttl.count() > 0 ? std::optional<Clock::time_point>(now + policy.ttl) : std::nullopt;
+    stored.topics = policy.invalidatedBy;
+    stored.sequence = CppNextSequence++;
+    ++CppStats.stores;
+}
+
+void ResultCache::evictOne(Clock::time_point now) {
+    auto oldest = CppEntries.end();
+    for (auto it = CppEntries.begin(); it != CppEntries.end(); ++it) {
+        if (it->second.expires && *it->second.expires <= now) {
+            CppEntries.erase(it);
+            return;
+        }
+        if (oldest == CppEntries.end() || it->second.sequence < oldest->second.sequence) {
+            oldest = it;
+        }
+    }
+    if (oldest != CppEntries.end()) {
+        CppEntries.erase(oldest);
+    }
+}
+
+void ResultCache::invalidate(const std::string& topic) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ++CppTopicGenerations[topic];
+    for (auto it = CppEntries.begin(); it != CppEntries.end();) {
+        const std::vector<std::string>& topics = it->second.topics;
+        if (std::find(topics.begin(), topics.end(), topic) != topics.end()) {
+            it = CppEntries.erase(it);
+            ++CppStats.invalidations;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppStats.invalidations += CppEntries.size();
+    CppEntries.clear();
+    ++CppEpoch;
+}
+
+ResultCache::Stats ResultCache::getStats() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    Stats stats = CppStats;
+    stats.entries = CppEntries.size();
+    return stats;
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
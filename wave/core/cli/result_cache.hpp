@@ -0,0 +1,102 @@
+#ifndef WAVE_CORE_CLI_RESULT_CACHE_HPP
+#define WAVE_CORE_CLI_RESULT_CACHE_HPP
+
+#include <any>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+struct CommandResult;
+
+// How long results of a read-only command may be reused (see ICommand::getCachePolicy()).
+// A command is cacheable if it has a TTL, an invalidation topic, or both; whichever comes first
+// ends the cached result.
+struct CachePolicy {
+    std::chrono::milliseconds ttl{0};       // 0 = no time limit
+    std::vector<std::string> invalidatedBy; // Event topics that drop cached results, e.g. "module.loaded"
+
+    bool isCacheable() const { return ttl.count() > 0 || !invalidatedBy.empty(); }
+};
+
+// Cached results of cacheable commands, keyed by command name, arguments and options.
+//
+// An entry holds the final CommandResult plus the rows the command emitted, so a hit can replay
+// both. Entries expire by TTL or are dropped by invalidate(topic). An execution that overlapped
+// an invalidation of one of its topics is not stored: begin() records the topic generations
+// before the command runs, and store() discards the result if any of them moved since.
+// All methods are thread-safe.
+class ResultCache {
+public:
+    struct Entry {
+        std::shared_ptr<const CommandResult> result;
+        std::vector<std::any> rows;
+    };
+
+    // Topic generations observed before an execution; pass it back to store().
+    struct Ticket {
+        uint64_t epoch = 0; // Bumped by clear()
+        std::vector<uint64_t> generations;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t invalidations = 0; // Entries dropped by topic events or clear()
+        size_t entries = 0;
+    };
+
+    explicit ResultCache(size_t maxEntries = 256, size_t maxRowsPerEntry = 10000);
+
+    // The live entry for key, or nullptr (expired entries are dropped on the way).
+    std::shared_ptr<const Entry> lookup(const std::string& key);
+    Ticket begin(const CachePolicy& policy);
+    // Stores an entry unless the ticket is stale or rows exceed the per-entry limit. When the
+    // cache is full, expired entries are dropped first, then the oldest one.
+    void store(const std::string& key, const CachePolicy& policy, const Ticket& ticket, Entry entry);
+
+    // Drops every entry depending on topic and makes in-flight executions depending on it skip
+    // their store().
+    void invalidate(const std::string& topic);
+    // Drops everything, including the results of executions in flight.
+    void clear();
+
+    size_t getMaxRowsPerEntry() const { return CppMaxRowsPerEntry; }
+    Stats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stored {
+        std::shared_ptr<const Entry> entry;
+        std::optional<Clock::time_point> expires;
+        std::vector<std::string> topics;
+        uint64_t sequence; // Insertion order, for eviction
+    };
+
+    const size_t CppMaxEntries;
+    const size_t CppMaxRowsPerEntry;
+    mutable std::mutex CppMutex;
+    std::map<std::string, Stored> CppEntries;
+    std::map<std::string, uint64_t> CppTopicGenerations;
+    uint64_t CppEpoch = 0;
+    uint64_t CppNextSequence = 0;
+    Stats CppStats;
+
+    void evictOne(Clock::time_point now);
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_RESULT_CACHE_HPP
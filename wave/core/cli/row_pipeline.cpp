@@ -0,0 +1,310 @@
+#include "row_pipeline.hpp"
+#include "output_formatter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <mutex>
+
+namespace wave {
+namespace core {
+namespace cli {
+
+namespace {
+// Text a row is matched and compared by: the whole row, or one member of a map row.
+std::string rowKey(const StructuredData& row, const std::string& field, const OutputFormatterRegistry& formatters) {
+    if (field.empty()) {
+        return formatters.toText(row);
+    }
+    if (row.type() == typeid(std::map<std::string, StructuredData>)) {
+        const auto& members = std::any_cast<const std::map<std::string, StructuredData>&>(row);
+        auto it = members.find(field);
+        return it == members.end() ? std::string() : formatters.toText(it->second);
+    }
+    if (row.type() == typeid(std::map<std::string, std::string>)) {
+        const auto& members = std::any_cast<const std::map<std::string, std::string>&>(row);
+        auto it = members.find(field);
+        return it == members.end() ? std::string() : it->second;
+    }
+    return std::string(); // Not a record: the field is missing
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+class GrepFilter : public RowFilter {
+public:
+    GrepFilter(std::string pattern, bool ignoreCase, bool invert, std::string field,
+               const OutputFormatterRegistry& formatters)
+        : CppPattern(ignoreCase ? toLower(std::move(pattern)) : std::move(pattern)), CppIgnoreCase(ignoreCase),
+          CppInvert(invert), CppField(std::move(field)), CppFormatters(formatters) {}
+
+    bool write(StructuredData row) override {
+        std::string text = rowKey(row, CppField, CppFormatters);
+        if (CppIgnoreCase) {
+            text = toLower(std::move(text));
+        }
+        bool matches = text.find(CppPattern) != std::string::npos;
+        if (matches == CppInvert) {
+            return true; // Dropped; keep the input coming
+        }
+        return forward(std::move(row));
+    }
+
+private:
+    std::string CppPattern;
+    bool CppIgnoreCase;
+    bool CppInvert;
+    std::string CppField;
+    const OutputFormatterRegistry& CppFormatters;
+};
+
+class HeadFilter : public RowFilter {
+public:
+    explicit HeadFilter(size_t limit) : CppRemaining(limit) {}
+
+    bool write(StructuredData row) override {
+        if (CppRemaining == 0) {
+            return false;
+        }
+        --CppRemaining;
+        // Returning false with the last row lets the command stop right away instead of
+        // producing one more row just to be told.
+        return forward(std::move(row)) && CppRemaining > 0;
+    }
+
+private:
+    size_t CppRemaining;
+};
+
+class SortFilter : public RowFilter {
+public:
+    SortFilter(bool reverse, bool numeric, std::string field, const OutputFormatterRegistry& formatters)
+        : CppReverse(reverse), CppNumeric(numeric), CppField(std::move(field)), CppFormatters(formatters) {}
+
+    bool write(StructuredData row) override {
+        Entry entry;
+        entry.key = rowKey(row, CppField, CppFormatters);
+        if (CppNumeric) {
+            char* end = nullptr;
+            entry.number = std::strtod(entry.key.c_str(), &end);
+            entry.isNumber = end != entry.key.c_str();
+        }
+        entry.row = std::move(row);
+        CppRows.push_back(std::move(entry));
+        return true;
+    }
+
+    void finish() override {
+        auto less = [this](const Entry& a, const Entry& b) {
+            if (CppNumeric && a.isNumber != b.isNumber) {
+                return !a.isNumber; // Non-numeric keys first, like sort -n
+            }
+            if (CppNumeric && a.isNumber && a.number != b.number) {
+                return a.number < b.number;
+            }
+            return a.key < b.key;
+        };
+        if (CppReverse) {
+            std::stable_sort(CppRows.begin(), CppRows.end(), [&less](const Entry& a, const Entry& b) { return less(b, a); });
+        } else {
+            std::stable_sort(CppRows.begin(), CppRows.end(), less);
+        }
+        for (Entry& entry : CppRows) {
+            if (!forward(std::move(entry.row))) {
+                break;
+            }
+        }
+        CppRows.clear();
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        double number = 0;
+        bool isNumber = false;
+        StructuredData row;
+    };
+    bool CppReverse;
+    bool CppNumeric;
+    std::string CppField;
+    const OutputFormatterRegistry& CppFormatters;
+    std::vector<Entry> CppRows;
+};
+
+class CountFilter : public RowFilter {
+public:
+    bool write(StructuredData) override {
+        ++CppCount;
+        return true;
+    }
+
+    void finish() override { forward(StructuredData(CppCount)); }
+
+private:
+    size_t CppCount = 0;
+};
+
+class UniqFilter : public RowFilter {
+public:
+    UniqFilter(std::string field, const OutputFormatterRegistry& formatters)
+        : CppField(std::move(field)), CppFormatters(formatters) {}
+
+    bool write(StructuredData row) override {
+        std::string key = rowKey(row, CppField, CppFormatters);
+        if (CppHasPrevious && key == CppPrevious) {
+            return true;
+        }
+        CppPrevious = std::move(key);
+        CppHasPrevious = true;
+        return forward(std::move(row));
+    }
+
+private:
+    std::string CppField;
+    const OutputFormatterRegistry& CppFormatters;
+    std::string CppPrevious;
+    bool CppHasPrevious = false;
+};
+
+bool expectArguments(const std::vector<std::string>& args, size_t max, const char* usage, std::string& error) {
+    if (args.size() > max) {
+        error = std::string("usage: ") + usage;
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+void RowPipeline::append(std::unique_ptr<RowFilter> filter) {
+    CppFilters.push_back(std::move(filter));
+}
+
+IOutputSink* RowPipeline::connect(IOutputSink* sink) {
+    IOutputSink* downstream = sink;
+    for (auto it = CppFilters.rbegin(); it != CppFilters.rend(); ++it) {
+        (*it)->setDownstream(downstream);
+        downstream = it->get();
+    }
+    return downstream;
+}
+
+void RowPipeline::finish() {
+    // Upstream first: a filter's finish() may write rows into the filters after it.
+    for (auto& filter : CppFilters) {
+        filter->finish();
+    }
+}
+
+PipelineOperatorRegistry::PipelineOperatorRegistry() {
+    using Type = OptionSpec::Type;
+
+    PipelineOperator grep;
+    grep.help = "grep [--ignore-case] [--invert] [--field <name>] <text> - keeps rows containing <text>.";
+    grep.options = {OptionSpec("ignore-case", Type::Flag, "Case-insensitive match"),
+                    OptionSpec("invert", Type::Flag, "Keep rows that do not match"),
+                    OptionSpec("field", Type::String, "Match this member of record rows")};
+    grep.create = [](const std::vector<std::string>& args, const ParsedOptions& options,
+                     const OutputFormatterRegistry& formatters, std::string& error) -> std::unique_ptr<RowFilter> {
+        if (args.size() != 1) {
+            error = "usage: grep [--ignore-case] [--invert] [--field <name>] <text>";
+            return nullptr;
+        }
+        return std::make_unique<GrepFilter>(args[0], options.getFlag("ignore-case"), options.getFlag("invert"),
+                                            options.getString("field").value_or(""), formatters);
+    };
+    CppOperators["grep"] = std::make_shared<const PipelineOperator>(std::move(grep));
+
+    PipelineOperator head;
+    head.help = "head [<n>] - passes the first n rows (default 10) and stops the command.";
+    head.create = [](const std::vector<std::string>& args, const ParsedOptions&, const OutputFormatterRegistry&,
+                     std::string& error) -> std::unique_ptr<RowFilter> {
+        if (!expectArguments(args, 1, "head [<n>]", error)) {
+            return nullptr;
+        }
+        size_t limit = 10;
+        if (!args.empty()) {
+            const std::string& text = args[0];
+            if (text.empty() || text.size() > 18 || text.find_first_not_of("0123456789") != std::string::npos) {
+                error = "invalid row count: " + text;
+                return nullptr;
+            }
+            limit = static_cast<size_t>(std::stoull(text));
+        }
+        return std::make_unique<HeadFilter>(limit);
+    };
+    CppOperators["head"] = std::make_shared<const PipelineOperator>(std::move(head));
+
+    PipelineOperator sort;
+    sort.help = "sort [--reverse] [--numeric] [--field <name>] - orders the rows.";
+    sort.options = {OptionSpec("reverse", Type::Flag, "Descending order"),
+                    OptionSpec("numeric", Type::Flag, "Compare keys as numbers"),
+                    OptionSpec("field", Type::String, "Sort record rows by this member")};
+    sort.create = [](const std::vector<std::string>& args, const ParsedOptions& options,
+                     const OutputFormatterRegistry& formatters, std::string& error) -> std::unique_ptr<RowFilter> {
+        if (!expectArguments(args, 0, "sort [--reverse] [--numeric] [--field <name>]", error)) {
+            return nullptr;
+        }
+        return std::make_unique<SortFilter>(options.getFlag("reverse"), options.getFlag("numeric"),
+                                            options.getString("field").value_or(""), formatters);
+    };
+    CppOperators["sort"] = std::make_shared<const PipelineOperator>(std::move(sort));
+
+    PipelineOperator count;
+    count.help = "count - replaces the rows by their number.";
+    count.create = [](const std::vector<std::string>& args, const ParsedOptions&, const OutputFormatterRegistry&,
+                      std::string& error) -> std::unique_ptr<RowFilter> {
+        if (!expectArguments(args, 0, "count", error)) {
+            return nullptr;
+        }
+        return std::make_unique<CountFilter>();
+    };
+    CppOperators["count"] = std::make_shared<const PipelineOperator>(std::move(count));
+
+    PipelineOperator uniq;
+    uniq.help = "uniq [--field <name>] - drops rows equal to the row before them.";
+    uniq.options = {OptionSpec("field", Type::String, "Compare record rows by this member")};
+    uniq.create = [](const std::vector<std::string>& args, const ParsedOptions& options,
+                     const OutputFormatterRegistry& formatters, std::string& error) -> std::unique_ptr<RowFilter> {
+        if (!expectArguments(args, 0, "uniq [--field <name>]", error)) {
+            return nullptr;
+        }
+        return std::make_unique<UniqFilter>(options.getString("field").value_or(""), formatters);
+    };
+    CppOperators["uniq"] = std::make_shared<const PipelineOperator>(std::move(uniq));
+}
+
+bool PipelineOperatorRegistry::registerOperator(const std::string& name, PipelineOperator op) {
+    if (name.empty() || !op.create) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(CppMutex);
+    return CppOperators.emplace(name, std::make_shared<const PipelineOperator>(std::move(op))).second;
+}
+
+bool PipelineOperatorRegistry::unregisterOperator(const std::string& name) {
+    std::unique_lock<std::shared_mutex> lock(CppMutex);
+    return CppOperators.erase(name) != 0;
+}
+
+std::shared_ptr<const PipelineOperator> PipelineOperatorRegistry::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(CppMutex);
+    auto it = CppOperators.find(name);
+    return it == CppOperators.end() ? nullptr : it->second;
+}
+
+std::vector<std::string> PipelineOperatorRegistry::getOperatorNames() const {
+    std::shared_lock<std::shared_mutex> lock(CppMutex);
+    std::vector<std::string> names;
+    for (const auto& entry : CppOperators) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+} // namespace cli
+} // namespace core
+} // namespace wave
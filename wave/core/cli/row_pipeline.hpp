@@ -0,0 +1,101 @@
+#ifndef WAVE_CORE_CLI_ROW_PIPELINE_HPP
+#define WAVE_CORE_CLI_ROW_PIPELINE_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "input_parser.hpp"
+#include "output_stream.hpp"
+
+namespace wave {
+namespace core {
+namespace cli {
+
+class OutputFormatterRegistry;
+
+// One downstream stage of a command pipeline ("log tail | grep Loader | head 20").
+//
+// Rows flow by push: the command's emit() calls write() on the first filter, which passes rows
+// on to the next stage on the same thread. Nothing is materialized between stages, and a stage
+// that wants no more rows (head) returns false from write(), which the command sees as the return
+// value of emit() and stops producing. Filters that need the whole input (sort, count) buffer in
+// write() and produce their output in finish().
+class RowFilter : public IOutputSink {
+public:
+    // Called once after the command returned: flush buffered rows downstream.
+    virtual void finish() {}
+
+    void setDownstream(IOutputSink* downstream) { CppDownstream = downstream; }
+
+protected:
+    bool forward(StructuredData row) { return CppDownstream->write(std::move(row)); }
+
+private:
+    IOutputSink* CppDownstream = nullptr;
+};
+
+// A named operator usable after '|'. create() builds the filter for one execution from the
+// stage's positional arguments and declared options; on bad arguments it returns nullptr and
+// describes the problem in error.
+struct PipelineOperator {
+    using Factory = std::function<std::unique_ptr<RowFilter>(const std::vector<std::string>& args,
+                                                             const ParsedOptions& options,
+                                                             const OutputFormatterRegistry& formatters,
+                                                             std::string& error)>;
+
+    std::string help;
+    std::vector<OptionSpec> options;
+    Factory create;
+};
+
+// The filters of one execution, in pipeline order.
+class RowPipeline {
+public:
+    bool empty() const { return CppFilters.empty(); }
+    size_t size() const { return CppFilters.size(); }
+    void append(std::unique_ptr<RowFilter> filter);
+
+    // Chains the filters in front of sink and returns the sink the command should write to
+    // (sink itself for an empty pipeline).
+    IOutputSink* connect(IOutputSink* sink);
+    // End of the command's output: finishes every filter, upstream first.
+    void finish();
+
+private:
+    std::vector<std::unique_ptr<RowFilter>> CppFilters;
+};
+
+// Pipeline operators by name. Built-in:
+//   grep [--ignore-case] [--invert] [--field <name>] <text>   rows whose text contains <text>
+//   head [<n>]                                                the first n rows (default 10)
+//   sort [--reverse] [--numeric] [--field <name>]             rows ordered by text or by a field
+//   count                                                     one row: the number of input rows
+//   uniq [--field <name>]                                     drops adjacent duplicate rows
+// A row's text is its text-format rendering (OutputFormatterRegistry::toText). With --field, rows
+// that are maps (std::map<std::string, StructuredData> or <std::string, std::string>) are compared
+// by that member instead. All methods are thread-safe.
+class PipelineOperatorRegistry {
+public:
+    PipelineOperatorRegistry();
+
+    // Returns false if an operator with that name exists already.
+    bool registerOperator(const std::string& name, PipelineOperator op);
+    bool unregisterOperator(const std::string& name);
+    // The operator, or nullptr if unknown.
+    std::shared_ptr<const PipelineOperator> find(const std::string& name) const;
+    std::vector<std::string> getOperatorNames() const;
+
+private:
+    mutable std::shared_mutex CppMutex;
+    std::map<std::string, std::shared_ptr<const PipelineOperator>> CppOperators;
+};
+
+} // namespace cli
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CLI_ROW_PIPELINE_HPP
@@ -36,6 +36,16 @@ void ConfigurationSystem::setConfigSource(const std::string& filePath) {
     // For now, just setting the path.
 }
 
+std::string ConfigurationSystem::getConfigSource() {
+    std::lock_guard<std::mutex> lock(CppConfigMutex);
+    return CppConfigFilePath;
+}
+
+ConfigurationSystem::ConfigSnapshot ConfigurationSystem::getSnapshot() {
+    std::lock_guard<std::mutex> lock(CppConfigMutex);
+    return CppConfigData;
+}
+
 ConfigResult ConfigurationSystem::getValue(const std::string& section, const std::string& key) {
     std::lock_guard<std::mutex> lock(CppConfigMutex);
     auto sec_it = CppConfigData.find(section);
@@ -61,11 +61,16 @@ public:
     
     // Sets the path to the configuration file.
     void setConfigSource(const std::string& filePath);
+    std::string getConfigSource();
+
+    // Copy of every section and its raw key/value strings, as stored.
+    using ConfigSnapshot = std::map<std::string, std::map<std::string, std::string>>;
+    ConfigSnapshot getSnapshot();
 
 private:
     // Internal representation of configuration data: map<section, map<key, value_string>>
     // Values are stored as strings initially from INI, conversion happens at getValue/setValue
-    using ConfigMap = std::map<std::string, std::map<std::string, std::string>>;
+    using ConfigMap = ConfigSnapshot;
     ConfigMap CppConfigData; // Renamed to avoid conflicts
     std::string CppConfigFilePath; // Renamed
     std::mutex CppConfigMutex; // Renamed
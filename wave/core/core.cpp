@@ -1,9 +1,69 @@
 #include "core.hpp"
+#include "core/cli/cli_commands.hpp"
+#include "core/core_commands.hpp"
+#include "core/moduleloader/module_index.hpp"
 #include <iostream> // For basic debug messages during init/shutdown
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 
 namespace wave {
 namespace core {
 
+namespace {
+// Reads a string setting. The INI parser keeps values verbatim, so inline "; comments" and
+// surrounding quotes are stripped here. Returns fallback if the key is missing.
+std::string readConfigString(configuration::ConfigurationSystem& config, const std::string& section,
+                             const std::string& key, const std::string& fallback = "") {
+    configuration::ConfigResult result = config.getValue(section, key);
+    if (!result.success || !result.value.has_value()) {
+        return fallback;
+    }
+    std::string value;
+    try {
+        value = std::any_cast<std::string>(result.value.value());
+    } catch (const std::bad_any_cast&) {
+        return fallback;
+    }
+
+    bool quoted = !value.empty() && value.front() == '"';
+    if (quoted) {
+        size_t closing = value.find('"', 1);
+        return closing == std::string::npos ? value.substr(1) : value.substr(1, closing - 1);
+    }
+    size_t comment = value.find(" ;");
+    if (comment != std::string::npos) {
+        value.erase(comment);
+    }
+    size_t last = value.find_last_not_of(" \t");
+    return last == std::string::npos ? std::string() : value.substr(0, last + 1);
+}
+
+bool readConfigBool(configuration::ConfigurationSystem& config, const std::string& section,
+                    const std::string& key, bool fallback) {
+    std::string value = readConfigString(config, section, key);
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (value == "true" || value == "yes" || value == "on" || value == "1") {
+        return true;
+    }
+    if (value == "false" || value == "no" || value == "off" || value == "0") {
+        return false;
+    }
+    return fallback;
+}
+
+// "~/..." is relative to $HOME, as users expect from shell history files.
+std::string expandHomePath(const std::string& path) {
+    const char* home = std::getenv("HOME");
+    if (path.rfind("~/", 0) == 0 && home && *home) {
+        return std::string(home) + path.substr(1);
+    }
+    return path;
+}
+} // namespace
+
 Core::Core() : CppIsInitialized(false) {
     // Order of initialization can be important.
     // 1. LoggingSystem: So other systems can log during their construction/init.
@@ -19,12 +79,25 @@ Core::Core() : CppIsInitialized(false) {
     //    but CLIEngine itself is fairly standalone.
     CppCliEngine_ptr = std::make_unique<cli::CLIEngine>();
 
-    // 5. ModuleLoaderSystem: Needs ICoreAccess (this), so it's typically initialized last among systems
-    //    that don't depend on modules being loaded at Core construction.
-    //    Or, it can be initialized earlier if other systems need to subscribe to module events
-    //    during their own construction (less common for Core construction phase).
-    //    Passing 'this' (ICoreAccess*) to ModuleLoaderSystem.
-    CppModuleLoaderSystem_ptr = std::make_unique<moduleloader::ModuleLoaderSystem>(this);
+    // 5. Core services: the systems above, as modules see them through WaveCoreApi.
+    CppCoreServices.setService(WAVE_SERVICE_LOGGING, CppLoggingSystem_ptr.get());
+    CppCoreServices.setService(WAVE_SERVICE_CONFIGURATION, CppConfigurationSystem_ptr.get());
+    CppCoreServices.setService(WAVE_SERVICE_EVENTBUS, CppEventBus_ptr.get());
+    CppCoreServices.setService(WAVE_SERVICE_CLI, CppCliEngine_ptr.get());
+    CppCoreServices.setLogFunction([this](uint32_t level, const std::string& source, const std::string& message) {
+        CppLoggingSystem_ptr->log(
+            logging::LogEntry(static_cast<logging::LogLevel>(std::min(level, WAVE_LOG_ERROR)), source, message));
+    });
+
+    // 6. ModuleLoaderSystem: hands the services table to every module it initializes, so it comes
+    //    last; it is a service itself.
+    CppModuleLoaderSystem_ptr = std::make_unique<moduleloader::ModuleLoaderSystem>(CppCoreServices.api());
+    CppCoreServices.setService(WAVE_SERVICE_MODULE_LOADER, CppModuleLoaderSystem_ptr.get());
+    // CLI commands a module registers from initialize() keep its instance loaded while they run.
+    CppModuleLoaderSystem_ptr->setInitializeScope(
+        [](const std::string& moduleName, moduleloader::ModuleLoaderSystem::InstancePin pin) -> std::shared_ptr<void> {
+            return std::make_shared<cli::CommandOwnerScope>(moduleName, [pin]() -> std::shared_ptr<void> { return pin(); });
+        });
 
     // std::cout << "[Core] Constructor: All core systems instantiated." << std::endl;
 }
@@ -49,6 +122,7 @@ Core::~Core() {
 }
 
 void Core::initialize(const std::string& configFilePath) {
+    auto initStart = std::chrono::steady_clock::now();
     if (CppIsInitialized) {
         // std::cout << "[Core] Already initialized." << std::endl;
         if (CppLoggingSystem_ptr) {
@@ -81,14 +155,135 @@ void Core::initialize(const std::string& configFilePath) {
     // }
 
 
-    // Other initializations can go here.
-    // For example, registering built-in CLI commands,
-    // loading default/essential modules, etc.
+    // Other initializations can go here, e.g. loading default/essential modules.
+    // Built-in CLI commands are registered below (registerBuiltinCommands).
+
+    // Cached CLI results (ICommand::getCachePolicy) are invalidated by EventBus events. Delivery is
+    // synchronous so a publisher's next query already misses the cache.
+    if (CppCliEngine_ptr && CppEventBus_ptr) {
+        eventbus::EventBus* bus = CppEventBus_ptr.get();
+        CppCliEngine_ptr->setCacheTopicSubscriber([bus](const std::string& topic, std::function<void()> invalidate) {
+            eventbus::SubscriptionId id = bus->subscribe(topic, [invalidate](const eventbus::StructuredData&) { invalidate(); },
+                                                         eventbus::DeliveryMode::Sync);
+            return std::function<void()>([bus, id]() { bus->unsubscribe(id); });
+        });
+    }
+
+    // Module events are republished on the EventBus ("module.loaded", "module.unloaded",
+    // "module.reloaded", and "module.error" for a failed load or unload), synchronously so cached
+    // "module list" results are dropped before the loader returns. A failure matters too: it ends
+    // a "loading" or "unloading" state a cached list may still show.
+    if (CppModuleLoaderSystem_ptr && CppEventBus_ptr) {
+        eventbus::EventBus* bus = CppEventBus_ptr.get();
+        CppModuleLoaderSystem_ptr->subscribeToModuleEvents(
+            [bus](moduleloader::ModuleEventType type, const moduleloader::ModuleInfo& info, const std::string&) {
+                switch (type) {
+                case moduleloader::ModuleEventType::Loaded:
+                    bus->publish("module.loaded", info.name, eventbus::DeliveryMode::Sync);
+                    break;
+                case moduleloader::ModuleEventType::Unloaded:
+                    bus->publish("module.unloaded", info.name, eventbus::DeliveryMode::Sync);
+                    break;
+                case moduleloader::ModuleEventType::Reloaded:
+                    bus->publish("module.reloaded", info.name, eventbus::DeliveryMode::Sync);
+                    break;
+                case moduleloader::ModuleEventType::ErrorLoading:
+                case moduleloader::ModuleEventType::ErrorUnloading:
+                    bus->publish("module.error", info.name, eventbus::DeliveryMode::Sync);
+                    break;
+                }
+            });
+        // Load and unload phases go out as "module.progress" with the moduleloader::ModuleProgress
+        // as payload, e.g. for a progress display while loadModuleAsync() runs.
+        CppModuleLoaderSystem_ptr->subscribeToModuleProgress([bus](const moduleloader::ModuleProgress& progress) {
+            bus->publish("module.progress", progress, eventbus::DeliveryMode::Sync);
+        });
+        // Isolated modules get their commands and topics forwarded while they are loaded.
+        CppModuleLoaderSystem_ptr->subscribeToModuleEvents(
+            [this](moduleloader::ModuleEventType type, const moduleloader::ModuleInfo& info, const std::string&) {
+                if (CppHostedModules_ptr) {
+                    CppHostedModules_ptr->onModuleEvent(type, info);
+                }
+            });
+    }
+
+    registerBuiltinCommands();
+
+    // Interactive history: [CLI] enable_history, max_history_items, history_file. The file is only
+    // read when the history is first used.
+    if (CppConfigurationSystem_ptr && CppCliEngine_ptr) {
+        cli::HistoryManager& history = CppCliEngine_ptr->getHistory();
+        history.setEnabled(readConfigBool(*CppConfigurationSystem_ptr, "CLI", "enable_history", true));
+        try {
+            long long maxItems = std::stoll(readConfigString(*CppConfigurationSystem_ptr, "CLI", "max_history_items", "500"));
+            history.setMaxItems(maxItems > 0 ? static_cast<size_t>(maxItems) : 1);
+        } catch (const std::exception&) {
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                        "Ignoring invalid [CLI] max_history_items."));
+        }
+        if (history.isEnabled()) {
+            history.setHistoryFile(expandHomePath(readConfigString(*CppConfigurationSystem_ptr, "CLI", "history_file")));
+        }
+    }
+
+    // Default output format: [CLI] output_format (the launcher's --output overrides it).
+    if (CppConfigurationSystem_ptr && CppCliEngine_ptr) {
+        std::string outputFormat = readConfigString(*CppConfigurationSystem_ptr, "CLI", "output_format");
+        if (!outputFormat.empty() && !CppCliEngine_ptr->setDefaultOutputFormat(outputFormat)) {
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                        "Ignoring unknown [CLI] output_format: " + outputFormat));
+        }
+    }
+
+    // Slow-command logging: [CLI] slow_command_threshold_ms, 0 or missing disables it.
+    if (CppConfigurationSystem_ptr && CppCliEngine_ptr) {
+        long long thresholdMs = 0;
+        try {
+            thresholdMs = std::stoll(readConfigString(*CppConfigurationSystem_ptr, "CLI", "slow_command_threshold_ms", "0"));
+        } catch (const std::exception&) {
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                        "Ignoring invalid [CLI] slow_command_threshold_ms."));
+        }
+        if (thresholdMs > 0) {
+            logging::LoggingSystem* logger = CppLoggingSystem_ptr.get();
+            CppCliEngine_ptr->setSlowCommandThreshold(std::chrono::milliseconds(thresholdMs),
+                [logger](const std::string& commandName, const std::vector<std::string>& args,
+                         std::chrono::nanoseconds elapsed) {
+                    std::string line = commandName;
+                    for (const std::string& arg : args) {
+                        line += " " + arg;
+                    }
+                    logger->log(logging::LogEntry(logging::LogLevel::Warning, "CLI",
+                                                  "Slow command (" + cli::CliStatsCommand::formatDuration(elapsed) + "): " + line));
+                });
+        }
+    }
+
+    // Remote CLI: only when [CLI] listen_uri is set (it is commented out in the default launcher.conf).
+    if (CppConfigurationSystem_ptr && CppCliEngine_ptr) {
+        std::string listenUri = readConfigString(*CppConfigurationSystem_ptr, "CLI", "listen_uri");
+        if (!listenUri.empty()) {
+            auto server = std::make_unique<cli::RemoteCLIServer>(*CppCliEngine_ptr);
+            std::string error;
+            if (server->start(listenUri, &error)) {
+                CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Info, "Core",
+                                                            "Remote CLI listening on " + server->getListenUri()));
+                CppRemoteCliServer_ptr = std::move(server);
+            } else {
+                CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Error, "Core",
+                                                            "Remote CLI disabled: " + error));
+            }
+        }
+    }
+
+    loadStartupModules();
 
     CppIsInitialized = true;
+    CppStartTime = std::chrono::steady_clock::now();
     if (CppLoggingSystem_ptr) {
         CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Info, "Core", "Core initialized successfully."));
     }
+    writeStartupReport(CppStartTime - initStart);
     // std::cout << "[Core] Initialized." << std::endl;
 }
 
@@ -107,23 +302,25 @@ void Core::shutdown() {
     // std::cout << "[Core] Shutting down..." << std::endl;
 
     // Order of shutdown is important:
-    // 1. Unload all modules: Modules might depend on other core systems.
+    // 0. Stop accepting remote CLI sessions; their commands may touch modules.
+    if (CppRemoteCliServer_ptr) {
+        CppRemoteCliServer_ptr->stop();
+        CppRemoteCliServer_ptr.reset();
+    }
+
+    // 1. Drop the lazy module stand-ins and wait for activations still in progress.
+    CppLazyModules_ptr.reset();
+
+    // 2. Unload all modules: Modules might depend on other core systems. Dependents go first, so
+    // every module can still use the modules it requires during its shutdown(). The file watcher
+    // stops first, so no reload races the unloading.
     if (CppModuleLoaderSystem_ptr) {
-        // std::cout << "[Core] Unloading all modules..." << std::endl;
-        // This part of ModuleLoaderSystem's destructor already handles unloading.
-        // However, calling it explicitly here ensures it happens before other systems are potentially nulled out
-        // if we were not using unique_ptrs or had more complex dependencies during system destructor phase.
-        // For unique_ptrs, their destructors are called in reverse order of declaration.
-        // CppModuleLoaderSystem_ptr's destructor will be called first among the unique_ptrs,
-        // which should unload modules. So, explicit call here might be redundant IF
-        // ModuleLoaderSystem's destructor is robust enough.
-        // Let's assume ModuleLoaderSystem's destructor handles unloading all modules.
-        // If specific actions are needed beyond that, call them here.
-        // For example, if ModuleLoaderSystem had a specific `unloadAllModules()` method:
-        // CppModuleLoaderSystem_ptr->unloadAllModules();
+        CppModuleLoaderSystem_ptr->stopWatching();
+        CppModuleLoaderSystem_ptr->unloadAllModules(CppModuleLoadThreads);
     }
+    CppHostedModules_ptr.reset();
     
-    // 2. Shutdown other systems if they have explicit shutdown methods.
+    // 3. Shutdown other systems if they have explicit shutdown methods.
     // Most of my systems manage resources via RAII and their destructors are sufficient.
     // e.g., CLIEngine, EventBus don't have explicit shutdown methods in their current design.
     // LoggingSystem's destructor closes the log file.
@@ -140,6 +337,284 @@ void Core::shutdown() {
     // std::cout << "[Core] Shutdown complete." << std::endl;
 }
 
+void Core::registerBuiltinCommands() {
+    if (!CppCliEngine_ptr) {
+        return;
+    }
+    cli::CLIEngine& engine = *CppCliEngine_ptr;
+    engine.registerCommand("cli stats", std::make_shared<cli::CliStatsCommand>(engine));
+    engine.registerCommand("cli history", std::make_shared<cli::CliHistoryCommand>(engine));
+    engine.registerCommand("cli cache", std::make_shared<cli::CliCacheCommand>(engine));
+
+    moduleloader::ModuleLoaderSystem& loader = *CppModuleLoaderSystem_ptr;
+    engine.registerCommand("module load", std::make_shared<ModuleLoadCommand>(loader));
+    engine.registerCommand("module unload", std::make_shared<ModuleUnloadCommand>(loader));
+    engine.registerCommand("module reload", std::make_shared<ModuleReloadCommand>(loader));
+    engine.registerCommand("module list", std::make_shared<ModuleListCommand>(loader));
+    engine.registerCommand("module stats", std::make_shared<ModuleStatsCommand>(loader));
+    engine.registerCommand("module available", std::make_shared<ModuleAvailableCommand>(loader));
+
+    configuration::ConfigurationSystem& config = *CppConfigurationSystem_ptr;
+    engine.registerCommand("config get", std::make_shared<ConfigGetCommand>(config));
+    engine.registerCommand("config set", std::make_shared<ConfigSetCommand>(config));
+    engine.registerCommand("config reload", std::make_shared<ConfigReloadCommand>(config));
+    engine.registerCommand("config dump", std::make_shared<ConfigDumpCommand>(config));
+
+    engine.registerCommand("log level", std::make_shared<LogLevelCommand>(*CppLoggingSystem_ptr));
+    engine.registerCommand("log tail", std::make_shared<LogTailCommand>(*CppLoggingSystem_ptr));
+
+    engine.registerCommand("eventbus topics", std::make_shared<EventBusTopicsCommand>(*CppEventBus_ptr));
+    engine.registerCommand("eventbus stats", std::make_shared<EventBusStatsCommand>(*CppEventBus_ptr));
+
+    engine.registerCommand("core status", std::make_shared<CoreStatusCommand>(*this));
+}
+
+void Core::loadStartupModules() {
+    // [Modules] modules_file names an INI file whose [modules] section maps a module name to its
+    // library; [Modules] load_threads bounds the parallel loader and its pool for asynchronous
+    // operations (0 = one per CPU core).
+    if (!CppConfigurationSystem_ptr || !CppModuleLoaderSystem_ptr) {
+        return;
+    }
+    CppLazyModules_ptr = std::make_unique<LazyModuleActivator>(*CppModuleLoaderSystem_ptr, *CppCliEngine_ptr,
+                                                               *CppEventBus_ptr, *CppLoggingSystem_ptr);
+    CppHostedModules_ptr = std::make_unique<HostedModuleBridge>(*CppModuleLoaderSystem_ptr, *CppCliEngine_ptr,
+                                                                *CppEventBus_ptr, *CppLoggingSystem_ptr);
+    try {
+        long long threads = std::stoll(readConfigString(*CppConfigurationSystem_ptr, "Modules", "load_threads", "0"));
+        CppModuleLoadThreads = threads > 0 ? static_cast<size_t>(threads) : 0;
+    } catch (const std::exception&) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core", "Ignoring invalid [Modules] load_threads."));
+    }
+    CppModuleLoaderSystem_ptr->setAsyncWorkerCount(CppModuleLoadThreads);
+    configureModuleIndex();
+
+    // [Modules] auto_reload hot reloads a module when its library file changes, once the file has
+    // been left alone for auto_reload_delay_ms. Meant for development; off by default.
+    if (readConfigBool(*CppConfigurationSystem_ptr, "Modules", "auto_reload", false)) {
+        long long delayMs = 500;
+        try {
+            delayMs = std::stoll(readConfigString(*CppConfigurationSystem_ptr, "Modules", "auto_reload_delay_ms", "500"));
+        } catch (const std::exception&) {
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core", "Ignoring invalid [Modules] auto_reload_delay_ms."));
+        }
+        if (CppModuleLoaderSystem_ptr->startWatching(std::chrono::milliseconds(std::max(0LL, delayMs)))) {
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Info, "Core", "Watching module libraries for changes."));
+        } else {
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                        "Cannot watch module libraries; auto_reload is off."));
+        }
+    }
+    std::string modulesFile = readConfigString(*CppConfigurationSystem_ptr, "Modules", "modules_file");
+    if (modulesFile.empty()) {
+        return;
+    }
+
+    configuration::ConfigurationSystem modulesConfig;
+    modulesConfig.setConfigSource(expandHomePath(modulesFile));
+    bool readOk = false;
+    std::string readMessage;
+    modulesConfig.reloadConfig([&readOk, &readMessage](bool success, const std::string& message) {
+        readOk = success;
+        readMessage = message;
+    });
+    if (!readOk) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Error, "Core", "Cannot read module list: " + readMessage));
+        return;
+    }
+
+    // "name = path" loads at startup; "name = path lazy" defers loading to the first use of one
+    // of the commands or topics the module's manifest declares; "name = path isolated" loads the
+    // module into a module host process of its own (see HostedModuleBridge).
+    std::vector<std::string> names;
+    std::vector<std::string> paths;
+    std::vector<std::pair<std::string, std::string>> isolated; // Name and path
+    size_t lazyCount = 0;
+    configuration::ConfigurationSystem::ConfigSnapshot snapshot = modulesConfig.getSnapshot();
+    for (const auto& entry : snapshot["modules"]) {
+        std::string path = readConfigString(modulesConfig, "modules", entry.first);
+        bool lazy = false;
+        bool isolate = false;
+        for (size_t flag = path.find_last_of(" \t"); flag != std::string::npos; flag = path.find_last_of(" \t")) {
+            std::string word = path.substr(flag + 1);
+            if (word == "lazy") {
+                lazy = true;
+            } else if (word == "isolated") {
+                isolate = true;
+            } else {
+                break;
+            }
+            path = path.substr(0, path.find_last_not_of(" \t", flag) + 1);
+        }
+        if (path.empty()) {
+            continue;
+        }
+        if (isolate) {
+            if (lazy) {
+                CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                            "Module " + entry.first + " cannot be both lazy and isolated; loading it now."));
+            }
+            isolated.emplace_back(entry.first, path);
+            continue;
+        }
+        if (lazy) {
+            std::string error;
+            std::optional<moduleloader::ModuleManifest> manifest = CppModuleLoaderSystem_ptr->getModuleIndex().manifest(path, &error);
+            if (manifest && CppLazyModules_ptr->addModule(path, *manifest)) {
+                ++lazyCount;
+                continue;
+            }
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                        "Module " + entry.first + " cannot be loaded lazily (" +
+                                                        (manifest ? "its manifest declares no commands or topics" : error) +
+                                                        "); loading it now."));
+        }
+        names.push_back(entry.first);
+        paths.push_back(path);
+    }
+    if (lazyCount > 0) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Info, "Core",
+                                                    std::to_string(lazyCount) + " lazy module(s) will load on first use."));
+    }
+    if (!CppModuleLoaderSystem_ptr->getModuleIndex().save()) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core", "Cannot write the module manifest cache."));
+    }
+    if (paths.empty() && isolated.empty()) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<moduleloader::ModuleResult> results;
+    if (!paths.empty()) {
+        results = CppModuleLoaderSystem_ptr->loadModules(paths, CppModuleLoadThreads);
+    }
+    // Isolated modules load after the others, which may provide what they require.
+    moduleloader::IsolationOptions options = isolationOptions();
+    for (const auto& module : isolated) {
+        names.push_back(module.first);
+        paths.push_back(module.second);
+        results.push_back(CppModuleLoaderSystem_ptr->loadIsolatedModule(module.second, options));
+    }
+    size_t loaded = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].status == moduleloader::ModuleResult::Status::Success) {
+            ++loaded;
+        } else {
+            CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Error, "Core",
+                                                        "Module " + names[i] + " not loaded: " + results[i].message));
+        }
+    }
+    long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Info, "Core",
+                                                "Loaded " + std::to_string(loaded) + " of " + std::to_string(paths.size()) +
+                                                " module(s) in " + std::to_string(elapsedMs) + " ms."));
+}
+
+moduleloader::IsolationOptions Core::isolationOptions() {
+    // [Modules] module_host is the module host executable; isolated_memory_limit_mb caps each
+    // host's address space (0 = no limit) and isolated_max_restarts how often a crashed host is
+    // started again.
+    moduleloader::IsolationOptions options;
+    options.hostExecutable = expandHomePath(readConfigString(*CppConfigurationSystem_ptr, "Modules", "module_host", "build/module_host"));
+    try {
+        long long limitMb = std::stoll(readConfigString(*CppConfigurationSystem_ptr, "Modules", "isolated_memory_limit_mb", "0"));
+        options.memoryLimitBytes = limitMb > 0 ? static_cast<size_t>(limitMb) * 1024 * 1024 : 0;
+    } catch (const std::exception&) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core", "Ignoring invalid [Modules] isolated_memory_limit_mb."));
+    }
+    try {
+        long long restarts = std::stoll(readConfigString(*CppConfigurationSystem_ptr, "Modules", "isolated_max_restarts", "3"));
+        options.maxRestarts = restarts > 0 ? static_cast<unsigned>(restarts) : 0;
+    } catch (const std::exception&) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core", "Ignoring invalid [Modules] isolated_max_restarts."));
+    }
+    return options;
+}
+
+void Core::configureModuleIndex() {
+    // [Modules] search_paths lists the directories searched for modules named without a path, in
+    // order, separated like PATH entries; [Modules] manifest_cache keeps their manifests between runs.
+    moduleloader::ModuleIndex& index = CppModuleLoaderSystem_ptr->getModuleIndex();
+#ifdef _WIN32
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+    std::vector<std::string> directories;
+    std::string searchPaths = readConfigString(*CppConfigurationSystem_ptr, "Modules", "search_paths");
+    size_t start = 0;
+    while (start <= searchPaths.size()) {
+        size_t end = searchPaths.find(separator, start);
+        if (end == std::string::npos) {
+            end = searchPaths.size();
+        }
+        std::string directory = searchPaths.substr(start, end - start);
+        if (!directory.empty()) {
+            directories.push_back(expandHomePath(directory));
+        }
+        start = end + 1;
+    }
+    index.setSearchPaths(directories);
+
+    std::string cacheFile = readConfigString(*CppConfigurationSystem_ptr, "Modules", "manifest_cache");
+    if (!cacheFile.empty() && !index.setCacheFile(expandHomePath(cacheFile))) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                    "Cannot read the module manifest cache " + cacheFile + "; rebuilding it."));
+    }
+}
+
+void Core::writeStartupReport(std::chrono::steady_clock::duration startupTime) {
+    if (!CppModuleLoaderSystem_ptr || !CppLoggingSystem_ptr) {
+        return;
+    }
+    std::vector<moduleloader::ModuleInfo> modules = ModuleStatsCommand::slowestFirst(CppModuleLoaderSystem_ptr->listModules());
+    auto ms = [](std::chrono::microseconds duration) { return duration.count() / 1000.0; };
+    double startupMs = std::chrono::duration<double, std::milli>(startupTime).count();
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "Startup took %.1f ms, %zu module(s) loaded.", startupMs, modules.size());
+    std::string summary = line;
+    // The three slowest modules go into the summary; "module stats" shows all of them.
+    for (size_t i = 0; i < modules.size() && i < 3; ++i) {
+        std::snprintf(line, sizeof(line), "%s %s %.1f ms (init %.1f ms)", i == 0 ? " Slowest:" : ",",
+                      modules[i].name.c_str(), ms(modules[i].profile.total()), ms(modules[i].profile.initialize));
+        summary += line;
+    }
+    CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Info, "Core", summary));
+
+    std::string reportFile = CppConfigurationSystem_ptr
+                                 ? readConfigString(*CppConfigurationSystem_ptr, "Modules", "startup_report")
+                                 : std::string();
+    if (reportFile.empty()) {
+        return;
+    }
+    std::ofstream report(expandHomePath(reportFile), std::ios::trunc);
+    if (!report) {
+        CppLoggingSystem_ptr->log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                                    "Cannot write the startup report to " + reportFile));
+        return;
+    }
+    std::snprintf(line, sizeof(line), "Startup took %.1f ms, %zu module(s) loaded.\n\n", startupMs, modules.size());
+    report << line;
+    std::snprintf(line, sizeof(line), "%-24s %10s %10s %10s %10s %10s %12s\n", "module", "open_ms", "symbols_ms",
+                  "create_ms", "init_ms", "total_ms", "rss_delta_kb");
+    report << line;
+    for (const moduleloader::ModuleInfo& info : modules) {
+        const moduleloader::ModuleLoadProfile& profile = info.profile;
+        std::snprintf(line, sizeof(line), "%-24s %10.1f %10.1f %10.1f %10.1f %10.1f %12lld\n", info.name.c_str(),
+                      ms(profile.open), ms(profile.symbols), ms(profile.create), ms(profile.initialize),
+                      ms(profile.total()), profile.rssDeltaBytes / 1024);
+        report << line;
+    }
+}
+
+std::chrono::steady_clock::duration Core::getUptime() const {
+    if (!CppIsInitialized) {
+        return std::chrono::steady_clock::duration::zero();
+    }
+    return std::chrono::steady_clock::now() - CppStartTime;
+}
+
 // --- Implementation of ICoreAccess interface ---
 
 eventbus::EventBus* Core::getEventBus() {
@@ -162,5 +637,17 @@ moduleloader::ModuleLoaderSystem* Core::getModuleLoaderSystem() {
     return CppModuleLoaderSystem_ptr.get();
 }
 
+cli::RemoteCLIServer* Core::getRemoteCLIServer() {
+    return CppRemoteCliServer_ptr.get();
+}
+
+LazyModuleActivator* Core::getLazyModuleActivator() {
+    return CppLazyModules_ptr.get();
+}
+
+const WaveCoreApi* Core::getCoreApi() const {
+    return CppCoreServices.api();
+}
+
 } // namespace core
 } // namespace wave
@@ -8,10 +8,15 @@
 #include "core/configuration/configuration.hpp"
 #include "core/logging/logging.hpp"
 #include "core/cli/cli_engine.hpp"
+#include "core/cli/remote_server.hpp"
 #include "core/moduleloader/module_loader.hpp"
+#include "core/moduleloader/core_services.hpp"
+#include "core/lazy_modules.hpp"
+#include "core/hosted_modules.hpp"
 
 #include <string> // For potential config file paths, etc.
 #include <memory> // For std::unique_ptr if choosing that for ownership
+#include <chrono>
 
 namespace wave {
 namespace core {
@@ -33,6 +38,17 @@ public:
     cli::CLIEngine* getCLIEngine() override;
     moduleloader::ModuleLoaderSystem* getModuleLoaderSystem() override;
 
+    // Remote CLI listener; null unless [CLI] listen_uri was configured and could be bound.
+    cli::RemoteCLIServer* getRemoteCLIServer();
+    // Modules marked lazy in the module list, loaded on first use; null before initialize().
+    LazyModuleActivator* getLazyModuleActivator();
+    // The table every module's initialize() receives: the systems above as core services.
+    const WaveCoreApi* getCoreApi() const;
+
+    bool isInitialized() const { return CppIsInitialized; }
+    // Time since initialize() completed; zero before that.
+    std::chrono::steady_clock::duration getUptime() const;
+
 private:
     // Core system instances
     // Using direct instances or unique_ptr for ownership.
@@ -48,6 +64,10 @@ private:
     // cli::CLIEngine CppCliEngine;
     // moduleloader::ModuleLoaderSystem CppModuleLoaderSystem; // Needs ICoreAccess*
 
+    // The services modules reach through WaveCoreApi. Declared before the systems so the table
+    // outlives every module, which may use it until its shutdown() returns.
+    moduleloader::CoreServiceRegistry CppCoreServices;
+
     // Option 2: Unique_ptr for more flexible initialization order in constructor body
     // and explicit control over deletion order in destructor if needed.
     std::unique_ptr<logging::LoggingSystem> CppLoggingSystem_ptr;
@@ -55,8 +75,29 @@ private:
     std::unique_ptr<eventbus::EventBus> CppEventBus_ptr;
     std::unique_ptr<cli::CLIEngine> CppCliEngine_ptr;
     std::unique_ptr<moduleloader::ModuleLoaderSystem> CppModuleLoaderSystem_ptr;
+    // Declared after the systems it uses; destroyed before them (and joined) at shutdown.
+    std::unique_ptr<LazyModuleActivator> CppLazyModules_ptr;
+    // Forwards commands and topics to isolated modules; dropped once all modules are unloaded.
+    std::unique_ptr<HostedModuleBridge> CppHostedModules_ptr;
+    // Declared last so it is destroyed first: remote sessions execute through CppCliEngine_ptr.
+    std::unique_ptr<cli::RemoteCLIServer> CppRemoteCliServer_ptr;
 
     bool CppIsInitialized;
+    std::chrono::steady_clock::time_point CppStartTime;
+    size_t CppModuleLoadThreads = 0; // [Modules] load_threads, also used to unload at shutdown
+
+    void registerBuiltinCommands();
+    // Loads the modules listed in [Modules] modules_file, in parallel and in dependency order;
+    // those marked lazy get stand-ins instead (see LazyModuleActivator), those marked isolated
+    // load into module hosts afterwards.
+    void loadStartupModules();
+    // Applies [Modules] search_paths and manifest_cache to the loader's ModuleIndex.
+    void configureModuleIndex();
+    // [Modules] settings for modules marked isolated.
+    moduleloader::IsolationOptions isolationOptions();
+    // Logs how long startup and each module's load took; with [Modules] startup_report set, also
+    // writes the per-module table to that file.
+    void writeStartupReport(std::chrono::steady_clock::duration startupTime);
 };
 
 } // namespace core
@@ -0,0 +1,431 @@
+#include "core_commands.hpp"
+#include "core.hpp"
+#include "core/moduleloader/module_index.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <set>
+
+namespace wave {
+namespace core {
+
+using cli::CommandResult;
+using cli::StructuredData;
+using Record = std::map<std::string, StructuredData>;
+
+namespace {
+CommandResult usage(const cli::ICommand& command) {
+    return CommandResult(CommandResult::Status::Error, "Usage: " + command.getHelp());
+}
+
+std::string joinWords(std::vector<std::string>::const_iterator begin, std::vector<std::string>::const_iterator end) {
+    std::string text;
+    for (auto it = begin; it != end; ++it) {
+        text += (text.empty() ? "" : " ") + *it;
+    }
+    return text;
+}
+
+const char* moduleStateName(moduleloader::ModuleState state) {
+    switch (state) {
+    case moduleloader::ModuleState::Loading: return "loading";
+    case moduleloader::ModuleState::Unloading: return "unloading";
+    default: return "ready";
+    }
+}
+
+Record moduleRecord(const moduleloader::ModuleInfo& info) {
+    return Record{{"name", info.name},
+                  {"version", info.version},
+                  {"state", std::string(moduleStateName(info.state))},
+                  {"path", info.path},
+                  {"provides", joinWords(info.provides.begin(), info.provides.end())},
+                  {"requires", joinWords(info.requirements.begin(), info.requirements.end())}};
+}
+
+// Same layout as the log file ("2024-05-01 12:00:00"), local time.
+std::string formatTimestamp(std::chrono::system_clock::time_point time) {
+    std::time_t t = std::chrono::system_clock::to_time_t(time);
+    std::tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &t);
+#else
+    localtime_r(&t, &timeinfo);
+#endif
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    return text;
+}
+
+double milliseconds(std::chrono::microseconds duration) {
+    return duration.count() / 1000.0;
+}
+
+Record profileRecord(const moduleloader::ModuleInfo& info) {
+    const moduleloader::ModuleLoadProfile& profile = info.profile;
+    return Record{{"name", info.name},
+                  {"open_ms", milliseconds(profile.open)},
+                  {"symbols_ms", milliseconds(profile.symbols)},
+                  {"create_ms", milliseconds(profile.create)},
+                  {"init_ms", milliseconds(profile.initialize)},
+                  {"total_ms", milliseconds(profile.total())},
+                  {"rss_delta_kb", profile.rssDeltaBytes / 1024}};
+}
+
+Record topicRecord(const eventbus::TopicStats& stats) {
+    return Record{{"topic", stats.topic},
+                  {"subscribers", stats.subscribers},
+                  {"published", stats.published},
+                  {"sync_deliveries", stats.syncDeliveries},
+                  {"async_deliveries", stats.asyncDeliveries}};
+}
+} // namespace
+
+// --- module ---
+
+CommandResult ModuleLoadCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext&) {
+    if (args.size() != 1) {
+        return usage(*this);
+    }
+    moduleloader::ModuleResult result = CppLoader.loadModule(args[0]);
+    if (result.status != moduleloader::ModuleResult::Status::Success) {
+        return CommandResult(CommandResult::Status::Error, result.message);
+    }
+    return CommandResult(CommandResult::Status::Success, "Loaded module " + result.module->name + " " + result.module->version + ".",
+                         StructuredData(moduleRecord(*result.module)));
+}
+
+CommandResult ModuleUnloadCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext&) {
+    if (args.size() != 1) {
+        return usage(*this);
+    }
+    moduleloader::ModuleResult result = CppLoader.unloadModule(args[0]);
+    if (result.status != moduleloader::ModuleResult::Status::Success) {
+        return CommandResult(CommandResult::Status::Error, result.message);
+    }
+    return CommandResult(CommandResult::Status::Success, "Unloaded module " + args[0] + ".");
+}
+
+const std::vector<cli::OptionSpec>& ModuleReloadCommand::getOptions() const {
+    static const std::vector<cli::OptionSpec> options = {
+        {"hot", cli::OptionSpec::Type::Flag, "Keep the running version until the new one is initialized, handing over its state."},
+    };
+    return options;
+}
+
+CommandResult ModuleReloadCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (args.size() != 1) {
+        return usage(*this);
+    }
+    bool hot = context.options.getFlag("hot");
+    moduleloader::ModuleResult result = hot ? CppLoader.hotReloadModule(args[0]) : CppLoader.reloadModule(args[0]);
+    if (result.status != moduleloader::ModuleResult::Status::Success) {
+        return CommandResult(CommandResult::Status::Error, result.message);
+    }
+    return CommandResult(CommandResult::Status::Success, hot ? result.message : "Reloaded module " + args[0] + ".",
+                         StructuredData(moduleRecord(*result.module)));
+}
+
+const cli::CachePolicy& ModuleListCommand::getCachePolicy() const {
+    // Core republishes the loader's module events on the EventBus under these topics.
+    static const cli::CachePolicy policy = [] {
+        cli::CachePolicy p;
+        p.invalidatedBy = {"module.loaded", "module.unloaded", "module.reloaded", "module.error"};
+        return p;
+    }();
+    return policy;
+}
+
+CommandResult ModuleListCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (!args.empty()) {
+        return usage(*this);
+    }
+    std::vector<moduleloader::ModuleInfo> modules = CppLoader.listModules();
+    for (const moduleloader::ModuleInfo& info : modules) {
+        if (!context.emit(StructuredData(moduleRecord(info)))) {
+            break;
+        }
+    }
+    return CommandResult(CommandResult::Status::Success, std::to_string(modules.size()) + " module(s) loaded.");
+}
+
+const cli::CachePolicy& ModuleStatsCommand::getCachePolicy() const {
+    static const cli::CachePolicy policy = [] {
+        cli::CachePolicy p;
+        p.invalidatedBy = {"module.loaded", "module.unloaded", "module.reloaded", "module.error"};
+        return p;
+    }();
+    return policy;
+}
+
+std::vector<moduleloader::ModuleInfo> ModuleStatsCommand::slowestFirst(std::vector<moduleloader::ModuleInfo> modules) {
+    // Modules still loading have no complete profile yet.
+    modules.erase(std::remove_if(modules.begin(), modules.end(),
+                                 [](const moduleloader::ModuleInfo& info) { return info.state == moduleloader::ModuleState::Loading; }),
+                  modules.end());
+    std::stable_sort(modules.begin(), modules.end(), [](const moduleloader::ModuleInfo& a, const moduleloader::ModuleInfo& b) {
+        return a.profile.total() > b.profile.total();
+    });
+    return modules;
+}
+
+CommandResult ModuleStatsCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (!args.empty()) {
+        return usage(*this);
+    }
+    std::vector<moduleloader::ModuleInfo> modules = slowestFirst(CppLoader.listModules());
+    std::chrono::microseconds total{0};
+    for (const moduleloader::ModuleInfo& info : modules) {
+        total += info.profile.total();
+        if (!context.emit(StructuredData(profileRecord(info)))) {
+            break;
+        }
+    }
+    char summary[96];
+    std::snprintf(summary, sizeof(summary), "%zu module(s), %.1f ms loading in total.", modules.size(), milliseconds(total));
+    return CommandResult(CommandResult::Status::Success, summary);
+}
+
+CommandResult ModuleAvailableCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (!args.empty()) {
+        return usage(*this);
+    }
+    moduleloader::ModuleIndex& index = CppLoader.getModuleIndex();
+    if (index.getSearchPaths().empty()) {
+        return CommandResult(CommandResult::Status::Error, "No module search paths; set [Modules] search_paths.");
+    }
+    std::set<std::string> loadedPaths;
+    for (const moduleloader::ModuleInfo& info : CppLoader.listModules()) {
+        loadedPaths.insert(info.path);
+    }
+    size_t readsBefore = index.getLibraryReads();
+    std::vector<moduleloader::ModuleIndex::Entry> entries = index.discover();
+    size_t opened = index.getLibraryReads() - readsBefore;
+    index.save();
+    for (const moduleloader::ModuleIndex::Entry& entry : entries) {
+        const std::vector<std::string> none;
+        const std::vector<std::string>& requirements = entry.manifest ? entry.manifest->requirements : none;
+        Record row{{"name", entry.manifest ? entry.manifest->name : std::filesystem::path(entry.path).filename().string()},
+                   {"version", entry.manifest ? entry.manifest->version : std::string()},
+                   {"path", entry.path},
+                   {"requires", joinWords(requirements.begin(), requirements.end())},
+                   {"loaded", loadedPaths.count(entry.path) > 0}};
+        if (!context.emit(StructuredData(row))) {
+            break;
+        }
+    }
+    return CommandResult(CommandResult::Status::Success, std::to_string(entries.size()) + " module librar" +
+                                                         (entries.size() == 1 ? "y" : "ies") + " found, " +
+                                                         std::to_string(opened) + " read from disk.");
+}
+
+// --- config ---
+
+CommandResult ConfigGetCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext&) {
+    if (args.empty() || args.size() > 2) {
+        return usage(*this);
+    }
+    if (args.size() == 2) {
+        configuration::ConfigResult result = CppConfig.getValue(args[0], args[1]);
+        if (!result.success || !result.value.has_value() || result.value->type() != typeid(std::string)) {
+            return CommandResult(CommandResult::Status::Error, "No setting [" + args[0] + "] " + args[1] + ".");
+        }
+        std::string value = std::any_cast<std::string>(*result.value);
+        return CommandResult(CommandResult::Status::Success, "[" + args[0] + "] " + args[1] + " = " + value,
+                             StructuredData(value));
+    }
+
+    configuration::ConfigurationSystem::ConfigSnapshot snapshot = CppConfig.getSnapshot();
+    auto section = snapshot.find(args[0]);
+    if (section == snapshot.end()) {
+        return CommandResult(CommandResult::Status::Error, "No section [" + args[0] + "].");
+    }
+    Record record;
+    for (const auto& entry : section->second) {
+        record.emplace(entry.first, entry.second);
+    }
+    return CommandResult(CommandResult::Status::Success,
+                         std::to_string(record.size()) + " setting(s) in [" + args[0] + "].", StructuredData(std::move(record)));
+}
+
+CommandResult ConfigSetCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext&) {
+    if (args.size() < 3) {
+        return usage(*this);
+    }
+    std::string value = joinWords(args.begin() + 2, args.end());
+    CppConfig.setValue(args[0], args[1], std::string(value));
+    return CommandResult(CommandResult::Status::Success, "[" + args[0] + "] " + args[1] + " = " + value);
+}
+
+CommandResult ConfigReloadCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext&) {
+    if (!args.empty()) {
+        return usage(*this);
+    }
+    // reloadConfig reports through its callback before it returns.
+    bool success = false;
+    std::string message = "Configuration was not reloaded.";
+    CppConfig.reloadConfig([&success, &message](bool ok, const std::string& text) {
+        success = ok;
+        message = text;
+    });
+    return CommandResult(success ? CommandResult::Status::Success : CommandResult::Status::Error, message);
+}
+
+CommandResult ConfigDumpCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (args.size() > 1) {
+        return usage(*this);
+    }
+    configuration::ConfigurationSystem::ConfigSnapshot snapshot = CppConfig.getSnapshot();
+    if (!args.empty() && snapshot.find(args[0]) == snapshot.end()) {
+        return CommandResult(CommandResult::Status::Error, "No section [" + args[0] + "].");
+    }
+    size_t count = 0;
+    for (const auto& section : snapshot) {
+        if (!args.empty() && section.first != args[0]) {
+            continue;
+        }
+        for (const auto& entry : section.second) {
+            ++count;
+            if (!context.emit(StructuredData(Record{{"section", section.first}, {"key", entry.first}, {"value", entry.second}}))) {
+                return CommandResult(CommandResult::Status::Success, std::to_string(count) + " setting(s).");
+            }
+        }
+    }
+    return CommandResult(CommandResult::Status::Success, std::to_string(count) + " setting(s).");
+}
+
+// --- log ---
+
+CommandResult LogLevelCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (args.size() > 2) {
+        return usage(*this);
+    }
+    if (args.empty()) {
+        std::map<std::string, logging::LogLevel> levels = CppLogger.getLogLevels();
+        for (const auto& entry : levels) {
+            if (!context.emit(StructuredData(Record{{"category", entry.first},
+                                                    {"level", logging::LoggingSystem::logLevelToString(entry.second)}}))) {
+                break;
+            }
+        }
+        return CommandResult(CommandResult::Status::Success, std::to_string(levels.size()) + " categor" +
+                             (levels.size() == 1 ? "y" : "ies") + " with an explicit level.");
+    }
+    if (args.size() == 2) {
+        std::optional<logging::LogLevel> level = logging::LoggingSystem::logLevelFromString(args[1]);
+        if (!level) {
+            return CommandResult(CommandResult::Status::Error, "Unknown log level: " + args[1] +
+                                 " (expected DEBUG, INFO, WARNING, ERROR or NONE)");
+        }
+        CppLogger.setLogLevel(args[0], *level);
+    }
+    std::string level = logging::LoggingSystem::logLevelToString(CppLogger.getLogLevel(args[0]));
+    return CommandResult(CommandResult::Status::Success, args[0] + ": " + level,
+                         StructuredData(Record{{"category", args[0]}, {"level", level}}));
+}
+
+const std::vector<cli::OptionSpec>& LogTailCommand::getOptions() const {
+    static const std::vector<cli::OptionSpec> options = {
+        {"lines", cli::OptionSpec::Type::Integer, "Number of entries to show (default: 20, 0 = all kept)."},
+        {"category", cli::OptionSpec::Type::String, "Only entries of this category."},
+    };
+    return options;
+}
+
+CommandResult LogTailCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (!args.empty()) {
+        return usage(*this);
+    }
+    long long lines = context.options.getInteger("lines").value_or(20);
+    if (lines < 0) {
+        return CommandResult(CommandResult::Status::Error, "log tail: --lines must not be negative.");
+    }
+    std::vector<logging::LogEntry> entries =
+        CppLogger.getRecentEntries(static_cast<size_t>(lines), context.options.getString("category").value_or(""));
+    for (const logging::LogEntry& entry : entries) {
+        if (!context.emit(StructuredData(Record{{"time", formatTimestamp(entry.timestamp)},
+                                                {"level", logging::LoggingSystem::logLevelToString(entry.level)},
+                                                {"category", entry.category},
+                                                {"message", entry.message}}))) {
+            break;
+        }
+    }
+    return CommandResult(CommandResult::Status::Success, std::to_string(entries.size()) + " log entr" +
+                         (entries.size() == 1 ? "y." : "ies."));
+}
+
+// --- eventbus ---
+
+CommandResult EventBusTopicsCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (!args.empty()) {
+        return usage(*this);
+    }
+    size_t count = 0;
+    for (const eventbus::TopicStats& stats : CppBus.getTopicStats()) {
+        if (stats.subscribers == 0) {
+            continue; // Published to, but nobody listens
+        }
+        ++count;
+        if (!context.emit(StructuredData(Record{{"topic", stats.topic}, {"subscribers", stats.subscribers}}))) {
+            break;
+        }
+    }
+    return CommandResult(CommandResult::Status::Success, std::to_string(count) + " topic(s) with subscribers.");
+}
+
+CommandResult EventBusStatsCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) {
+    if (args.size() > 1) {
+        return usage(*this);
+    }
+    std::vector<eventbus::TopicStats> topics = CppBus.getTopicStats();
+    if (!args.empty()) {
+        for (const eventbus::TopicStats& stats : topics) {
+            if (stats.topic == args[0]) {
+                return CommandResult(CommandResult::Status::Success, "Event stats for " + stats.topic + ".",
+                                     StructuredData(topicRecord(stats)));
+            }
+        }
+        return CommandResult(CommandResult::Status::Warning, "No subscribers or events for topic: " + args[0]);
+    }
+    for (const eventbus::TopicStats& stats : topics) {
+        if (!context.emit(StructuredData(topicRecord(stats)))) {
+            break;
+        }
+    }
+    return CommandResult(CommandResult::Status::Success, "Event stats for " + std::to_string(topics.size()) + " topic(s).");
+}
+
+// --- core ---
+
+CommandResult CoreStatusCommand::executeWithContext(const std::vector<std::string>& args, cli::CommandContext&) {
+    if (!args.empty()) {
+        return usage(*this);
+    }
+    double uptime = std::chrono::duration<double>(CppCore.getUptime()).count();
+    size_t modules = CppCore.getModuleLoaderSystem()->listModules().size();
+    size_t commands = CppCore.getCLIEngine()->getRegisteredCommands().size();
+    size_t topics = CppCore.getEventBus()->getTopicStats().size();
+    cli::RemoteCLIServer* remote = CppCore.getRemoteCLIServer();
+    LazyModuleActivator* lazy = CppCore.getLazyModuleActivator();
+    size_t lazyPending = lazy ? lazy->getPendingModules().size() : 0;
+
+    Record record = {
+        {"initialized", CppCore.isInitialized()},
+        {"uptime_seconds", uptime},
+        {"modules", modules},
+        {"lazy_modules_pending", lazyPending},
+        {"commands", commands},
+        {"event_topics", topics},
+        {"config_file", CppCore.getConfigurationSystem()->getConfigSource()},
+        {"remote_cli", remote ? remote->getListenUri() : std::string()},
+    };
+    char summary[160];
+    std::snprintf(summary, sizeof(summary), "Core %s, up %.0fs; %zu module(s), %zu command(s).",
+                  CppCore.isInitialized() ? "running" : "not initialized", uptime, modules, commands);
+    return CommandResult(CommandResult::Status::Success, summary, StructuredData(std::move(record)));
+}
+
+} // namespace core
+} // namespace wave
@@ -0,0 +1,244 @@
+#ifndef WAVE_CORE_CORE_COMMANDS_HPP
+#define WAVE_CORE_CORE_COMMANDS_HPP
+
+#include "core/cli/cli_engine.hpp"
+#include "core/configuration/configuration.hpp"
+#include "core/eventbus/eventbus.hpp"
+#include "core/logging/logging.hpp"
+#include "core/moduleloader/module_loader.hpp"
+
+namespace wave {
+namespace core {
+
+class Core;
+
+// Built-in administration commands, registered by Core::initialize under the "module", "config",
+// "log", "eventbus" and "core" command groups. They only use the systems' read and control APIs
+// and return records (std::map<std::string, StructuredData>), one row per item for listings, so
+// every output format and pipeline operator ("module list | grep clip", "--output json") applies.
+
+// Helper base: execute(args) runs executeWithContext with an empty context, like the cli commands.
+class CoreCommand : public cli::ICommand {
+public:
+    cli::CommandResult execute(const std::vector<std::string>& args) override {
+        cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+};
+
+// module load <path|name>
+class ModuleLoadCommand : public CoreCommand {
+public:
+    explicit ModuleLoadCommand(moduleloader::ModuleLoaderSystem& loader) : CppLoader(loader) {}
+    std::string getName() const override { return "module load"; }
+    std::string getHelp() const override {
+        return "module load <path|name> - loads a module library and initializes it; a name is looked up in the search paths.";
+    }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    moduleloader::ModuleLoaderSystem& CppLoader;
+};
+
+// module unload <name>
+class ModuleUnloadCommand : public CoreCommand {
+public:
+    explicit ModuleUnloadCommand(moduleloader::ModuleLoaderSystem& loader) : CppLoader(loader) {}
+    std::string getName() const override { return "module unload"; }
+    std::string getHelp() const override { return "module unload <name> - shuts a module down and unloads its library."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    moduleloader::ModuleLoaderSystem& CppLoader;
+};
+
+// module reload [--hot] <name>
+// --hot swaps in the new version before the old one is shut down (see ModuleLoaderSystem::hotReloadModule).
+class ModuleReloadCommand : public CoreCommand {
+public:
+    explicit ModuleReloadCommand(moduleloader::ModuleLoaderSystem& loader) : CppLoader(loader) {}
+    std::string getName() const override { return "module reload"; }
+    std::string getHelp() const override {
+        return "module reload [--hot] <name> - unloads a module and loads it again from the same path.";
+    }
+    const std::vector<cli::OptionSpec>& getOptions() const override;
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    moduleloader::ModuleLoaderSystem& CppLoader;
+};
+
+// module list
+// One row per loaded module: name, version, path, provides, requires. Cached until a module.* event.
+class ModuleListCommand : public CoreCommand {
+public:
+    explicit ModuleListCommand(moduleloader::ModuleLoaderSystem& loader) : CppLoader(loader) {}
+    std::string getName() const override { return "module list"; }
+    std::string getHelp() const override { return "module list - lists the loaded modules."; }
+    const cli::CachePolicy& getCachePolicy() const override;
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    moduleloader::ModuleLoaderSystem& CppLoader;
+};
+
+// module stats
+// One row per module with its load profile (see moduleloader::ModuleLoadProfile), slowest first:
+// name, open_ms, symbols_ms, create_ms, init_ms, total_ms, rss_delta_kb.
+class ModuleStatsCommand : public CoreCommand {
+public:
+    explicit ModuleStatsCommand(moduleloader::ModuleLoaderSystem& loader) : CppLoader(loader) {}
+    std::string getName() const override { return "module stats"; }
+    std::string getHelp() const override { return "module stats - shows how long each module took to load, slowest first."; }
+    const cli::CachePolicy& getCachePolicy() const override;
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+    // Modules in the order the command lists them.
+    static std::vector<moduleloader::ModuleInfo> slowestFirst(std::vector<moduleloader::ModuleInfo> modules);
+
+private:
+    moduleloader::ModuleLoaderSystem& CppLoader;
+};
+
+// module available
+// One row per library in the module search paths: name, version, path, requires, loaded. Manifests
+// come from the loader's ModuleIndex, so only new or changed libraries are opened. Libraries
+// without a manifest cannot be loaded; they are listed with their file name and an empty version.
+class ModuleAvailableCommand : public CoreCommand {
+public:
+    explicit ModuleAvailableCommand(moduleloader::ModuleLoaderSystem& loader) : CppLoader(loader) {}
+    std::string getName() const override { return "module available"; }
+    std::string getHelp() const override { return "module available - lists the module libraries found in the search paths."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    moduleloader::ModuleLoaderSystem& CppLoader;
+};
+
+// config get <section> [<key>]
+// The raw value of one key, or a record of every key in the section.
+class ConfigGetCommand : public CoreCommand {
+public:
+    explicit ConfigGetCommand(configuration::ConfigurationSystem& config) : CppConfig(config) {}
+    std::string getName() const override { return "config get"; }
+    std::string getHelp() const override { return "config get <section> [<key>] - shows a setting, or all settings of a section."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    configuration::ConfigurationSystem& CppConfig;
+};
+
+// config set <section> <key> <value...>
+// In memory only; words after <key> are joined by single spaces.
+class ConfigSetCommand : public CoreCommand {
+public:
+    explicit ConfigSetCommand(configuration::ConfigurationSystem& config) : CppConfig(config) {}
+    std::string getName() const override { return "config set"; }
+    std::string getHelp() const override { return "config set <section> <key> <value> - changes a setting (not written back to the file)."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    configuration::ConfigurationSystem& CppConfig;
+};
+
+// config reload
+class ConfigReloadCommand : public CoreCommand {
+public:
+    explicit ConfigReloadCommand(configuration::ConfigurationSystem& config) : CppConfig(config) {}
+    std::string getName() const override { return "config reload"; }
+    std::string getHelp() const override { return "config reload - reads the configuration file again."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    configuration::ConfigurationSystem& CppConfig;
+};
+
+// config dump [<section>]
+// One row per setting: section, key, value.
+class ConfigDumpCommand : public CoreCommand {
+public:
+    explicit ConfigDumpCommand(configuration::ConfigurationSystem& config) : CppConfig(config) {}
+    std::string getName() const override { return "config dump"; }
+    std::string getHelp() const override { return "config dump [<section>] - lists every setting, or those of one section."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    configuration::ConfigurationSystem& CppConfig;
+};
+
+// log level [<category> [<level>]]
+// Without arguments, one row per category with an explicit level; with a category, its effective
+// level; with a level too, sets it.
+class LogLevelCommand : public CoreCommand {
+public:
+    explicit LogLevelCommand(logging::LoggingSystem& logger) : CppLogger(logger) {}
+    std::string getName() const override { return "log level"; }
+    std::string getHelp() const override {
+        return "log level [<category> [DEBUG|INFO|WARNING|ERROR|NONE]] - shows or sets log levels.";
+    }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    logging::LoggingSystem& CppLogger;
+};
+
+// log tail [--lines <n>] [--category <name>]
+// The newest log entries kept in memory, oldest first: time, level, category, message.
+class LogTailCommand : public CoreCommand {
+public:
+    explicit LogTailCommand(logging::LoggingSystem& logger) : CppLogger(logger) {}
+    std::string getName() const override { return "log tail"; }
+    std::string getHelp() const override {
+        return "log tail [--lines <n>] [--category <name>] - shows the most recent log entries (default 20).";
+    }
+    const std::vector<cli::OptionSpec>& getOptions() const override;
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    logging::LoggingSystem& CppLogger;
+};
+
+// eventbus topics
+// One row per topic: topic, subscribers.
+class EventBusTopicsCommand : public CoreCommand {
+public:
+    explicit EventBusTopicsCommand(eventbus::EventBus& bus) : CppBus(bus) {}
+    std::string getName() const override { return "eventbus topics"; }
+    std::string getHelp() const override { return "eventbus topics - lists event topics and their subscriber counts."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    eventbus::EventBus& CppBus;
+};
+
+// eventbus stats [<topic>]
+// One row per topic: topic, subscribers, published, sync and async deliveries.
+class EventBusStatsCommand : public CoreCommand {
+public:
+    explicit EventBusStatsCommand(eventbus::EventBus& bus) : CppBus(bus) {}
+    std::string getName() const override { return "eventbus stats"; }
+    std::string getHelp() const override { return "eventbus stats [<topic>] - publish and delivery counts per topic."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    eventbus::EventBus& CppBus;
+};
+
+// core status
+// One record: initialized, uptime, module/lazy module/command/topic counts, config file, remote CLI
+// address.
+class CoreStatusCommand : public CoreCommand {
+public:
+    explicit CoreStatusCommand(Core& core) : CppCore(core) {}
+    std::string getName() const override { return "core status"; }
+    std::string getHelp() const override { return "core status - summary of the core systems."; }
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override;
+
+private:
+    Core& CppCore;
+};
+
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_CORE_COMMANDS_HPP
@@ -18,16 +18,20 @@ EventBus::~EventBus() {
 
 void EventBus::publish(const std::string& eventName, const StructuredData& payload, DeliveryMode mode) {
     std::lock_guard<std::mutex> lock(CppMutex);
+    TopicStats& counters = CppTopicCounters[eventName];
+    ++counters.published;
     auto it = CppSubscribers.find(eventName);
     if (it != CppSubscribers.end()) {
         for (const auto& sub : it->second) {
             if (mode == DeliveryMode::Async && sub.mode == DeliveryMode::Async) {
+                ++counters.asyncDeliveries;
                 // Asynchronous delivery
                 std::thread([callback = sub.callback, payload]() {
                     callback(payload);
                 }).detach(); // Detach the thread to allow it to run independently
             } else {
                 // Synchronous delivery (either publisher or subscriber requested Sync)
+                ++counters.syncDeliveries;
                 sub.callback(payload);
             }
         }
@@ -127,6 +131,21 @@ void EventBus::unsubscribe(SubscriptionId id) {
     }
 }
 
+std::vector<TopicStats> EventBus::getTopicStats() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    std::map<std::string, TopicStats> topics = CppTopicCounters;
+    for (const auto& entry : CppSubscribers) {
+        topics[entry.first].subscribers = entry.second.size();
+    }
+    std::vector<TopicStats> result;
+    result.reserve(topics.size());
+    for (auto& entry : topics) {
+        entry.second.topic = entry.first;
+        result.push_back(std::move(entry.second));
+    }
+    return result;
+}
+
 } // namespace eventbus
 } // namespace core
 } // namespace wave
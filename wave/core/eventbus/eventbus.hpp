@@ -30,6 +30,15 @@ enum class DeliveryMode {
     Async  // Event is delivered asynchronously in a separate thread (or thread pool)
 };
 
+// Per-topic counters reported by EventBus::getTopicStats().
+struct TopicStats {
+    std::string topic;
+    size_t subscribers = 0;
+    uint64_t published = 0;       // publish() calls, including those nobody was subscribed to
+    uint64_t syncDeliveries = 0;  // Callbacks run on the publisher's thread
+    uint64_t asyncDeliveries = 0; // Callbacks handed to a delivery thread
+};
+
 class EventBus {
 public:
     EventBus();
@@ -52,6 +61,9 @@ public:
     // id: The unique ID of the subscription to remove.
     void unsubscribe(SubscriptionId id);
 
+    // Every topic that has subscribers or was published to, sorted by name.
+    std::vector<TopicStats> getTopicStats() const;
+
 private:
     struct Subscription {
         SubscriptionId id;
@@ -61,10 +73,11 @@ private:
         // but current design uses id mapping directly to subscription details.
     };
 
-    std::mutex CppMutex; // Renamed to avoid conflict with potential system macros
+    mutable std::mutex CppMutex; // Renamed to avoid conflict with potential system macros
     std::map<std::string, std::vector<Subscription>> CppSubscribers; // Renamed
     std::map<SubscriptionId, std::pair<std::string, size_t>> CppSubscriptionMap; // Maps ID to (eventName, index in CppSubscribers[eventName]) // Renamed
     std::atomic<SubscriptionId> CppNextSubscriptionId; // Renamed
+    std::map<std::string, TopicStats> CppTopicCounters; // Delivery counters; 'subscribers' is filled in on read
     
     // Helper to find a subscription's details by ID for unsubscribe
     // Returns true if found, and populates eventName and index.
@@ -0,0 +1,216 @@
+#include "hosted_modules.hpp"
+#include "core/cli/input_parser.hpp"
+#include "core/cli/remote_protocol.hpp"
+#include "core/moduleloader/module_host.hpp"
+
+namespace wave {
+namespace core {
+
+namespace {
+// Events waiting for the delivery thread; beyond this, new ones are dropped with a warning.
+const size_t MAX_PENDING_DELIVERIES = 1024;
+
+cli::CommandResult::Status parseStatus(const std::string& status) {
+    if (status == "Success") return cli::CommandResult::Status::Success;
+    if (status == "Warning") return cli::CommandResult::Status::Warning;
+    return cli::CommandResult::Status::Error;
+}
+
+// A command of an isolated module: runs the command line in the module's host and replays the
+// remote protocol frames it answers with. Rows arrive as the host rendered them, as text.
+class HostedCommand : public cli::ICommand {
+public:
+    HostedCommand(moduleloader::ModuleLoaderSystem& loader, std::string moduleName, std::string commandName)
+        : CppLoader(loader), CppModuleName(std::move(moduleName)), CppCommandName(std::move(commandName)) {}
+
+    std::string getName() const override { return CppCommandName; }
+    std::string getHelp() const override {
+        return CppCommandName + " - provided by module " + CppModuleName + " (isolated in a module host).";
+    }
+
+    cli::CommandResult execute(const std::vector<std::string>& args) override {
+        cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override {
+        moduleloader::ModuleLoaderSystem::ModuleRef module = CppLoader.acquireModule(CppModuleName);
+        auto* hosted = dynamic_cast<moduleloader::HostedModule*>(module.get());
+        if (!hosted) {
+            return cli::CommandResult(cli::CommandResult::Status::Error, "Module " + CppModuleName + " is not loaded.");
+        }
+        // No options are declared, so args still hold them as typed and the host parses them.
+        std::string line = CppCommandName;
+        for (const std::string& arg : args) {
+            line += ' ';
+            line += cli::InputParser::quote(arg);
+        }
+        std::string frames, error;
+        if (!hosted->execute(line, frames, error)) {
+            return cli::CommandResult(cli::CommandResult::Status::Error, error);
+        }
+
+        cli::CommandResult result(cli::CommandResult::Status::Error, "Module host sent no status for " + CppCommandName + ".");
+        size_t start = 0;
+        while (start < frames.size()) {
+            size_t end = frames.find('\n', start);
+            if (end == std::string::npos) {
+                end = frames.size();
+            }
+            std::string frame = frames.substr(start, end - start);
+            start = end + 1;
+            if (frame.size() < 2 || frame[1] != ' ') {
+                continue;
+            }
+            std::string payload = cli::unescapeRemotePayload(std::string_view(frame).substr(2));
+            if (frame[0] == cli::REMOTE_FRAME_ROW) {
+                if (!context.emit(payload)) {
+                    break; // The consumer stopped reading
+                }
+            } else if (frame[0] == cli::REMOTE_FRAME_DATA) {
+                result.data = payload;
+            } else if (frame[0] == cli::REMOTE_FRAME_STATUS) {
+                size_t space = payload.find(' ');
+                result.status = parseStatus(payload.substr(0, space));
+                result.message = space == std::string::npos ? std::string() : payload.substr(space + 1);
+            }
+        }
+        return result;
+    }
+
+private:
+    moduleloader::ModuleLoaderSystem& CppLoader;
+    std::string CppModuleName;
+    std::string CppCommandName;
+};
+} // namespace
+
+HostedModuleBridge::HostedModuleBridge(moduleloader::ModuleLoaderSystem& loader, cli::CLIEngine& engine,
+                                       eventbus::EventBus& bus, logging::LoggingSystem& logger)
+    : CppLoader(loader), CppEngine(engine), CppBus(bus), CppLogger(logger) {
+    CppDeliveryThread = std::thread([this]() { deliverEvents(); });
+}
+
+HostedModuleBridge::~HostedModuleBridge() {
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        while (!CppModules.empty()) {
+            remove(CppModules.begin()->first);
+        }
+    }
+    // No subscription can enqueue any more: the bus runs Sync callbacks under the lock that
+    // unsubscribe() takes. A delivery blocked in a host call ends within the host's call timeout.
+    {
+        std::lock_guard<std::mutex> lock(CppDeliveryMutex);
+        CppStopping = true;
+        CppDeliveries.clear();
+    }
+    CppDeliveryReady.notify_all();
+    CppDeliveryThread.join();
+}
+
+void HostedModuleBridge::onModuleEvent(moduleloader::ModuleEventType type, const moduleloader::ModuleInfo& info) {
+    // Runs in the loader's event callback: nothing here may call back into the loader.
+    if (!info.isolation) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (type == moduleloader::ModuleEventType::Loaded) {
+        remove(info.name); // A reload may bring a different manifest
+        install(info);
+    } else if (type == moduleloader::ModuleEventType::Unloaded) {
+        remove(info.name);
+    }
+}
+
+std::vector<std::string> HostedModuleBridge::getBridgedModules() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    std::vector<std::string> names;
+    for (const auto& pair : CppModules) {
+        names.push_back(pair.first);
+    }
+    return names;
+}
+
+void HostedModuleBridge::install(const moduleloader::ModuleInfo& info) {
+    auto* hosted = dynamic_cast<moduleloader::HostedModule*>(info.instance);
+    if (!hosted || !hosted->getManifest()) {
+        return;
+    }
+    const moduleloader::ModuleManifest& manifest = *hosted->getManifest();
+    Bridged& bridged = CppModules[info.name];
+    for (const std::string& command : manifest.commands) {
+        auto forward = std::make_shared<HostedCommand>(CppLoader, info.name, command);
+        CppEngine.registerCommand(command, forward);
+        bridged.commands.emplace_back(command, forward);
+    }
+    // Sync delivery into the bridge's queue: a call into the host may take a while and must not
+    // hold up the publisher, and the bridge's thread, unlike a bus delivery thread, is joined
+    // before the loader and the module go away.
+    for (const std::string& topic : manifest.topics) {
+        std::string moduleName = info.name;
+        bridged.subscriptions.push_back(CppBus.subscribe(
+            topic,
+            [this, moduleName, topic](const eventbus::StructuredData& payload) {
+                if (payload.type() == typeid(std::string)) {
+                    enqueue(Delivery{moduleName, topic, std::any_cast<const std::string&>(payload)});
+                }
+            },
+            eventbus::DeliveryMode::Sync));
+    }
+}
+
+void HostedModuleBridge::enqueue(Delivery delivery) {
+    {
+        std::lock_guard<std::mutex> lock(CppDeliveryMutex);
+        if (CppDeliveries.size() < MAX_PENDING_DELIVERIES) {
+            CppDeliveries.push_back(std::move(delivery));
+            CppDeliveryReady.notify_one();
+            return;
+        }
+    }
+    CppLogger.log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                    "Event " + delivery.topic + " not delivered to module " + delivery.moduleName +
+                                        ": too many events are waiting for module hosts."));
+}
+
+void HostedModuleBridge::deliverEvents() {
+    while (true) {
+        Delivery delivery;
+        {
+            std::unique_lock<std::mutex> lock(CppDeliveryMutex);
+            CppDeliveryReady.wait(lock, [this]() { return CppStopping || !CppDeliveries.empty(); });
+            if (CppStopping) {
+                return;
+            }
+            delivery = std::move(CppDeliveries.front());
+            CppDeliveries.pop_front();
+        }
+        // The module is found anew each time: it may have been unloaded or reloaded meanwhile.
+        moduleloader::ModuleLoaderSystem::ModuleRef module = CppLoader.acquireModule(delivery.moduleName);
+        auto* target = dynamic_cast<moduleloader::HostedModule*>(module.get());
+        std::string error;
+        if (target && !target->publish(delivery.topic, delivery.payload, error)) {
+            CppLogger.log(logging::LogEntry(logging::LogLevel::Warning, "Core",
+                                            "Event " + delivery.topic + " not delivered to module " +
+                                                delivery.moduleName + ": " + error));
+        }
+    }
+}
+
+void HostedModuleBridge::remove(const std::string& moduleName) {
+    auto it = CppModules.find(moduleName);
+    if (it == CppModules.end()) {
+        return;
+    }
+    for (const auto& command : it->second.commands) {
+        CppEngine.unregisterCommand(command.first, *command.second);
+    }
+    for (eventbus::SubscriptionId id : it->second.subscriptions) {
+        CppBus.unsubscribe(id);
+    }
+    CppModules.erase(it);
+}
+
+} // namespace core
+} // namespace wave
@@ -0,0 +1,87 @@
+#ifndef WAVE_CORE_HOSTED_MODULES_HPP
+#define WAVE_CORE_HOSTED_MODULES_HPP
+
+#include "core/cli/cli_engine.hpp"
+#include "core/eventbus/eventbus.hpp"
+#include "core/logging/logging.hpp"
+#include "core/moduleloader/module_loader.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wave {
+namespace core {
+
+// Makes modules running in a module host (marked "isolated" in modules.conf, see
+// moduleloader::HostedModule) reachable from the launcher.
+//
+// An isolated module registers its commands and subscriptions with the core of its host, which the
+// launcher cannot see. For every command in the module's manifest the bridge registers a command
+// of the same name that runs the command line in the host and replays its rows and result. For
+// every topic in the manifest it subscribes on the launcher's EventBus and republishes events in
+// the host; only string payloads can cross, other events are dropped. Nothing travels the other
+// way: events the module publishes stay in its host. Events are queued by the subscription and
+// handed to the hosts, in order, by a delivery thread of the bridge, so a slow host never holds up
+// a publisher; the destructor waits for the delivery in progress and drops the rest.
+//
+// The bridge follows the loader's module events: commands and subscriptions appear when an
+// isolated module is loaded (again, after a reload) and go when it is unloaded.
+class HostedModuleBridge {
+public:
+    HostedModuleBridge(moduleloader::ModuleLoaderSystem& loader, cli::CLIEngine& engine, eventbus::EventBus& bus,
+                       logging::LoggingSystem& logger);
+    // Unregisters every forwarded command and subscription and stops the delivery thread.
+    ~HostedModuleBridge();
+
+    HostedModuleBridge(const HostedModuleBridge&) = delete;
+    HostedModuleBridge& operator=(const HostedModuleBridge&) = delete;
+
+    // Called from the loader's module event callback; ignores modules that are not isolated.
+    void onModuleEvent(moduleloader::ModuleEventType type, const moduleloader::ModuleInfo& info);
+
+    // Names of the isolated modules currently bridged.
+    std::vector<std::string> getBridgedModules() const;
+
+private:
+    struct Bridged {
+        std::vector<std::pair<std::string, std::shared_ptr<cli::ICommand>>> commands;
+        std::vector<eventbus::SubscriptionId> subscriptions;
+    };
+
+    moduleloader::ModuleLoaderSystem& CppLoader;
+    cli::CLIEngine& CppEngine;
+    eventbus::EventBus& CppBus;
+    logging::LoggingSystem& CppLogger;
+
+    mutable std::mutex CppMutex; // Guards CppModules
+    std::map<std::string, Bridged> CppModules;
+
+    // An event on its way to a module host.
+    struct Delivery {
+        std::string moduleName;
+        std::string topic;
+        std::string payload;
+    };
+    std::mutex CppDeliveryMutex; // Guards the three members below
+    std::condition_variable CppDeliveryReady;
+    std::deque<Delivery> CppDeliveries;
+    bool CppStopping = false;
+    std::thread CppDeliveryThread; // Runs deliverEvents(); joined by the destructor
+
+    void install(const moduleloader::ModuleInfo& info);   // Expects CppMutex held
+    void remove(const std::string& moduleName);           // Expects CppMutex held
+    void enqueue(Delivery delivery);                      // Called by the subscriptions
+    void deliverEvents();
+};
+
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_HOSTED_MODULES_HPP
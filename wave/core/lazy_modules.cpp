@@ -0,0 +1,251 @@
+#include "lazy_modules.hpp"
+#include "core/cli/input_parser.hpp"
+
+#include <algorithm>
+
+namespace wave {
+namespace core {
+
+namespace {
+// Stand-in for a command of a lazy module: loads the module, then runs the command line again so
+// it reaches the module's own command (with that command's option parsing).
+class LazyCommand : public cli::ICommand {
+public:
+    LazyCommand(LazyModuleActivator& activator, cli::CLIEngine& engine, std::string moduleName, std::string commandName)
+        : CppActivator(activator), CppEngine(engine), CppModuleName(std::move(moduleName)), CppCommandName(std::move(commandName)) {}
+
+    std::string getName() const override { return CppCommandName; }
+    std::string getHelp() const override {
+        return CppCommandName + " - provided by module " + CppModuleName + " (loaded on first use).";
+    }
+
+    cli::CommandResult execute(const std::vector<std::string>& args) override {
+        cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+
+    cli::CommandResult executeWithContext(const std::vector<std::string>& args, cli::CommandContext& context) override {
+        moduleloader::ModuleResult loaded = CppActivator.activate(CppModuleName);
+        if (loaded.status != moduleloader::ModuleResult::Status::Success) {
+            return cli::CommandResult(cli::CommandResult::Status::Error,
+                                      "Module " + CppModuleName + " could not be loaded: " + loaded.message);
+        }
+        std::shared_ptr<cli::ICommand> real = CppEngine.findCommand(CppCommandName);
+        if (!real || real.get() == this) {
+            return cli::CommandResult(cli::CommandResult::Status::Error,
+                                      "Module " + CppModuleName + " was loaded but did not register '" + CppCommandName + "'.");
+        }
+        // The stand-in declares no options, so args still hold the options as typed ("--output"
+        // excepted, which the engine has taken into context.outputFormat already).
+        std::string line = CppCommandName;
+        for (const std::string& arg : args) {
+            line += ' ';
+            line += cli::InputParser::quote(arg);
+        }
+        return CppEngine.executeCommand(line, context);
+    }
+
+private:
+    LazyModuleActivator& CppActivator;
+    cli::CLIEngine& CppEngine;
+    std::string CppModuleName;
+    std::string CppCommandName;
+};
+} // namespace
+
+LazyModuleActivator::LazyModuleActivator(moduleloader::ModuleLoaderSystem& loader, cli::CLIEngine& engine,
+                                         eventbus::EventBus& bus, logging::LoggingSystem& logger)
+    : CppLoader(loader), CppEngine(engine), CppBus(bus), CppLogger(logger) {}
+
+LazyModuleActivator::~LazyModuleActivator() {
+    std::vector<std::shared_ptr<LazyModule>> modules;
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        CppShuttingDown = true;
+        for (const auto& pair : CppModules) {
+            modules.push_back(pair.second);
+        }
+    }
+    // Once the topic subscriptions are gone no new background activation can start; the stand-in
+    // commands refer to this object and must not outlive it.
+    for (const auto& module : modules) {
+        std::lock_guard<std::mutex> activation(module->activationMutex);
+        if (!module->active) {
+            removeStandIns(*module);
+        }
+    }
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        threads.swap(CppThreads);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool LazyModuleActivator::addModule(const std::string& modulePath, const moduleloader::ModuleManifest& manifest) {
+    if (manifest.commands.empty() && manifest.topics.empty()) {
+        return false;
+    }
+    auto module = std::make_shared<LazyModule>();
+    module->path = modulePath;
+    module->manifest = manifest;
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        if (!CppModules.emplace(manifest.name, module).second) {
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> activation(module->activationMutex);
+    installStandIns(*module);
+    return true;
+}
+
+std::shared_ptr<LazyModuleActivator::LazyModule> LazyModuleActivator::findModule(const std::string& moduleName) const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    auto it = CppModules.find(moduleName);
+    return it == CppModules.end() ? nullptr : it->second;
+}
+
+moduleloader::ModuleResult LazyModuleActivator::activate(const std::string& moduleName) {
+    std::set<std::string> visiting;
+    return activate(moduleName, visiting);
+}
+
+moduleloader::ModuleResult LazyModuleActivator::activate(const std::string& moduleName, std::set<std::string>& visiting) {
+    using moduleloader::ModuleResult;
+    std::shared_ptr<LazyModule> module = findModule(moduleName);
+    if (!module) {
+        return ModuleResult(ModuleResult::Status::NotFound, "No lazy module named " + moduleName);
+    }
+    if (!visiting.insert(moduleName).second) {
+        return ModuleResult(ModuleResult::Status::Error, "Lazy module " + moduleName + " depends on itself.");
+    }
+
+    // Lazy modules providing a requirement are activated first; the loader refuses a module whose
+    // requirements are not loaded. Requirements met by regular modules need nothing here.
+    for (const std::string& requirement : module->manifest.requirements) {
+        std::string provider;
+        {
+            std::lock_guard<std::mutex> lock(CppMutex);
+            for (const auto& pair : CppModules) {
+                const std::vector<std::string>& provides = pair.second->manifest.provides;
+                if (pair.first != moduleName &&
+                    (pair.first == requirement || std::find(provides.begin(), provides.end(), requirement) != provides.end())) {
+                    provider = pair.first;
+                    break;
+                }
+            }
+        }
+        if (provider.empty()) {
+            continue;
+        }
+        ModuleResult result = activate(provider, visiting);
+        if (result.status != ModuleResult::Status::Success) {
+            return ModuleResult(ModuleResult::Status::Error,
+                                "Required module " + provider + " could not be loaded: " + result.message);
+        }
+    }
+
+    std::lock_guard<std::mutex> activation(module->activationMutex);
+    if (module->active) {
+        return ModuleResult(ModuleResult::Status::Success, "Module already loaded.");
+    }
+    // Loaded by other means ("module load") in the meantime.
+    for (const moduleloader::ModuleInfo& info : CppLoader.listModules()) {
+        if (info.name == moduleName) {
+            removeStandIns(*module);
+            module->active = true;
+            return ModuleResult(ModuleResult::Status::Success, "Module already loaded.", info);
+        }
+    }
+
+    // The module registers its own commands under the stand-ins' names, so they go first.
+    removeStandIns(*module);
+    auto start = std::chrono::steady_clock::now();
+    ModuleResult result = CppLoader.loadModule(module->path);
+    if (result.status != ModuleResult::Status::Success) {
+        bool shuttingDown;
+        {
+            std::lock_guard<std::mutex> lock(CppMutex);
+            shuttingDown = CppShuttingDown;
+        }
+        if (!shuttingDown) {
+            installStandIns(*module); // The next use tries again
+        }
+        CppLogger.log(logging::LogEntry(logging::LogLevel::Error, "Core", "Lazy module " + moduleName + " not loaded: " + result.message));
+        return result;
+    }
+    module->active = true;
+    long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    CppLogger.log(logging::LogEntry(logging::LogLevel::Info, "Core",
+                                    "Lazy module " + moduleName + " loaded on first use in " + std::to_string(elapsedMs) + " ms."));
+    return result;
+}
+
+std::vector<std::string> LazyModuleActivator::getPendingModules() const {
+    std::map<std::string, std::shared_ptr<LazyModule>> modules;
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        modules = CppModules;
+    }
+    std::vector<std::string> pending;
+    for (const auto& pair : modules) {
+        std::lock_guard<std::mutex> activation(pair.second->activationMutex);
+        if (!pair.second->active) {
+            pending.push_back(pair.first);
+        }
+    }
+    return pending;
+}
+
+// Both expect module.activationMutex held.
+void LazyModuleActivator::installStandIns(LazyModule& module) {
+    const std::string& moduleName = module.manifest.name;
+    for (const std::string& command : module.manifest.commands) {
+        auto standIn = std::make_shared<LazyCommand>(*this, CppEngine, moduleName, command);
+        CppEngine.registerCommand(command, standIn);
+        module.commands.emplace_back(command, standIn);
+    }
+    // Sync delivery: the callback only hands off to a thread, and unsubscribe() then guarantees
+    // no callback is still running (it takes the bus lock the delivery holds).
+    for (const std::string& topic : module.manifest.topics) {
+        module.subscriptions.push_back(CppBus.subscribe(
+            topic, [this, moduleName](const eventbus::StructuredData&) { activateInBackground(moduleName); },
+            eventbus::DeliveryMode::Sync));
+    }
+}
+
+void LazyModuleActivator::removeStandIns(LazyModule& module) {
+    // A stand-in whose name was taken already was never registered; the check leaves that
+    // command alone.
+    for (const auto& command : module.commands) {
+        CppEngine.unregisterCommand(command.first, *command.second);
+    }
+    module.commands.clear();
+    for (eventbus::SubscriptionId id : module.subscriptions) {
+        CppBus.unsubscribe(id);
+    }
+    module.subscriptions.clear();
+}
+
+void LazyModuleActivator::activateInBackground(const std::string& moduleName) {
+    // Runs inside EventBus::publish with the bus locked: loading here would deadlock as soon as
+    // the module subscribes to something, so the work moves to a thread of its own.
+    std::lock_guard<std::mutex> lock(CppMutex);
+    auto it = CppModules.find(moduleName);
+    if (CppShuttingDown || it == CppModules.end() || it->second->activationStarted) {
+        return;
+    }
+    it->second->activationStarted = true;
+    CppThreads.emplace_back([this, moduleName]() {
+        if (activate(moduleName).status != moduleloader::ModuleResult::Status::Success) {
+            std::lock_guard<std::mutex> retry(CppMutex);
+            CppModules[moduleName]->activationStarted = false; // The next event tries again
+        }
+    });
+}
+
+} // namespace core
+} // namespace wave
@@ -0,0 +1,86 @@
+#ifndef WAVE_CORE_LAZY_MODULES_HPP
+#define WAVE_CORE_LAZY_MODULES_HPP
+
+#include "core/cli/cli_engine.hpp"
+#include "core/eventbus/eventbus.hpp"
+#include "core/logging/logging.hpp"
+#include "core/moduleloader/module_loader.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wave {
+namespace core {
+
+// Loads modules marked "lazy" in modules.conf on first use instead of at startup.
+//
+// For each lazy module the activator registers a stand-in command for every command in the
+// module's manifest and subscribes to every topic it lists. The first call of a stand-in loads the
+// module and runs the same command line against the module's real command. The first event on a
+// topic loads the module on a background thread; that event itself is not replayed to the module
+// (it subscribes during initialize(), after the event was delivered), so topics suit "wake up"
+// notifications rather than events that must not be lost.
+//
+// While a module is being activated its stand-ins are unregistered, so a concurrent caller that
+// resolves the command at that moment gets "Command not found". If loading fails the stand-ins are
+// registered again and the next use retries.
+class LazyModuleActivator {
+public:
+    LazyModuleActivator(moduleloader::ModuleLoaderSystem& loader, cli::CLIEngine& engine, eventbus::EventBus& bus,
+                        logging::LoggingSystem& logger);
+    // Drops the stand-ins and waits for activations running on background threads.
+    ~LazyModuleActivator();
+
+    LazyModuleActivator(const LazyModuleActivator&) = delete;
+    LazyModuleActivator& operator=(const LazyModuleActivator&) = delete;
+
+    // Registers stand-ins for the manifest's commands and topics. Returns false, registering
+    // nothing, if the manifest declares neither (the module could never be activated) or a module
+    // of that name was added already.
+    bool addModule(const std::string& modulePath, const moduleloader::ModuleManifest& manifest);
+
+    // Loads a lazy module now, after the lazy modules providing its requirements. Returns Success
+    // if it is loaded (or was already), NotFound if no lazy module has that name.
+    moduleloader::ModuleResult activate(const std::string& moduleName);
+
+    // Names of lazy modules not activated yet.
+    std::vector<std::string> getPendingModules() const;
+
+private:
+    struct LazyModule {
+        std::string path;
+        moduleloader::ModuleManifest manifest;
+        std::mutex activationMutex; // Serializes activate() per module
+        bool active = false;
+        bool activationStarted = false; // A topic started a background activation
+        std::vector<std::pair<std::string, std::shared_ptr<cli::ICommand>>> commands; // Registered stand-ins
+        std::vector<eventbus::SubscriptionId> subscriptions;
+    };
+
+    moduleloader::ModuleLoaderSystem& CppLoader;
+    cli::CLIEngine& CppEngine;
+    eventbus::EventBus& CppBus;
+    logging::LoggingSystem& CppLogger;
+
+    mutable std::mutex CppMutex; // Guards CppModules and CppThreads, not the modules' state
+    std::map<std::string, std::shared_ptr<LazyModule>> CppModules;
+    std::vector<std::thread> CppThreads; // Topic-triggered activations
+    bool CppShuttingDown = false;         // Set by the destructor: no new stand-ins or activations
+
+    std::shared_ptr<LazyModule> findModule(const std::string& moduleName) const;
+    moduleloader::ModuleResult activate(const std::string& moduleName, std::set<std::string>& visiting);
+    void installStandIns(LazyModule& module);
+    void removeStandIns(LazyModule& module);
+    void activateInBackground(const std::string& moduleName);
+};
+
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_LAZY_MODULES_HPP
@@ -2,6 +2,7 @@
 #include <iostream> // For std::cerr, std::cout
 #include <algorithm> // For std::find_if, not strictly needed with map
 #include <iomanip>   // For std::put_time for formatting time
+#include <cctype>
 
 namespace wave {
 namespace core {
@@ -19,8 +20,19 @@ std::string LoggingSystem::logLevelToString(LogLevel level) {
     }
 }
 
+std::optional<LogLevel> LoggingSystem::logLevelFromString(const std::string& text) {
+    std::string upper = text;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+    if (upper == "DEBUG") return LogLevel::Debug;
+    if (upper == "INFO") return LogLevel::Info;
+    if (upper == "WARNING" || upper == "WARN") return LogLevel::Warning;
+    if (upper == "ERROR") return LogLevel::Error;
+    if (upper == "NONE") return LogLevel::None;
+    return std::nullopt;
+}
+
 LoggingSystem::LoggingSystem()
-    : CppDefaultLogLevel(LogLevel::Info), CppFileLoggingEnabled(false) {
+    : CppDefaultLogLevel(LogLevel::Info), CppFileLoggingEnabled(false), CppRecentCapacity(1000) {
     // Default log level for "default" category is Info.
     CppCategoryLogLevels["default"] = LogLevel::Info;
 }
@@ -147,6 +159,14 @@ void LoggingSystem::log(const LogEntry& entry) {
             outputToFile(entry);
         }
 
+        // Keep it for "log tail"
+        if (CppRecentCapacity > 0) {
+            if (CppRecentEntries.size() >= CppRecentCapacity) {
+                CppRecentEntries.pop_front();
+            }
+            CppRecentEntries.push_back(entry);
+        }
+
         // Broadcast to subscribers
         broadcastLogEvent(entry);
     }
@@ -178,6 +198,40 @@ LogLevel LoggingSystem::getLogLevel(const std::string& category) const {
     return CppDefaultLogLevel; 
 }
 
+std::map<std::string, LogLevel> LoggingSystem::getLogLevels() const {
+    std::lock_guard<std::mutex> lock(CppLogMutex);
+    return CppCategoryLogLevels;
+}
+
+std::vector<LogEntry> LoggingSystem::getRecentEntries(size_t maxCount, const std::string& category) const {
+    std::lock_guard<std::mutex> lock(CppLogMutex);
+    std::vector<LogEntry> entries;
+    // Walk backwards so only the requested number of matches is copied.
+    for (auto it = CppRecentEntries.rbegin(); it != CppRecentEntries.rend(); ++it) {
+        if (maxCount > 0 && entries.size() >= maxCount) {
+            break;
+        }
+        if (category.empty() || it->category == category) {
+            entries.push_back(*it);
+        }
+    }
+    std::reverse(entries.begin(), entries.end());
+    return entries;
+}
+
+void LoggingSystem::setRecentEntryCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(CppLogMutex);
+    CppRecentCapacity = capacity;
+    while (CppRecentEntries.size() > CppRecentCapacity) {
+        CppRecentEntries.pop_front();
+    }
+}
+
+size_t LoggingSystem::getRecentEntryCapacity() const {
+    std::lock_guard<std::mutex> lock(CppLogMutex);
+    return CppRecentCapacity;
+}
+
 void LoggingSystem::subscribeToLogEvents(LogEventCallback callback) {
     std::lock_guard<std::mutex> lock(CppLogMutex);
     CppLogEventCallbacks.push_back(callback);
@@ -12,6 +12,8 @@
 #include <fstream>  // For file output
 #include <sstream>  // For formatting log messages
 #include <iomanip>  // For std::put_time
+#include <deque>    // Recent entries kept for "log tail"
+#include <optional>
 
 namespace wave {
 namespace core {
@@ -71,8 +73,20 @@ public:
     // Disables file logging.
     void disableFileLogging();
 
+    // Every category with an explicitly set level, including "default".
+    std::map<std::string, LogLevel> getLogLevels() const;
+
+    // The newest entries that passed their category's level, oldest first. At most maxCount
+    // entries are returned (0 = all kept); a non-empty category selects only that category.
+    // The system keeps the last getRecentEntryCapacity() entries (default 1000, 0 disables).
+    std::vector<LogEntry> getRecentEntries(size_t maxCount, const std::string& category = "") const;
+    void setRecentEntryCapacity(size_t capacity);
+    size_t getRecentEntryCapacity() const;
+
     // Helper to convert LogLevel to string
     static std::string logLevelToString(LogLevel level);
+    // Inverse of logLevelToString, case-insensitive; "WARN" is accepted for Warning.
+    static std::optional<LogLevel> logLevelFromString(const std::string& text);
 
 private:
     mutable std::mutex CppLogMutex; // Renamed, made mutable for const getLogLevel
@@ -81,6 +95,8 @@ private:
     std::vector<LogEventCallback> CppLogEventCallbacks; // Renamed
     std::ofstream CppLogFileStream; // Renamed
     bool CppFileLoggingEnabled; // Renamed
+    std::deque<LogEntry> CppRecentEntries; // Bounded by CppRecentCapacity
+    size_t CppRecentCapacity;
 
     void outputToConsole(const LogEntry& entry) const;
     void outputToFile(const LogEntry& entry);
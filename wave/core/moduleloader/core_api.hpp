@@ -0,0 +1,90 @@
+#ifndef WAVE_CORE_MODULELOADER_CORE_API_HPP
+#define WAVE_CORE_MODULELOADER_CORE_API_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Core API: what a module gets from the core. ILauncherModule::initialize receives a pointer to
+// the core's WaveCoreApi, a table of plain C function pointers, valid until the module's
+// shutdown() returns:
+//
+//   void Database::initialize(const WaveCoreApi* core) {
+//       CppBus = wave::core::moduleloader::coreService<wave::core::eventbus::EventBus>(core, WAVE_SERVICE_EVENTBUS);
+//       if (WAVE_CORE_API_HAS(core, log)) {
+//           core->log(core->context, WAVE_LOG_INFO, "Database", "initialized");
+//       }
+//   }
+//
+// Core services are looked up by name. getService() returns the service object itself, so a module
+// calls it directly, with no cast through a common base class and no RTTI shared across the
+// library boundary. A service the core does not have (a module host has no module loader), or has
+// only in a version older than the module asks for, comes back as nullptr; serviceVersion() asks
+// without fetching. The objects behind the C++ services (EventBus, LoggingSystem, ...) are C++
+// classes, so modules using them must be built with a compatible compiler; log() needs nothing
+// but C.
+//
+// Compatibility: the table only grows. A core fills in 'size' with sizeof(WaveCoreApi) as it was
+// built, so a module built against newer headers checks WAVE_CORE_API_HAS before calling a
+// function an older core may not have, and a module built against older headers just never looks
+// past the fields it knows. Services are versioned the same way, each on its own: a service's
+// version goes up when it changes incompatibly, and getService(name, minVersion) lets a module
+// ask for what it was built against.
+//
+// Versions: 1 = serviceVersion, getService, log.
+
+#define WAVE_CORE_API_VERSION 1u
+
+// Services of the launcher core, with the version of each that this header describes.
+#define WAVE_SERVICE_LOGGING "wave.logging"             // wave::core::logging::LoggingSystem
+#define WAVE_SERVICE_CONFIGURATION "wave.configuration" // wave::core::configuration::ConfigurationSystem
+#define WAVE_SERVICE_EVENTBUS "wave.eventbus"           // wave::core::eventbus::EventBus
+#define WAVE_SERVICE_CLI "wave.cli"                     // wave::core::cli::CLIEngine
+#define WAVE_SERVICE_MODULE_LOADER "wave.moduleloader"  // wave::core::moduleloader::ModuleLoaderSystem
+#define WAVE_SERVICE_VERSION 1u
+
+// Levels for WaveCoreApi::log, in the order of wave::core::logging::LogLevel.
+#define WAVE_LOG_DEBUG 0u
+#define WAVE_LOG_INFO 1u
+#define WAVE_LOG_WARNING 2u
+#define WAVE_LOG_ERROR 3u
+
+// True if 'api' is set and has the function 'field'.
+#define WAVE_CORE_API_HAS(api, field) \
+    ((api) != NULL && (api)->size >= offsetof(struct WaveCoreApi, field) + sizeof((api)->field) && (api)->field != NULL)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct WaveCoreApi {
+    uint32_t apiVersion;  // WAVE_CORE_API_VERSION the core was built against
+    uint32_t size;        // sizeof(struct WaveCoreApi) in the core's build
+    void* context;        // Passed back as the first argument of every function
+    // Version 1
+    uint32_t (*serviceVersion)(void* context, const char* name);             // 0 if there is no such service
+    void* (*getService)(void* context, const char* name, uint32_t minVersion); // nullptr if absent or older
+    void (*log)(void* context, uint32_t level, const char* source, const char* message);
+};
+
+#ifdef __cplusplus
+}
+
+namespace wave {
+namespace core {
+namespace moduleloader {
+
+// Typed getService(): nullptr if 'core' is null or lacks the service (in at least 'minVersion').
+template <typename Service>
+Service* coreService(const WaveCoreApi* core, const char* name, uint32_t minVersion = WAVE_SERVICE_VERSION) {
+    if (!WAVE_CORE_API_HAS(core, getService)) {
+        return nullptr;
+    }
+    return static_cast<Service*>(core->getService(core->context, name, minVersion));
+}
+
+} // namespace moduleloader
+} // namespace core
+} // namespace wave
+#endif
+
+#endif // WAVE_CORE_MODULELOADER_CORE_API_HPP
@@ -0,0 +1,88 @@
+#include "core_services.hpp"
+
+namespace wave {
+namespace core {
+namespace moduleloader {
+
+namespace {
+// The WaveCoreApi functions; 'context' is the CoreServiceRegistry. Nothing may throw across them.
+uint32_t apiServiceVersion(void* context, const char* name) {
+    if (!name) {
+        return 0;
+    }
+    try {
+        return static_cast<const CoreServiceRegistry*>(context)->serviceVersion(name);
+    } catch (...) {
+        return 0;
+    }
+}
+
+void* apiGetService(void* context, const char* name, uint32_t minVersion) {
+    if (!name) {
+        return nullptr;
+    }
+    try {
+        return static_cast<const CoreServiceRegistry*>(context)->getService(name, minVersion);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void apiLog(void* context, uint32_t level, const char* source, const char* message) {
+    try {
+        static_cast<const CoreServiceRegistry*>(context)->log(level, source ? source : "", message ? message : "");
+    } catch (...) {
+        // Dropped
+    }
+}
+} // namespace
+
+CoreServiceRegistry::CoreServiceRegistry() {
+    CppApi.apiVersion = WAVE_CORE_API_VERSION;
+    CppApi.size = sizeof(WaveCoreApi);
+    CppApi.context = this;
+    CppApi.serviceVersion = apiServiceVersion;
+    CppApi.getService = apiGetService;
+    CppApi.log = apiLog;
+}
+
+void CoreServiceRegistry::setService(const std::string& name, void* service, uint32_t version) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (service) {
+        CppServices[name] = Service{service, version};
+    } else {
+        CppServices.erase(name);
+    }
+}
+
+void CoreServiceRegistry::setLogFunction(LogFunction log) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppLog = std::move(log);
+}
+
+uint32_t CoreServiceRegistry::serviceVersion(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    auto it = CppServices.find(name);
+    return it == CppServices.end() ? 0 : it->second.version;
+}
+
+void* CoreServiceRegistry::getService(const std::string& name, uint32_t minVersion) const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    auto it = CppServices.find(name);
+    return it == CppServices.end() || it->second.version < minVersion ? nullptr : it->second.object;
+}
+
+void CoreServiceRegistry::log(uint32_t level, const std::string& source, const std::string& message) const {
+    LogFunction log;
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        log = CppLog;
+    }
+    if (log) {
+        log(level, source, message);
+    }
+}
+
+} // namespace moduleloader
+} // namespace core
+} // namespace wave
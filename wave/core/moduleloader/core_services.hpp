@@ -0,0 +1,56 @@
+#ifndef WAVE_CORE_MODULELOADER_CORE_SERVICES_HPP
+#define WAVE_CORE_MODULELOADER_CORE_SERVICES_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "core_api.hpp"
+
+namespace wave {
+namespace core {
+namespace moduleloader {
+
+// The core's side of WaveCoreApi (core_api.hpp): the services a core offers its modules, and the
+// table that hands them out. The Core registers its systems here and passes api() to the
+// ModuleLoaderSystem, which gives it to every module's initialize(); a module host does the same
+// with its own. Thread-safe; the table is valid for the lifetime of the registry.
+class CoreServiceRegistry {
+public:
+    using LogFunction = std::function<void(uint32_t level, const std::string& source, const std::string& message)>;
+
+    CoreServiceRegistry();
+    CoreServiceRegistry(const CoreServiceRegistry&) = delete;
+    CoreServiceRegistry& operator=(const CoreServiceRegistry&) = delete;
+
+    // Offers 'service' under 'name' in 'version', replacing a service of that name; nullptr
+    // withdraws it.
+    void setService(const std::string& name, void* service, uint32_t version = WAVE_SERVICE_VERSION);
+    // Where WaveCoreApi::log goes; without one, messages are dropped.
+    void setLogFunction(LogFunction log);
+
+    uint32_t serviceVersion(const std::string& name) const;
+    void* getService(const std::string& name, uint32_t minVersion) const;
+    void log(uint32_t level, const std::string& source, const std::string& message) const;
+
+    const WaveCoreApi* api() const { return &CppApi; }
+
+private:
+    struct Service {
+        void* object = nullptr;
+        uint32_t version = 0;
+    };
+
+    WaveCoreApi CppApi;
+    mutable std::mutex CppMutex; // Guards the members below
+    std::map<std::string, Service> CppServices;
+    LogFunction CppLog;
+};
+
+} // namespace moduleloader
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_MODULELOADER_CORE_SERVICES_HPP
@@ -0,0 +1,484 @@
+#include "module_host.hpp"
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace wave {
+namespace core {
+namespace moduleloader {
+
+#ifdef __linux__
+struct ModuleHostChannel::Shared {
+    sem_t request; // Posted by the launcher when a request is in 'data'
+    sem_t reply;   // Posted by the host when its reply is in 'data'
+    uint32_t type;
+    uint64_t length;
+    uint64_t capacity;
+    char data[1]; // 'capacity' bytes
+};
+#else
+struct ModuleHostChannel::Shared {};
+#endif
+
+namespace {
+const char* requestName(HostRequest type) {
+    switch (type) {
+    case HostRequest::Describe: return "describe";
+    case HostRequest::Initialize: return "initialize()";
+    case HostRequest::Shutdown: return "shutdown()";
+    case HostRequest::ExportState: return "exportState()";
+    case HostRequest::ImportState: return "importState()";
+    case HostRequest::Execute: return "a command";
+    case HostRequest::Publish: return "an event";
+    default: return "exit";
+    }
+}
+
+std::string joinNames(const std::vector<std::string>& names) {
+    std::string joined;
+    for (const auto& name : names) {
+        joined += (joined.empty() ? "" : ",") + name;
+    }
+    return joined;
+}
+
+std::vector<std::string> splitText(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+std::vector<std::string> splitNames(const std::string& joined) {
+    std::vector<std::string> names;
+    for (const auto& name : splitText(joined, ',')) {
+        if (!name.empty()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+// How long the destructor waits for a host to exit after the Exit request.
+const std::chrono::milliseconds HOST_EXIT_TIMEOUT(2000);
+} // namespace
+
+std::unique_ptr<ModuleHostChannel> ModuleHostChannel::create(size_t capacity, std::string& error) {
+#ifdef __linux__
+    int fd = memfd_create("wave-module-host", MFD_CLOEXEC);
+    size_t bytes = offsetof(Shared, data) + capacity;
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        error = std::string("Cannot create the module host channel: ") + std::strerror(errno);
+        if (fd >= 0) close(fd);
+        return nullptr;
+    }
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        error = std::string("Cannot map the module host channel: ") + std::strerror(errno);
+        close(fd);
+        return nullptr;
+    }
+    Shared* shared = static_cast<Shared*>(memory);
+    sem_init(&shared->request, 1, 0);
+    sem_init(&shared->reply, 1, 0);
+    shared->type = 0;
+    shared->length = 0;
+    shared->capacity = capacity;
+    return std::unique_ptr<ModuleHostChannel>(new ModuleHostChannel(fd, shared, bytes, capacity));
+#else
+    (void)capacity;
+    error = "Isolated modules are not supported on this platform.";
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<ModuleHostChannel> ModuleHostChannel::attach(int fd, std::string& error) {
+#ifdef __linux__
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < offsetof(Shared, data)) {
+        error = "Not a module host channel: file descriptor " + std::to_string(fd);
+        return nullptr;
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        error = std::string("Cannot map the module host channel: ") + std::strerror(errno);
+        return nullptr;
+    }
+    Shared* shared = static_cast<Shared*>(memory);
+    if (offsetof(Shared, data) + shared->capacity != bytes) {
+        munmap(memory, bytes);
+        error = "Not a module host channel: file descriptor " + std::to_string(fd);
+        return nullptr;
+    }
+    return std::unique_ptr<ModuleHostChannel>(new ModuleHostChannel(fd, shared, bytes, bytes - offsetof(Shared, data)));
+#else
+    (void)fd;
+    error = "Isolated modules are not supported on this platform.";
+    return nullptr;
+#endif
+}
+
+ModuleHostChannel::~ModuleHostChannel() {
+#ifdef __linux__
+    munmap(CppShared, CppMappedBytes);
+    close(CppFd);
+#endif
+}
+
+bool ModuleHostChannel::call(const HostMessage& request, HostMessage& reply, std::chrono::milliseconds timeout,
+                             const std::function<bool()>& alive, std::string& error) {
+#ifdef __linux__
+    if (request.payload.size() > CppCapacity) {
+        error = "Request too large for the module host channel.";
+        return false;
+    }
+    CppShared->type = request.type;
+    CppShared->length = request.payload.size();
+    std::memcpy(CppShared->data, request.payload.data(), request.payload.size());
+    sem_post(&CppShared->request);
+
+    // Waits in short steps, so a host that dies is noticed right away rather than at the timeout.
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += 20 * 1000 * 1000;
+        if (until.tv_nsec >= 1000 * 1000 * 1000) {
+            until.tv_sec += 1;
+            until.tv_nsec -= 1000 * 1000 * 1000;
+        }
+        if (sem_timedwait(&CppShared->reply, &until) == 0) {
+            // The host writes type and length; a length past the mapping is cut to what it holds.
+            uint64_t length = CppShared->length;
+            reply.type = CppShared->type;
+            reply.payload.assign(CppShared->data, static_cast<size_t>(std::min<uint64_t>(length, CppCapacity)));
+            return true;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (!alive()) {
+            error = "Module host exited.";
+            return false;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            error = "Module host did not answer in time.";
+            return false;
+        }
+    }
+#else
+    (void)request;
+    (void)reply;
+    (void)timeout;
+    (void)alive;
+    error = "Isolated modules are not supported on this platform.";
+    return false;
+#endif
+}
+
+bool ModuleHostChannel::receive(HostMessage& request) {
+#ifdef __linux__
+    while (sem_wait(&CppShared->request) != 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    uint64_t length = CppShared->length;
+    request.type = CppShared->type;
+    request.payload.assign(CppShared->data, static_cast<size_t>(std::min<uint64_t>(length, CppCapacity)));
+    return true;
+#else
+    (void)request;
+    return false;
+#endif
+}
+
+bool ModuleHostChannel::reply(const HostMessage& reply) {
+#ifdef __linux__
+    HostMessage tooLarge{static_cast<uint32_t>(HostReply::Failed), "Reply too large for the module host channel."};
+    const HostMessage& sent = reply.payload.size() > CppCapacity ? tooLarge : reply;
+    CppShared->type = sent.type;
+    CppShared->length = sent.payload.size();
+    std::memcpy(CppShared->data, sent.payload.data(), sent.payload.size());
+    return sem_post(&CppShared->reply) == 0;
+#else
+    (void)reply;
+    return false;
+#endif
+}
+
+std::string encodeHostDescription(const std::string& name, const std::string& version,
+                                  const std::optional<ModuleManifest>& manifest) {
+    const ModuleManifest none;
+    const ModuleManifest& m = manifest ? *manifest : none;
+    return name + "\n" + version + "\n" + std::to_string(manifest ? m.abiVersion : 0) + "\n" + m.name + "\n" + m.version +
+           "\n" + joinNames(m.provides) + "\n" + joinNames(m.requirements) + "\n" + joinNames(m.commands) + "\n" +
+           joinNames(m.topics);
+}
+
+bool decodeHostDescription(const std::string& text, std::string& name, std::string& version,
+                           std::optional<ModuleManifest>& manifest) {
+    std::vector<std::string> fields = splitText(text, '\n');
+    fields.resize(9); // getline drops trailing empty fields
+    if (fields[0].empty()) {
+        return false;
+    }
+    name = fields[0];
+    version = fields[1];
+    manifest.reset();
+    unsigned long abiVersion = 0;
+    try {
+        abiVersion = std::stoul(fields[2]);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (abiVersion > 0) {
+        ModuleManifest m;
+        m.abiVersion = static_cast<unsigned>(abiVersion);
+        m.name = fields[3];
+        m.version = fields[4];
+        m.provides = splitNames(fields[5]);
+        m.requirements = splitNames(fields[6]);
+        m.commands = splitNames(fields[7]);
+        m.topics = splitNames(fields[8]);
+        manifest = m;
+    }
+    return true;
+}
+
+// --- HostedModule ---
+
+std::unique_ptr<HostedModule> HostedModule::start(const std::string& libraryPath, const IsolationOptions& options,
+                                                  std::string& error) {
+    std::unique_ptr<HostedModule> module(new HostedModule(libraryPath, options));
+    std::lock_guard<std::mutex> lock(module->CppMutex);
+    std::string description;
+    if (!module->spawnHost(error) || module->exchange(HostRequest::Describe, "", description, error) != Outcome::Ok) {
+        return nullptr;
+    }
+    if (!decodeHostDescription(description, module->CppName, module->CppVersion, module->CppManifest)) {
+        error = "Module host sent an unreadable description of " + libraryPath + ".";
+        return nullptr;
+    }
+    return module;
+}
+
+HostedModule::~HostedModule() {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (!hostAlive()) {
+        stopHost();
+        return;
+    }
+#ifdef __linux__
+    std::string reply, error;
+    HostMessage answer;
+    CppChannel->call(HostMessage{static_cast<uint32_t>(HostRequest::Exit), ""}, answer, HOST_EXIT_TIMEOUT,
+                     [this]() { return hostAlive(); }, error);
+    auto deadline = std::chrono::steady_clock::now() + HOST_EXIT_TIMEOUT;
+    while (hostAlive() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+#endif
+    stopHost();
+}
+
+bool HostedModule::spawnHost(std::string& error) {
+#ifdef __linux__
+    CppChannel = ModuleHostChannel::create(ModuleHostChannel::DEFAULT_CAPACITY, error);
+    if (!CppChannel) {
+        return false;
+    }
+    // Everything the child needs is prepared before fork(): after it, only exec is safe.
+    int fd = CppChannel->fd();
+    std::vector<std::string> args = {CppOptions.hostExecutable, "--channel", std::to_string(fd), "--memory-limit",
+                                     std::to_string(CppOptions.memoryLimitBytes), CppLibraryPath};
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        fcntl(fd, F_SETFD, 0); // Keep the channel open across exec
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    if (pid < 0) {
+        error = std::string("Cannot start a module host: ") + std::strerror(errno);
+        CppChannel.reset();
+        return false;
+    }
+    CppPid = pid;
+    CppExitReason.clear();
+    return true;
+#else
+    error = "Isolated modules are not supported on this platform.";
+    return false;
+#endif
+}
+
+bool HostedModule::hostAlive() {
+#ifdef __linux__
+    if (CppPid <= 0) {
+        return false;
+    }
+    int status = 0;
+    pid_t result = waitpid(CppPid, &status, WNOHANG);
+    if (result == 0) {
+        return true;
+    }
+    if (result == CppPid && WIFSIGNALED(status)) {
+        CppExitReason = "was killed by signal " + std::to_string(WTERMSIG(status)) + " (" + strsignal(WTERMSIG(status)) + ")";
+    } else if (result == CppPid && WEXITSTATUS(status) == 127) {
+        CppExitReason = "could not be started (" + CppOptions.hostExecutable + ")";
+    } else if (result == CppPid) {
+        CppExitReason = "exited with status " + std::to_string(WEXITSTATUS(status));
+    } else {
+        CppExitReason = "is gone";
+    }
+    CppPid = -1;
+#endif
+    return false;
+}
+
+void HostedModule::stopHost() {
+#ifdef __linux__
+    if (CppPid > 0) {
+        kill(CppPid, SIGKILL);
+        waitpid(CppPid, nullptr, 0);
+        CppPid = -1;
+    }
+#endif
+    CppChannel.reset();
+}
+
+HostedModule::Outcome HostedModule::exchange(HostRequest type, const std::string& payload, std::string& reply,
+                                             std::string& error) {
+    HostMessage answer;
+    std::string channelError;
+    if (!CppChannel || !CppChannel->call(HostMessage{static_cast<uint32_t>(type), payload}, answer, CppOptions.callTimeout,
+                                         [this]() { return hostAlive(); }, channelError)) {
+        // A host that stopped answering is treated as crashed.
+        std::string reason = hostAlive() ? "did not answer within " + std::to_string(CppOptions.callTimeout.count()) + " ms"
+                                         : (CppExitReason.empty() ? "is not running" : CppExitReason);
+        stopHost();
+        error = "Module host of " + (CppName.empty() ? CppLibraryPath : CppName) + " " + reason + " during " +
+                requestName(type) + ".";
+        return Outcome::Lost;
+    }
+    if (answer.type != static_cast<uint32_t>(HostReply::Ok)) {
+        error = answer.payload;
+        return Outcome::Failed;
+    }
+    reply = std::move(answer.payload);
+    return Outcome::Ok;
+}
+
+bool HostedModule::restartHost(std::string& error) {
+    if (CppRestarts >= CppOptions.maxRestarts) {
+        error = "Module " + CppName + " stays down after " + std::to_string(CppRestarts) + " restart(s) of its host.";
+        return false;
+    }
+    ++CppRestarts;
+    stopHost();
+    std::string description;
+    if (!spawnHost(error) || exchange(HostRequest::Describe, "", description, error) != Outcome::Ok) {
+        return false;
+    }
+    if (CppInitialized && exchange(HostRequest::Initialize, "", description, error) != Outcome::Ok) {
+        return false;
+    }
+    return true;
+}
+
+bool HostedModule::request(HostRequest type, const std::string& payload, std::string& reply, std::string& error) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (!hostAlive() && !restartHost(error)) {
+        // The host died between calls and cannot come back.
+        return false;
+    }
+    Outcome outcome = exchange(type, payload, reply, error);
+    if (outcome == Outcome::Lost) {
+        // Bring the module back for the next call; this one is not retried, it may be what crashed.
+        std::string restartError;
+        error += restartHost(restartError) ? " The host was restarted." : " " + restartError;
+    }
+    return outcome == Outcome::Ok;
+}
+
+void HostedModule::initialize(const WaveCoreApi*) {
+    std::string reply, error;
+    if (!request(HostRequest::Initialize, "", reply, error)) {
+        throw std::runtime_error(error);
+    }
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppInitialized = true;
+}
+
+void HostedModule::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        CppInitialized = false;
+    }
+    std::string reply, error;
+    if (!request(HostRequest::Shutdown, "", reply, error)) {
+        throw std::runtime_error(error);
+    }
+}
+
+std::string HostedModule::exportState() {
+    std::string state, error;
+    if (!request(HostRequest::ExportState, "", state, error)) {
+        throw std::runtime_error(error);
+    }
+    return state;
+}
+
+void HostedModule::importState(const std::string& state) {
+    std::string reply, error;
+    if (!request(HostRequest::ImportState, state, reply, error)) {
+        throw std::runtime_error(error);
+    }
+}
+
+bool HostedModule::execute(const std::string& commandLine, std::string& frames, std::string& error) {
+    return request(HostRequest::Execute, commandLine, frames, error);
+}
+
+bool HostedModule::publish(const std::string& topic, const std::string& payload, std::string& error) {
+    std::string reply;
+    return request(HostRequest::Publish, topic + "\n" + payload, reply, error);
+}
+
+int HostedModule::getHostPid() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppPid;
+}
+
+unsigned HostedModule::getRestarts() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppRestarts;
+}
+
+} // namespace moduleloader
+} // namespace core
+} // namespace wave
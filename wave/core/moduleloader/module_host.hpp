@@ -0,0 +1,166 @@
+#ifndef WAVE_CORE_MODULELOADER_MODULE_HOST_HPP
+#define WAVE_CORE_MODULELOADER_MODULE_HOST_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "module_loader.hpp"
+
+namespace wave {
+namespace core {
+namespace moduleloader {
+
+// Out-of-process modules.
+//
+// A module loaded with ModuleLoaderSystem::loadIsolatedModule runs in a module host: a child
+// process (wave/module_host.cpp) that opens the library and creates the module against a core of
+// its own (logging, configuration, EventBus and CLIEngine, all local to the host). The launcher
+// talks to it over a ModuleHostChannel and sees the module through a HostedModule, which forwards
+// the ILauncherModule calls. Commands and topics the module declares in its manifest are forwarded
+// as well (see HostedModuleBridge in core/hosted_modules.hpp); anything the module publishes on its
+// own EventBus stays in the host.
+
+// Requests from the launcher to a module host. Each gets exactly one reply: HostReply::Ok, with
+// the payload noted here, or HostReply::Failed with an error message.
+enum class HostRequest : uint32_t {
+    Describe = 1, // -> encodeHostDescription() of the module
+    Initialize,   // ILauncherModule::initialize with the host's core
+    Shutdown,     // ILauncherModule::shutdown
+    ExportState,  // -> the state
+    ImportState,  // payload: the state
+    Execute,      // payload: a command line for the host's CLIEngine -> remote protocol frames (remote_protocol.hpp)
+    Publish,      // payload: "<topic>\n<string payload>", published synchronously on the host's EventBus
+    Exit          // The host destroys the module, replies and exits
+};
+
+enum class HostReply : uint32_t {
+    Ok = 100,
+    Failed
+};
+
+struct HostMessage {
+    uint32_t type = 0;
+    std::string payload;
+};
+
+// Shared memory between the launcher and one module host: an anonymous memory file holding one
+// message buffer and two process-shared semaphores. Strictly request and reply: the launcher
+// writes a request into the buffer and posts 'request'; the host reads it, writes its reply into
+// the same buffer and posts 'reply'. Callers of call() must serialize; HostedModule does.
+// Messages larger than the buffer are refused. Linux only: create() fails elsewhere.
+class ModuleHostChannel {
+public:
+    static const size_t DEFAULT_CAPACITY = 1024 * 1024;
+
+    // Launcher side: a new channel. fd() is inherited by the host across exec.
+    static std::unique_ptr<ModuleHostChannel> create(size_t capacity, std::string& error);
+    // Host side: maps the channel the launcher passed down.
+    static std::unique_ptr<ModuleHostChannel> attach(int fd, std::string& error);
+    ~ModuleHostChannel();
+
+    ModuleHostChannel(const ModuleHostChannel&) = delete;
+    ModuleHostChannel& operator=(const ModuleHostChannel&) = delete;
+
+    int fd() const { return CppFd; }
+
+    // Launcher: sends 'request' and waits for the reply. Fails, with 'error' set, after 'timeout'
+    // or as soon as 'alive' returns false; it is asked every few milliseconds while waiting.
+    bool call(const HostMessage& request, HostMessage& reply, std::chrono::milliseconds timeout,
+              const std::function<bool()>& alive, std::string& error);
+
+    // Host: waits for the next request, and answers it.
+    bool receive(HostMessage& request);
+    bool reply(const HostMessage& reply);
+
+private:
+    struct Shared;
+    ModuleHostChannel(int fd, Shared* shared, size_t mappedBytes, size_t capacity)
+        : CppFd(fd), CppShared(shared), CppMappedBytes(mappedBytes), CppCapacity(capacity) {}
+
+    int CppFd;
+    Shared* CppShared; // Writable by the other process: lengths read from it are clamped
+    size_t CppMappedBytes;
+    size_t CppCapacity; // Bytes of message data the mapping holds; never read back from CppShared
+};
+
+// The module description a host sends for HostRequest::Describe: one field per line (name,
+// version, manifest ABI version with 0 for none, manifest name and version, then provides,
+// requirements, commands and topics, comma-separated).
+std::string encodeHostDescription(const std::string& name, const std::string& version,
+                                  const std::optional<ModuleManifest>& manifest);
+bool decodeHostDescription(const std::string& text, std::string& name, std::string& version,
+                           std::optional<ModuleManifest>& manifest);
+
+// The launcher's side of a module running in a module host.
+//
+// Every call is a request to the host and waits for its reply; calls are serialized. A call that
+// fails because the host crashed, was killed for exceeding its memory limit, or hung past
+// IsolationOptions::callTimeout throws (initialize) or reports an error; the host is then
+// started again and, if the module had been initialized, initialized again, so the module is back
+// for the next call. The state of the crashed instance is lost. After maxRestarts restarts the
+// module stays down and every call fails.
+class HostedModule : public ILauncherModule {
+public:
+    // Starts a host for the library and reads the module's description from it. Returns nullptr,
+    // with 'error' set, if the host cannot be started or cannot create the module.
+    static std::unique_ptr<HostedModule> start(const std::string& libraryPath, const IsolationOptions& options,
+                                               std::string& error);
+    ~HostedModule() override; // Ends the host: Exit, then SIGKILL if it does not exit in time
+
+    void initialize(const WaveCoreApi* core) override; // The host passes its own core; 'core' is not used
+    void shutdown() override;
+    std::string getName() const override { return CppName; }
+    std::string getVersion() const override { return CppVersion; }
+    std::string exportState() override;
+    void importState(const std::string& state) override;
+
+    const std::optional<ModuleManifest>& getManifest() const { return CppManifest; }
+    // Runs a command line in the host's CLIEngine; 'frames' receives the result as remote protocol
+    // frames.
+    bool execute(const std::string& commandLine, std::string& frames, std::string& error);
+    // Publishes a string payload on the host's EventBus.
+    bool publish(const std::string& topic, const std::string& payload, std::string& error);
+
+    int getHostPid() const;
+    unsigned getRestarts() const;
+
+private:
+    HostedModule(const std::string& libraryPath, const IsolationOptions& options)
+        : CppLibraryPath(libraryPath), CppOptions(options) {}
+
+    // How one request went: answered Ok, answered Failed, or no answer because the host is gone.
+    enum class Outcome { Ok, Failed, Lost };
+
+    bool spawnHost(std::string& error);            // Expects CppMutex held
+    void stopHost();                               // Expects CppMutex held
+    bool hostAlive();                              // Expects CppMutex held; reaps an exited host
+    bool restartHost(std::string& error);          // Expects CppMutex held
+    Outcome exchange(HostRequest type, const std::string& payload, std::string& reply,
+                     std::string& error);          // Expects CppMutex held; stops a host that is lost
+    // Takes CppMutex; restarts a lost host after the request fails.
+    bool request(HostRequest type, const std::string& payload, std::string& reply, std::string& error);
+
+    const std::string CppLibraryPath;
+    const IsolationOptions CppOptions;
+    std::string CppName;
+    std::string CppVersion;
+    std::optional<ModuleManifest> CppManifest;
+
+    mutable std::mutex CppMutex; // One request at a time; guards everything below
+    std::unique_ptr<ModuleHostChannel> CppChannel;
+    int CppPid = -1;
+    std::string CppExitReason; // How the last host ended
+    bool CppInitialized = false;
+    unsigned CppRestarts = 0;
+};
+
+} // namespace moduleloader
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_MODULELOADER_MODULE_HOST_HPP
@@ -0,0 +1,306 @@
+#include "module_index.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace wave {
+namespace core {
+namespace moduleloader {
+
+namespace {
+// First line of a cache file. Files with another first line are ignored and rewritten. Format 2
+// came with WAVE_MODULE_MIN_ABI_VERSION: format 1 files hold manifests the loader now refuses.
+const char* const CACHE_HEADER = "# wave module manifest cache, format 2";
+
+#ifdef _WIN32
+const char* const LIBRARY_PREFIX = "";
+const char* const LIBRARY_SUFFIX = ".dll";
+#elif defined(__APPLE__)
+const char* const LIBRARY_PREFIX = "lib";
+const char* const LIBRARY_SUFFIX = ".dylib";
+#else
+const char* const LIBRARY_PREFIX = "lib";
+const char* const LIBRARY_SUFFIX = ".so";
+#endif
+
+bool hasDirectory(const std::string& nameOrPath) {
+#ifdef _WIN32
+    return nameOrPath.find_first_of("/\\") != std::string::npos;
+#else
+    return nameOrPath.find('/') != std::string::npos;
+#endif
+}
+
+// Name lists are stored comma-separated; module, capability, command and topic names have no commas.
+std::string joinNames(const std::vector<std::string>& names) {
+    std::string joined;
+    for (const auto& name : names) {
+        joined += (joined.empty() ? "" : ",") + name;
+    }
+    return joined;
+}
+
+std::vector<std::string> splitNames(const std::string& joined) {
+    std::vector<std::string> names;
+    std::stringstream stream(joined);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        if (!name.empty()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (size_t tab = line.find('\t'); tab != std::string::npos; tab = line.find('\t', start)) {
+        fields.push_back(line.substr(start, tab - start));
+        start = tab + 1;
+    }
+    fields.push_back(line.substr(start));
+    return fields;
+}
+
+// One line per library: path, modified, size, ABI version (0 = no manifest), name, version,
+// provides, requirements, commands, topics, error.
+std::string formatEntry(const ModuleIndex::Entry& entry) {
+    const ModuleManifest empty;
+    const ModuleManifest& manifest = entry.manifest ? *entry.manifest : empty;
+    return entry.path + "\t" + std::to_string(entry.modified) + "\t" + std::to_string(entry.size) + "\t" +
+           std::to_string(entry.manifest ? manifest.abiVersion : 0) + "\t" + manifest.name + "\t" +
+           manifest.version + "\t" + joinNames(manifest.provides) + "\t" + joinNames(manifest.requirements) +
+           "\t" + joinNames(manifest.commands) + "\t" + joinNames(manifest.topics) + "\t" + entry.error;
+}
+
+std::optional<ModuleIndex::Entry> parseEntry(const std::string& line) {
+    std::vector<std::string> fields = splitFields(line);
+    if (fields.size() != 11 || fields[0].empty()) {
+        return std::nullopt;
+    }
+    ModuleIndex::Entry entry;
+    try {
+        entry.path = fields[0];
+        entry.modified = std::stoll(fields[1]);
+        entry.size = std::stoull(fields[2]);
+        unsigned long abiVersion = std::stoul(fields[3]);
+        if (abiVersion > 0 && abiVersion < WAVE_MODULE_MIN_ABI_VERSION) {
+            return std::nullopt; // A manifest the loader would refuse; read the library again
+        }
+        if (abiVersion > 0) {
+            ModuleManifest manifest;
+            manifest.abiVersion = static_cast<unsigned>(abiVersion);
+            manifest.name = fields[4];
+            manifest.version = fields[5];
+            manifest.provides = splitNames(fields[6]);
+            manifest.requirements = splitNames(fields[7]);
+            manifest.commands = splitNames(fields[8]);
+            manifest.topics = splitNames(fields[9]);
+            entry.manifest = manifest;
+        }
+        entry.error = fields[10];
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    return entry;
+}
+} // namespace
+
+ModuleIndex::~ModuleIndex() {
+    save();
+}
+
+void ModuleIndex::setSearchPaths(const std::vector<std::string>& directories) {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppSearchPaths.clear();
+    for (const auto& directory : directories) {
+        if (!directory.empty()) {
+            CppSearchPaths.push_back(directory);
+        }
+    }
+}
+
+std::vector<std::string> ModuleIndex::getSearchPaths() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppSearchPaths;
+}
+
+std::string ModuleIndex::resolve(const std::string& moduleNameOrPath) const {
+    if (moduleNameOrPath.empty() || hasDirectory(moduleNameOrPath)) {
+        return moduleNameOrPath;
+    }
+    const std::string candidates[] = {moduleNameOrPath, LIBRARY_PREFIX + moduleNameOrPath + LIBRARY_SUFFIX};
+    for (const auto& directory : getSearchPaths()) {
+        for (const auto& candidate : candidates) {
+            std::error_code ec;
+            std::filesystem::path path = std::filesystem::path(directory) / candidate;
+            if (std::filesystem::is_regular_file(path, ec)) {
+                return path.string();
+            }
+        }
+    }
+    return moduleNameOrPath;
+}
+
+bool ModuleIndex::setCacheFile(const std::string& cacheFile) {
+    std::map<std::string, Entry> entries;
+    bool readOk = true;
+    bool current = true;
+    std::error_code ec;
+    if (std::filesystem::exists(cacheFile, ec)) {
+        std::ifstream in(cacheFile);
+        std::string line;
+        if (!in) {
+            readOk = false;
+        } else if (!std::getline(in, line) || line != CACHE_HEADER) {
+            current = false; // Another format; start over
+        } else {
+            while (std::getline(in, line)) {
+                std::optional<Entry> entry = parseEntry(line);
+                if (entry) {
+                    entries[entry->path] = *entry;
+                }
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(CppMutex);
+    CppCacheFile = cacheFile;
+    CppEntries = std::move(entries);
+    CppDirty = !current;
+    return readOk;
+}
+
+bool ModuleIndex::save() {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    if (!CppDirty || CppCacheFile.empty()) {
+        return true;
+    }
+    if (!writeCacheFile()) {
+        return false;
+    }
+    CppDirty = false;
+    return true;
+}
+
+bool ModuleIndex::writeCacheFile() {
+    // Written to a temporary file and renamed over the old one, so a launcher starting at the same
+    // time never reads half a cache.
+    std::string temporary = CppCacheFile + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << CACHE_HEADER << "\n";
+        for (const auto& pair : CppEntries) {
+            // Entries with a tab or line break in a field would not read back; they are left out.
+            std::string line = formatEntry(pair.second);
+            if (line.find_first_of("\r\n") == std::string::npos && splitFields(line).size() == 11) {
+                out << line << "\n";
+            }
+        }
+        if (!out.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, CppCacheFile, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+std::optional<ModuleIndex::Entry> ModuleIndex::lookup(const std::string& path, std::string& error) {
+    std::error_code sizeError;
+    std::error_code timeError;
+    unsigned long long size = std::filesystem::file_size(path, sizeError);
+    long long modified = std::filesystem::last_write_time(path, timeError).time_since_epoch().count();
+    if (sizeError || timeError) {
+        error = "Failed to load library: " + path;
+        return std::nullopt;
+    }
+    {
+        std::lock_guard<std::mutex> lock(CppMutex);
+        auto it = CppEntries.find(path);
+        if (it != CppEntries.end() && it->second.modified == modified && it->second.size == size) {
+            ++CppCacheHits;
+            return it->second;
+        }
+    }
+
+    Entry entry;
+    entry.path = path;
+    entry.modified = modified;
+    entry.size = size;
+    bool opened = false;
+    entry.manifest = ModuleLoaderSystem::readModuleManifest(path, &entry.error, &opened);
+    std::lock_guard<std::mutex> lock(CppMutex);
+    ++CppLibraryReads;
+    if (!opened) {
+        error = entry.error;
+        return std::nullopt;
+    }
+    CppEntries[path] = entry;
+    CppDirty = true;
+    return entry;
+}
+
+std::optional<ModuleManifest> ModuleIndex::manifest(const std::string& moduleNameOrPath, std::string* error) {
+    std::string reason;
+    std::optional<Entry> entry = lookup(resolve(moduleNameOrPath), reason);
+    if (entry && !entry->manifest) {
+        reason = entry->error;
+    }
+    if (error && (!entry || !entry->manifest)) {
+        *error = reason;
+    }
+    return entry ? entry->manifest : std::nullopt;
+}
+
+bool ModuleIndex::isLibraryFile(const std::string& fileName) {
+    const std::string suffix = LIBRARY_SUFFIX;
+    return fileName.size() > suffix.size() && fileName.compare(fileName.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::vector<ModuleIndex::Entry> ModuleIndex::discover() {
+    std::vector<Entry> found;
+    std::set<std::string> seen;
+    for (const auto& directory : getSearchPaths()) {
+        std::vector<std::string> files;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code typeError;
+            if (it->is_regular_file(typeError) && isLibraryFile(it->path().filename().string())) {
+                files.push_back(it->path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto& file : files) {
+            std::string error;
+            std::optional<Entry> entry;
+            if (seen.insert(file).second && (entry = lookup(file, error))) {
+                found.push_back(*entry);
+            }
+        }
+    }
+    return found;
+}
+
+size_t ModuleIndex::getLibraryReads() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppLibraryReads;
+}
+
+size_t ModuleIndex::getCacheHits() const {
+    std::lock_guard<std::mutex> lock(CppMutex);
+    return CppCacheHits;
+}
+
+} // namespace moduleloader
+} // namespace core
+} // namespace wave
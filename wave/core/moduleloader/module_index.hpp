@@ -0,0 +1,87 @@
+#ifndef WAVE_CORE_MODULELOADER_MODULE_INDEX_HPP
+#define WAVE_CORE_MODULELOADER_MODULE_INDEX_HPP
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "module_loader.hpp"
+
+namespace wave {
+namespace core {
+namespace moduleloader {
+
+// Where module libraries are found, and what they declare.
+//
+// Search paths: modules.conf and "module load" may name a module by a bare name
+// ("clipboard_module") instead of a path. resolve() looks for it in each search directory in
+// order, first under the name as given, then as the platform's library file (lib<name>.so,
+// lib<name>.dylib, <name>.dll). Anything with a directory separator in it is a path and is used
+// unchanged, as is a bare name found in no search directory.
+//
+// Manifest cache: manifest() opens a library to read its manifest only if the cache holds no
+// entry for that path with the file's current modification time and size. Libraries that export
+// no manifest are remembered as well, so discover() can scan the search directories at every
+// start without dlopen-ing files that have not changed. Libraries that cannot be opened are not
+// cached; a missing dependency may turn up later. With a cache file set, the cache is read from it
+// and written back by save() and on destruction, in both cases only if something changed.
+//
+// All methods are thread-safe.
+class ModuleIndex {
+public:
+    struct Entry {
+        std::string path;
+        long long modified = 0;  // Last write time, in the file clock's ticks
+        unsigned long long size = 0;
+        std::optional<ModuleManifest> manifest; // nullopt if the library exports none
+        std::string error;       // Why there is no manifest
+    };
+
+    ModuleIndex() = default;
+    ~ModuleIndex();
+    ModuleIndex(const ModuleIndex&) = delete;
+    ModuleIndex& operator=(const ModuleIndex&) = delete;
+
+    void setSearchPaths(const std::vector<std::string>& directories);
+    std::vector<std::string> getSearchPaths() const;
+    std::string resolve(const std::string& moduleNameOrPath) const;
+
+    // Reads 'cacheFile' into the cache (a missing file is an empty cache) and remembers it for
+    // save(). Entries that do not parse are skipped. Returns false if the file exists but cannot
+    // be read.
+    bool setCacheFile(const std::string& cacheFile);
+    bool save();
+
+    // The manifest of a library, named by path or bare name. Returns nullopt with the reason in
+    // 'error' as ModuleLoaderSystem::readModuleManifest does.
+    std::optional<ModuleManifest> manifest(const std::string& moduleNameOrPath, std::string* error = nullptr);
+    // Every library in the search directories, in search path order then by file name, with its
+    // cached or freshly read manifest. Libraries that cannot be opened are left out.
+    std::vector<Entry> discover();
+
+    // How many libraries manifest() and discover() had to open, and how many answers came from
+    // the cache, since construction.
+    size_t getLibraryReads() const;
+    size_t getCacheHits() const;
+
+private:
+    static bool isLibraryFile(const std::string& fileName);
+    std::optional<Entry> lookup(const std::string& path, std::string& error);
+    bool writeCacheFile();
+
+    mutable std::mutex CppMutex; // Guards everything below; libraries are opened without it
+    std::vector<std::string> CppSearchPaths;
+    std::map<std::string, Entry> CppEntries; // Keyed by library path
+    std::string CppCacheFile;
+    bool CppDirty = false;
+    size_t CppLibraryReads = 0;
+    size_t CppCacheHits = 0;
+};
+
+} // namespace moduleloader
+} // namespace core
+} // namespace wave
+
+#endif // WAVE_CORE_MODULELOADER_MODULE_INDEX_HPP
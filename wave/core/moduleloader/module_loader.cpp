@@ -1,408 +1,1397 @@
 #include "module_loader.hpp"
+#include "module_index.hpp"
+#include "module_host.hpp"
+#include "../cli/command_pool.hpp"
 #include <iostream> // For potential debug/error output, though logging system is preferred in real app
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 // Define standard names for module entry/exit functions
 const char* CREATE_MODULE_FUNC_NAME = "create_module_instance";
 const char* DESTROY_MODULE_FUNC_NAME = "destroy_module_instance";
+const char* MODULE_MANIFEST_FUNC_NAME = "wave_module_manifest";
+// Asynchronous operations waiting for a worker; more are rejected.
+const size_t ASYNC_QUEUE_CAPACITY = 256;
 
 namespace wave {
 namespace core {
 namespace moduleloader {
 
-ModuleLoaderSystem::ModuleLoaderSystem(ICoreAccess* coreAccess)
-    : CppCoreAccess(coreAccess) {
+namespace {
+// The destroy function of modules running in a module host: ends the host.
+void destroyHostedModule(ILauncherModule* module) {
+    delete module;
+}
+} // namespace
+
+ModuleLoaderSystem::ModuleLoaderSystem(const WaveCoreApi* coreApi)
+    : CppModules(std::make_shared<const ModuleRegistry>()), CppCoreApi(coreApi),
+      CppIndex(std::make_unique<ModuleIndex>()) {
 }
 
 ModuleLoaderSystem::~ModuleLoaderSystem() {
-    std::lock_guard<std::mutex> lock(CppModuleMutex);
-    // Unload all modules on destruction
-    // Iterate over a copy of keys because CppLoadedModules will be modified by unload
-    std::vector<std::string> moduleNames;
-    for (const auto& pair : CppLoadedModules) {
-        moduleNames.push_back(pair.first);
-    }
-    for (const auto& name : moduleNames) {
-        // Suppress events during shutdown or handle them if necessary
-        // For now, use internalUnloadModule which doesn't broadcast by default if isReloading=true (misusing flag here)
-        // A better way would be a dedicated flag for "isSystemShuttingDown"
-        internalUnloadModule(name, true); // true to suppress some event noise during mass unload
+    stopWatching();
+    // Queued asynchronous operations run first; they may still load or unload modules.
+    {
+        std::lock_guard<std::mutex> lock(CppAsyncPoolMutex);
+        if (CppAsyncPool) {
+            CppAsyncPool->shutdown();
+        }
     }
-    CppLoadedModules.clear();
+    // Unload all modules on destruction, dependents before the modules they need. No events:
+    // subscribers may already be gone at this point.
+    internalUnloadAll(0, false);
 }
 
-ModuleResult ModuleLoaderSystem::loadModule(const std::string& modulePath) {
-    std::lock_guard<std::mutex> lock(CppModuleMutex);
+namespace {
+void closeLibrary(void* handle) {
+#ifdef _WIN32
+    FreeLibrary((HMODULE)handle);
+#else
+    dlclose(handle);
+#endif
+}
 
-    // Check if a module from this path is already loaded by iterating CppLoadedModules.
-    // This is important because moduleName is from module->getName(), not path.
-    for (const auto& pair : CppLoadedModules) {
-        if (pair.second.path == modulePath) {
-            return ModuleResult(ModuleResult::Status::Error, "Module from this path is already loaded: " + modulePath, pair.second);
+// Runs task(i) for every i in [0, count) on up to maxThreads threads (0 = one per hardware
+// thread) and returns when all are done. A single task, or a single thread, runs inline.
+void runParallel(size_t count, size_t maxThreads, const std::function<void(size_t)>& task) {
+    size_t threads = maxThreads ? maxThreads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
         }
+        return;
+    }
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                task(i);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
     }
+}
 
-    void* libHandle = nullptr;
-#ifdef _WIN32
-    libHandle = LoadLibrary(modulePath.c_str());
-#else
-    libHandle = dlopen(modulePath.c_str(), RTLD_LAZY | RTLD_GLOBAL); // RTLD_GLOBAL might be needed for RTTI/exceptions between module and host
+// Resident set size of this process in bytes, or -1 where unknown.
+long long residentBytes() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long long sizePages = 0, residentPages = 0;
+    if (statm >> sizePages >> residentPages) {
+        return residentPages * sysconf(_SC_PAGESIZE);
+    }
 #endif
+    return -1;
+}
 
-    if (!libHandle) {
-        std::string errorMsg = "Failed to load library: " + modulePath;
+// Copies a module library to a file of its own in the temporary directory, so it can be opened while
+// the library at 'path' is loaded already (dlopen would hand back the loaded one), or while a build
+// overwrites it. Each copy gets the next version number ("wave-<pid>-v<n>-<file name>"). Returns the
+// copy's path, or an empty string with 'error' set.
+std::string makeShadowCopy(const std::string& path, std::string& error) {
+    static std::atomic<unsigned> counter{0};
 #ifdef _WIN32
-        errorMsg += " (Error Code: " + std::to_string(GetLastError()) + ")";
+    std::string process = std::to_string(GetCurrentProcessId());
 #else
-        errorMsg += " (Error: " + std::string(dlerror()) + ")";
+    std::string process = std::to_string(getpid());
 #endif
-        ModuleInfo errorInfo; errorInfo.path = modulePath;
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
+    std::error_code ec;
+    std::filesystem::path source(path);
+    std::filesystem::path copy = std::filesystem::temp_directory_path(ec) /
+                                 ("wave-" + process + "-v" + std::to_string(++counter) + "-" + source.filename().string());
+    if (!ec) {
+        std::filesystem::copy_file(source, copy, std::filesystem::copy_options::overwrite_existing, ec);
+    }
+    if (ec) {
+        error = "Cannot copy " + path + " to a shadow file: " + ec.message();
+        return "";
     }
+    return copy.string();
+}
 
-    CreateModuleFunc createFunc = nullptr;
-    DestroyModuleFunc destroyFunc = nullptr; // Keep track of destroy for cleanup on partial failure
+std::vector<std::string> copyNameList(const char* const* list) {
+    std::vector<std::string> names;
+    for (; list && *list; ++list) {
+        names.push_back(*list);
+    }
+    return names;
+}
 
+// Copies the manifest exported by an opened library. Returns nullopt with an empty 'error' if the
+// library exports none, and with 'error' set if the manifest is unusable.
+std::optional<ModuleManifest> manifestFromHandle(void* handle, std::string& error) {
 #ifdef _WIN32
-    createFunc = (CreateModuleFunc)GetProcAddress((HMODULE)libHandle, CREATE_MODULE_FUNC_NAME);
-    destroyFunc = (DestroyModuleFunc)GetProcAddress((HMODULE)libHandle, DESTROY_MODULE_FUNC_NAME);
+    auto manifestFunc = (WaveModuleManifestFunc)GetProcAddress((HMODULE)handle, MODULE_MANIFEST_FUNC_NAME);
 #else
-    createFunc = (CreateModuleFunc)dlsym(libHandle, CREATE_MODULE_FUNC_NAME);
-    destroyFunc = (DestroyModuleFunc)dlsym(libHandle, DESTROY_MODULE_FUNC_NAME);
+    auto manifestFunc = (WaveModuleManifestFunc)dlsym(handle, MODULE_MANIFEST_FUNC_NAME);
 #endif
+    if (!manifestFunc) {
+        return std::nullopt;
+    }
+    const WaveModuleManifest* exported = manifestFunc();
+    if (!exported) {
+        error = std::string(MODULE_MANIFEST_FUNC_NAME) + " returned nullptr.";
+        return std::nullopt;
+    }
+    if (exported->abiVersion == 0 || exported->abiVersion > WAVE_MODULE_ABI_VERSION) {
+        error = "Module manifest has ABI version " + std::to_string(exported->abiVersion) + ", this loader supports up to " +
+                std::to_string(WAVE_MODULE_ABI_VERSION) + ".";
+        return std::nullopt;
+    }
+    if (exported->abiVersion < WAVE_MODULE_MIN_ABI_VERSION) {
+        error = "Module manifest has ABI version " + std::to_string(exported->abiVersion) +
+                ": built for the ICoreAccess interface, which became WaveCoreApi in version " +
+                std::to_string(WAVE_MODULE_MIN_ABI_VERSION) + ". Rebuild the module.";
+        return std::nullopt;
+    }
+    if (!exported->name || !*exported->name) {
+        error = "Module manifest has no name.";
+        return std::nullopt;
+    }
+    ModuleManifest manifest;
+    manifest.abiVersion = exported->abiVersion;
+    manifest.name = exported->name;
+    manifest.version = exported->version ? exported->version : "";
+    manifest.provides = copyNameList(exported->provides);
+    manifest.requirements = copyNameList(exported->requirements);
+    if (exported->abiVersion >= 2) {
+        manifest.commands = copyNameList(exported->commands);
+        manifest.topics = copyNameList(exported->topics);
+    }
+    return manifest;
+}
+} // namespace
 
-    if (!createFunc) {
-        std::string errorMsg = "Failed to find '" + std::string(CREATE_MODULE_FUNC_NAME) + "' in " + modulePath;
-#ifndef _WIN32 // dlerror might provide more info on POSIX if dlsym failed for other reasons
-        const char* dlsym_error = dlerror();
-        if (dlsym_error) errorMsg += " (dlsym Error: " + std::string(dlsym_error) + ")";
-#endif
+std::optional<ModuleManifest> ModuleLoaderSystem::readModuleManifest(const std::string& modulePath, std::string* error,
+                                                                     bool* opened) {
+    std::string reason;
 #ifdef _WIN32
-        FreeLibrary((HMODULE)libHandle);
+    void* handle = LoadLibrary(modulePath.c_str());
 #else
-        dlclose(libHandle);
+    void* handle = dlopen(modulePath.c_str(), RTLD_LAZY | RTLD_LOCAL);
 #endif
-        ModuleInfo errorInfo; errorInfo.path = modulePath;
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
+    std::optional<ModuleManifest> manifest;
+    if (opened) {
+        *opened = handle != nullptr;
+    }
+    if (!handle) {
+        reason = "Failed to load library: " + modulePath;
+    } else {
+        manifest = manifestFromHandle(handle, reason);
+        if (!manifest && reason.empty()) {
+            reason = "No '" + std::string(MODULE_MANIFEST_FUNC_NAME) + "' in " + modulePath;
+        }
+        closeLibrary(handle);
     }
-    // Note: destroyFunc is optional for the module to export. If not found, we can't call it, but can still proceed.
+    if (!manifest && error) {
+        *error = reason;
+    }
+    return manifest;
+}
 
-    ILauncherModule* moduleInstance = nullptr;
-    try {
-        moduleInstance = createFunc();
-    } catch (const std::exception& e) {
+std::chrono::microseconds ModuleLoaderSystem::reportPhase(const std::string& path, const std::string& name, ModulePhase phase,
+                                     std::chrono::steady_clock::time_point started,
+                                     std::chrono::steady_clock::time_point& phaseStarted) {
+    auto now = std::chrono::steady_clock::now();
+    ModuleProgress progress;
+    progress.path = path;
+    progress.name = name;
+    progress.phase = phase;
+    progress.phaseDuration = std::chrono::duration_cast<std::chrono::microseconds>(now - phaseStarted);
+    progress.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - started);
+    phaseStarted = now;
+
+    std::vector<ModuleProgressCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(CppProgressMutex);
+        callbacks = CppProgressCallbacks;
+    }
+    for (const auto& callback : callbacks) {
+        try {
+            callback(progress);
+        } catch (const std::exception& e) {
+            std::cerr << "Exception in ModuleProgressCallback: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Unknown exception in ModuleProgressCallback." << std::endl;
+        }
+    }
+    return progress.phaseDuration;
+}
+
+void ModuleLoaderSystem::prepareModule(PreparedModule& module) {
+    const std::string& modulePath = module.path;
+    if (module.shadowPath.empty() && CppShadowLoads) {
+        module.shadowPath = makeShadowCopy(modulePath, module.error);
+        if (!module.error.empty()) {
+            return;
+        }
+    }
+    const std::string& openPath = module.shadowPath.empty() ? module.path : module.shadowPath;
+    module.residentBefore = residentBytes();
+    module.started = module.phaseStarted = std::chrono::steady_clock::now();
+    if (module.isolation) {
+        prepareHostedModule(module, openPath);
+        return;
+    }
 #ifdef _WIN32
-        FreeLibrary((HMODULE)libHandle);
+    module.handle = LoadLibrary(openPath.c_str());
 #else
-        dlclose(libHandle);
+    // RTLD_GLOBAL might be needed for RTTI/exceptions between module and host. A hot reload copy is
+    // loaded next to the running library and kept local, so neither binds to the other's symbols.
+    module.handle = dlopen(openPath.c_str(), RTLD_LAZY | (module.localSymbols ? RTLD_LOCAL : RTLD_GLOBAL));
 #endif
-        std::string errorMsg = std::string(CREATE_MODULE_FUNC_NAME) + " threw an exception: " + e.what();
-        ModuleInfo errorInfo; errorInfo.path = modulePath;
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
-    } catch (...) {
+
+    if (!module.handle) {
+        module.error = "Failed to load library: " + modulePath;
 #ifdef _WIN32
-        FreeLibrary((HMODULE)libHandle);
+        module.error += " (Error Code: " + std::to_string(GetLastError()) + ")";
 #else
-        dlclose(libHandle);
+        module.error += " (Error: " + std::string(dlerror()) + ")";
 #endif
-        std::string errorMsg = std::string(CREATE_MODULE_FUNC_NAME) + " threw an unknown exception.";
-        ModuleInfo errorInfo; errorInfo.path = modulePath;
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
+        return;
     }
+    module.profile.open = reportPhase(modulePath, "", ModulePhase::Opened, module.started, module.phaseStarted);
 
+    std::string manifestError;
+    module.manifest = manifestFromHandle(module.handle, manifestError);
+    if (!manifestError.empty()) {
+        module.error = manifestError + " (" + modulePath + ")";
+        discardModule(module);
+        return;
+    }
+    // Without a manifest nothing says which interface initialize() expects: a library built before
+    // WaveCoreApi would take the table for an ICoreAccess.
+    if (!module.manifest) {
+        module.error = "No '" + std::string(MODULE_MANIFEST_FUNC_NAME) + "' in " + modulePath +
+                       ": modules must export a manifest of ABI version " + std::to_string(WAVE_MODULE_MIN_ABI_VERSION) +
+                       " or later (see module_manifest.hpp). Rebuild the module.";
+        discardModule(module);
+        return;
+    }
 
-    if (!moduleInstance) {
 #ifdef _WIN32
-        FreeLibrary((HMODULE)libHandle);
+    module.create = (CreateModuleFunc)GetProcAddress((HMODULE)module.handle, CREATE_MODULE_FUNC_NAME);
+    module.destroy = (DestroyModuleFunc)GetProcAddress((HMODULE)module.handle, DESTROY_MODULE_FUNC_NAME);
 #else
-        dlclose(libHandle);
+    module.create = (CreateModuleFunc)dlsym(module.handle, CREATE_MODULE_FUNC_NAME);
+    module.destroy = (DestroyModuleFunc)dlsym(module.handle, DESTROY_MODULE_FUNC_NAME);
+#endif
+
+    if (!module.create) {
+        module.error = "Failed to find '" + std::string(CREATE_MODULE_FUNC_NAME) + "' in " + modulePath;
+#ifndef _WIN32 // dlerror might provide more info on POSIX if dlsym failed for other reasons
+        const char* dlsym_error = dlerror();
+        if (dlsym_error) module.error += " (dlsym Error: " + std::string(dlsym_error) + ")";
 #endif
-        std::string errorMsg = std::string(CREATE_MODULE_FUNC_NAME) + " returned nullptr from " + modulePath;
-        ModuleInfo errorInfo; errorInfo.path = modulePath;
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
+        discardModule(module);
+        return;
     }
+    // Note: destroy is optional for the module to export. If not found, we can't call it, but can still proceed.
+    module.profile.symbols = reportPhase(modulePath, "", ModulePhase::SymbolsResolved, module.started, module.phaseStarted);
 
     try {
-        moduleInstance->initialize(CppCoreAccess);
+        module.instance = module.create();
     } catch (const std::exception& e) {
-        if (destroyFunc) { // Attempt to let module clean itself up
-            try { destroyFunc(moduleInstance); } catch(...) { /* ignore cleanup error */ }
-        } else {
-            // If no destroy_module_instance, we might leak moduleInstance here if it's not self-managing on init failure
-            // Or, the module should handle its own cleanup if initialize throws.
-            // For robust C interface, often create/destroy are the main resource managers.
-            // If ILauncherModule is pure interface, `delete moduleInstance` might be needed if `createFunc` implies ownership transfer.
-            // The PRD for `destroy_module_instance` suggests it takes the instance, implying it handles deletion.
-            // If `destroyFunc` is null, and `initialize` fails, this is a potential leak unless `createFunc` returns a self-deleting object or similar.
-            // For now, assume if destroyFunc is null, the module handles its own memory or createFunc is like a factory for singletons.
-            // A common pattern is: if initialize fails, module's destructor should clean up. If `destroyFunc` exists, it's called.
-            // If `destroyFunc` is missing, we can't do much other than unload the lib.
+        module.error = std::string(CREATE_MODULE_FUNC_NAME) + " threw an exception: " + e.what();
+    } catch (...) {
+        module.error = std::string(CREATE_MODULE_FUNC_NAME) + " threw an unknown exception.";
+    }
+    if (module.error.empty() && !module.instance) {
+        module.error = std::string(CREATE_MODULE_FUNC_NAME) + " returned nullptr from " + modulePath;
+    }
+    if (!module.error.empty()) {
+        discardModule(module);
+        return;
+    }
+    module.name = module.instance->getName();
+    module.version = module.instance->getVersion();
+    if (module.manifest && module.manifest->name != module.name) {
+        module.error = "Module manifest name '" + module.manifest->name + "' does not match getName() '" + module.name + "' in " + modulePath;
+        discardModule(module);
+        return;
+    }
+    module.profile.create = reportPhase(modulePath, module.name, ModulePhase::Created, module.started, module.phaseStarted);
+}
+
+void ModuleLoaderSystem::prepareHostedModule(PreparedModule& module, const std::string& openPath) {
+    const std::string& modulePath = module.path;
+    std::string error;
+    std::unique_ptr<HostedModule> hosted = HostedModule::start(openPath, *module.isolation, error);
+    if (!hosted) {
+        module.error = "Failed to load isolated module: " + modulePath + " (" + error + ")";
+        discardModule(module);
+        return;
+    }
+    // The host opened the library, resolved its symbols and created the module before it answered.
+    module.profile.open = reportPhase(modulePath, "", ModulePhase::Opened, module.started, module.phaseStarted);
+    module.profile.symbols = reportPhase(modulePath, "", ModulePhase::SymbolsResolved, module.started, module.phaseStarted);
+    module.manifest = hosted->getManifest();
+    module.name = hosted->getName();
+    module.version = hosted->getVersion();
+    module.instance = hosted.release();
+    module.destroy = destroyHostedModule;
+    if (module.manifest && module.manifest->name != module.name) {
+        module.error = "Module manifest name '" + module.manifest->name + "' does not match getName() '" + module.name + "' in " + modulePath;
+        discardModule(module);
+        return;
+    }
+    module.profile.create = reportPhase(modulePath, module.name, ModulePhase::Created, module.started, module.phaseStarted);
+}
+
+void ModuleLoaderSystem::initializeModule(PreparedModule& module) {
+    // What the module registers from initialize() is tied to this instance (see setInitializeScope).
+    std::shared_ptr<void> scope;
+    if (!module.isolation) {
+        InitializeScope initializeScope;
+        {
+            std::lock_guard<std::mutex> lock(CppModuleMutex);
+            initializeScope = CppInitializeScope;
         }
-#ifdef _WIN32
-        FreeLibrary((HMODULE)libHandle);
-#else
-        dlclose(libHandle);
-#endif
-        std::string errorMsg = "Module " + moduleInstance->getName() + " initialize() failed: " + e.what();
-        ModuleInfo errorInfo; errorInfo.path = modulePath; errorInfo.name = moduleInstance->getName(); // Name might be available
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
+        if (initializeScope) {
+            module.pinTarget = std::make_shared<PinTarget>();
+            std::shared_ptr<PinTarget> target = module.pinTarget;
+            scope = initializeScope(module.name, [target]() -> ModuleRef {
+                std::lock_guard<std::mutex> lock(target->mutex);
+                return target->ref.lock();
+            });
+        }
+    }
+    // Time spent waiting for the registry, or for dependencies in a batch, is not initialize()'s.
+    module.phaseStarted = std::chrono::steady_clock::now();
+    try {
+        module.instance->initialize(CppCoreApi);
+        module.profile.initialize = reportPhase(module.path, module.name, ModulePhase::Initialized, module.started, module.phaseStarted);
+        long long residentAfter = residentBytes();
+        if (module.residentBefore >= 0 && residentAfter >= 0) {
+            module.profile.rssDeltaBytes = residentAfter - module.residentBefore;
+        }
+        return;
+    } catch (const std::exception& e) {
+        module.error = "Module " + module.name + " initialize() failed: " + e.what();
     } catch (...) {
-         if (destroyFunc) { try { destroyFunc(moduleInstance); } catch(...) {} }
-#ifdef _WIN32
-        FreeLibrary((HMODULE)libHandle);
-#else
-        dlclose(libHandle);
-#endif
-        std::string errorMsg = "Module " + moduleInstance->getName() + " initialize() failed with unknown exception.";
-        ModuleInfo errorInfo; errorInfo.path = modulePath; errorInfo.name = moduleInstance->getName();
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
+        module.error = "Module " + module.name + " initialize() failed with unknown exception.";
     }
+    scope.reset();
+    // If the module exports no destroy_module_instance it is expected to clean up after a failed
+    // initialize() itself; all we can do is unload the library.
+    discardModule(module);
+}
 
+void ModuleLoaderSystem::discardModule(PreparedModule& module) {
+    if (module.instance && module.destroy) {
+        try { module.destroy(module.instance); } catch (...) { /* ignore cleanup error */ }
+    }
+    module.instance = nullptr;
+    if (module.handle) {
+        closeLibrary(module.handle);
+        module.handle = nullptr;
+    }
+    if (!module.shadowPath.empty()) {
+        std::remove(module.shadowPath.c_str());
+        module.shadowPath.clear();
+    }
+}
 
-    std::string moduleName = moduleInstance->getName();
-    if (CppLoadedModules.count(moduleName)) {
-        // A module with the same *name* is already loaded. This is an error.
-        // Paths must be unique (checked earlier), names must also be unique.
-        if (destroyFunc) { try { destroyFunc(moduleInstance); } catch(...) {} }
-#ifdef _WIN32
-        FreeLibrary((HMODULE)libHandle);
-#else
-        dlclose(libHandle);
-#endif
-        std::string errorMsg = "Module with name '" + moduleName + "' already loaded. Module names must be unique.";
-        ModuleInfo errorInfo; errorInfo.path = modulePath; errorInfo.name = moduleName;
-        broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg);
-        return ModuleResult(ModuleResult::Status::Error, errorMsg, errorInfo);
+std::shared_ptr<const ModuleLoaderSystem::ModuleRegistry> ModuleLoaderSystem::registrySnapshot() const {
+    return std::atomic_load(&CppModules);
+}
+
+void ModuleLoaderSystem::updateRegistry(const std::function<void(ModuleRegistry&)>& edit) {
+    auto next = std::make_shared<ModuleRegistry>(*registrySnapshot());
+    edit(*next);
+    std::atomic_store(&CppModules, std::shared_ptr<const ModuleRegistry>(std::move(next)));
+}
+
+std::unique_lock<std::mutex> ModuleLoaderSystem::lockEvents() {
+    return std::unique_lock<std::mutex>(CppEventMutex);
+}
+
+void ModuleLoaderSystem::anchorModule(const ModuleInfo& info, const std::shared_ptr<PinTarget>& pinTarget) {
+    if (!info.instance) {
+        return;
+    }
+    InstanceAnchor anchor;
+    anchor.signal = std::make_shared<DrainSignal>();
+    std::shared_ptr<DrainSignal> signal = anchor.signal;
+    // Does not own the instance: the deleter only reports that no reference is left.
+    anchor.ref = ModuleRef(info.instance, [signal](ILauncherModule*) {
+        std::lock_guard<std::mutex> lock(signal->mutex);
+        signal->drained = true;
+        signal->condition.notify_all();
+    });
+    if (pinTarget) {
+        std::lock_guard<std::mutex> lock(pinTarget->mutex);
+        pinTarget->ref = anchor.ref;
+    }
+    anchor.pinTarget = pinTarget;
+    CppAnchors[info.name] = std::move(anchor);
+}
+
+ModuleLoaderSystem::InstanceAnchor ModuleLoaderSystem::takeAnchor(const std::string& moduleName) {
+    InstanceAnchor anchor;
+    auto it = CppAnchors.find(moduleName);
+    if (it != CppAnchors.end()) {
+        anchor = std::move(it->second);
+        CppAnchors.erase(it);
+    }
+    // Pins taken from now on fail; the ones already held are waited for like other ModuleRefs.
+    if (anchor.pinTarget) {
+        std::lock_guard<std::mutex> lock(anchor.pinTarget->mutex);
+        anchor.pinTarget->ref.reset();
+    }
+    return anchor;
+}
+
+void ModuleLoaderSystem::waitForDrain(InstanceAnchor& anchor) {
+    if (!anchor.signal) {
+        return;
+    }
+    anchor.ref.reset();
+    std::unique_lock<std::mutex> lock(anchor.signal->mutex);
+    anchor.signal->condition.wait(lock, [&]() { return anchor.signal->drained; });
+}
+
+ModuleLoaderSystem::ModuleRef ModuleLoaderSystem::acquireModule(const std::string& moduleName) const {
+    std::lock_guard<std::mutex> lock(CppModuleMutex);
+    auto it = CppAnchors.find(moduleName);
+    return it == CppAnchors.end() ? nullptr : it->second.ref;
+}
+
+void ModuleLoaderSystem::setInitializeScope(InitializeScope scope) {
+    std::lock_guard<std::mutex> lock(CppModuleMutex);
+    CppInitializeScope = std::move(scope);
+}
+
+bool ModuleLoaderSystem::isPathTaken(const ModuleRegistry& registry, const std::string& modulePath, ModuleInfo* loaded) const {
+    for (const auto& pair : registry) {
+        if (pair.second.path == modulePath) {
+            if (loaded) *loaded = pair.second;
+            return true;
+        }
     }
+    return CppPendingPaths.count(modulePath) > 0;
+}
 
+std::map<std::string, std::string> ModuleLoaderSystem::readyProviders(const ModuleRegistry& registry) {
+    std::map<std::string, std::string> providers;
+    for (const auto& pair : registry) {
+        if (pair.second.state != ModuleState::Ready) continue;
+        providers.emplace(pair.first, pair.first);
+        for (const std::string& capability : pair.second.provides) {
+            providers.emplace(capability, pair.first);
+        }
+    }
+    return providers;
+}
+
+std::string ModuleLoaderSystem::findDependent(const ModuleRegistry& registry, const std::string& moduleName) {
+    auto target = registry.find(moduleName);
+    if (target == registry.end()) {
+        return "";
+    }
+    // What the module is needed for: its own name, and capabilities no other Ready module provides.
+    std::set<std::string> needed = {moduleName};
+    for (const std::string& capability : target->second.provides) {
+        bool elsewhere = false;
+        for (const auto& pair : registry) {
+            if (pair.first != moduleName && pair.second.state == ModuleState::Ready &&
+                std::find(pair.second.provides.begin(), pair.second.provides.end(), capability) != pair.second.provides.end()) {
+                elsewhere = true;
+                break;
+            }
+        }
+        if (!elsewhere) needed.insert(capability);
+    }
+    // A module still loading counts too: it was admitted because this one was there.
+    for (const auto& pair : registry) {
+        if (pair.first == moduleName) continue;
+        for (const std::string& requirement : pair.second.requirements) {
+            if (needed.count(requirement)) return pair.first;
+        }
+    }
+    return "";
+}
+
+ModuleInfo ModuleLoaderSystem::infoFor(const PreparedModule& module, ModuleState state) {
     ModuleInfo info;
-    info.path = modulePath;
-    info.libraryHandle = libHandle;
-    info.instance = moduleInstance;
-    info.name = moduleName; // From moduleInstance->getName()
-    info.version = moduleInstance->getVersion(); // From moduleInstance->getVersion()
+    info.path = module.path;
+    info.libraryHandle = module.handle;
+    info.instance = module.instance;
+    info.name = module.name; // From moduleInstance->getName()
+    info.version = module.version; // From moduleInstance->getVersion()
+    if (module.manifest) {
+        info.provides = module.manifest->provides;
+        info.requirements = module.manifest->requirements;
+    }
+    info.state = state;
+    info.profile = module.profile;
+    info.abiVersion = module.manifest ? module.manifest->abiVersion : 0;
+    info.shadowPath = module.shadowPath;
+    info.isolation = module.isolation;
+    return info;
+}
 
-    CppLoadedModules[info.name] = info;
+void ModuleLoaderSystem::reserveModule(PreparedModule& module, bool checkRequirements) {
+    std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
+    if (registry->count(module.name)) {
+        // A module with the same *name* is already loaded (or on its way in or out). Paths must be
+        // unique (checked earlier), names must also be unique.
+        module.error = "Module with name '" + module.name + "' already loaded. Module names must be unique.";
+        return;
+    }
+    if (checkRequirements && module.manifest) {
+        std::map<std::string, std::string> providers = readyProviders(*registry);
+        for (const std::string& requirement : module.manifest->requirements) {
+            if (!providers.count(requirement)) {
+                module.error = "Module '" + module.name + "' requires '" + requirement + "', which no loaded module provides.";
+                return;
+            }
+        }
+    }
+    ModuleInfo info = infoFor(module, ModuleState::Loading);
+    updateRegistry([&](ModuleRegistry& modules) { modules[info.name] = info; });
+}
+
+ModuleResult ModuleLoaderSystem::failModule(PreparedModule& module) {
+    ModuleInfo errorInfo; errorInfo.path = module.path; errorInfo.name = module.name; // Name might be available
+    broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, module.error);
+    return ModuleResult(ModuleResult::Status::Error, module.error, errorInfo);
+}
+
+ModuleResult ModuleLoaderSystem::publishModule(PreparedModule& module, bool reloaded) {
+    ModuleInfo info = infoFor(module, ModuleState::Ready);
+    std::unique_lock<std::mutex> events;
+    {
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        updateRegistry([&](ModuleRegistry& modules) {
+            if (module.error.empty()) {
+                modules[info.name] = info;
+            } else {
+                modules.erase(module.name);
+            }
+        });
+        if (module.error.empty()) {
+            anchorModule(info, module.pinTarget);
+        }
+        events = lockEvents();
+    }
+    if (!module.error.empty()) {
+        return failModule(module);
+    }
     broadcastEvent(ModuleEventType::Loaded, info, "Module loaded successfully.");
+    if (reloaded) {
+        broadcastEvent(ModuleEventType::Reloaded, info, "Module reloaded successfully.");
+        return ModuleResult(ModuleResult::Status::Success, "Module reloaded successfully.", info);
+    }
     return ModuleResult(ModuleResult::Status::Success, "Module loaded successfully.", info);
 }
 
+ModuleResult ModuleLoaderSystem::loadModule(const std::string& moduleNameOrPath) {
+    return loadSingle(moduleNameOrPath, std::nullopt);
+}
 
-ModuleResult ModuleLoaderSystem::internalUnloadModule(const std::string& moduleName, bool isReloading) {
-    auto it = CppLoadedModules.find(moduleName);
-    if (it == CppLoadedModules.end()) {
-        if (!isReloading) { // Don't broadcast error if it's part of a reload that might expect non-existence
-            ModuleInfo errorInfo; errorInfo.name = moduleName;
-            broadcastEvent(ModuleEventType::ErrorUnloading, errorInfo, "Module not found for unloading.");
+ModuleResult ModuleLoaderSystem::loadIsolatedModule(const std::string& moduleNameOrPath, const IsolationOptions& options) {
+    return loadSingle(moduleNameOrPath, options);
+}
+
+ModuleResult ModuleLoaderSystem::loadSingle(const std::string& moduleNameOrPath, const std::optional<IsolationOptions>& isolation) {
+    const std::string modulePath = CppIndex->resolve(moduleNameOrPath);
+    PreparedModule module;
+    module.path = modulePath;
+    module.isolation = isolation;
+    {
+        // Check if a module from this path is already loaded (or being loaded). This is important
+        // because the registry is keyed by module->getName(), not path.
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        ModuleInfo loaded;
+        if (isPathTaken(*registrySnapshot(), modulePath, &loaded)) {
+            return ModuleResult(ModuleResult::Status::Error, "Module from this path is already loaded: " + modulePath, loaded);
+        }
+        CppPendingPaths.insert(modulePath);
+    }
+
+    // The path is reserved: open the library and create the module without the lock, then swap the
+    // path reservation for one of the name. A duplicate name is reported before initialize() runs.
+    prepareModule(module);
+    {
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        CppPendingPaths.erase(modulePath);
+        if (module.error.empty()) {
+            reserveModule(module, true);
         }
-        return ModuleResult(ModuleResult::Status::NotFound, "Module not found: " + moduleName);
     }
+    if (!module.error.empty()) {
+        discardModule(module);
+        std::unique_lock<std::mutex> events = lockEvents();
+        return failModule(module);
+    }
+
+    initializeModule(module);
+    return publishModule(module);
+}
+
+std::vector<ModuleResult> ModuleLoaderSystem::loadModules(const std::vector<std::string>& moduleNamesOrPaths, size_t maxThreads) {
+    std::vector<std::string> modulePaths;
+    for (const std::string& nameOrPath : moduleNamesOrPaths) {
+        modulePaths.push_back(CppIndex->resolve(nameOrPath));
+    }
+    std::vector<PreparedModule> modules(modulePaths.size());
+    std::vector<std::optional<ModuleResult>> results(modulePaths.size());
 
-    ModuleInfo infoToUnload = it->second; // Make a copy for event broadcasting after removal
+    // Paths that are loaded already, or listed twice, are reported without touching the file; the
+    // others are reserved until their modules are named.
+    std::vector<size_t> pending;
+    {
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
+        std::set<std::string> seen;
+        for (size_t i = 0; i < modulePaths.size(); ++i) {
+            modules[i].path = modulePaths[i];
+            ModuleInfo loaded;
+            if (isPathTaken(*registry, modulePaths[i], &loaded) || !seen.insert(modulePaths[i]).second) {
+                results[i] = ModuleResult(ModuleResult::Status::Error,
+                                          "Module from this path is already loaded: " + modulePaths[i], loaded);
+            } else {
+                pending.push_back(i);
+            }
+        }
+        for (size_t i : pending) {
+            CppPendingPaths.insert(modulePaths[i]);
+        }
+    }
+
+    // Phase 1: dlopen, symbol lookup and create_module_instance for every module at once. The
+    // loader lock is not held, so these run concurrently with each other and with other loads.
+    runParallel(pending.size(), maxThreads, [&](size_t n) { prepareModule(modules[pending[n]]); });
+
+    // Module names and manifests are known now: each module is reserved under its name (a name
+    // that is taken already, or appears earlier in the batch, loses before its initialize() runs).
+    // Each requirement is resolved to a Ready module (already initialized) or to a module of this
+    // batch (an edge of the dependency graph).
+    std::vector<size_t> ready;
+    std::vector<std::vector<size_t>> dependencies(modules.size());
+    {
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        for (size_t i : pending) {
+            PreparedModule& module = modules[i];
+            CppPendingPaths.erase(module.path);
+            if (module.error.empty()) reserveModule(module, false);
+            if (module.error.empty()) ready.push_back(i);
+        }
+
+        std::map<std::string, std::string> loaded = readyProviders(*registrySnapshot());
+        std::map<std::string, size_t> batch;
+        for (size_t i : ready) {
+            batch.emplace(modules[i].name, i);
+        }
+        for (size_t i : ready) {
+            if (modules[i].manifest) {
+                for (const std::string& capability : modules[i].manifest->provides) {
+                    batch.emplace(capability, i);
+                }
+            }
+        }
+        for (size_t i : ready) {
+            PreparedModule& module = modules[i];
+            if (!module.manifest) continue;
+            for (const std::string& requirement : module.manifest->requirements) {
+                if (loaded.count(requirement)) continue;
+                auto provider = batch.find(requirement);
+                if (provider == batch.end()) {
+                    module.error = "Module '" + module.name + "' requires '" + requirement + "', which no loaded module provides.";
+                    break;
+                }
+                if (provider->second != i) dependencies[i].push_back(provider->second);
+            }
+        }
+    }
+    for (size_t i : pending) {
+        if (!modules[i].error.empty()) discardModule(modules[i]);
+    }
 
+    // Phase 2: initialize() in waves. A wave is every module whose dependencies have all been
+    // initialized; its modules are independent of each other and initialized concurrently. A
+    // module whose dependency failed fails too, without running its initialize().
+    enum class InitState { Pending, Initialized, Failed };
+    std::vector<InitState> state(modules.size(), InitState::Pending);
+    std::vector<size_t> initOrder;
+    for (size_t i : ready) {
+        if (!modules[i].error.empty()) state[i] = InitState::Failed;
+    }
+    for (;;) {
+        std::vector<size_t> wave;
+        bool progress = false;
+        for (size_t i : ready) {
+            if (state[i] != InitState::Pending) continue;
+            bool blocked = false;
+            const PreparedModule* failedDependency = nullptr;
+            for (size_t dependency : dependencies[i]) {
+                if (state[dependency] == InitState::Failed) failedDependency = &modules[dependency];
+                if (state[dependency] == InitState::Pending) blocked = true;
+            }
+            if (failedDependency) {
+                modules[i].error = "Module '" + modules[i].name + "' not initialized: required module '" +
+                                   failedDependency->name + "' failed to load.";
+                discardModule(modules[i]);
+                state[i] = InitState::Failed;
+                progress = true;
+            } else if (!blocked) {
+                wave.push_back(i);
+            }
+        }
+        if (wave.empty()) {
+            if (progress) continue;
+            break;
+        }
+        runParallel(wave.size(), maxThreads, [&](size_t n) { initializeModule(modules[wave[n]]); });
+        for (size_t i : wave) {
+            state[i] = modules[i].error.empty() ? InitState::Initialized : InitState::Failed;
+            if (state[i] == InitState::Initialized) initOrder.push_back(i);
+        }
+    }
+    // Whatever is still pending waits on itself through a cycle.
+    for (size_t i : ready) {
+        if (state[i] == InitState::Pending) {
+            modules[i].error = "Module '" + modules[i].name + "' not initialized: it is part of, or depends on, a dependency cycle.";
+            discardModule(modules[i]);
+        }
+    }
+
+    // Publish the whole batch at once; events go out in initialization order, so a module's Loaded
+    // event follows those of the modules it needs. Results line up with modulePaths.
+    std::unique_lock<std::mutex> events;
+    {
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        updateRegistry([&](ModuleRegistry& registry) {
+            for (size_t i : ready) {
+                if (modules[i].error.empty()) {
+                    registry[modules[i].name] = infoFor(modules[i], ModuleState::Ready);
+                } else {
+                    registry.erase(modules[i].name);
+                }
+            }
+        });
+        for (size_t i : initOrder) {
+            anchorModule(infoFor(modules[i], ModuleState::Ready), modules[i].pinTarget);
+        }
+        events = lockEvents();
+    }
+    for (size_t i : initOrder) {
+        ModuleInfo info = infoFor(modules[i], ModuleState::Ready);
+        broadcastEvent(ModuleEventType::Loaded, info, "Module loaded successfully.");
+        results[i] = ModuleResult(ModuleResult::Status::Success, "Module loaded successfully.", info);
+    }
+    std::vector<ModuleResult> ordered;
+    ordered.reserve(modules.size());
+    for (size_t i = 0; i < modules.size(); ++i) {
+        ordered.push_back(results[i] ? std::move(*results[i]) : failModule(modules[i]));
+    }
+    return ordered;
+}
+
+bool ModuleLoaderSystem::releaseModule(ModuleInfo& info, std::vector<std::string>& errors) {
+    const std::string& moduleName = info.name;
+    auto started = std::chrono::steady_clock::now();
+    auto phaseStarted = started;
     try {
-        if (infoToUnload.instance) {
-            infoToUnload.instance->shutdown();
+        if (info.instance) {
+            info.instance->shutdown();
         }
     } catch (const std::exception& e) {
-        // Log this error. Should we proceed with unload? Generally yes.
-        std::string errorMsg = "Exception during " + moduleName + "->shutdown(): " + e.what();
-        // Don't remove from map yet, just broadcast error and potentially return error
-        // but still attempt to free library. This is tricky.
-        // For now, we'll log (conceptually) and proceed with unload.
-        // The event could be ErrorUnloading, but we will still try to FreeLibrary.
-        broadcastEvent(ModuleEventType::ErrorUnloading, infoToUnload, errorMsg);
-        // Continue to unload library despite shutdown error.
+        // Reported, but the module is unloaded anyway.
+        errors.push_back("Exception during " + moduleName + "->shutdown(): " + e.what());
     } catch (...) {
-        std::string errorMsg = "Unknown exception during " + moduleName + "->shutdown().";
-        broadcastEvent(ModuleEventType::ErrorUnloading, infoToUnload, errorMsg);
-        // Continue to unload.
+        errors.push_back("Unknown exception during " + moduleName + "->shutdown().");
     }
 
     // Get DestroyModuleFunc from the library before closing it
-    DestroyModuleFunc destroyFunc = nullptr;
-    if (infoToUnload.libraryHandle) {
+    DestroyModuleFunc destroyFunc = info.isolation ? destroyHostedModule : nullptr;
+    if (info.libraryHandle) {
 #ifdef _WIN32
-        destroyFunc = (DestroyModuleFunc)GetProcAddress((HMODULE)infoToUnload.libraryHandle, DESTROY_MODULE_FUNC_NAME);
+        destroyFunc = (DestroyModuleFunc)GetProcAddress((HMODULE)info.libraryHandle, DESTROY_MODULE_FUNC_NAME);
 #else
-        destroyFunc = (DestroyModuleFunc)dlsym(infoToUnload.libraryHandle, DESTROY_MODULE_FUNC_NAME);
+        destroyFunc = (DestroyModuleFunc)dlsym(info.libraryHandle, DESTROY_MODULE_FUNC_NAME);
 #endif
     }
 
-    if (destroyFunc && infoToUnload.instance) {
+    if (destroyFunc && info.instance) {
         try {
-            destroyFunc(infoToUnload.instance);
+            destroyFunc(info.instance);
         } catch (const std::exception& e) {
-            std::string errorMsg = std::string(DESTROY_MODULE_FUNC_NAME) + " threw an exception for module " + moduleName + ": " + e.what();
-            broadcastEvent(ModuleEventType::ErrorUnloading, infoToUnload, errorMsg);
-            // Continue.
+            errors.push_back(std::string(DESTROY_MODULE_FUNC_NAME) + " threw an exception for module " + moduleName + ": " + e.what());
         } catch (...) {
-            std::string errorMsg = std::string(DESTROY_MODULE_FUNC_NAME) + " threw an unknown exception for module " + moduleName + ".";
-            broadcastEvent(ModuleEventType::ErrorUnloading, infoToUnload, errorMsg);
-            // Continue.
+            errors.push_back(std::string(DESTROY_MODULE_FUNC_NAME) + " threw an unknown exception for module " + moduleName + ".");
         }
-    } else if (infoToUnload.instance) {
-        // If no destroy_module_instance, it's assumed that ILauncherModule's destructor
-        // or some other mechanism handles resource cleanup when the library is unloaded.
-        // Or, if create_module_instance was a factory for a singleton, this is fine.
-        // If create_module_instance heap-allocated and expected destroy_module_instance
-        // to delete it, this is a leak. This relies on module design.
-        // For this PRD, we assume if destroy_module_instance is not there, it's okay.
     }
-    infoToUnload.instance = nullptr; // Instance is now gone or managed by module's DLL shutdown
+    // Without destroy_module_instance, the module is expected to clean up when its library is
+    // unloaded (e.g. a singleton instance); a heap-allocated instance would leak. This relies on
+    // module design.
+    info.instance = nullptr; // Instance is now gone or managed by module's DLL shutdown
+    reportPhase(info.path, moduleName, ModulePhase::ShutDown, started, phaseStarted);
 
-    if (infoToUnload.libraryHandle) {
+    if (info.libraryHandle) {
 #ifdef _WIN32
-        if (!FreeLibrary((HMODULE)infoToUnload.libraryHandle)) {
-            // Failed to free library
-            std::string errorMsg = "Failed to free library for module " + moduleName + " (Error Code: " + std::to_string(GetLastError()) + ")";
-            broadcastEvent(ModuleEventType::ErrorUnloading, infoToUnload, errorMsg);
-            // Don't remove from map, as it's still technically "loaded" if lib won't free. This is a severe error.
-            return ModuleResult(ModuleResult::Status::Error, errorMsg, infoToUnload);
+        if (!FreeLibrary((HMODULE)info.libraryHandle)) {
+            // Still loaded as far as the OS is concerned. This is a severe error.
+            errors.push_back("Failed to free library for module " + moduleName + " (Error Code: " + std::to_string(GetLastError()) + ")");
+            return false;
         }
 #else
-        if (dlclose(infoToUnload.libraryHandle) != 0) {
-            // Failed to free library
-            std::string errorMsg = "Failed to free library for module " + moduleName + " (Error: " + std::string(dlerror()) + ")";
-            broadcastEvent(ModuleEventType::ErrorUnloading, infoToUnload, errorMsg);
-            return ModuleResult(ModuleResult::Status::Error, errorMsg, infoToUnload);
+        if (dlclose(info.libraryHandle) != 0) {
+            errors.push_back("Failed to free library for module " + moduleName + " (Error: " + std::string(dlerror()) + ")");
+            return false;
         }
 #endif
     }
-    
-    infoToUnload.libraryHandle = nullptr;
-    CppLoadedModules.erase(moduleName);
-
-    if (!isReloading) {
-        broadcastEvent(ModuleEventType::Unloaded, infoToUnload, "Module unloaded successfully.");
+    info.libraryHandle = nullptr;
+    if (!info.shadowPath.empty()) {
+        std::remove(info.shadowPath.c_str());
+        info.shadowPath.clear();
     }
-    return ModuleResult(ModuleResult::Status::Success, "Module unloaded successfully.", infoToUnload);
+    reportPhase(info.path, moduleName, ModulePhase::Closed, started, phaseStarted);
+    return true;
+}
+
+namespace {
+std::string busyMessage(const ModuleInfo& info) {
+    const char* what = info.state == ModuleState::Loading     ? "still being loaded."
+                       : info.state == ModuleState::Unloading ? "already being unloaded."
+                                                              : "being hot reloaded.";
+    return "Module '" + info.name + "' is " + what;
 }
+} // namespace
 
 ModuleResult ModuleLoaderSystem::unloadModule(const std::string& moduleName) {
-    std::lock_guard<std::mutex> lock(CppModuleMutex);
-    return internalUnloadModule(moduleName, false);
+    ModuleInfo info;
+    InstanceAnchor anchor;
+    {
+        std::unique_lock<std::mutex> lock(CppModuleMutex);
+        std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
+        auto it = registry->find(moduleName);
+        if (it == registry->end()) {
+            lock.unlock();
+            ModuleInfo errorInfo; errorInfo.name = moduleName;
+            std::unique_lock<std::mutex> events = lockEvents();
+            broadcastEvent(ModuleEventType::ErrorUnloading, errorInfo, "Module not found for unloading.");
+            return ModuleResult(ModuleResult::Status::NotFound, "Module not found: " + moduleName);
+        }
+        info = it->second;
+        std::string refusal;
+        if (info.state != ModuleState::Ready || CppHotReloads.count(moduleName)) {
+            refusal = busyMessage(info);
+        } else {
+            std::string dependent = findDependent(*registry, moduleName);
+            if (!dependent.empty()) {
+                refusal = "Module '" + moduleName + "' is required by '" + dependent + "'; unload that module first.";
+            }
+        }
+        if (!refusal.empty()) {
+            lock.unlock();
+            std::unique_lock<std::mutex> events = lockEvents();
+            broadcastEvent(ModuleEventType::ErrorUnloading, info, refusal);
+            return ModuleResult(ModuleResult::Status::Error, refusal, info);
+        }
+        // From here on no module can be admitted on the strength of this one, and no other caller
+        // can unload or reload it.
+        updateRegistry([&](ModuleRegistry& modules) { modules[moduleName].state = ModuleState::Unloading; });
+        anchor = takeAnchor(moduleName);
+    }
+    waitForDrain(anchor);
+
+    ModuleInfo released = info; // Copy for event broadcasting after removal
+    std::vector<std::string> errors;
+    bool closed = releaseModule(released, errors);
+
+    std::unique_lock<std::mutex> events;
+    {
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        updateRegistry([&](ModuleRegistry& modules) {
+            if (closed) {
+                modules.erase(moduleName);
+            } else {
+                // Don't remove it, as it's still technically "loaded" if the library won't free.
+                ModuleInfo& entry = modules[moduleName];
+                entry.instance = nullptr;
+                entry.state = ModuleState::Ready;
+            }
+        });
+        events = lockEvents();
+    }
+    // Shutdown and destroy errors are reported, but the unload goes ahead.
+    for (const std::string& error : errors) {
+        broadcastEvent(ModuleEventType::ErrorUnloading, released, error);
+    }
+    if (!closed) {
+        return ModuleResult(ModuleResult::Status::Error, errors.back(), released);
+    }
+    broadcastEvent(ModuleEventType::Unloaded, released, "Module unloaded successfully.");
+    return ModuleResult(ModuleResult::Status::Success, "Module unloaded successfully.", released);
+}
+
+void ModuleLoaderSystem::unloadAllModules(size_t maxThreads) {
+    internalUnloadAll(maxThreads, true);
+}
+
+void ModuleLoaderSystem::internalUnloadAll(size_t maxThreads, bool broadcast) {
+    // Modules still Loading belong to the call loading them and are left alone.
+    for (;;) {
+        std::vector<ModuleInfo> wave;
+        std::vector<InstanceAnchor> anchors;
+        {
+            std::lock_guard<std::mutex> lock(CppModuleMutex);
+            std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
+            std::map<std::string, std::string> providers;
+            for (const auto& pair : *registry) {
+                providers.emplace(pair.first, pair.first);
+                for (const std::string& capability : pair.second.provides) {
+                    providers.emplace(capability, pair.first);
+                }
+            }
+            // The modules that some other module still needs.
+            std::set<std::string> needed;
+            for (const auto& pair : *registry) {
+                for (const std::string& requirement : pair.second.requirements) {
+                    auto provider = providers.find(requirement);
+                    if (provider != providers.end() && provider->second != pair.first) {
+                        needed.insert(provider->second);
+                    }
+                }
+            }
+            // A wave is every Ready module no remaining module depends on. Loading never admits a
+            // cycle, but should one show up anyway, the rest goes down together rather than never.
+            std::vector<ModuleInfo> candidates;
+            for (const auto& pair : *registry) {
+                if (pair.second.state != ModuleState::Ready || CppHotReloads.count(pair.first)) continue;
+                candidates.push_back(pair.second);
+                if (!needed.count(pair.first)) wave.push_back(pair.second);
+            }
+            if (wave.empty()) wave = candidates;
+            if (wave.empty()) break;
+            updateRegistry([&](ModuleRegistry& modules) {
+                for (const ModuleInfo& info : wave) modules[info.name].state = ModuleState::Unloading;
+            });
+            for (const ModuleInfo& info : wave) anchors.push_back(takeAnchor(info.name));
+        }
+        for (InstanceAnchor& anchor : anchors) {
+            waitForDrain(anchor);
+        }
+
+        std::vector<ModuleInfo> released = wave;
+        std::vector<std::vector<std::string>> errors(wave.size());
+        runParallel(wave.size(), maxThreads, [&](size_t n) { releaseModule(released[n], errors[n]); });
+
+        // A module whose library would not close is dropped too; there is nothing left to retry.
+        std::unique_lock<std::mutex> events;
+        {
+            std::lock_guard<std::mutex> lock(CppModuleMutex);
+            updateRegistry([&](ModuleRegistry& modules) {
+                for (const ModuleInfo& info : wave) modules.erase(info.name);
+            });
+            if (broadcast) events = lockEvents();
+        }
+        if (!broadcast) continue;
+        for (size_t n = 0; n < released.size(); ++n) {
+            for (const std::string& error : errors[n]) {
+                broadcastEvent(ModuleEventType::ErrorUnloading, released[n], error);
+            }
+            broadcastEvent(ModuleEventType::Unloaded, released[n], "Module unloaded successfully.");
+        }
+    }
 }
 
 ModuleResult ModuleLoaderSystem::reloadModule(const std::string& moduleName) {
-    std::lock_guard<std::mutex> lock(CppModuleMutex);
-    
-    auto it = CppLoadedModules.find(moduleName);
-    if (it == CppLoadedModules.end()) {
-        ModuleInfo errorInfo; errorInfo.name = moduleName;
-        // Not broadcasting here, loadModule will handle error if path isn't found or valid
-        return ModuleResult(ModuleResult::Status::NotFound, "Module not found for reload: " + moduleName, errorInfo);
-    }
-    std::string modulePath = it->second.path; // Get path before unloading
-
-    ModuleResult unloadRes = internalUnloadModule(moduleName, true); // true to suppress Unloaded event
-    if (unloadRes.status != ModuleResult::Status::Success) {
-        // Unload failed, possibly broadcast ErrorUnloading if internalUnloadModule didn't,
-        // or augment its message.
-        ModuleInfo info = unloadRes.module.has_value() ? unloadRes.module.value() : ModuleInfo();
-        info.name = moduleName; info.path = modulePath; // ensure info is populated
-        broadcastEvent(ModuleEventType::ErrorUnloading, info, "Failed to unload module during reload: " + unloadRes.message);
-        return ModuleResult(ModuleResult::Status::Error, "Reload failed during unload phase: " + unloadRes.message, info);
-    }
-
-    // Unlock and relock is not ideal here. loadModule also locks.
-    // A better pattern might be for loadModule to have an internal version that assumes lock is held.
-    // For now, this will cause recursive mutex lock if loadModule is called directly.
-    // Let's temporarily unlock to call loadModule, which will re-lock.
-    // This is NOT ideal for atomicity of reload.
-    // A better way: internalLoadModule and internalUnloadModule that expect lock to be held.
-    // For now, to avoid deadlock, I'll use the public loadModule after unlocking.
-    // This means `reloadModule` is not atomic as a whole.
-    //
-    // Correction: The lock is std::recursive_mutex if it were, but it's std::mutex.
-    // So, this will deadlock if loadModule (public) is called.
-    // I need an internalLoadModule or to restructure.
-    //
-    // Simplest fix for now: unlock, call public loadModule, then re-evaluate atomicity.
-    // This is a temporary simplification for this step.
-    // The lock guard will unlock upon exiting this scope if I don't do it manually.
-    //
-    // Let's assume CppModuleMutex is a recursive mutex for this to work simply,
-    // or that loadModule has an internal version.
-    // The prompt implies std::mutex. So, I must release the lock.
-    // The state of CppLoadedModules is consistent before this unlock.
-    //
-    // The `lock` is function-scoped, so it will be released when `reloadModule` returns.
-    // To call `loadModule`, I need to release it earlier or `loadModule` needs an internal variant.
-    // I will not implement internalLoadModule right now to keep it simpler for this stage.
-    // This means the `reloadModule` is not atomic.
-    // The `lock_guard` will release the mutex when `reloadModule` function scope is exited.
-    // This is a known limitation of current simplified approach.
-    //
-    // To actually make it work without deadlock with std::mutex:
-    // The `internalUnloadModule` already expects to be called when lock is held.
-    // `loadModule` needs an `internalLoadModule` counterpart.
-    //
-    // For now, let's make a big simplification: reload is just unload + load.
-    // The lock will be acquired by unload, then by load. This is fine.
-    // The `broadcastEvent` for `Reloaded` is the challenge.
-    //
-    // The `lock_guard` is at the beginning of `reloadModule`.
-    // `internalUnloadModule` is called.
-    // Then `loadModule(modulePath)` needs to be called. This public `loadModule` will try to acquire the same lock.
-    // This IS A DEADLOCK.
-    //
-    // Solution:
-    // 1. Store module path.
-    // 2. Call (public) unloadModule. This will acquire and release the lock.
-    // 3. Call (public) loadModule. This will acquire and release the lock.
-    // This makes reload not atomic but avoids deadlock.
-
-    // Drop the main lock for reloadModule
-    CppModuleMutex.unlock(); 
-    
-    ModuleResult loadRes = loadModule(modulePath); // This will acquire its own lock
-    
-    // Re-acquire lock to broadcast the Reloaded event consistently
-    CppModuleMutex.lock();
-
-    if (loadRes.status == ModuleResult::Status::Success) {
-        // If both unload (implicitly, as it must have been loaded) and load were successful
-        broadcastEvent(ModuleEventType::Reloaded, loadRes.module.value(), "Module reloaded successfully.");
-        return ModuleResult(ModuleResult::Status::Success, "Module reloaded successfully.", loadRes.module);
+    ModuleInfo info;
+    InstanceAnchor anchor;
+    {
+        std::unique_lock<std::mutex> lock(CppModuleMutex);
+        std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
+        auto it = registry->find(moduleName);
+        if (it == registry->end()) {
+            ModuleInfo errorInfo; errorInfo.name = moduleName;
+            // Not broadcasting here: there is nothing to reload
+            return ModuleResult(ModuleResult::Status::NotFound, "Module not found for reload: " + moduleName, errorInfo);
+        }
+        info = it->second;
+        if (info.state != ModuleState::Ready || CppHotReloads.count(moduleName)) {
+            lock.unlock();
+            std::string message = busyMessage(info);
+            std::unique_lock<std::mutex> events = lockEvents();
+            broadcastEvent(ModuleEventType::ErrorUnloading, info, "Failed to unload module during reload: " + message);
+            return ModuleResult(ModuleResult::Status::Error, "Reload failed during unload phase: " + message, info);
+        }
+        // The entry stays in the registry, Unloading, until the new library has been opened: the
+        // name and path remain reserved throughout. Modules that require this one stay loaded.
+        updateRegistry([&](ModuleRegistry& modules) { modules[moduleName].state = ModuleState::Unloading; });
+        anchor = takeAnchor(moduleName);
+    }
+    waitForDrain(anchor);
+
+    ModuleInfo released = info;
+    std::vector<std::string> unloadErrors;
+    bool closed = releaseModule(released, unloadErrors);
+    if (!closed) {
+        std::unique_lock<std::mutex> events;
+        {
+            std::lock_guard<std::mutex> lock(CppModuleMutex);
+            updateRegistry([&](ModuleRegistry& modules) {
+                ModuleInfo& entry = modules[moduleName];
+                entry.instance = nullptr;
+                entry.state = ModuleState::Ready;
+            });
+            events = lockEvents();
+        }
+        for (const std::string& error : unloadErrors) {
+            broadcastEvent(ModuleEventType::ErrorUnloading, released, error);
+        }
+        broadcastEvent(ModuleEventType::ErrorUnloading, released, "Failed to unload module during reload: " + unloadErrors.back());
+        return ModuleResult(ModuleResult::Status::Error, "Reload failed during unload phase: " + unloadErrors.back(), released);
+    }
+
+    PreparedModule module;
+    module.path = info.path;
+    module.isolation = info.isolation;
+    prepareModule(module);
+    {
+        // Swap the old entry for the new module in one step.
+        std::lock_guard<std::mutex> lock(CppModuleMutex);
+        updateRegistry([&](ModuleRegistry& modules) { modules.erase(moduleName); });
+        if (module.error.empty()) {
+            reserveModule(module, true);
+        }
+    }
+    if (!unloadErrors.empty()) {
+        // Shutdown and destroy errors are reported, but the reload goes ahead.
+        std::unique_lock<std::mutex> events = lockEvents();
+        for (const std::string& error : unloadErrors) {
+            broadcastEvent(ModuleEventType::ErrorUnloading, released, error);
+        }
+    }
+
+    ModuleResult loadRes(ModuleResult::Status::Error, "");
+    if (!module.error.empty()) {
+        discardModule(module);
+        std::unique_lock<std::mutex> events = lockEvents();
+        loadRes = failModule(module);
     } else {
-        // Load failed after successful unload.
-        ModuleInfo info; info.name = moduleName; info.path = modulePath; // original info
-        broadcastEvent(ModuleEventType::ErrorLoading, info, "Failed to load module during reload: " + loadRes.message);
-        return ModuleResult(ModuleResult::Status::Error, "Reload failed during load phase: " + loadRes.message, info);
+        initializeModule(module);
+        loadRes = publishModule(module, true);
+    }
+    if (loadRes.status != ModuleResult::Status::Success) {
+        return ModuleResult(ModuleResult::Status::Error, "Reload failed during load phase: " + loadRes.message, released);
+    }
+    return loadRes;
+}
+ModuleResult ModuleLoaderSystem::hotReloadModule(const std::string& moduleName) {
+    ModuleInfo old;
+    {
+        std::unique_lock<std::mutex> lock(CppModuleMutex);
+        std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
+        auto it = registry->find(moduleName);
+        if (it == registry->end()) {
+            ModuleInfo errorInfo; errorInfo.name = moduleName;
+            return ModuleResult(ModuleResult::Status::NotFound, "Module not found for reload: " + moduleName, errorInfo);
+        }
+        old = it->second;
+        if (old.state != ModuleState::Ready || !old.instance || CppHotReloads.count(moduleName)) {
+            std::string message = old.instance ? busyMessage(old) : "Module '" + moduleName + "' has no instance.";
+            return ModuleResult(ModuleResult::Status::Error, "Hot reload failed: " + message, old);
+        }
+        // Keeps unload and reload away; the module stays Ready and in use meanwhile.
+        CppHotReloads.insert(moduleName);
+    }
+
+    // Open the new version next to the running one, from a copy of the library.
+    PreparedModule module;
+    module.path = old.path;
+    module.shadowPath = makeShadowCopy(old.path, module.error);
+    module.localSymbols = true;
+    module.isolation = old.isolation;
+    if (module.error.empty()) {
+        prepareModule(module);
+    }
+    if (module.error.empty() && module.name != moduleName) {
+        module.error = "Hot reload of '" + moduleName + "': " + old.path + " now holds module '" + module.name + "'.";
+    }
+
+    // Hand the running instance's state over before the new one initializes.
+    bool handedOver = false;
+    size_t stateBytes = 0;
+    if (module.error.empty() && old.abiVersion >= 3 && module.manifest && module.manifest->abiVersion >= 3) {
+        try {
+            std::string state = old.instance->exportState();
+            stateBytes = state.size();
+            module.instance->importState(state);
+            handedOver = true;
+        } catch (const std::exception& e) {
+            module.error = "State handoff of module " + moduleName + " failed: " + e.what();
+        } catch (...) {
+            module.error = "State handoff of module " + moduleName + " failed with unknown exception.";
+        }
+    }
+    if (module.error.empty()) {
+        initializeModule(module);
+    }
+    if (!module.error.empty()) {
+        discardModule(module);
+        {
+            std::lock_guard<std::mutex> lock(CppModuleMutex);
+            CppHotReloads.erase(moduleName);
+        }
+        std::unique_lock<std::mutex> events = lockEvents();
+        broadcastEvent(ModuleEventType::ErrorLoading, old, "Hot reload failed: " + module.error);
+        return ModuleResult(ModuleResult::Status::Error, "Hot reload failed, the running instance was kept: " + module.error, old);
+    }
+
+    // The switch: one registry update and one anchor swap, under the lock.
+    ModuleInfo info = infoFor(module, ModuleState::Ready);
+    InstanceAnchor retired;
+    {
+        std::unique_lock<std::mutex> events;
+        {
+            std::lock_guard<std::mutex> lock(CppModuleMutex);
+            updateRegistry([&](ModuleRegistry& modules) { modules[moduleName] = info; });
+            retired = takeAnchor(moduleName);
+            anchorModule(info, module.pinTarget);
+            CppHotReloads.erase(moduleName);
+            events = lockEvents();
+        }
+        broadcastEvent(ModuleEventType::Loaded, info, "Module loaded successfully.");
+        broadcastEvent(ModuleEventType::Reloaded, info, "Module hot reloaded.");
+    }
+
+    // Retire the old instance once the calls still running in it are done.
+    waitForDrain(retired);
+    std::vector<std::string> errors;
+    releaseModule(old, errors);
+    if (!errors.empty()) {
+        std::unique_lock<std::mutex> events = lockEvents();
+        for (const std::string& error : errors) {
+            broadcastEvent(ModuleEventType::ErrorUnloading, old, error);
+        }
+    }
+    std::string message = handedOver ? "Module hot reloaded; " + std::to_string(stateBytes) + " byte(s) of state handed over."
+                                     : "Module hot reloaded without state handoff (needs manifest ABI version 3).";
+    return ModuleResult(ModuleResult::Status::Success, message, info);
+}
+
+std::future<ModuleResult> ModuleLoaderSystem::runAsync(std::function<ModuleResult()> operation) {
+    auto promise = std::make_shared<std::promise<ModuleResult>>();
+    std::future<ModuleResult> result = promise->get_future();
+    bool queued;
+    {
+        std::lock_guard<std::mutex> lock(CppAsyncPoolMutex);
+        if (!CppAsyncPool) {
+            size_t workers = CppAsyncWorkerCount ? CppAsyncWorkerCount : std::max(1u, std::thread::hardware_concurrency());
+            CppAsyncPool = std::make_unique<cli::CommandThreadPool>(workers, ASYNC_QUEUE_CAPACITY);
+        }
+        queued = CppAsyncPool->submit([promise, operation]() {
+            try {
+                promise->set_value(operation());
+            } catch (...) {
+                promise->set_exception(std::current_exception()); // e.g. std::bad_alloc
+            }
+        });
+    }
+    if (!queued) {
+        promise->set_value(ModuleResult(ModuleResult::Status::Error,
+                                        "Module operation rejected: the loader's queue is full or the loader is shutting down."));
+    }
+    return result;
+}
+
+std::future<ModuleResult> ModuleLoaderSystem::loadModuleAsync(const std::string& modulePath) {
+    return runAsync([this, modulePath]() { return loadModule(modulePath); });
+}
+
+std::future<ModuleResult> ModuleLoaderSystem::unloadModuleAsync(const std::string& moduleName) {
+    return runAsync([this, moduleName]() { return unloadModule(moduleName); });
+}
+
+std::future<ModuleResult> ModuleLoaderSystem::reloadModuleAsync(const std::string& moduleName) {
+    return runAsync([this, moduleName]() { return reloadModule(moduleName); });
+}
+
+std::future<ModuleResult> ModuleLoaderSystem::hotReloadModuleAsync(const std::string& moduleName) {
+    return runAsync([this, moduleName]() { return hotReloadModule(moduleName); });
+}
+
+void ModuleLoaderSystem::setAsyncWorkerCount(size_t workers) {
+    std::lock_guard<std::mutex> lock(CppAsyncPoolMutex);
+    CppAsyncWorkerCount = workers;
+}
+
+namespace {
+// Directory part of a module path, as watched; "." for a bare file name.
+std::string libraryDirectory(const std::string& path) {
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    return directory.empty() ? "." : directory;
+}
+} // namespace
+
+bool ModuleLoaderSystem::startWatching(std::chrono::milliseconds debounce) {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(CppWatchMutex);
+    if (CppWatchThread.joinable()) {
+        return true;
     }
+    int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        return false;
+    }
+    CppShadowLoads = true;
+    CppWatchStop = false;
+    CppWatchThread = std::thread([this, inotifyFd, debounce]() {
+        watchLoop(inotifyFd, debounce);
+        close(inotifyFd);
+    });
+    return true;
+#else
+    (void)debounce;
+    return false;
+#endif
 }
 
+void ModuleLoaderSystem::stopWatching() {
+    std::lock_guard<std::mutex> lock(CppWatchMutex);
+    if (CppWatchThread.joinable()) {
+        CppWatchStop = true;
+        CppWatchThread.join();
+    }
+}
+
+bool ModuleLoaderSystem::isWatching() const {
+    std::lock_guard<std::mutex> lock(CppWatchMutex);
+    return CppWatchThread.joinable();
+}
+
+void ModuleLoaderSystem::watchLoop(int inotifyFd, std::chrono::milliseconds debounce) {
+#ifdef __linux__
+    // The loop wakes at least this often to follow the registry and to notice stopWatching().
+    const std::chrono::milliseconds tick(100);
+    std::map<std::string, int> watches;              // Directory -> watch descriptor
+    std::map<int, std::string> watchedDirectories;   // Watch descriptor -> directory
+    std::map<std::string, std::chrono::steady_clock::time_point> due; // Module -> when to reload it
+    alignas(inotify_event) char buffer[4096];
+
+    while (!CppWatchStop) {
+        // Watch the directory of every loaded module's library rather than the file: a build that
+        // renames a new file over the library would leave a watch on the old file with nothing to say.
+        std::map<std::string, std::string> libraries; // Module -> path
+        std::set<std::string> directories;
+        std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
+        for (const auto& pair : *registry) {
+            if (pair.second.state == ModuleState::Ready) {
+                libraries[pair.first] = pair.second.path;
+                directories.insert(libraryDirectory(pair.second.path));
+            }
+        }
+        for (const auto& directory : directories) {
+            if (!watches.count(directory)) {
+                int wd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+                if (wd >= 0) {
+                    watches[directory] = wd;
+                    watchedDirectories[wd] = directory;
+                }
+            }
+        }
+        for (auto it = watches.begin(); it != watches.end();) {
+            if (directories.count(it->first)) {
+                ++it;
+                continue;
+            }
+            inotify_rm_watch(inotifyFd, it->second);
+            watchedDirectories.erase(it->second);
+            it = watches.erase(it);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::milliseconds timeout = tick;
+        for (const auto& pair : due) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(pair.second - now);
+            timeout = std::max(std::chrono::milliseconds(0), std::min(timeout, left));
+        }
+        pollfd readable = {inotifyFd, POLLIN, 0};
+        if (poll(&readable, 1, static_cast<int>(timeout.count())) > 0) {
+            ssize_t length;
+            while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (char* at = buffer; at < buffer + length;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                    at += sizeof(inotify_event) + event->len;
+                    auto directory = watchedDirectories.find(event->wd);
+                    if (event->len == 0 || directory == watchedDirectories.end()) {
+                        continue;
+                    }
+                    // Every further write pushes the reload back: wait until the build is done.
+                    for (const auto& library : libraries) {
+                        if (libraryDirectory(library.second) == directory->second &&
+                            std::filesystem::path(library.second).filename() == event->name) {
+                            due[library.first] = std::chrono::steady_clock::now() + debounce;
+                        }
+                    }
+                }
+            }
+        }
+
+        now = std::chrono::steady_clock::now();
+        for (auto it = due.begin(); it != due.end() && !CppWatchStop;) {
+            if (it->second > now) {
+                ++it;
+                continue;
+            }
+            std::string moduleName = it->first;
+            it = due.erase(it);
+            if (libraries.count(moduleName)) {
+                // A failed reload keeps the running version; the next write to the file retries.
+                hotReloadModule(moduleName);
+            }
+        }
+    }
+#else
+    (void)inotifyFd;
+    (void)debounce;
+#endif
+}
 
 std::vector<ModuleInfo> ModuleLoaderSystem::listModules() const {
-    std::lock_guard<std::mutex> lock(CppModuleMutex);
+    std::shared_ptr<const ModuleRegistry> registry = registrySnapshot();
     std::vector<ModuleInfo> modules;
-    for (const auto& pair : CppLoadedModules) {
+    modules.reserve(registry->size());
+    for (const auto& pair : *registry) {
         modules.push_back(pair.second);
     }
     return modules;
 }
 
 void ModuleLoaderSystem::subscribeToModuleEvents(ModuleEventCallback callback) {
-    std::lock_guard<std::mutex> lock(CppModuleMutex);
+    std::unique_lock<std::mutex> events = lockEvents();
     CppEventCallbacks.push_back(callback);
 }
 
-void ModuleLoaderSystem::broadcastEvent(ModuleEventType type, const ModuleInfo& info, const std::string& message) {
-    // This function assumes CppModuleMutex is ALREADY HELD by the caller.
-    // Or, if it's for an error that occurs before lock, it might need to acquire it.
-    // Given its usage, it's usually called when lock is held.
-
-    // Copy callbacks in case one tries to subscribe/unsubscribe during iteration.
-    std::vector<ModuleEventCallback> callbacks_copy = CppEventCallbacks;
+void ModuleLoaderSystem::subscribeToModuleProgress(ModuleProgressCallback callback) {
+    std::lock_guard<std::mutex> lock(CppProgressMutex);
+    CppProgressCallbacks.push_back(callback);
+}
 
-    for (const auto& callback : callbacks_copy) {
+void ModuleLoaderSystem::broadcastEvent(ModuleEventType type, const ModuleInfo& info, const std::string& message) {
+    // Expects CppEventMutex held by the caller (see lockEvents()), but not CppModuleMutex.
+    for (const auto& callback : CppEventCallbacks) {
         try {
             callback(type, info, message);
         } catch (const std::exception& e) {
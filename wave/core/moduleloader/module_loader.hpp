@@ -5,11 +5,20 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <set>
+#include <atomic>
+#include <thread>
 #include <functional>
+#include <future>
 #include <any>
 #include <optional>
 #include <chrono> // For potential future use in ModuleInfo (e.g. load time)
 
+#include "module_manifest.hpp"
+#include "core_api.hpp"
+
 // Platform-specific includes for dynamic library loading
 #ifdef _WIN32
 #include <windows.h>
@@ -19,15 +28,51 @@
 
 namespace wave {
 namespace core {
+namespace cli {
+class CommandThreadPool;
+}
 namespace moduleloader {
 
 // Forward declaration
-class ICoreAccess;
 class ILauncherModule;
+class ModuleIndex;
 
 // Re-using StructuredData definition
 using StructuredData = std::any;
 
+// Where a module is in its life cycle. A module is listed from the moment its name is known:
+// Loading while initialize() runs, Ready once loaded, Unloading while shutdown() runs. Only a Ready
+// module's instance may be used; the loader refuses to unload or reload a module in another state.
+enum class ModuleState {
+    Loading,
+    Ready,
+    Unloading
+};
+
+// Where the time (and memory) went while a module loaded. Phases match ModulePhase: open is
+// dlopen including relocation of the library, symbols the manifest and entry point lookups, create
+// create_module_instance, initialize ILauncherModule::initialize. rssDeltaBytes is the change of
+// the process's resident set from before dlopen to after initialize() (Linux only, 0 elsewhere);
+// memory other threads allocated meanwhile, e.g. modules loading in parallel, counts too.
+struct ModuleLoadProfile {
+    std::chrono::microseconds open{0};
+    std::chrono::microseconds symbols{0};
+    std::chrono::microseconds create{0};
+    std::chrono::microseconds initialize{0};
+    long long rssDeltaBytes = 0;
+
+    std::chrono::microseconds total() const { return open + symbols + create + initialize; }
+};
+
+// How a module loaded with ModuleLoaderSystem::loadIsolatedModule runs: in a module host process
+// (see module_host.hpp), started from 'hostExecutable'.
+struct IsolationOptions {
+    std::string hostExecutable;
+    size_t memoryLimitBytes = 0;   // Address space limit of the host (RLIMIT_AS); 0 = none
+    unsigned maxRestarts = 3;      // Host crashes survived before the module stays down
+    std::chrono::milliseconds callTimeout{30000}; // A call taking longer counts as a hang: the host is killed
+};
+
 // Module Information
 struct ModuleInfo {
     std::string name;
@@ -35,11 +80,33 @@ struct ModuleInfo {
     std::string path; // Filesystem path to the loaded module file
     void* libraryHandle; // OS-specific handle (HMODULE or void*)
     ILauncherModule* instance; // Pointer to the module instance
+    std::vector<std::string> provides;     // From the manifest; empty for modules without one
+    std::vector<std::string> requirements; // Module or capability names this module needs
+    ModuleState state;
+    ModuleLoadProfile profile; // Of the load that produced this instance
+    unsigned abiVersion;       // Of the module's manifest; 0 for modules without one
+    // The private copy of 'path' the library was opened from after a hot reload, removed again when
+    // the module is unloaded. Empty if the library was opened from 'path' itself.
+    std::string shadowPath;
+    // Set for a module running in a module host process; 'instance' is then a HostedModule and
+    // 'libraryHandle' is null.
+    std::optional<IsolationOptions> isolation;
 
-    ModuleInfo() : libraryHandle(nullptr), instance(nullptr) {}
+    ModuleInfo() : libraryHandle(nullptr), instance(nullptr), state(ModuleState::Ready), abiVersion(0) {}
     // Making ModuleInfo movable and copyable (default is fine for now, but consider ownership of instance if not raw pointer)
 };
 
+// A module's manifest (see module_manifest.hpp), copied out of the library.
+struct ModuleManifest {
+    unsigned abiVersion = 0;
+    std::string name;
+    std::string version;
+    std::vector<std::string> provides;
+    std::vector<std::string> requirements;
+    std::vector<std::string> commands; // Version 2 manifests only
+    std::vector<std::string> topics;   // Version 2 manifests only
+};
+
 // Result of module operations
 struct ModuleResult {
     enum class Status {
@@ -69,38 +136,161 @@ enum class ModuleEventType {
 // Callback for module events
 using ModuleEventCallback = std::function<void(ModuleEventType type, const ModuleInfo& info, const std::string& message)>;
 
+// Steps of loading and unloading a module, reported as they complete.
+enum class ModulePhase {
+    Opened,          // Library opened (dlopen / LoadLibrary)
+    SymbolsResolved, // Manifest read, entry points found
+    Created,         // create_module_instance returned
+    Initialized,     // ILauncherModule::initialize returned
+    ShutDown,        // ILauncherModule::shutdown and destroy_module_instance returned
+    Closed           // Library closed
+};
+
+struct ModuleProgress {
+    std::string path;
+    std::string name; // Empty before the module is created
+    ModulePhase phase;
+    std::chrono::microseconds phaseDuration{0}; // Time spent in this phase
+    std::chrono::microseconds elapsed{0};       // Since the load or unload of this module started
+};
+
+// Called on the thread doing the work, possibly on several threads at once, with no loader lock
+// held. A failed step is not reported here; the operation's result and event carry the error.
+using ModuleProgressCallback = std::function<void(const ModuleProgress& progress)>;
+
 // Interface for modules (to be implemented by actual modules)
 class ILauncherModule {
 public:
     virtual ~ILauncherModule() = default;
-    virtual void initialize(ICoreAccess* coreAccess) = 0;
+    // 'core' gives access to the core's services (see core_api.hpp) and stays valid until
+    // shutdown() returns. It may be null, e.g. in tests.
+    virtual void initialize(const WaveCoreApi* core) = 0;
+    // A module that registered CLI commands in initialize() removes them here with
+    // CLIEngine::unregisterCommand(name, *command). During a hot reload the replacement instance
+    // has already registered its own commands under the same names when the old one shuts down,
+    // and removing by name alone would remove those.
     virtual void shutdown() = 0;
     virtual std::string getName() const = 0;
     virtual std::string getVersion() const = 0;
-};
 
-// Dummy interface for core access (to be provided by the core to modules)
-class ICoreAccess {
-public:
-    virtual ~ICoreAccess() = default;
-    // Example: virtual LoggingSystem* getLoggingSystem() = 0;
-    // For now, it's empty as per requirements.
-    virtual void placeholder() const { /* Does nothing */ } // To make it have at least one virtual method if needed
+    // State handoff for hot reload. Called only for modules whose manifest declares ABI version 3 or
+    // later (see module_manifest.hpp), so modules built against older headers never see them.
+    // exportState() is called on the running instance, importState() on its replacement, before that
+    // one's initialize(). The format is the module's own. importState() throws to reject the state,
+    // which cancels the hot reload and leaves the running instance in place.
+    virtual std::string exportState() { return std::string(); }
+    virtual void importState(const std::string& state) { (void)state; }
 };
 
 
 // Module Loader System
+//
+// Module code (create_module_instance, initialize(), shutdown(), destroy_module_instance) never
+// runs under the loader lock: that lock only guards changes to the registry of modules, and a
+// module's state reserves its name and path while its own code runs. Loads and unloads of
+// different modules therefore proceed concurrently, and listModules() reads an immutable snapshot
+// of the registry without locking at all.
+//
+// Event callbacks run one at a time, in the order the registry changed, without the loader lock.
+// A callback may call listModules() but must not load, unload or reload modules, or subscribe.
 class ModuleLoaderSystem {
 public:
-    ModuleLoaderSystem(ICoreAccess* coreAccess); // Provide core access to modules
+    // 'coreApi' is passed to every module's initialize(); it must outlive the loader. See
+    // CoreServiceRegistry for building one.
+    explicit ModuleLoaderSystem(const WaveCoreApi* coreApi);
     ~ModuleLoaderSystem();
 
-    ModuleResult loadModule(const std::string& modulePath);
+    // Takes a library path or a bare module name, which is looked up in the search paths (see
+    // ModuleIndex::resolve). ModuleInfo::path is the resolved path.
+    ModuleResult loadModule(const std::string& moduleNameOrPath);
+    // Loads several modules at once, e.g. everything listed in modules.conf at startup. All
+    // libraries are opened (dlopen, symbol lookup, create_module_instance) in parallel without
+    // holding the loader lock, then the modules are initialized. Uses up to maxThreads threads
+    // (0 = one per hardware thread) and returns one result per path, in order.
+    // Initialization follows the manifests' dependencies: each wave holds the modules whose
+    // requirements are met by loaded modules or earlier waves, and its modules are initialized
+    // concurrently. A module whose requirement is missing, failed, or part of a cycle is not
+    // loaded. Events are broadcast in initialization order once every module is done.
+    std::vector<ModuleResult> loadModules(const std::vector<std::string>& moduleNamesOrPaths, size_t maxThreads = 0);
+    // Loads a module into a child process of its own (see HostedModule), so a crash or runaway
+    // allocation in the module does not take the launcher down. Otherwise it behaves like
+    // loadModule(): the module is listed, unloaded, reloaded and hot reloaded like any other, and
+    // stays isolated across reloads. Linux only.
+    ModuleResult loadIsolatedModule(const std::string& moduleNameOrPath, const IsolationOptions& options);
+    // Fails if another loaded module requires this one (or a capability only it provides).
     ModuleResult unloadModule(const std::string& moduleName);
-    ModuleResult reloadModule(const std::string& moduleName); // Convenience: unload then load
+    // Unloads every module in reverse dependency order: modules nothing depends on first, each
+    // wave shut down concurrently on up to maxThreads threads.
+    void unloadAllModules(size_t maxThreads = 0);
+    // Unload then load from the same path; the name stays reserved in between, and modules that
+    // require this one are left loaded.
+    ModuleResult reloadModule(const std::string& moduleName);
+    // Replaces a module without taking it down. The library at the module's path is copied to a
+    // private file and opened next to the running one (RTLD_LOCAL), the running instance's state is
+    // handed to the new one (ABI version 3 modules), the new instance is initialized, and then the
+    // registry switches to it in one step: from then on listModules() and acquireModule() return
+    // the new instance. The old one is shut down and its library closed once every ModuleRef to it
+    // has been released. If anything fails before the switch the running instance stays as it was.
+    // Both libraries are loaded at the same time, so a module that supports this must keep its
+    // implementation out of the global symbol namespace (internal linkage or hidden visibility), or
+    // the new library's code may bind to the old one's. CLI commands the new instance registers
+    // take over the old instance's (see setInitializeScope and ILauncherModule::shutdown), and the
+    // old library is not closed while one of its commands is still running.
+    ModuleResult hotReloadModule(const std::string& moduleName);
+
+    // A reference that keeps a module instance from being shut down while a call into it runs.
+    // Unloading, reloading or hot reloading the module waits until every ModuleRef to the instance
+    // is gone, so hold one only for the duration of a call and never while unloading from the same
+    // thread. Returns nullptr unless the module is Ready.
+    using ModuleRef = std::shared_ptr<ILauncherModule>;
+    ModuleRef acquireModule(const std::string& moduleName) const;
 
+    // Wraps every in-process module's initialize(), on the thread that runs it: scope(name, pin) is
+    // called first and what it returns is released once initialize() has returned. pin() yields a
+    // ModuleRef to the instance being initialized while that instance is Ready, and nullptr before
+    // (including between a hot reload's initialize() and its switch) and once it is unloaded or
+    // replaced. Core uses this to pin a module for the duration of every CLI command it registers
+    // (cli::CommandOwnerScope), so unload, reload and hot reload also wait for those commands.
+    using InstancePin = std::function<ModuleRef()>;
+    using InitializeScope = std::function<std::shared_ptr<void>(const std::string& moduleName, InstancePin pin)>;
+    void setInitializeScope(InitializeScope scope);
+
+    // Asynchronous variants: the operation runs on the loader's worker pool and the future yields
+    // its result; events and progress are reported as for the blocking calls. If the pool's queue
+    // is full the future holds an Error result right away. Operations still queued when the loader
+    // is destroyed run first.
+    std::future<ModuleResult> loadModuleAsync(const std::string& modulePath);
+    std::future<ModuleResult> unloadModuleAsync(const std::string& moduleName);
+    std::future<ModuleResult> reloadModuleAsync(const std::string& moduleName);
+    std::future<ModuleResult> hotReloadModuleAsync(const std::string& moduleName);
+    // Size of the worker pool (0 = one per hardware thread). Takes effect only before the first
+    // asynchronous operation starts the pool.
+    void setAsyncWorkerCount(size_t workers);
+
+    // Watches the libraries of loaded modules and hot reloads a module (see hotReloadModule) once
+    // its file has been rewritten or replaced and then left alone for 'debounce', since a build
+    // writes a library in several steps. While watching, modules are loaded from versioned shadow
+    // copies in the temporary directory, so a build may overwrite the original library freely;
+    // start watching before loading the modules to watch. Reloads report through the module events
+    // like any other. Needs inotify: returns false on other platforms, or if the watch cannot be
+    // set up. The reloads run on the watcher's thread.
+    bool startWatching(std::chrono::milliseconds debounce = std::chrono::milliseconds(500));
+    void stopWatching(); // Waits for a reload in progress
+    bool isWatching() const;
+
+    // Every module in the registry, including those still Loading or already Unloading. Lock-free.
     std::vector<ModuleInfo> listModules() const;
+    // Reads a library's manifest without creating the module. Returns nullopt, with the reason in
+    // 'error', if the library cannot be opened, exports no manifest, or has an unsupported ABI;
+    // 'opened' tells the first case from the others. Opens the library every time; ModuleIndex
+    // caches the result.
+    static std::optional<ModuleManifest> readModuleManifest(const std::string& modulePath, std::string* error = nullptr,
+                                                            bool* opened = nullptr);
+    // Search paths and the manifest cache. loadModule() and loadModules() resolve bare module
+    // names through it, so configure it before loading.
+    ModuleIndex& getModuleIndex() { return *CppIndex; }
     void subscribeToModuleEvents(ModuleEventCallback callback);
+    void subscribeToModuleProgress(ModuleProgressCallback callback);
 
     // Define function pointer types for module entry points
     // These are functions that each module shared library is expected to export.
@@ -109,15 +299,117 @@ public:
 
 
 private:
-    mutable std::mutex CppModuleMutex; // Renamed
-    std::map<std::string, ModuleInfo> CppLoadedModules; // Keyed by module name (from ILauncherModule::getName()) // Renamed
+    using ModuleRegistry = std::map<std::string, ModuleInfo>; // Keyed by module name (from ILauncherModule::getName())
+
+    // The registry is never modified in place: writers copy it under CppModuleMutex and publish the
+    // copy with std::atomic_store; readers take the current one with std::atomic_load.
+    std::shared_ptr<const ModuleRegistry> CppModules;
+    mutable std::mutex CppModuleMutex;   // Serializes registry writers; guards CppPendingPaths
+    std::set<std::string> CppPendingPaths; // Paths being opened, before the module's name is known
+    std::set<std::string> CppHotReloads;   // Modules being hot reloaded; guarded by CppModuleMutex
+
+    // Counts the ModuleRefs of one instance: 'ref' is the one acquireModule copies, and its deleter
+    // runs when the last copy is gone.
+    struct DrainSignal {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool drained = false;
+    };
+    // What an InstancePin resolves: the anchor's ref while the instance is Ready.
+    struct PinTarget {
+        std::mutex mutex;
+        std::weak_ptr<ILauncherModule> ref;
+    };
+    struct InstanceAnchor {
+        ModuleRef ref;
+        std::shared_ptr<DrainSignal> signal;
+        std::shared_ptr<PinTarget> pinTarget; // Cleared when the anchor is taken: no new pins
+    };
+    std::map<std::string, InstanceAnchor> CppAnchors; // Ready modules; guarded by CppModuleMutex
+    InitializeScope CppInitializeScope;                // Guarded by CppModuleMutex
+    // Expects CppModuleMutex held. pinTarget is the instance's, if initialize() ran in a scope.
+    void anchorModule(const ModuleInfo& info, const std::shared_ptr<PinTarget>& pinTarget);
+    InstanceAnchor takeAnchor(const std::string& moduleName); // Expects CppModuleMutex held
+    static void waitForDrain(InstanceAnchor& anchor);   // Drops the anchor's ref and waits for the others
+    std::mutex CppEventMutex;            // Serializes event delivery; guards CppEventCallbacks
     std::vector<ModuleEventCallback> CppEventCallbacks; // Renamed
-    ICoreAccess* CppCoreAccess; // Non-owning pointer to core access interface // Renamed
+    const WaveCoreApi* CppCoreApi; // Non-owning; handed to every module's initialize()
+    std::mutex CppProgressMutex; // Guards CppProgressCallbacks only; callbacks run without it
+    std::vector<ModuleProgressCallback> CppProgressCallbacks;
+    std::unique_ptr<ModuleIndex> CppIndex;
 
-    void broadcastEvent(ModuleEventType type, const ModuleInfo& info, const std::string& message);
-    
-    // Internal helper to unload a module, assumes lock is held or not needed if called from public method that locks
-    ModuleResult internalUnloadModule(const std::string& moduleName, bool isReloading = false);
+    // File watching (startWatching). CppShadowLoads makes every load open a shadow copy.
+    std::atomic<bool> CppShadowLoads{false};
+    std::atomic<bool> CppWatchStop{false};
+    mutable std::mutex CppWatchMutex; // Guards CppWatchThread
+    std::thread CppWatchThread;
+    void watchLoop(int inotifyFd, std::chrono::milliseconds debounce);
+
+    // Worker pool of the *Async operations, started on first use.
+    std::mutex CppAsyncPoolMutex;
+    std::unique_ptr<cli::CommandThreadPool> CppAsyncPool;
+    size_t CppAsyncWorkerCount = 0;
+    std::future<ModuleResult> runAsync(std::function<ModuleResult()> operation);
+
+    std::shared_ptr<const ModuleRegistry> registrySnapshot() const;
+    // Applies 'edit' to a copy of the registry and publishes it. Expects CppModuleMutex held.
+    void updateRegistry(const std::function<void(ModuleRegistry&)>& edit);
+    // Takes the event lock. Called with CppModuleMutex still held, so events are delivered in the
+    // order the registry changed; the caller then releases CppModuleMutex and broadcasts.
+    std::unique_lock<std::mutex> lockEvents();
+    void broadcastEvent(ModuleEventType type, const ModuleInfo& info, const std::string& message); // Expects the event lock held
+
+    // A module on its way in: library opened and instance created, not yet registered.
+    struct PreparedModule {
+        std::string path;
+        std::string shadowPath; // If set, the library is opened from this copy of 'path'
+        bool localSymbols = false; // Opened next to a running copy of itself: RTLD_LOCAL
+        std::optional<IsolationOptions> isolation; // Runs in a module host instead of this process
+        void* handle = nullptr;
+        CreateModuleFunc create = nullptr;
+        DestroyModuleFunc destroy = nullptr;
+        ILauncherModule* instance = nullptr;
+        std::string name;
+        std::string version;
+        std::optional<ModuleManifest> manifest;
+        std::string error; // Set by the step that failed
+        std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point phaseStarted = started;
+        ModuleLoadProfile profile;
+        long long residentBefore = -1; // Bytes, -1 if unknown
+        std::shared_ptr<PinTarget> pinTarget; // Set by initializeModule when an InitializeScope is set
+    };
+    // Reports a completed phase to the progress callbacks, starts timing the next one and returns
+    // the phase's duration.
+    std::chrono::microseconds reportPhase(const std::string& path, const std::string& name, ModulePhase phase,
+                     std::chrono::steady_clock::time_point started, std::chrono::steady_clock::time_point& phaseStarted);
+    // Load steps. prepareModule, initializeModule and discardModule run module code and are called
+    // without any loader lock.
+    void prepareModule(PreparedModule& module);    // dlopen, manifest, dlsym, create_module_instance
+    void prepareHostedModule(PreparedModule& module, const std::string& openPath); // prepareModule in a module host
+    void initializeModule(PreparedModule& module); // ILauncherModule::initialize
+    void discardModule(PreparedModule& module);    // destroy_module_instance, close the library, remove the shadow copy
+    // Expects CppModuleMutex held. Adds the module in state Loading, or sets its error if the name is
+    // taken or (with checkRequirements) a requirement has no Ready provider.
+    void reserveModule(PreparedModule& module, bool checkRequirements);
+    // Marks a reserved module Ready, or removes it if its initialize() failed, and reports the
+    // outcome. Takes the locks itself. 'reloaded' adds a Reloaded event after Loaded.
+    ModuleResult publishModule(PreparedModule& module, bool reloaded = false);
+    ModuleResult failModule(PreparedModule& module); // Expects the event lock held
+    static ModuleInfo infoFor(const PreparedModule& module, ModuleState state);
+    // loadModule and loadIsolatedModule.
+    ModuleResult loadSingle(const std::string& moduleNameOrPath, const std::optional<IsolationOptions>& isolation);
+    // Expects CppModuleMutex held: true if a module of the registry, or a load in progress, uses the path.
+    bool isPathTaken(const ModuleRegistry& registry, const std::string& modulePath, ModuleInfo* loaded = nullptr) const;
+    // Capability (and module) name -> name of the Ready module providing it.
+    static std::map<std::string, std::string> readyProviders(const ModuleRegistry& registry);
+    // Name of another module (in any state) that needs 'moduleName', or empty if none does.
+    static std::string findDependent(const ModuleRegistry& registry, const std::string& moduleName);
+    // shutdown(), destroy_module_instance and closing the library. Runs module code and touches no
+    // loader state, so it runs without the lock, on several threads in unloadAllModules. Problems are
+    // appended to 'errors'; returns false if the library could not be closed.
+    bool releaseModule(ModuleInfo& info, std::vector<std::string>& errors);
+    void internalUnloadAll(size_t maxThreads, bool broadcast);
 };
 
 } // namespace moduleloader
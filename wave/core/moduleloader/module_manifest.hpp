@@ -0,0 +1,62 @@
+#ifndef WAVE_CORE_MODULELOADER_MODULE_MANIFEST_HPP
+#define WAVE_CORE_MODULELOADER_MODULE_MANIFEST_HPP
+
+#include <stdint.h>
+
+// Module manifest: what a module library is and what it needs, readable by the loader without
+// creating or initializing the module. A module exports it next to create_module_instance:
+//
+//   static const char* const provides[] = {"storage.sql", nullptr};
+//   static const char* const requirements[] = {"EventMonitor", nullptr};
+//   static const char* const commands[] = {"db query", "db stats", nullptr};
+//   static const WaveModuleManifest manifest = {WAVE_MODULE_ABI_VERSION, "Database", "1.2.0", provides, requirements,
+//                                               commands, nullptr};
+//   extern "C" const WaveModuleManifest* wave_module_manifest() { return &manifest; }
+//
+// Plain C types only, so a library built by another compiler (or in C) can describe itself. The
+// strings and lists must stay valid while the library is loaded; static storage is the usual way.
+//
+// Every module must export a manifest: it is how the loader knows which interface the module was
+// built against, and libraries without one are refused. A module always provides its own name.
+// Each entry in 'requirements' names a module or a capability another module provides; the loader
+// initializes providers first and shuts them down last, and refuses to unload a module that a
+// loaded module still requires.
+//
+// 'commands' and 'topics' (ABI version 2) list the CLI commands the module registers and the
+// EventBus topics it handles. They let the core load a module marked lazy in modules.conf on
+// first use: the core registers stand-ins for them and loads the module when one is used.
+//
+// Versions: 1 = name, version, provides, requirements; 2 = adds commands, topics; 3 = no new
+// fields, but the module's ILauncherModule has exportState()/importState(), which the loader calls
+// on hot reload; 4 = no new fields, but ILauncherModule::initialize receives the core's WaveCoreApi
+// (core_api.hpp) instead of an ICoreAccess. The loader reads only the fields of the version a
+// module declares and calls the state hooks only from version 3 on. Modules declaring a version
+// before 4, like those without a manifest, are refused: their initialize() expects the old
+// argument and must be rebuilt.
+
+#define WAVE_MODULE_ABI_VERSION 4u
+#define WAVE_MODULE_MIN_ABI_VERSION 4u // Oldest version the loader accepts
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct WaveModuleManifest {
+    uint32_t abiVersion;                  // WAVE_MODULE_ABI_VERSION the module was built against
+    const char* name;                     // Must match ILauncherModule::getName()
+    const char* version;
+    const char* const* provides;          // nullptr-terminated capability names, or nullptr
+    const char* const* requirements;      // nullptr-terminated module/capability names, or nullptr
+    // Version 2
+    const char* const* commands;          // nullptr-terminated full command names ("db query"), or nullptr
+    const char* const* topics;            // nullptr-terminated EventBus topics, or nullptr
+};
+
+// Signature of the exported "wave_module_manifest" function.
+typedef const struct WaveModuleManifest* (*WaveModuleManifestFunc)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAVE_CORE_MODULELOADER_MODULE_MANIFEST_HPP
@@ -0,0 +1,158 @@
+#include "core/cli/input_parser.hpp"
+#include "core/cli/remote_protocol.hpp"
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Command-line client for a launcher started with [CLI] listen_uri.
+//
+// Usage: launcher-cli [-r|--remote <uri>] [command ...]
+//
+//   --remote <uri>  Server address (default: unix:/tmp/launcher.sock).
+//   command ...     Runs this single command. Without one, every line of stdin is sent as a command.
+//
+// Rows and string data are printed to stdout, "[Status] message" lines to stderr.
+// Exit status is 1 if any command ended with Error, 2 on connection or usage errors.
+
+namespace {
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [-r|--remote <uri>] [command ...]\n";
+}
+
+#ifdef __linux__
+// Buffered reader for '\n'-terminated frames.
+class FrameReader {
+public:
+    explicit FrameReader(int fd) : CppFd(fd) {}
+
+    bool next(std::string& frame) {
+        while (true) {
+            size_t newline = CppBuffer.find('\n');
+            if (newline != std::string::npos) {
+                frame = CppBuffer.substr(0, newline);
+                CppBuffer.erase(0, newline + 1);
+                return true;
+            }
+            char chunk[4096];
+            ssize_t received = ::recv(CppFd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            CppBuffer.append(chunk, static_cast<size_t>(received));
+        }
+    }
+
+private:
+    int CppFd;
+    std::string CppBuffer;
+};
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Sends one command and prints its frames until the status frame.
+// Returns 0 on Success/Warning, 1 on Error, 2 if the connection broke.
+int runCommand(int fd, FrameReader& reader, const std::string& command) {
+    if (!sendAll(fd, command + "\n")) {
+        std::cerr << "Connection lost while sending command.\n";
+        return 2;
+    }
+    std::string frame;
+    while (reader.next(frame)) {
+        if (frame.size() < 2) {
+            continue;
+        }
+        std::string payload = wave::core::cli::unescapeRemotePayload(std::string_view(frame).substr(2));
+        if (frame[0] == wave::core::cli::REMOTE_FRAME_STATUS) {
+            size_t space = payload.find(' ');
+            std::string status = payload.substr(0, space);
+            std::string message = space == std::string::npos ? std::string() : payload.substr(space + 1);
+            std::cerr << "[" << status << "] " << message << "\n";
+            return status == "Error" ? 1 : 0;
+        }
+        if (frame[0] == wave::core::cli::REMOTE_FRAME_OUTPUT) {
+            std::cout << payload << std::flush; // "--output" bytes already carry their own line ends
+            continue;
+        }
+        std::cout << payload << "\n";
+    }
+    std::cerr << "Connection closed by the launcher.\n";
+    return 2;
+}
+#endif
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string uri = "unix:/tmp/launcher.sock";
+    std::string command;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-r" || arg == "--remote") && i + 1 < argc && command.empty()) {
+            uri = argv[++i];
+        } else if ((arg == "-h" || arg == "--help") && command.empty()) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            // Re-quoted so the server's tokenizer sees each word as one argument again; a lone "|"
+            // still separates pipeline stages.
+            command += (command.empty() ? "" : " ") + (arg == "|" ? arg : wave::core::cli::InputParser::quote(arg));
+        }
+    }
+
+#ifdef __linux__
+    wave::core::cli::RemoteEndpoint endpoint;
+    std::string error;
+    if (!wave::core::cli::parseRemoteUri(uri, endpoint, &error)) {
+        std::cerr << error << "\n";
+        return 2;
+    }
+    int fd = wave::core::cli::connectRemoteEndpoint(endpoint, &error);
+    if (fd < 0) {
+        std::cerr << error << "\n";
+        return 2;
+    }
+
+    FrameReader reader(fd);
+    int exitCode = 0;
+    if (!command.empty()) {
+        exitCode = runCommand(fd, reader, command);
+    } else {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue; // The server sends no reply for blank lines.
+            }
+            int status = runCommand(fd, reader, line);
+            if (status == 2) {
+                exitCode = 2;
+                break;
+            }
+            exitCode = std::max(exitCode, status);
+            if (line == "exit" || line == "quit") {
+                break;
+            }
+        }
+    }
+    ::close(fd);
+    return exitCode;
+#else
+    (void)command;
+    std::cerr << "launcher-cli is only supported on Linux.\n";
+    return 2;
+#endif
+}
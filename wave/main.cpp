@@ -0,0 +1,96 @@
+#include "core/core.hpp"
+#include "core/cli/output_formatter.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+
+// Launcher entry point.
+//
+// Usage: launcher [--config <path>] [--batch [<script>|-]] [--parallel] [--keep-going] [--output <format>]
+//
+//   --config <path>   Core configuration file (default: wave/conf/launcher.conf).
+//   --batch [script]  Execute the script (or stdin when omitted or "-") without the interactive
+//                     prompt, print a summary and exit. Exit status is 1 if any statement failed.
+//   --parallel        Batch mode: run statements concurrently between "wait" barriers.
+//   --keep-going      Batch mode: continue after a failing statement instead of stopping.
+//   --output <format> Output format of command results: text (default), json, tsv or binary.
+//                     In batch mode the final summary is written in that format too.
+
+namespace {
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--config <path>] [--batch [<script>|-]] [--parallel] [--keep-going] [--output <format>]\n";
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string configPath = "wave/conf/launcher.conf";
+    bool batchMode = false;
+    std::string scriptPath = "-";
+    wave::core::cli::ScriptOptions scriptOptions;
+    std::string outputFormat;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (arg == "--batch") {
+            batchMode = true;
+            if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                scriptPath = argv[++i];
+            }
+        } else if (arg == "--parallel") {
+            scriptOptions.parallel = true;
+        } else if (arg == "--keep-going") {
+            scriptOptions.stopOnError = false;
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputFormat = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    wave::core::Core core;
+    core.initialize(configPath);
+    wave::core::cli::CLIEngine* cli = core.getCLIEngine();
+    if (!outputFormat.empty() && !cli->setDefaultOutputFormat(outputFormat)) {
+        std::cerr << "Unknown output format: " << outputFormat << "\n";
+        core.shutdown();
+        return 2;
+    }
+
+    int exitCode = 0;
+    if (batchMode) {
+        std::ifstream scriptFile;
+        std::istream* script = &std::cin;
+        if (scriptPath != "-") {
+            scriptFile.open(scriptPath);
+            if (!scriptFile.is_open()) {
+                std::cerr << "Cannot open script: " << scriptPath << "\n";
+                core.shutdown();
+                return 2;
+            }
+            script = &scriptFile;
+        }
+
+        scriptOptions.transcript = &std::cout;
+        wave::core::cli::CommandResult summary = cli->executeScript(*script, scriptOptions);
+        if (outputFormat.empty() || outputFormat == "text") {
+            std::cout << "[" << wave::core::cli::CommandResult::statusToString(summary.status) << "] "
+                      << summary.message << std::endl;
+        } else {
+            cli->getOutputFormatters().create(outputFormat, std::cout)->finish(summary);
+        }
+        exitCode = summary.status == wave::core::cli::CommandResult::Status::Error ? 1 : 0;
+    } else {
+        cli->startInteractiveSession();
+    }
+
+    core.shutdown();
+    return exitCode;
+}
@@ -0,0 +1,276 @@
+#include "core/eventbus/eventbus.hpp"
+#include "core/configuration/configuration.hpp"
+#include "core/logging/logging.hpp"
+#include "core/cli/cli_engine.hpp"
+#include "core/cli/output_formatter.hpp"
+#include "core/cli/output_stream.hpp"
+#include "core/cli/remote_protocol.hpp"
+#include "core/moduleloader/core_services.hpp"
+#include "core/moduleloader/module_host.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <dlfcn.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Module host: runs one isolated module for a launcher (see core/moduleloader/module_host.hpp).
+// Started by the launcher, never by hand.
+//
+// Usage: module_host --channel <fd> [--memory-limit <bytes>] <library>
+//
+//   --channel <fd>          The ModuleHostChannel the launcher created and passed down.
+//   --memory-limit <bytes>  Address space limit of this process; 0 (the default) for none.
+//
+// The module gets a core of its own: logging, configuration, an EventBus and a CLIEngine local to
+// this process, and no module loader. The host exits when asked to, when its channel fails, or
+// when the launcher dies.
+
+namespace {
+using namespace wave::core;
+
+class HostCore {
+public:
+    HostCore() {
+        CppServices.setService(WAVE_SERVICE_LOGGING, &CppLogging);
+        CppServices.setService(WAVE_SERVICE_CONFIGURATION, &CppConfiguration);
+        CppServices.setService(WAVE_SERVICE_EVENTBUS, &CppEventBus);
+        CppServices.setService(WAVE_SERVICE_CLI, &CppCliEngine);
+        CppServices.setLogFunction([this](uint32_t level, const std::string& source, const std::string& message) {
+            CppLogging.log(logging::LogEntry(static_cast<logging::LogLevel>(std::min(level, WAVE_LOG_ERROR)), source, message));
+        });
+    }
+
+    const WaveCoreApi* api() const { return CppServices.api(); }
+    eventbus::EventBus& getEventBus() { return CppEventBus; }
+    cli::CLIEngine& getCLIEngine() { return CppCliEngine; }
+
+private:
+    logging::LoggingSystem CppLogging;
+    configuration::ConfigurationSystem CppConfiguration;
+    eventbus::EventBus CppEventBus;
+    cli::CLIEngine CppCliEngine;
+    moduleloader::CoreServiceRegistry CppServices; // Declared last, so it goes before the services it hands out
+};
+
+// Collects the rows a command emits as remote protocol frames.
+class FrameSink : public cli::IOutputSink {
+public:
+    explicit FrameSink(const cli::OutputFormatterRegistry& formatters) : CppFormatters(formatters) {}
+
+    bool write(cli::StructuredData row) override {
+        cli::appendRemoteFrame(frames, cli::REMOTE_FRAME_ROW, CppFormatters.toText(row));
+        return true;
+    }
+
+    std::string frames;
+
+private:
+    const cli::OutputFormatterRegistry& CppFormatters;
+};
+
+// The module, created from its library as the launcher's loader would.
+struct HostedLibrary {
+    void* handle = nullptr;
+    moduleloader::ILauncherModule* instance = nullptr;
+    void (*destroy)(moduleloader::ILauncherModule*) = nullptr;
+    std::optional<moduleloader::ModuleManifest> manifest;
+    std::string error;
+
+    bool open(const std::string& path) {
+        handle = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
+        if (!handle) {
+            error = "Failed to load library: " + path + " (Error: " + dlerror() + ")";
+            return false;
+        }
+        std::string manifestError;
+        manifest = moduleloader::ModuleLoaderSystem::readModuleManifest(path, &manifestError);
+        if (!manifestError.empty()) {
+            error = manifestError; // The launcher's loader would refuse the module too
+            return false;
+        }
+        auto create = reinterpret_cast<moduleloader::ILauncherModule* (*)()>(dlsym(handle, "create_module_instance"));
+        destroy = reinterpret_cast<void (*)(moduleloader::ILauncherModule*)>(dlsym(handle, "destroy_module_instance"));
+        if (!create) {
+            error = "Failed to find 'create_module_instance' in " + path;
+            return false;
+        }
+        try {
+            instance = create();
+        } catch (const std::exception& e) {
+            error = std::string("create_module_instance threw an exception: ") + e.what();
+            return false;
+        }
+        if (!instance) {
+            error = "create_module_instance returned nullptr from " + path;
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (instance && destroy) {
+            destroy(instance);
+        }
+        instance = nullptr;
+        if (handle) {
+            dlclose(handle);
+            handle = nullptr;
+        }
+    }
+};
+
+moduleloader::HostMessage ok(std::string payload = std::string()) {
+    return moduleloader::HostMessage{static_cast<uint32_t>(moduleloader::HostReply::Ok), std::move(payload)};
+}
+
+moduleloader::HostMessage failed(std::string message) {
+    return moduleloader::HostMessage{static_cast<uint32_t>(moduleloader::HostReply::Failed), std::move(message)};
+}
+
+moduleloader::HostMessage execute(HostCore& core, const std::string& commandLine) {
+    cli::CLIEngine& engine = core.getCLIEngine();
+    FrameSink sink(engine.getOutputFormatters());
+    cli::CommandResult result = engine.executeCommand(commandLine, sink);
+    if (result.data.has_value()) {
+        cli::appendRemoteFrame(sink.frames, cli::REMOTE_FRAME_DATA, engine.getOutputFormatters().toText(*result.data));
+    }
+    cli::appendRemoteFrame(sink.frames, cli::REMOTE_FRAME_STATUS,
+                           cli::CommandResult::statusToString(result.status) + " " + result.message);
+    return ok(sink.frames);
+}
+
+// Answers one request; sets 'exit' for HostRequest::Exit.
+moduleloader::HostMessage serve(HostCore& core, HostedLibrary& library, const moduleloader::HostMessage& request, bool& exit) {
+    using moduleloader::HostRequest;
+    HostRequest type = static_cast<HostRequest>(request.type);
+    if (type == HostRequest::Exit) {
+        library.close();
+        exit = true;
+        return ok();
+    }
+    if (!library.instance) {
+        return failed(library.error);
+    }
+    try {
+        switch (type) {
+        case HostRequest::Describe:
+            return ok(moduleloader::encodeHostDescription(library.instance->getName(), library.instance->getVersion(),
+                                                          library.manifest));
+        case HostRequest::Initialize:
+            library.instance->initialize(core.api());
+            return ok();
+        case HostRequest::Shutdown:
+            library.instance->shutdown();
+            return ok();
+        case HostRequest::ExportState:
+            return ok(library.instance->exportState());
+        case HostRequest::ImportState:
+            library.instance->importState(request.payload);
+            return ok();
+        case HostRequest::Execute:
+            return execute(core, request.payload);
+        case HostRequest::Publish: {
+            size_t split = request.payload.find('\n');
+            if (split == std::string::npos) {
+                return failed("Malformed publish request.");
+            }
+            core.getEventBus().publish(request.payload.substr(0, split), request.payload.substr(split + 1),
+                                        eventbus::DeliveryMode::Sync);
+            return ok();
+        }
+        default:
+            return failed("Unknown module host request " + std::to_string(request.type) + ".");
+        }
+    } catch (const std::exception& e) {
+        return failed(e.what());
+    } catch (...) {
+        return failed("Unknown exception in module " + library.instance->getName() + ".");
+    }
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --channel <fd> [--memory-limit <bytes>] <library>\n";
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int channelFd = -1;
+    unsigned long long memoryLimit = 0;
+    std::string libraryPath;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--channel" && i + 1 < argc) {
+                channelFd = std::stoi(argv[++i]);
+            } else if (arg == "--memory-limit" && i + 1 < argc) {
+                memoryLimit = std::stoull(argv[++i]);
+            } else if (libraryPath.empty() && arg.rfind("--", 0) != 0) {
+                libraryPath = arg;
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        }
+    } catch (const std::exception&) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (channelFd < 0 || libraryPath.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+#ifdef __linux__
+    // Do not outlive the launcher: leave as soon as it is no longer our parent, even while the
+    // module is busy. Not PR_SET_PDEATHSIG, which fires when the launcher *thread* that started
+    // this host ends, and hosts are started and restarted from whichever thread makes the call.
+    pid_t launcher = getppid();
+    if (launcher == 1) {
+        return 1;
+    }
+    std::thread([launcher]() {
+        while (getppid() == launcher) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        _exit(1);
+    }).detach();
+#endif
+
+    std::string error;
+    std::unique_ptr<moduleloader::ModuleHostChannel> channel = moduleloader::ModuleHostChannel::attach(channelFd, error);
+    if (!channel) {
+        std::cerr << "module_host: " << error << "\n";
+        return 1;
+    }
+#ifdef __linux__
+    // The limit applies to the module, not to the channel mapped above.
+    if (memoryLimit > 0) {
+        rlimit limit;
+        limit.rlim_cur = limit.rlim_max = static_cast<rlim_t>(memoryLimit);
+        setrlimit(RLIMIT_AS, &limit);
+    }
+#endif
+
+    // Both the core and the library are ended explicitly; a module may still use the core while it
+    // is destroyed.
+    HostCore core;
+    HostedLibrary library;
+    library.open(libraryPath);
+
+    bool exit = false;
+    moduleloader::HostMessage request;
+    while (!exit && channel->receive(request)) {
+        if (!channel->reply(serve(core, library, request, exit))) {
+            break;
+        }
+    }
+    library.close();
+    return 0;
+}
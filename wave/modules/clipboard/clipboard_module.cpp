@@ -16,7 +16,7 @@ namespace modules {
 namespace clipboard {
 
 ClipboardModule::ClipboardModule() 
-    : CppCoreAccess(nullptr), 
+    : CppLoggingSystem(nullptr), 
       CppModuleName("ClipboardModule"), 
       CppModuleVersion("1.0.0") {
     // std::cout << "[ClipboardModule] Constructor." << std::endl;
@@ -26,29 +26,23 @@ ClipboardModule::~ClipboardModule() {
     // std::cout << "[ClipboardModule] Destructor." << std::endl;
 }
 
-void ClipboardModule::initialize(wave::core::moduleloader::ICoreAccess* moduleCoreAccess) {
-    // The module loader passes a ICoreAccess defined within its own scope (dummy one).
-    // We need to cast it to the main ICoreAccess (from wave/include) to access full core features.
-    CppCoreAccess = dynamic_cast<wave::ICoreAccess*>(moduleCoreAccess);
+void ClipboardModule::initialize(const WaveCoreApi* core) {
+    // The core hands out its LoggingSystem directly; null (no logging) if it has none in the
+    // version this module was built against.
+    CppLoggingSystem = wave::core::moduleloader::coreService<wave::core::logging::LoggingSystem>(core, WAVE_SERVICE_LOGGING);
 
-    if (!CppCoreAccess && moduleCoreAccess) {
-        // This means the passed pointer was not of the expected wave::Core type (or compatible).
-        // Log an error if possible, though logging system itself might not be accessible if CppCoreAccess is null.
-        std::cerr << "[ClipboardModule] CRITICAL ERROR: Failed to dynamic_cast ICoreAccess. Module will not function correctly." << std::endl;
-        // Depending on policy, could throw or set an internal error state.
-    }
-
-    // if (CppCoreAccess && CppCoreAccess->getLoggingSystem()) { // Now CppCoreAccess is wave::ICoreAccess*
-    //     CppCoreAccess->getLoggingSystem()->log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Info, CppModuleName, "ClipboardModule initialized."));
+    // if (CppLoggingSystem) {
+    //     CppLoggingSystem->log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Info, CppModuleName, "ClipboardModule initialized."));
     // }
     // std::cout << "[ClipboardModule] Initialized." << std::endl;
 }
 
 void ClipboardModule::shutdown() {
-    // if (CppCoreAccess && CppCoreAccess->getLoggingSystem()) {
-    //     CppCoreAccess->getLoggingSystem()->log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Info, CppModuleName, "ClipboardModule shutdown."));
+    // if (CppLoggingSystem) {
+    //     CppLoggingSystem->log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Info, CppModuleName, "ClipboardModule shutdown."));
     // }
     // std::cout << "[ClipboardModule] Shutdown." << std::endl;
+    CppLoggingSystem = nullptr; // Only valid until shutdown() returns
 }
 
 std::string ClipboardModule::getName() const {
@@ -98,17 +92,17 @@ void ClipboardModule::broadcastEvent(ClipboardEventType type, const ClipboardDat
         try {
             callback(type, eventData);
         } catch (const std::exception& e) {
-            // Handle callback error (e.g., log via CoreAccess if available and safe)
+            // Handle callback error (e.g., log via the core's LoggingSystem if available)
             // std::cerr << "Exception in ClipboardEventCallback: " << e.what() << std::endl;
-             if (CppCoreAccess && CppCoreAccess->getLoggingSystem()) {
-                 CppCoreAccess->getLoggingSystem()->log(wave::core::logging::LogEntry(
+             if (CppLoggingSystem) {
+                 CppLoggingSystem->log(wave::core::logging::LogEntry(
                      wave::core::logging::LogLevel::Error, CppModuleName, 
                      "Exception in clipboard event callback: " + std::string(e.what())));
              }
         } catch (...) {
             // std::cerr << "Unknown exception in ClipboardEventCallback." << std::endl;
-            if (CppCoreAccess && CppCoreAccess->getLoggingSystem()) {
-                 CppCoreAccess->getLoggingSystem()->log(wave::core::logging::LogEntry(
+            if (CppLoggingSystem) {
+                 CppLoggingSystem->log(wave::core::logging::LogEntry(
                      wave::core::logging::LogLevel::Error, CppModuleName, 
                      "Unknown exception in clipboard event callback."));
             }
@@ -231,8 +225,21 @@ ClipboardResult ClipboardModule::platformPaste() {
 } // namespace wave
 
 
+namespace {
+// Name and version match getName() and getVersion(); the module registers no commands or topics.
+const WaveModuleManifest clipboardManifest = {WAVE_MODULE_ABI_VERSION, "ClipboardModule", "1.0.0",
+                                              nullptr, nullptr, nullptr, nullptr};
+} // namespace
+
 // Exported C functions for dynamic loading
 extern "C" {
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    const WaveModuleManifest* wave_module_manifest() {
+        return &clipboardManifest;
+    }
+
     #ifdef _WIN32
     __declspec(dllexport)
     #endif
@@ -1,8 +1,8 @@
 #ifndef WAVE_MODULES_CLIPBOARD_CLIPBOARD_MODULE_HPP
 #define WAVE_MODULES_CLIPBOARD_CLIPBOARD_MODULE_HPP
 
-#include "wave/core/moduleloader/module_loader.hpp" // For ILauncherModule
-#include "wave/include/ICoreAccess.hpp" // For ICoreAccess
+#include "wave/core/moduleloader/module_loader.hpp" // For ILauncherModule and WaveCoreApi
+#include "wave/core/logging/logging.hpp"
 #include <string>
 #include <vector>
 #include <functional>
@@ -51,7 +51,7 @@ public:
     ~ClipboardModule() override;
 
     // --- ILauncherModule interface ---
-    void initialize(wave::core::moduleloader::ICoreAccess* coreAccess) override;
+    void initialize(const WaveCoreApi* core) override;
     void shutdown() override;
     std::string getName() const override;
     std::string getVersion() const override;
@@ -63,7 +63,7 @@ public:
     void subscribeToClipboardEvents(ClipboardEventCallback callback);
 
 private:
-    wave::ICoreAccess* CppCoreAccess; // Renamed - Use the main ICoreAccess
+    wave::core::logging::LoggingSystem* CppLoggingSystem; // From the core's services; null if the core has none
     std::string CppModuleName; // Renamed
     std::string CppModuleVersion; // Renamed
     
@@ -89,6 +89,11 @@ private:
 
 // Required for dynamic loading
 extern "C" {
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    const WaveModuleManifest* wave_module_manifest();
+
     #ifdef _WIN32
     __declspec(dllexport)
     #endif
@@ -0,0 +1,173 @@
+#include "core/cli/cli_engine.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Dispatch overhead benchmark for CLIEngine::executeCommand: tokenizing, registry lookup, option
+// handling and invoking a command that does nothing, for registries of 10 to 10k commands and for
+// several concurrent callers. Build it optimized and without sanitizers, e.g.
+//
+//   g++ -std=c++17 -O2 -DNDEBUG -I wave -I . -pthread wave/tests/bench_cli_dispatch.cpp wave/core/cli/*.cpp
+//
+// Usage: bench_cli_dispatch [--iterations <n>] [--max-ns <n>]
+//   --iterations <n>  executeCommand calls per measurement and thread (default 200000)
+//   --max-ns <n>      exit with status 1 if the single-threaded mean of any registry size exceeds
+//                     n nanoseconds per dispatch, for use as a regression gate (e.g. --max-ns 1000)
+
+namespace {
+
+// Returns immediately; all measured time is dispatch overhead.
+class NoopCommand : public wave::core::cli::ICommand {
+public:
+    std::string getName() const override { return "noop"; }
+    std::string getHelp() const override { return "noop - does nothing."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>&) override {
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "");
+    }
+};
+
+// Same, with declared options so the typed option parser is part of the measurement.
+class NoopWithOptionsCommand : public NoopCommand {
+public:
+    const std::vector<wave::core::cli::OptionSpec>& getOptions() const override {
+        static const std::vector<wave::core::cli::OptionSpec> options = {
+            {"limit", wave::core::cli::OptionSpec::Type::Integer, ""},
+            {"verbose", wave::core::cli::OptionSpec::Type::Flag, ""},
+        };
+        return options;
+    }
+};
+
+// Registers 'count' commands in groups of 10 ("group7 command73"), the shape modules produce.
+void registerCommands(wave::core::cli::CLIEngine& engine, size_t count, const std::shared_ptr<wave::core::cli::ICommand>& command) {
+    for (size_t i = 0; i < count; ++i) {
+        engine.registerCommand("group" + std::to_string(i / 10) + " command" + std::to_string(i), command);
+    }
+}
+
+// Mean nanoseconds per executeCommand over 'iterations' calls on each of 'threads' threads,
+// cycling through 'lines'.
+double measure(wave::core::cli::CLIEngine& engine, const std::vector<std::string>& lines, size_t threads, size_t iterations) {
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<size_t> failures{0};
+    std::vector<double> perThread(threads, 0.0);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            ++ready;
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                const std::string& line = lines[(i + t) % lines.size()];
+                if (engine.executeCommand(line).status != wave::core::cli::CommandResult::Status::Success) {
+                    ++failures;
+                }
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            perThread[t] = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    go = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failures.load() > 0) {
+        std::cerr << "Unexpected dispatch failures: " << failures.load() << std::endl;
+        std::exit(2);
+    }
+    double sum = 0;
+    for (double value : perThread) {
+        sum += value;
+    }
+    return sum / static_cast<double>(threads);
+}
+
+// Dispatch lines spread over the whole registry, so lookups do not all hit one hot path.
+std::vector<std::string> makeLines(size_t count, const std::string& suffix) {
+    std::vector<std::string> lines;
+    size_t step = count < 64 ? 1 : count / 64;
+    for (size_t i = 0; i < count; i += step) {
+        lines.push_back("group" + std::to_string(i / 10) + " command" + std::to_string(i) + suffix);
+    }
+    return lines;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = 200000;
+    double maxNanos = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-ns" && i + 1 < argc) {
+            maxNanos = std::strtod(argv[++i], nullptr);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--iterations <n>] [--max-ns <n>]\n";
+            return 2;
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threadCounts = {1, 2, 4, 8};
+    const size_t registrySizes[] = {10, 100, 1000, 10000};
+
+    std::cout << "CLIEngine dispatch overhead, mean ns per executeCommand (" << iterations
+              << " calls per thread, " << hardwareThreads << " hardware threads)\n\n";
+    std::printf("%-10s %-28s", "commands", "line");
+    for (size_t threads : threadCounts) {
+        std::printf(" %9zu thr", threads);
+    }
+    std::printf("\n");
+
+    bool withinBudget = true;
+    for (size_t registrySize : registrySizes) {
+        struct Variant {
+            const char* label;
+            std::shared_ptr<wave::core::cli::ICommand> command;
+            std::string suffix;
+        };
+        const Variant variants[] = {
+            {"group command", std::make_shared<NoopCommand>(), ""},
+            {"group command a b c", std::make_shared<NoopCommand>(), " alpha beta gamma"},
+            {"... --limit 5 --verbose", std::make_shared<NoopWithOptionsCommand>(), " --limit 5 --verbose x"},
+        };
+        for (const Variant& variant : variants) {
+            wave::core::cli::CLIEngine engine;
+            registerCommands(engine, registrySize, variant.command);
+            std::vector<std::string> lines = makeLines(registrySize, variant.suffix);
+            measure(engine, lines, 1, iterations / 10 + 1); // Warm-up
+
+            std::printf("%-10zu %-28s", registrySize, variant.label);
+            for (size_t threads : threadCounts) {
+                double nanos = measure(engine, lines, threads, iterations);
+                std::printf(" %13.0f", nanos);
+                if (threads == 1 && maxNanos > 0 && nanos > maxNanos) {
+                    withinBudget = false;
+                }
+            }
+            std::printf("\n");
+        }
+    }
+
+    if (!withinBudget) {
+        std::cout << "\nFAILED: single-threaded dispatch exceeded " << maxNanos << " ns." << std::endl;
+        return 1;
+    }
+    return 0;
+}
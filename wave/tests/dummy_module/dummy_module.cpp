@@ -1,12 +1,24 @@
-#include "../../core/moduleloader/module_loader.hpp" // To get ILauncherModule and ICoreAccess
+#include "../../core/moduleloader/module_loader.hpp" // To get ILauncherModule and WaveCoreApi
+#include "../../core/moduleloader/module_manifest.hpp"
 #include <iostream> // For basic output from the module
+#include <chrono>
+#include <cstdlib>
+#include <thread>
 
-// Concrete implementation of ILauncherModule
+// The same source builds several test modules (see CMakeLists.txt); these select which one.
+#ifndef DUMMY_MODULE_NAME
+#define DUMMY_MODULE_NAME "DummyModule"
+#endif
+
+namespace {
+// Concrete implementation of ILauncherModule. Internal linkage: the variants are loaded side by
+// side with RTLD_GLOBAL and must not bind to each other's DummyModule symbols.
 class DummyModule : public wave::core::moduleloader::ILauncherModule {
 private:
-    wave::core::moduleloader::ICoreAccess* core_ = nullptr;
-    std::string name_ = "DummyModule";
+    const WaveCoreApi* core_ = nullptr;
+    std::string name_ = DUMMY_MODULE_NAME;
     std::string version_ = "1.0.0";
+    int handoffs_ = 0; // Hot reloads this instance's state has been through
 public:
     DummyModule() {
         // std::cout << "[DummyModule] Constructor called." << std::endl;
@@ -16,16 +28,20 @@ public:
         // std::cout << "[DummyModule] Destructor called." << std::endl;
     }
 
-    void initialize(wave::core::moduleloader::ICoreAccess* coreAccess) override {
-        core_ = coreAccess;
-        // std::cout << "[DummyModule] Initialized. CoreAccess ptr: " << core_ << std::endl;
-        if (core_) {
-            // core_->placeholder(); // Example of using core access
+    void initialize(const WaveCoreApi* core) override {
+        core_ = core;
+#ifdef DUMMY_MODULE_INIT_DELAY_MS
+        std::this_thread::sleep_for(std::chrono::milliseconds(DUMMY_MODULE_INIT_DELAY_MS));
+#endif
+        // The tests check for this line to see the table arrive.
+        if (WAVE_CORE_API_HAS(core_, log)) {
+            core_->log(core_->context, WAVE_LOG_INFO, name_.c_str(), (name_ + " initialized").c_str());
         }
     }
 
     void shutdown() override {
         // std::cout << "[DummyModule] Shutdown." << std::endl;
+        core_ = nullptr;
     }
 
     std::string getName() const override {
@@ -36,11 +52,57 @@ public:
         return version_;
     }
 
+    // The state is the number of hand-offs so far, so tests can follow it across hot reloads.
+    std::string exportState() override {
+        return std::to_string(handoffs_);
+    }
+
+    // "crash" takes the process down, for the isolated module tests.
+    void importState(const std::string& state) override {
+        if (state == "crash") {
+            std::abort();
+        }
+        handoffs_ = std::stoi(state) + 1;
+    }
+
     void setName(const std::string& newName) { name_ = newName; } // Custom method for testing
 };
 
+#ifdef DUMMY_MODULE_PROVIDES
+const char* const dummyProvides[] = {DUMMY_MODULE_PROVIDES, nullptr};
+#else
+const char* const dummyProvides[] = {nullptr};
+#endif
+#ifdef DUMMY_MODULE_REQUIRES
+const char* const dummyRequirements[] = {DUMMY_MODULE_REQUIRES, nullptr};
+#else
+const char* const dummyRequirements[] = {nullptr};
+#endif
+#ifdef DUMMY_MODULE_COMMAND
+const char* const dummyCommands[] = {DUMMY_MODULE_COMMAND, nullptr};
+#else
+const char* const dummyCommands[] = {nullptr};
+#endif
+#ifdef DUMMY_MODULE_TOPIC
+const char* const dummyTopics[] = {DUMMY_MODULE_TOPIC, nullptr};
+#else
+const char* const dummyTopics[] = {nullptr};
+#endif
+const WaveModuleManifest dummyManifest = {WAVE_MODULE_ABI_VERSION, DUMMY_MODULE_NAME, "1.0.0", dummyProvides,
+                                          dummyRequirements, dummyCommands, dummyTopics};
+} // namespace
+
 // Exported C functions to create and destroy the module instance
 extern "C" {
+#ifndef DUMMY_MODULE_NO_MANIFEST
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    const WaveModuleManifest* wave_module_manifest() {
+        return &dummyManifest;
+    }
+#endif
+
     #ifdef _WIN32
     __declspec(dllexport)
     #endif
@@ -1,12 +1,18 @@
 #include "core/cli/cli_engine.hpp"
+#include "core/cli/cli_commands.hpp"
+#include "core/cli/output_formatter.hpp"
 #include <iostream>
 #include <cassert>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include <chrono> // For sleep
 #include <sstream> // For joining args in EchoCommand
+#include <fstream>
+#include <cstdio>
+#include <unistd.h> // getpid for temporary file names
 
 // Helper function to print test headers
 void printTestHeader(const std::string& testName) {
@@ -99,6 +105,166 @@ public:
 };
 
 
+// Long-running command that polls its cancellation token and tracks peak concurrency.
+class SlowCommand : public wave::core::cli::ICommand {
+public:
+    std::atomic<int> running{0};
+    std::atomic<int> peakRunning{0};
+    size_t maxConcurrency;
+
+    explicit SlowCommand(size_t limit = 0) : maxConcurrency(limit) {}
+    std::string getName() const override { return "slow"; }
+    std::string getHelp() const override { return "slow <ms> - sleeps for the given time, honouring cancellation."; }
+    size_t getMaxConcurrency() const override { return maxConcurrency; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>& args) override {
+        wave::core::cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>& args,
+                                                      wave::core::cli::CommandContext& context) override {
+        int now = ++running;
+        int peak = peakRunning.load();
+        while (now > peak && !peakRunning.compare_exchange_weak(peak, now)) {}
+
+        int totalMs = args.empty() ? 50 : std::stoi(args[0]);
+        for (int elapsed = 0; elapsed < totalMs; elapsed += 5) {
+            if (context.cancellation.isCancelled()) {
+                --running;
+                return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Warning, "Cancelled.");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        --running;
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "Done.");
+    }
+};
+
+// Emits two structured rows (maps with nested values) for the output format tests.
+class RecordsCommand : public wave::core::cli::ICommand {
+public:
+    std::string getName() const override { return "records"; }
+    std::string getHelp() const override { return "records - streams two structured rows."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>& args) override {
+        wave::core::cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>&,
+                                                      wave::core::cli::CommandContext& context) override {
+        using Row = std::map<std::string, wave::core::cli::StructuredData>;
+        context.emit(wave::core::cli::StructuredData(Row{
+            {"name", std::string("alpha")}, {"pid", 1}, {"tags", std::vector<std::string>{"a", "b"}}}));
+        context.emit(wave::core::cli::StructuredData(Row{
+            {"name", std::string("be\ta")}, {"pid", 2.5}, {"tags", std::vector<std::string>{}}}));
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "2 records.");
+    }
+};
+
+// Read-only command with a cache policy; counts how often it really runs.
+class ModuleListCommand : public wave::core::cli::ICommand {
+public:
+    std::atomic<int> runs{0};
+    wave::core::cli::CachePolicy policy;
+    std::string getName() const override { return "modules"; }
+    std::string getHelp() const override { return "modules [prefix] - lists fake modules."; }
+    const wave::core::cli::CachePolicy& getCachePolicy() const override { return policy; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>& args) override {
+        wave::core::cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>& args,
+                                                      wave::core::cli::CommandContext& context) override {
+        int run = ++runs;
+        for (const char* name : {"audio", "clipboard", "network"}) {
+            if (!args.empty() && std::string(name).rfind(args[0], 0) != 0) {
+                continue;
+            }
+            if (!context.emit(wave::core::cli::StructuredData(std::string(name)))) {
+                break;
+            }
+        }
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success,
+                                              "run " + std::to_string(run));
+    }
+};
+
+// Emits a number of rows through the streaming API, stopping early when the consumer goes away.
+class CountCommand : public wave::core::cli::ICommand {
+public:
+    std::atomic<int> produced{0};
+    std::string getName() const override { return "count"; }
+    std::string getHelp() const override { return "count <n> [summary] - streams the numbers 0..n-1 as rows; with 'summary' also returns \"<n> rows\"."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>& args) override {
+        wave::core::cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>& args,
+                                                      wave::core::cli::CommandContext& context) override {
+        int n = args.empty() ? 0 : std::stoi(args[0]);
+        for (int i = 0; i < n; ++i) {
+            if (!context.emit(wave::core::cli::StructuredData(i))) {
+                return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Warning, "Stopped by consumer.");
+            }
+            ++produced;
+        }
+        if (args.size() > 1 && args[1] == "summary") {
+            return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "Counted.",
+                                                  wave::core::cli::StructuredData(std::to_string(n) + " rows"));
+        }
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "Counted.");
+    }
+};
+
+// Declares typed options and reports what it received.
+class CopyCommand : public wave::core::cli::ICommand {
+public:
+    std::vector<std::string> lastArgs;
+    bool lastAppend = false;
+    long long lastRepeat = 0;
+    std::string lastFormat;
+
+    std::string getName() const override { return "copy"; }
+    std::string getHelp() const override { return "copy <text> [--append] [--repeat=<n>] [--format <name>]"; }
+    const std::vector<wave::core::cli::OptionSpec>& getOptions() const override {
+        static const std::vector<wave::core::cli::OptionSpec> options = {
+            {"append", wave::core::cli::OptionSpec::Type::Flag},
+            {"repeat", wave::core::cli::OptionSpec::Type::Integer},
+            {"format", wave::core::cli::OptionSpec::Type::String},
+        };
+        return options;
+    }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>& args) override {
+        wave::core::cli::CommandContext context;
+        return executeWithContext(args, context);
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>& args,
+                                                      wave::core::cli::CommandContext& context) override {
+        lastArgs = args;
+        lastAppend = context.options.getFlag("append");
+        lastRepeat = context.options.getInteger("repeat").value_or(1);
+        lastFormat = context.options.getString("format").value_or("text");
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "Copied.");
+    }
+};
+
+// Unregisters itself mid-execution and records whether it was destroyed while running.
+class SelfRemovingCommand : public wave::core::cli::ICommand {
+public:
+    wave::core::cli::CLIEngine* engine;
+    std::atomic<bool>* destroyed;
+    SelfRemovingCommand(wave::core::cli::CLIEngine* e, std::atomic<bool>* d) : engine(e), destroyed(d) {}
+    ~SelfRemovingCommand() override { *destroyed = true; }
+    std::string getName() const override { return "ephemeral"; }
+    std::string getHelp() const override { return "ephemeral - unregisters itself while running."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>&) override {
+        engine->unregisterCommand("ephemeral");
+        // The registry no longer references us, but the executing call still does.
+        bool stillAlive = !destroyed->load();
+        return wave::core::cli::CommandResult(stillAlive ? wave::core::cli::CommandResult::Status::Success
+                                                         : wave::core::cli::CommandResult::Status::Error,
+                                              "Unregistered during execution.");
+    }
+};
+
 void testRegistrationAndUnregistration() {
     printTestHeader("Command Registration and Unregistration Test");
     wave::core::cli::CLIEngine engine;
@@ -290,6 +456,998 @@ void testThreadSafety() {
 }
 
 
+void testAsyncExecution() {
+    printTestHeader("Async Execution Test");
+    wave::core::cli::CLIEngine engine(4, 16);
+    EchoCommand echoCmd;
+    SlowCommand slowCmd;
+    engine.registerCommand("echo", &echoCmd);
+    engine.registerCommand("slow", &slowCmd);
+
+    // Plain async execution resolves with the command's result.
+    auto echoHandle = engine.executeCommandAsync("echo async works");
+    wave::core::cli::CommandResult result = echoHandle.result.get();
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(std::any_cast<std::string>(result.data.value()) == "async works");
+
+    // Lookup errors resolve immediately instead of throwing.
+    auto missingHandle = engine.executeCommandAsync("nonexistentcmd");
+    result = missingHandle.result.get();
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    assert(result.message.find("Command not found") != std::string::npos);
+
+    // Cancellation reaches a running command through its context.
+    auto slowHandle = engine.executeCommandAsync("slow 5000");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    slowHandle.cancellation.cancel();
+    assert(slowHandle.result.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    result = slowHandle.result.get();
+    assert(result.status == wave::core::cli::CommandResult::Status::Warning);
+    assert(result.message == "Cancelled.");
+
+    std::cout << "Async Execution Test: PASSED" << std::endl;
+}
+
+void testAsyncConcurrencyLimit() {
+    printTestHeader("Async Per-Command Concurrency Limit Test");
+    wave::core::cli::CLIEngine engine(4, 16);
+    SlowCommand limitedCmd(1);
+    engine.registerCommand("slow", &limitedCmd);
+
+    std::vector<wave::core::cli::AsyncCommandHandle> handles;
+    for (int i = 0; i < 4; ++i) {
+        handles.push_back(engine.executeCommandAsync("slow 20"));
+    }
+    for (auto& handle : handles) {
+        assert(handle.result.get().status == wave::core::cli::CommandResult::Status::Success);
+    }
+    // Four workers were available, but the command allows only one instance at a time.
+    assert(limitedCmd.peakRunning.load() == 1);
+
+    // A token cancelled before the deferred invocation starts skips the command entirely.
+    auto first = engine.executeCommandAsync("slow 50");
+    auto second = engine.executeCommandAsync("slow 50");
+    second.cancellation.cancel();
+    assert(first.result.get().status == wave::core::cli::CommandResult::Status::Success);
+    wave::core::cli::CommandResult skipped = second.result.get();
+    assert(skipped.status == wave::core::cli::CommandResult::Status::Error);
+    assert(skipped.message.find("cancelled before execution") != std::string::npos);
+
+    // Waiting executions are bounded too: with one running and the queue's worth waiting, the next
+    // is rejected at once instead of growing the backlog.
+    wave::core::cli::CLIEngine smallEngine(2, 2);
+    SlowCommand busyCmd(1);
+    smallEngine.registerCommand("slow", &busyCmd);
+    std::vector<wave::core::cli::AsyncCommandHandle> waiting;
+    for (int i = 0; i < 3; ++i) {
+        waiting.push_back(smallEngine.executeCommandAsync("slow 30"));
+    }
+    auto overflow = smallEngine.executeCommandAsync("slow 30");
+    assert(overflow.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    wave::core::cli::CommandResult refused = overflow.result.get();
+    assert(refused.status == wave::core::cli::CommandResult::Status::Error);
+    assert(refused.message.find("waiting for a concurrency slot") != std::string::npos);
+    for (auto& handle : waiting) {
+        assert(handle.result.get().status == wave::core::cli::CommandResult::Status::Success);
+    }
+    assert(busyCmd.peakRunning.load() == 1);
+
+    std::cout << "Async Per-Command Concurrency Limit Test: PASSED" << std::endl;
+}
+
+void testStreamingOutput() {
+    printTestHeader("Streaming Output Test");
+    wave::core::cli::CLIEngine engine(2, 8);
+    CountCommand countCmd;
+    engine.registerCommand("count", &countCmd);
+
+    // Non-streaming callers receive the rows collected into CommandResult::data.
+    wave::core::cli::CommandResult result = engine.executeCommand("count 3");
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    auto rows = std::any_cast<std::vector<wave::core::cli::StructuredData>>(result.data.value());
+    assert(rows.size() == 3 && std::any_cast<int>(rows[2]) == 2);
+
+    // Data returned as well is not lost: it follows the emitted rows, sync and async alike.
+    result = engine.executeCommand("count 2 summary");
+    rows = std::any_cast<std::vector<wave::core::cli::StructuredData>>(result.data.value());
+    assert(rows.size() == 3 && std::any_cast<int>(rows[1]) == 1 && std::any_cast<std::string>(rows[2]) == "2 rows");
+    result = engine.executeCommandAsync("count 2 summary").result.get();
+    rows = std::any_cast<std::vector<wave::core::cli::StructuredData>>(result.data.value());
+    assert(rows.size() == 3 && std::any_cast<std::string>(rows[2]) == "2 rows");
+
+    // Streaming through a bounded buffer: the producer can never run ahead by more than the buffer.
+    countCmd.produced = 0;
+    auto stream = engine.executeCommandStreaming("count 10000", 16);
+    int expected = 0;
+    while (auto row = stream.rows->read()) {
+        assert(std::any_cast<int>(*row) == expected);
+        assert(countCmd.produced.load() <= expected + 17);
+        ++expected;
+    }
+    assert(expected == 10000);
+    assert(stream.result.get().status == wave::core::cli::CommandResult::Status::Success);
+
+    // A reader that stops early unblocks the producer, which sees emit() return false.
+    countCmd.produced = 0;
+    auto partial = engine.executeCommandStreaming("count 1000000", 4);
+    for (int i = 0; i < 5; ++i) {
+        assert(partial.rows->read().has_value());
+    }
+    partial.rows->cancel();
+    result = partial.result.get();
+    assert(result.status == wave::core::cli::CommandResult::Status::Warning);
+    assert(countCmd.produced.load() < 1000000);
+
+    // Lookup failures close the stream immediately.
+    auto missing = engine.executeCommandStreaming("nonexistentcmd");
+    assert(!missing.rows->read().has_value());
+    assert(missing.result.get().status == wave::core::cli::CommandResult::Status::Error);
+
+    std::cout << "Streaming Output Test: PASSED" << std::endl;
+}
+
+void testHierarchicalDispatch() {
+    printTestHeader("Hierarchical Dispatch and Completion Test");
+    wave::core::cli::CLIEngine engine;
+    EchoCommand historyCmd;
+    EchoCommand showCmd;
+    EchoCommand clearCmd;
+    FailCommand closeCmd;
+
+    engine.registerCommand("clipboard show history", &historyCmd);
+    engine.registerCommand("clipboard show", &showCmd);
+    engine.registerCommand("clipboard clear", &clearCmd);
+    engine.registerCommand("close", &closeCmd);
+
+    // Multi-word names are matched word by word; the remaining words are arguments.
+    wave::core::cli::CommandResult result = engine.executeCommand("clipboard show history 10");
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(std::any_cast<std::string>(result.data.value()) == "10");
+
+    // Longest match wins: "clipboard show extra" runs "clipboard show" with argument "extra".
+    result = engine.executeCommand("clipboard show extra");
+    assert(std::any_cast<std::string>(result.data.value()) == "extra");
+
+    // Unambiguous prefixes are expanded at every level.
+    result = engine.executeCommand("clipb sh hist 5");
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(std::any_cast<std::string>(result.data.value()) == "5");
+
+    // Ambiguous prefixes and command groups are reported instead of guessed.
+    result = engine.executeCommand("cl show");
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    assert(result.message.find("Ambiguous command: cl ") != std::string::npos);
+    result = engine.executeCommand("clipboard");
+    assert(result.message.find("Incomplete command: clipboard") != std::string::npos);
+
+    // Aliases cover whole command groups.
+    assert(engine.registerAlias("cb", "clipboard"));
+    assert(!engine.registerAlias("cb", "close")); // Alias already in use
+    assert(!engine.registerAlias("x", "does not exist"));
+    result = engine.executeCommand("cb show history 7");
+    assert(std::any_cast<std::string>(result.data.value()) == "7");
+    assert(engine.getAliases().size() == 1);
+
+    // Completion candidates for the next word.
+    auto candidates = engine.getCompletions("cl");
+    assert(candidates.size() == 2 && candidates[0] == "clipboard" && candidates[1] == "close");
+    candidates = engine.getCompletions("clipboard ");
+    assert(candidates.size() == 2 && candidates[0] == "clear" && candidates[1] == "show");
+    candidates = engine.getCompletions("cb show h");
+    assert(candidates.size() == 1 && candidates[0] == "history");
+
+    auto registered = engine.getRegisteredCommands();
+    assert(registered.size() == 4);
+
+    // Unregistering a command keeps sibling and child commands intact.
+    engine.unregisterCommand("clipboard show");
+    result = engine.executeCommand("clipboard show history");
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(engine.unregisterAlias("cb"));
+    result = engine.executeCommand("cb show history");
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+
+    // An ambiguous word further in is the one reported.
+    EchoCommand copyCmd;
+    engine.registerCommand("clipboard copy", &copyCmd);
+    result = engine.executeCommand("clipboard c text");
+    assert(result.message == "Ambiguous command: c (candidates: clear, copy)");
+    engine.unregisterCommand("clipboard copy");
+
+    std::cout << "Hierarchical Dispatch and Completion Test: PASSED" << std::endl;
+}
+
+void testTokenizer() {
+    printTestHeader("Tokenizer Test");
+    std::vector<std::string_view> tokens;
+    std::string scratch;
+    std::string error;
+
+    std::string line = R"(clipboard copy "hello world" it\'s 'single "quoted"' --name="a b" "" plain)";
+    assert(wave::core::cli::InputParser::tokenize(line, tokens, scratch, &error));
+    assert(tokens.size() == 8);
+    assert(tokens[0] == "clipboard" && tokens[1] == "copy");
+    assert(tokens[2] == "hello world");
+    assert(tokens[3] == "it's");
+    assert(tokens[4] == "single \"quoted\"");
+    assert(tokens[5] == "--name=a b");
+    assert(tokens[6].empty());
+    assert(tokens[7] == "plain");
+    // Plain tokens are views into the original line, not copies.
+    assert(tokens[0].data() == line.data());
+
+    std::string escapes = R"("tab\there" "quote\"inside")";
+    assert(wave::core::cli::InputParser::tokenize(escapes, tokens, scratch, &error));
+    assert(tokens.size() == 2 && tokens[0] == "tab\there" && tokens[1] == "quote\"inside");
+
+    // quote() is the inverse of tokenize(), and keeps the line on one line.
+    using wave::core::cli::InputParser;
+    assert(InputParser::quote("plain") == "plain");
+    assert(InputParser::quote("") == "\"\"");
+    assert(InputParser::quote("two words") == "\"two words\"");
+    assert(InputParser::quote("a|b;c#") == "\"a|b;c#\"");
+    std::vector<std::string> awkward = {"it's", "say \"hi\"", "back\\slash", "line\nbreak", "tab\there",
+                                        std::string("nul\0bell\a\r", 10), "\\n literally"};
+    std::string quotedLine;
+    for (const std::string& word : awkward) {
+        quotedLine += InputParser::quote(word) + " ";
+    }
+    assert(quotedLine.find('\n') == std::string::npos);
+    assert(InputParser::tokenize(quotedLine, tokens, scratch, &error));
+    assert(tokens.size() == awkward.size());
+    for (size_t i = 0; i < awkward.size(); ++i) {
+        assert(tokens[i] == awkward[i]);
+    }
+
+    assert(!wave::core::cli::InputParser::tokenize("echo \"unterminated", tokens, scratch, &error));
+    assert(error.find("Unterminated quote") != std::string::npos);
+
+    // The owned variant survives moves of the object holding it.
+    wave::core::cli::TokenizedLine owned(std::string("say \"short\""));
+    wave::core::cli::TokenizedLine moved = std::move(owned);
+    assert(moved.ok() && moved.tokens().size() == 2 && moved.tokens()[1] == "short");
+
+    std::cout << "Tokenizer Test: PASSED" << std::endl;
+}
+
+void testQuotedArgumentsAndOptions() {
+    printTestHeader("Quoted Arguments and Typed Options Test");
+    wave::core::cli::CLIEngine engine;
+    EchoCommand echoCmd;
+    CopyCommand copyCmd;
+    engine.registerCommand("echo", &echoCmd);
+    engine.registerCommand("clipboard copy", &copyCmd);
+
+    // Quoted arguments arrive as a single argument.
+    wave::core::cli::CommandResult result = engine.executeCommand("echo \"hello   world\" again");
+    assert(std::any_cast<std::string>(result.data.value()) == "hello   world again");
+
+    // Commands without option specs still receive --tokens verbatim.
+    result = engine.executeCommand("echo --not-an-option");
+    assert(std::any_cast<std::string>(result.data.value()) == "--not-an-option");
+
+    result = engine.executeCommand("clipboard copy \"hello world\" --append --repeat=3 --format json");
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(copyCmd.lastArgs.size() == 1 && copyCmd.lastArgs[0] == "hello world");
+    assert(copyCmd.lastAppend && copyCmd.lastRepeat == 3 && copyCmd.lastFormat == "json");
+
+    // "--" ends option processing.
+    result = engine.executeCommand("clipboard copy -- --append");
+    assert(copyCmd.lastArgs.size() == 1 && copyCmd.lastArgs[0] == "--append" && !copyCmd.lastAppend);
+
+    result = engine.executeCommand("clipboard copy x --repeat=many");
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    assert(result.message.find("Invalid integer") != std::string::npos);
+    result = engine.executeCommand("clipboard copy x --bogus");
+    assert(result.message.find("Unknown option: --bogus") != std::string::npos);
+    result = engine.executeCommand("clipboard copy 'unterminated");
+    assert(result.message.find("Failed to parse command line") != std::string::npos);
+
+    std::cout << "Quoted Arguments and Typed Options Test: PASSED" << std::endl;
+}
+
+void testRefcountedRegistry() {
+    printTestHeader("Refcounted Snapshot Registry Test");
+    wave::core::cli::CLIEngine engine;
+    std::atomic<bool> destroyed(false);
+
+    {
+        auto command = std::make_shared<SelfRemovingCommand>(&engine, &destroyed);
+        engine.registerCommand("ephemeral", command);
+    } // The engine now holds the only reference.
+
+    wave::core::cli::CommandResult result = engine.executeCommand("ephemeral");
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(destroyed.load()); // Released once the execution dropped its reference
+    assert(engine.executeCommand("ephemeral").message.find("Command not found") != std::string::npos);
+
+    // Dispatch keeps working while other threads register and unregister commands.
+    EchoCommand echoCmd;
+    engine.registerCommand("echo", &echoCmd);
+    std::atomic<bool> stop(false);
+    std::atomic<int> failures(0);
+    std::thread writer([&engine, &stop]() {
+        int i = 0;
+        while (!stop.load()) {
+            std::string name = "module cmd" + std::to_string(i++ % 50);
+            engine.registerCommand(name, std::make_shared<EchoCommand>());
+            engine.unregisterCommand(name);
+        }
+    });
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&engine, &failures]() {
+            for (int i = 0; i < 2000; ++i) {
+                if (engine.executeCommand("echo ping").status != wave::core::cli::CommandResult::Status::Success) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    stop = true;
+    writer.join();
+    assert(failures.load() == 0);
+
+
+    // A large flat registry, built in scrambled order: children stay sorted, registration shares
+    // the untouched ones, and removal leaves the rest reachable.
+    wave::core::cli::CLIEngine wide;
+    auto shared = std::make_shared<EchoCommand>();
+    const int wideCount = 5000;
+    for (int i = 0; i < wideCount; ++i) {
+        wide.registerCommand("w" + std::to_string((i * 7919) % wideCount), shared);
+    }
+    std::vector<std::string> names = wide.getRegisteredCommands();
+    assert(names.size() == static_cast<size_t>(wideCount) && std::is_sorted(names.begin(), names.end()));
+    for (int i = 0; i < wideCount; i += 2) {
+        wide.unregisterCommand("w" + std::to_string(i));
+    }
+    assert(wide.getRegisteredCommands().size() == static_cast<size_t>(wideCount / 2));
+    assert(wide.executeCommand("w4999 x").status == wave::core::cli::CommandResult::Status::Success);
+    assert(wide.executeCommand("w4998").message.find("Command not found") != std::string::npos);
+    assert(wide.executeCommand("w498").message.find("Ambiguous command: w498 (candidates: w4981, w4983") != std::string::npos);
+
+    std::cout << "Refcounted Snapshot Registry Test: PASSED" << std::endl;
+}
+
+void testFindAndConditionalUnregister() {
+    printTestHeader("Find and Conditional Unregister Test");
+    wave::core::cli::CLIEngine engine;
+    auto first = std::make_shared<EchoCommand>();
+    auto second = std::make_shared<EchoCommand>();
+    engine.registerCommand("tool run", first);
+
+    assert(engine.findCommand("tool run") == first);
+    assert(engine.findCommand("tool") == nullptr);   // A group, not a command
+    assert(engine.findCommand("tool r") == nullptr); // No prefix matching
+    assert(engine.findCommand("") == nullptr);
+
+    // Only the expected command is removed.
+    assert(!engine.unregisterCommand("tool run", *second));
+    assert(engine.findCommand("tool run") == first);
+    assert(engine.unregisterCommand("tool run", *first));
+    assert(engine.findCommand("tool run") == nullptr);
+    assert(!engine.unregisterCommand("tool run", *first));
+
+    std::cout << "Find and Conditional Unregister Test: PASSED" << std::endl;
+}
+
+// Records how many pins are held while it runs.
+class PinProbeCommand : public wave::core::cli::ICommand {
+public:
+    explicit PinProbeCommand(const std::atomic<int>& held) : CppHeld(held) {}
+    std::string getName() const override { return "probe"; }
+    std::string getHelp() const override { return "probe - reports held pins."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>&) override {
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success,
+                                              std::to_string(CppHeld.load()) + " pin(s)");
+    }
+
+private:
+    const std::atomic<int>& CppHeld;
+};
+
+void testCommandOwnerScope() {
+    printTestHeader("Command Owner Scope Test");
+    using Status = wave::core::cli::CommandResult::Status;
+    wave::core::cli::CLIEngine engine;
+    std::atomic<int> held(0);
+    std::atomic<bool> loaded(true);
+    auto pin = [&]() -> std::shared_ptr<void> {
+        if (!loaded) {
+            return nullptr;
+        }
+        ++held;
+        return std::shared_ptr<void>(static_cast<void*>(&held), [&held](void*) { --held; });
+    };
+
+    // Registered in a scope, a command runs pinned; it fails once the owner cannot be pinned.
+    auto oldProbe = std::make_shared<PinProbeCommand>(held);
+    auto oldEcho = std::make_shared<EchoCommand>();
+    {
+        wave::core::cli::CommandOwnerScope scope("Probe", pin);
+        assert(wave::core::cli::CommandOwnerScope::current() == &scope);
+        engine.registerCommand("probe", oldProbe);
+        engine.registerCommand("probe echo", oldEcho);
+    }
+    assert(!wave::core::cli::CommandOwnerScope::current());
+    assert(engine.executeCommand("probe").message == "1 pin(s)");
+    assert(held.load() == 0);
+    assert(engine.findCommand("probe")->getHelp() == "probe - reports held pins.");
+    loaded = false;
+    auto refused = engine.executeCommand("probe");
+    assert(refused.status == Status::Error && refused.message.find("module 'Probe' is not loaded") != std::string::npos);
+    loaded = true;
+
+    // A new instance of the same owner takes the names over; someone else's command is kept.
+    auto newProbe = std::make_shared<PinProbeCommand>(held);
+    {
+        wave::core::cli::CommandOwnerScope scope("Probe", pin);
+        engine.registerCommand("probe", newProbe);
+        wave::core::cli::CommandOwnerScope other("Other", pin);
+        engine.registerCommand("probe echo", std::make_shared<EchoCommand>());
+    }
+    // The old instance's shutdown: its "probe" is already gone, its "probe echo" is removed.
+    assert(!engine.unregisterCommand("probe", *oldProbe));
+    assert(engine.unregisterCommand("probe echo", *oldEcho));
+    assert(engine.executeCommand("probe").status == Status::Success);
+    assert(engine.unregisterCommand("probe", *newProbe));
+    assert(!engine.findCommand("probe"));
+
+    // Outside a scope nothing changes: the first registration keeps the name.
+    engine.registerCommand("probe", oldProbe);
+    engine.registerCommand("probe", newProbe);
+    assert(engine.findCommand("probe") == oldProbe);
+    std::cout << "Command Owner Scope Test: PASSED" << std::endl;
+}
+
+void testScriptExecution() {
+    printTestHeader("Script Execution Test");
+    wave::core::cli::CLIEngine engine(4, 16);
+    EchoCommand echoCmd;
+    FailCommand failCmd;
+    SlowCommand slowCmd;
+    engine.registerCommand("echo", &echoCmd);
+    engine.registerCommand("fail", &failCmd);
+    engine.registerCommand("slow", &slowCmd);
+
+    std::istringstream script(
+        "# provisioning script\n"
+        "echo one; echo \"two; still two\"\n"
+        "\n"
+        "   echo three\n"
+        "fail\n"
+        "echo never\n");
+    std::ostringstream transcript;
+    wave::core::cli::ScriptOptions options;
+    options.transcript = &transcript;
+    wave::core::cli::CommandResult result = engine.executeScript(script, options);
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    auto summary = std::any_cast<wave::core::cli::ScriptSummary>(result.data.value());
+    assert(summary.succeeded == 3 && summary.failed == 1 && summary.skipped == 1);
+    assert(summary.statements.size() == 4);
+    assert(summary.statements[1].commandLine == "echo \"two; still two\"");
+    assert(std::any_cast<std::string>(summary.statements[1].result.data.value()) == "two; still two");
+    assert(summary.statements[2].lineNumber == 4);
+    assert(summary.statements[3].lineNumber == 5);
+    assert(transcript.str().find("[Error] This command always fails.") != std::string::npos);
+
+    // Keep going past failures.
+    std::istringstream script2("fail; echo after");
+    options.stopOnError = false;
+    options.transcript = nullptr;
+    result = engine.executeScript(script2, options);
+    summary = std::any_cast<wave::core::cli::ScriptSummary>(result.data.value());
+    assert(summary.failed == 1 && summary.succeeded == 1 && summary.skipped == 0);
+
+    // Parallel statements overlap; "wait" separates waves.
+    std::istringstream script3("slow 60; slow 60; slow 60\nwait\necho done");
+    options.parallel = true;
+    auto start = std::chrono::steady_clock::now();
+    result = engine.executeScript(script3, options);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    summary = std::any_cast<wave::core::cli::ScriptSummary>(result.data.value());
+    assert(summary.succeeded == 4);
+    assert(summary.statements[3].commandLine == "echo done");
+    assert(slowCmd.peakRunning.load() >= 2);
+    assert(elapsed < std::chrono::milliseconds(170));
+
+    // A parallel transcript uses each statement's own "--output", taken from its async handle.
+    std::istringstream script4("echo hi --output json; echo there");
+    std::ostringstream parallelTranscript;
+    options.transcript = &parallelTranscript;
+    result = engine.executeScript(script4, options);
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(parallelTranscript.str().find("{\"type\":\"result\",\"status\":\"Success\"") == 0);
+    assert(parallelTranscript.str().find("[Success] Echoed successfully.\nData: there\n") != std::string::npos);
+    options.transcript = nullptr;
+
+    // A queue full of other work makes a parallel script wait for room, not fail.
+    {
+        wave::core::cli::CLIEngine busy(1, 2);
+        busy.registerCommand("echo", &echoCmd);
+        busy.registerCommand("slow", &slowCmd);
+        std::vector<wave::core::cli::AsyncCommandHandle> load;
+        load.push_back(busy.executeCommandAsync("slow 40"));
+        while (slowCmd.running.load() == 0) {
+            std::this_thread::yield();
+        }
+        load.push_back(busy.executeCommandAsync("slow 40")); // Queued behind the running one
+        load.push_back(busy.executeCommandAsync("slow 40"));
+        std::istringstream script5("echo a; echo b; echo c");
+        result = busy.executeScript(script5, options);
+        assert(result.status == wave::core::cli::CommandResult::Status::Success);
+        summary = std::any_cast<wave::core::cli::ScriptSummary>(result.data.value());
+        assert(summary.succeeded == 3);
+        for (auto& handle : load) {
+            assert(handle.result.get().status == wave::core::cli::CommandResult::Status::Success);
+        }
+
+        // stopOnError within a wave: with one worker, the failure is seen while the rest wait,
+        // and those are cancelled before they start.
+        std::istringstream script6("fail; slow 100; echo never");
+        busy.registerCommand("fail", &failCmd);
+        options.stopOnError = true;
+        result = busy.executeScript(script6, options);
+        summary = std::any_cast<wave::core::cli::ScriptSummary>(result.data.value());
+        assert(summary.failed == 1);
+        assert(summary.skipped >= 1 && summary.succeeded + summary.warnings + summary.skipped == 2);
+        for (const auto& statement : summary.statements) {
+            assert(statement.commandLine != "echo never");
+        }
+        options.stopOnError = false;
+    }
+
+    std::istringstream broken("echo 'unterminated\necho fine");
+    result = engine.executeScript(broken);
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    assert(result.message.find("Failed to parse script") != std::string::npos);
+
+    std::cout << "Script Execution Test: PASSED" << std::endl;
+}
+
+void testCommandMetrics() {
+    printTestHeader("Command Metrics Test");
+    wave::core::cli::CLIEngine engine(2, 16);
+    EchoCommand echoCmd;
+    FailCommand failCmd;
+    SlowCommand slowCmd;
+    engine.registerCommand("echo", &echoCmd);
+    engine.registerCommand("fail", &failCmd);
+    engine.registerCommand("slow", &slowCmd);
+    engine.registerCommand("cli stats", std::make_shared<wave::core::cli::CliStatsCommand>(engine));
+
+    std::vector<std::string> slowCommands;
+    std::mutex slowMutex;
+    engine.setSlowCommandThreshold(std::chrono::milliseconds(20),
+        [&](const std::string& name, const std::vector<std::string>& args, std::chrono::nanoseconds elapsed) {
+            std::lock_guard<std::mutex> lock(slowMutex);
+            assert(elapsed >= std::chrono::milliseconds(20));
+            slowCommands.push_back(name + (args.empty() ? "" : " " + args[0]));
+        });
+
+    for (int i = 0; i < 5; ++i) {
+        engine.executeCommand("echo hi");
+    }
+    engine.executeCommand("fail");
+    engine.executeCommand("nosuchcommand"); // Not resolved: not recorded
+    engine.executeCommandAsync("slow 30").result.get();
+
+    wave::core::cli::CommandStats echoStats = engine.getMetrics().snapshot("echo");
+    assert(echoStats.invocations == 5 && echoStats.errors == 0);
+    assert(echoStats.maxTime >= echoStats.meanTime());
+    assert(echoStats.percentile(99) <= echoStats.maxTime);
+    wave::core::cli::CommandStats slowStats = engine.getMetrics().snapshot("slow");
+    assert(slowStats.invocations == 1 && slowStats.maxTime >= std::chrono::milliseconds(30));
+    assert(slowStats.histogram.back() == 0 && slowStats.histogram[9] == 1); // 25ms < t <= 50ms
+    assert(engine.getMetrics().snapshot("fail").errors == 1);
+    assert(engine.getMetrics().snapshot().size() == 3);
+    {
+        std::lock_guard<std::mutex> lock(slowMutex);
+        assert(slowCommands.size() == 1 && slowCommands[0] == "slow 30");
+    }
+
+    // cli stats: header plus one row per command, sorted as requested.
+    wave::core::cli::CommandResult result = engine.executeCommand("cli stats --sort calls --top 2");
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    auto rows = std::any_cast<std::vector<wave::core::cli::StructuredData>>(result.data.value());
+    assert(rows.size() == 3);
+    assert(std::any_cast<std::string>(rows[0]).rfind("COMMAND", 0) == 0);
+    assert(std::any_cast<std::string>(rows[1]).rfind("echo ", 0) == 0);
+    assert(engine.executeCommand("cli stats --sort bogus").status == wave::core::cli::CommandResult::Status::Error);
+    assert(engine.executeCommand("cli stats never").status == wave::core::cli::CommandResult::Status::Warning);
+
+    engine.executeCommand("cli stats --reset");
+    assert(engine.getMetrics().snapshot("echo").invocations == 0);
+    assert(engine.getMetrics().snapshot().size() == 1); // Only the "cli stats --reset" call itself
+
+    engine.setSlowCommandThreshold(std::chrono::milliseconds(0), nullptr);
+    engine.executeCommand("slow 25");
+    assert(slowCommands.size() == 1);
+
+    std::cout << "Command Metrics Test: PASSED" << std::endl;
+}
+void testCommandHistory() {
+    printTestHeader("Command History Test");
+    std::string path = "/tmp/wave_test_history_" + std::to_string(::getpid());
+    std::remove(path.c_str());
+
+    {
+        wave::core::cli::HistoryManager history(3);
+        history.setHistoryFile(path);
+        assert(!history.isLoaded());
+        assert(history.add("echo one"));
+        assert(!history.add("echo one")); // Same as newest
+        assert(!history.add("   "));
+        assert(history.add("clipboard show"));
+        assert(history.add("echo two"));
+        assert(history.add("echo one")); // Moves to newest, no duplicate
+        assert(history.entries() == std::vector<std::string>({"clipboard show", "echo two", "echo one"}));
+        assert(history.add("log tail")); // Capacity 3: oldest dropped
+        assert(history.entries() == std::vector<std::string>({"echo two", "echo one", "log tail"}));
+
+        assert(*history.expand("!!") == "log tail");
+        assert(*history.expand("!1") == "echo two");
+        assert(*history.expand("!-2") == "echo one");
+        assert(*history.expand("!?two") == "echo two");
+        assert(*history.expand("!echo") == "echo one");
+        assert(history.expand("plain line") == std::optional<std::string>("plain line"));
+        std::string error;
+        assert(!history.expand("!nothing", &error) && !error.empty());
+        assert(!history.expand("!9"));
+    }
+
+    // Reloaded lazily from the tail of the file, duplicates collapsed to their newest position.
+    {
+        wave::core::cli::HistoryManager history(3);
+        history.setHistoryFile(path);
+        assert(!history.isLoaded());
+        assert(history.size() == 3);
+        assert(history.isLoaded());
+        assert(history.entries() == std::vector<std::string>({"echo two", "echo one", "log tail"}));
+
+        // Incremental reverse search. "echo two" was pushed out by the new entry (capacity 3).
+        history.add("echo three");
+        wave::core::cli::HistorySearch search(history);
+        assert(search.type("e") == std::optional<std::string>("echo three"));
+        assert(search.type("c") == std::optional<std::string>("echo three")); // Still matches
+        assert(search.next() == std::optional<std::string>("echo one"));
+        assert(search.backspace() == std::optional<std::string>("echo three"));
+        assert(search.type("cho o") == std::optional<std::string>("echo one")); // Continues to older entries
+        assert(!search.type("x"));
+        assert(search.backspace() == std::optional<std::string>("echo one"));
+        assert(!search.next()); // Nothing older
+        assert(search.query() == "echo o");
+    }
+
+    // The append-only file is compacted once it holds more than twice max-items lines.
+    {
+        wave::core::cli::HistoryManager history(2);
+        history.setHistoryFile(path);
+        for (int i = 0; i < 10; ++i) {
+            history.add("cmd " + std::to_string(i));
+        }
+        std::ifstream file(path);
+        size_t lines = 0;
+        for (std::string line; std::getline(file, line);) {
+            ++lines;
+        }
+        assert(lines <= 4);
+        assert(history.entries() == std::vector<std::string>({"cmd 8", "cmd 9"}));
+    }
+
+    // cli history lists numbered entries and can clear them.
+    wave::core::cli::CLIEngine engine;
+    engine.registerCommand("cli history", std::make_shared<wave::core::cli::CliHistoryCommand>(engine));
+    engine.getHistory().setHistoryFile(path);
+    wave::core::cli::CommandResult result = engine.executeCommand("cli history 9");
+    auto rows = std::any_cast<std::vector<wave::core::cli::StructuredData>>(result.data.value());
+    assert(rows.size() == 1 && std::any_cast<std::string>(rows[0]) == "    2  cmd 9");
+    engine.executeCommand("cli history --clear");
+    assert(engine.getHistory().size() == 0);
+    wave::core::cli::HistoryManager reopened;
+    reopened.setHistoryFile(path);
+    assert(reopened.size() == 0);
+
+    engine.getHistory().setEnabled(false);
+    assert(!engine.getHistory().add("ignored"));
+
+    std::remove(path.c_str());
+    std::cout << "Command History Test: PASSED" << std::endl;
+}
+
+void testOutputFormatters() {
+    printTestHeader("Output Formatters Test");
+    wave::core::cli::CLIEngine engine;
+    EchoCommand echoCmd;
+    CountCommand countCmd;
+    RecordsCommand recordsCmd;
+    engine.registerCommand("echo", &echoCmd);
+    engine.registerCommand("count", &countCmd);
+    engine.registerCommand("records", &recordsCmd);
+
+    // JSON Lines: one record per row as it is emitted, then the result.
+    std::ostringstream json;
+    auto result = engine.executeCommand("records --output json", json);
+    assert(result.status == wave::core::cli::CommandResult::Status::Success);
+    assert(json.str() ==
+           "{\"type\":\"row\",\"value\":{\"name\":\"alpha\",\"pid\":1,\"tags\":[\"a\",\"b\"]}}\n"
+           "{\"type\":\"row\",\"value\":{\"name\":\"be\\ta\",\"pid\":2.5,\"tags\":[]}}\n"
+           "{\"type\":\"result\",\"status\":\"Success\",\"message\":\"2 records.\"}\n");
+
+    // TSV: header from the first row, nested values as JSON, no status.
+    std::ostringstream tsv;
+    engine.executeCommand("records --output=tsv", tsv);
+    assert(tsv.str() == "name\tpid\ttags\nalpha\t1\t[\"a\",\"b\"]\nbe\\ta\t2.5\t[]\n");
+
+    // Binary: a CBOR sequence of the same records.
+    std::ostringstream binary;
+    engine.executeCommand("count 2 --output binary", binary);
+    std::string bytes = binary.str();
+    assert(bytes.size() > 20);
+    assert(static_cast<unsigned char>(bytes[0]) == 0xa2);         // map(2)
+    assert(bytes.compare(1, 5, "\x64type") == 0);                 // text(4) "type"
+    assert(bytes.compare(6, 4, "\x63row") == 0);                  // text(3) "row"
+    assert(bytes.find("\x65value\x00") != std::string::npos);     // first row: unsigned 0
+
+    // Text is the default; rows as lines, then the status and data lines.
+    std::ostringstream text;
+    engine.executeCommand("count 2", text);
+    assert(text.str() == "0\n1\n[Success] Counted.\n");
+    std::ostringstream echoed;
+    engine.executeCommand("echo hi there", echoed);
+    assert(echoed.str() == "[Success] Echoed successfully.\nData: hi there\n");
+
+    // Errors are rendered in the requested format; unknown formats fall back to text.
+    std::ostringstream missing;
+    result = engine.executeCommand("nosuch --output json", missing);
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    assert(missing.str().find("{\"type\":\"result\",\"status\":\"Error\"") == 0);
+    std::ostringstream unknown;
+    result = engine.executeCommand("echo hi --output yaml", unknown);
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    assert(unknown.str().find("[Error] Unknown output format: yaml (available: binary, json, text, tsv)") == 0);
+    result = engine.executeCommand("echo hi --output");
+    assert(result.status == wave::core::cli::CommandResult::Status::Error);
+    // The plain API strips the option too.
+    result = engine.executeCommand("echo hi --output json");
+    assert(std::any_cast<std::string>(result.data.value()) == "hi");
+
+    // Custom value types and defaults.
+    struct Point { int x; int y; };
+    engine.getOutputFormatters().registerValueType<Point>([](const Point& point, wave::core::cli::ValueWriter& writer) {
+        writer.beginArray(2);
+        writer.integer(point.x);
+        writer.integer(point.y);
+        writer.endArray();
+    });
+    assert(engine.getOutputFormatters().toText(wave::core::cli::StructuredData(Point{3, -4})) == "[3,-4]");
+    assert(engine.getOutputFormatters().toText(wave::core::cli::StructuredData(std::make_pair(1, 2))) ==
+           "(Opaque/Cannot display type)");
+    assert(!engine.setDefaultOutputFormat("yaml"));
+    assert(engine.setDefaultOutputFormat("json"));
+    std::ostringstream defaulted;
+    engine.executeCommand("echo hi", defaulted);
+    assert(defaulted.str() == "{\"type\":\"result\",\"status\":\"Success\",\"message\":\"Echoed successfully.\",\"data\":\"hi\"}\n");
+
+    // Script transcripts use the format as well.
+    std::istringstream script("echo one; count 1 --output tsv");
+    std::ostringstream transcript;
+    wave::core::cli::ScriptOptions options;
+    options.transcript = &transcript;
+    options.outputFormat = "text";
+    result = engine.executeScript(script, options);
+    assert(transcript.str() == "[Success] Echoed successfully.\nData: one\n0\n");
+    std::ostringstream summary;
+    engine.getOutputFormatters().create("json", summary)->finish(result);
+    assert(summary.str().find("\"data\":{\"succeeded\":2,\"warnings\":0,\"failed\":0,\"skipped\":0,"
+                              "\"statements\":[{\"line\":1,\"command\":\"echo one\"") != std::string::npos);
+
+    std::cout << "Output Formatters Test: PASSED" << std::endl;
+}
+
+void testPipelines() {
+    printTestHeader("Pipeline Test");
+    using Status = wave::core::cli::CommandResult::Status;
+    wave::core::cli::CLIEngine engine;
+    EchoCommand echoCmd;
+    CountCommand countCmd;
+    RecordsCommand recordsCmd;
+    engine.registerCommand("echo", &echoCmd);
+    engine.registerCommand("numbers", &countCmd);
+    engine.registerCommand("records", &recordsCmd);
+
+    std::vector<std::string_view> stages;
+    std::string error;
+    assert(wave::core::cli::InputParser::splitPipeline("a 'x|y' \\| b | c \"|\" ", stages, &error));
+    assert(stages.size() == 2 && stages[0] == "a 'x|y' \\| b" && stages[1] == "c \"|\"");
+    assert(!wave::core::cli::InputParser::splitPipeline("a || b", stages, &error));
+    assert(!wave::core::cli::InputParser::splitPipeline("a | ", stages, &error));
+
+    auto rowsOf = [](const wave::core::cli::CommandResult& result) {
+        std::vector<std::string> texts;
+        if (result.data.has_value()) {
+            for (const auto& row : std::any_cast<const std::vector<wave::core::cli::StructuredData>&>(*result.data)) {
+                texts.push_back(row.type() == typeid(int) ? std::to_string(std::any_cast<int>(row))
+                                                          : std::any_cast<std::string>(row));
+            }
+        }
+        return texts;
+    };
+
+    // head stops the producer instead of discarding the rest of its output.
+    auto result = engine.executeCommand("numbers 1000000 | head 3");
+    assert(rowsOf(result) == (std::vector<std::string>{"0", "1", "2"}));
+    assert(result.status == Status::Warning); // The command saw emit() return false
+    assert(countCmd.produced.load() == 2);
+
+    // Filters pass the original structured rows, not their text.
+    result = engine.executeCommand("numbers 30 | grep 1 | sort --numeric --reverse | head 4");
+    assert(rowsOf(result) == (std::vector<std::string>{"21", "19", "18", "17"}));
+    result = engine.executeCommand("numbers 30 | grep --invert 1 | count");
+    assert(std::any_cast<size_t>(std::any_cast<const std::vector<wave::core::cli::StructuredData>&>(*result.data)[0]) == 18);
+
+    // Returned data flows through the pipeline as well.
+    result = engine.executeCommand("echo Hello | grep --ignore-case hello");
+    assert(rowsOf(result) == (std::vector<std::string>{"Hello"}));
+    result = engine.executeCommand("echo Hello | grep bye");
+    assert(result.status == Status::Success && !result.data.has_value());
+
+    // Record rows by field; output formats apply to the filtered rows.
+    std::ostringstream tsv;
+    engine.executeCommand("records | sort --field pid --numeric --reverse | uniq --field tags --output tsv", tsv);
+    assert(tsv.str() == "name\tpid\ttags\nbe\\ta\t2.5\t[]\nalpha\t1\t[\"a\",\"b\"]\n");
+    std::ostringstream json;
+    engine.executeCommand("records | grep --field name alp --output=json", json);
+    assert(json.str().find("\"name\":\"alpha\"") != std::string::npos);
+    assert(json.str().find("be\\ta") == std::string::npos);
+
+    // Errors.
+    result = engine.executeCommand("numbers 3 | nosuch");
+    assert(result.status == Status::Error && result.message.find("Unknown pipeline operator: nosuch") == 0);
+    result = engine.executeCommand("numbers 3 | head x");
+    assert(result.status == Status::Error && result.message == "head: invalid row count: x");
+    result = engine.executeCommand("numbers 3 | sort --bogus");
+    assert(result.status == Status::Error);
+    result = engine.executeCommand("numbers 3 || head");
+    assert(result.status == Status::Error && result.message.find("Empty pipeline stage") != std::string::npos);
+
+    // Custom operators.
+    wave::core::cli::PipelineOperator twice;
+    twice.help = "twice - repeats each row.";
+    twice.create = [](const std::vector<std::string>&, const wave::core::cli::ParsedOptions&,
+                      const wave::core::cli::OutputFormatterRegistry&, std::string&) -> std::unique_ptr<wave::core::cli::RowFilter> {
+        struct Twice : wave::core::cli::RowFilter {
+            bool write(wave::core::cli::StructuredData row) override { return forward(row) && forward(row); }
+        };
+        return std::make_unique<Twice>();
+    };
+    assert(engine.getPipelineOperators().registerOperator("twice", twice));
+    assert(!engine.getPipelineOperators().registerOperator("twice", twice));
+    auto asyncHandle = engine.executeCommandAsync("numbers 2 | twice | head 3");
+    assert(rowsOf(asyncHandle.result.get()) == (std::vector<std::string>{"0", "0", "1"}));
+
+    std::cout << "Pipeline Test: PASSED" << std::endl;
+}
+
+void testResultCache() {
+    printTestHeader("Result Cache Test");
+    using Status = wave::core::cli::CommandResult::Status;
+    // A fake event source standing in for the EventBus; declared first because the engine
+    // unsubscribes when it is destroyed.
+    std::map<std::string, std::function<void()>> subscribers;
+    int unsubscribed = 0;
+    wave::core::cli::CLIEngine engine;
+    ModuleListCommand modules;
+    modules.policy.invalidatedBy = {"module.loaded", "module.unloaded"};
+    engine.registerCommand("modules", &modules);
+
+    engine.setCacheTopicSubscriber([&](const std::string& topic, std::function<void()> invalidate) {
+        subscribers[topic] = invalidate;
+        return std::function<void()>([&unsubscribed]() { ++unsubscribed; });
+    });
+
+    auto first = engine.executeCommand("modules");
+    assert(first.message == "run 1" && modules.runs.load() == 1);
+    auto second = engine.executeCommand("modules");
+    assert(second.message == "run 1" && modules.runs.load() == 1); // Served from the cache
+    auto rows = std::any_cast<std::vector<wave::core::cli::StructuredData>>(second.data.value());
+    assert(rows.size() == 3 && std::any_cast<std::string>(rows[2]) == "network");
+    assert(subscribers.size() == 2);
+
+    // Arguments are part of the key; pipelines and formats apply to replayed rows.
+    assert(engine.executeCommand("modules c").message == "run 2");
+    assert(engine.executeCommand("modules c").message == "run 2");
+    std::ostringstream json;
+    engine.executeCommand("modules | grep net --output json", json);
+    assert(modules.runs.load() == 2);
+    assert(json.str() == "{\"type\":\"row\",\"value\":\"network\"}\n"
+                         "{\"type\":\"result\",\"status\":\"Success\",\"message\":\"run 1\"}\n");
+
+    // Arguments are length-prefixed in the key: a quoted newline does not alias two arguments.
+    assert(engine.executeCommand("modules \"c\nx\"").message == "run 3");
+    assert(engine.executeCommand("modules c x").message == "run 4");
+    assert(engine.executeCommand("modules \"c\nx\"").message == "run 3");
+    modules.runs = 2;
+    engine.getResultCache().clear();
+
+    // A consumer that stops early leaves an incomplete run, which is not cached.
+    subscribers["module.loaded"]();
+    assert(engine.executeCommand("modules | head 1").message == "run 3");
+    assert(engine.executeCommand("modules").message == "run 4");
+    assert(engine.executeCommand("modules").message == "run 4");
+    engine.invalidateCachedResults("module.unloaded");
+    assert(engine.executeCommand("modules").message == "run 5");
+
+    // TTL-only policy.
+    modules.policy.invalidatedBy.clear();
+    modules.policy.ttl = std::chrono::milliseconds(40);
+    engine.getResultCache().clear();
+    assert(engine.executeCommand("modules").message == "run 6");
+    assert(engine.executeCommand("modules").message == "run 6");
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    assert(engine.executeCommand("modules").message == "run 7");
+
+    // An invalidation while the command runs keeps its (possibly stale) result out of the cache.
+    wave::core::cli::ResultCache cache;
+    wave::core::cli::CachePolicy policy;
+    policy.invalidatedBy = {"t"};
+    auto ticket = cache.begin(policy);
+    cache.invalidate("t");
+    cache.store("k", policy, ticket, wave::core::cli::ResultCache::Entry{
+        std::make_shared<const wave::core::cli::CommandResult>(Status::Success, "stale"), {}});
+    assert(!cache.lookup("k"));
+    ticket = cache.begin(policy);
+    cache.store("k", policy, ticket, wave::core::cli::ResultCache::Entry{
+        std::make_shared<const wave::core::cli::CommandResult>(Status::Success, "fresh"), {}});
+    assert(cache.lookup("k")->result->message == "fresh");
+
+    wave::core::cli::CliCacheCommand cacheCmd(engine);
+    engine.registerCommand("cli cache", &cacheCmd);
+    auto stats = engine.executeCommand("cli cache");
+    assert(stats.status == Status::Success && stats.message.find("1 cached result(s)") == 0);
+    engine.executeCommand("cli cache --clear");
+    assert(engine.getResultCache().getStats().entries == 0);
+
+    engine.unregisterCommand("modules");
+    assert(unsubscribed == 0);
+
+    // A second execution waits for the first one's subscription instead of caching a result that
+    // an event published meanwhile would never invalidate.
+    {
+        wave::core::cli::CLIEngine racing;
+        ModuleListCommand slowModules;
+        slowModules.policy.invalidatedBy = {"module.loaded"};
+        racing.registerCommand("modules", &slowModules);
+        std::mutex gate;
+        std::unique_lock<std::mutex> closed(gate);
+        std::atomic<bool> subscribing{false};
+        racing.setCacheTopicSubscriber([&](const std::string&, std::function<void()>) {
+            subscribing = true;
+            std::lock_guard<std::mutex> wait(gate);
+            return std::function<void()>();
+        });
+        std::thread firstRun([&racing]() { racing.executeCommand("modules"); });
+        while (!subscribing.load()) {
+            std::this_thread::yield();
+        }
+        std::atomic<bool> secondDone{false};
+        std::thread secondRun([&racing, &secondDone]() {
+            racing.executeCommand("modules");
+            secondDone = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(!secondDone.load() && slowModules.runs.load() == 0);
+        closed.unlock();
+        firstRun.join();
+        secondRun.join();
+        assert(slowModules.runs.load() >= 1);
+    }
+    std::cout << "Result Cache Test: PASSED" << std::endl;
+}
+
 int main() {
     std::cout << "Starting CLIEngine Test Suite..." << std::endl;
 
@@ -297,6 +1455,21 @@ int main() {
     testCommandExecution();
     testHelpMessages();
     testThreadSafety();
+    testAsyncExecution();
+    testAsyncConcurrencyLimit();
+    testStreamingOutput();
+    testHierarchicalDispatch();
+    testTokenizer();
+    testQuotedArgumentsAndOptions();
+    testRefcountedRegistry();
+    testFindAndConditionalUnregister();
+    testCommandOwnerScope();
+    testScriptExecution();
+    testCommandMetrics();
+    testCommandHistory();
+    testOutputFormatters();
+    testPipelines();
+    testResultCache();
 
     // Note: startInteractiveSession() is harder to test automatically.
     // It can be tested manually by uncommenting:
@@ -1,7 +1,10 @@
 #include "core/core.hpp" // This should bring in ICoreAccess via core.hpp's include
+#include "core/moduleloader/module_index.hpp"
 #include <iostream>
 #include <cassert>
+#include <cstdlib>
 #include <string>
+#include <thread>
 
 // Helper function to print test headers
 void printTestHeader(const std::string& testName) {
@@ -82,19 +85,22 @@ void testCoreInstantiationAndAccess() {
     std::cout << "Core Instantiation and System Access Test: PASSED" << std::endl;
 }
 
-// Dummy main for testing ICoreAccess through Core
+// A module using the core the way a loaded one would: through the WaveCoreApi table.
 // This also serves to ensure all necessary headers are included and linkable.
 class TestModuleUsingCore : public wave::core::moduleloader::ILauncherModule {
-    wave::ICoreAccess* coreAccess_ = nullptr;
+    const WaveCoreApi* core_ = nullptr;
 public:
-    void initialize(wave::ICoreAccess* coreAccess) override {
-        coreAccess_ = coreAccess;
-        assert(coreAccess_ != nullptr && "CoreAccess provided to module should not be null.");
-        
-        // Modules would use the coreAccess to get other systems
-        wave::core::logging::LoggingSystem* logger = coreAccess_->getLoggingSystem();
+    wave::core::logging::LoggingSystem* logger = nullptr;
+
+    void initialize(const WaveCoreApi* core) override {
+        core_ = core;
+        assert(core_ != nullptr && "Core API provided to module should not be null.");
+
+        // Modules get the other systems as core services, without casting the core.
+        logger = wave::core::moduleloader::coreService<wave::core::logging::LoggingSystem>(core_, WAVE_SERVICE_LOGGING);
         assert(logger != nullptr && "Module could access LoggingSystem.");
         logger->log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Debug, "TestModule", "TestModule initialized via Core."));
+        core_->log(core_->context, WAVE_LOG_DEBUG, "TestModule", "Logged through the core API.");
     }
     void shutdown() override { /* ... */ }
     std::string getName() const override { return "TestModuleUsingCore"; }
@@ -116,21 +122,254 @@ void testCoreWithModuleLoader() {
     // A full module load test via Core would be more involved here.
     std::cout << "  ModuleLoaderSystem obtained from Core. Further module loading tests are in test_module_loader.cpp." << std::endl;
     
-    // Example: If we had a dummy module instance to pass to ModuleLoaderSystem constructor for some reason
-    // (not how it's designed, but as an example of using a system from Core)
-    // TestModuleUsingCore testModule;
-    // moduleLoader->loadModule(...); // This would use the actual module loading mechanism.
+    // The services table modules receive hands out the Core's own systems.
+    const WaveCoreApi* api = appCore.getCoreApi();
+    assert(api != nullptr && api->apiVersion == WAVE_CORE_API_VERSION);
+    TestModuleUsingCore testModule;
+    testModule.initialize(api);
+    assert(testModule.logger == appCore.getLoggingSystem());
+    testModule.shutdown();
+    using wave::core::moduleloader::coreService;
+    assert(coreService<wave::core::eventbus::EventBus>(api, WAVE_SERVICE_EVENTBUS) == appCore.getEventBus());
+    assert(coreService<wave::core::cli::CLIEngine>(api, WAVE_SERVICE_CLI) == appCore.getCLIEngine());
+    assert(coreService<wave::core::configuration::ConfigurationSystem>(api, WAVE_SERVICE_CONFIGURATION) ==
+           appCore.getConfigurationSystem());
+    assert(coreService<wave::core::moduleloader::ModuleLoaderSystem>(api, WAVE_SERVICE_MODULE_LOADER) == moduleLoader);
+    assert(api->serviceVersion(api->context, WAVE_SERVICE_LOGGING) == WAVE_SERVICE_VERSION);
+    assert(coreService<wave::core::logging::LoggingSystem>(api, WAVE_SERVICE_LOGGING, WAVE_SERVICE_VERSION + 1) == nullptr);
     
     appCore.shutdown();
     std::cout << "Core with ModuleLoader Test: PASSED (basic check)" << std::endl;
 }
 
 
+void testBuiltinCommands() {
+    printTestHeader("Built-in Core Commands Test");
+    using Status = wave::core::cli::CommandResult::Status;
+    using Record = std::map<std::string, wave::core::cli::StructuredData>;
+
+    std::string configPath = "test_core_commands.ini";
+    {
+        std::ofstream configFile(configPath);
+        configFile << "[TestSection]\nTestKey = TestValue\nOther = 2\n";
+    }
+    wave::core::Core appCore;
+    appCore.initialize(configPath);
+    wave::core::cli::CLIEngine& engine = *appCore.getCLIEngine();
+
+    auto status = engine.executeCommand("core status");
+    assert(status.status == Status::Success && status.data.has_value());
+    const auto& record = std::any_cast<const Record&>(*status.data);
+    assert(std::any_cast<bool>(record.at("initialized")));
+    assert(std::any_cast<std::string>(record.at("config_file")) == configPath);
+    std::cout << "  core status: " << status.message << std::endl;
+
+    auto value = engine.executeCommand("config get TestSection TestKey");
+    assert(value.status == Status::Success && std::any_cast<std::string>(*value.data) == "TestValue");
+    assert(engine.executeCommand("config set TestSection TestKey two words").status == Status::Success);
+    assert(std::any_cast<std::string>(*engine.executeCommand("config get TestSection TestKey").data) == "two words");
+    assert(engine.executeCommand("config get NoSuchSection").status == Status::Error);
+    auto dump = engine.executeCommand("config dump TestSection");
+    assert(dump.status == Status::Success);
+    assert(std::any_cast<const std::vector<wave::core::cli::StructuredData>&>(*dump.data).size() == 2);
+    assert(engine.executeCommand("config reload").status == Status::Success);
+    assert(std::any_cast<std::string>(*engine.executeCommand("config get TestSection TestKey").data) == "TestValue");
+
+    assert(engine.executeCommand("log level CoreTest DEBUG").status == Status::Success);
+    assert(appCore.getLoggingSystem()->getLogLevel("CoreTest") == wave::core::logging::LogLevel::Debug);
+    assert(engine.executeCommand("log level CoreTest LOUD").status == Status::Error);
+    appCore.getLoggingSystem()->log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Debug, "CoreTest", "tail me"));
+    auto tail = engine.executeCommand("log tail --lines 1 --category CoreTest");
+    const auto& rows = std::any_cast<const std::vector<wave::core::cli::StructuredData>&>(*tail.data);
+    assert(rows.size() == 1);
+    assert(std::any_cast<std::string>(std::any_cast<const Record&>(rows[0]).at("message")) == "tail me");
+
+    // "module list" is cacheable and must be dropped by the module.* topics Core republishes.
+    assert(engine.executeCommand("module list").status == Status::Success);
+    assert(engine.executeCommand("module list").status == Status::Success);
+    assert(engine.getResultCache().getStats().hits == 1);
+    appCore.getEventBus()->publish("module.loaded", std::string("x"), wave::core::eventbus::DeliveryMode::Sync);
+    assert(engine.getResultCache().getStats().entries == 0);
+    // Failed loads and unloads ("module.error") drop it as well.
+    assert(engine.executeCommand("module list").status == Status::Success);
+    assert(engine.getResultCache().getStats().entries == 1);
+    assert(engine.executeCommand("module unload NoSuchModule").status == Status::Error);
+    assert(engine.getResultCache().getStats().entries == 0);
+
+    auto topics = engine.executeCommand("eventbus topics");
+    assert(topics.status == Status::Success);
+    auto stats = engine.executeCommand("eventbus stats module.loaded");
+    assert(stats.status == Status::Success);
+    assert(std::any_cast<uint64_t>(std::any_cast<const Record&>(*stats.data).at("published")) == 1);
+
+    appCore.shutdown();
+    std::remove(configPath.c_str());
+    std::cout << "Built-in Core Commands Test: PASSED" << std::endl;
+}
+
+void testLazyModules() {
+    printTestHeader("Lazy Module Activation Test");
+    using Status = wave::core::cli::CommandResult::Status;
+    using Record = std::map<std::string, wave::core::cli::StructuredData>;
+
+    // DummyLazy declares the command "dummylazy ping" and the topic "dummylazy.wake" in its
+    // manifest but registers nothing itself (see tests/dummy_module).
+    const std::string lazyModulePath = "wave/tests/dummy_module/build/lib/libdummy_lazy_module.so";
+    if (!std::ifstream(lazyModulePath).good()) {
+        std::cout << "  " << lazyModulePath << " not built; skipped." << std::endl;
+        return;
+    }
+    std::string configPath = "test_core_lazy.ini";
+    std::string modulesPath = "test_core_lazy_modules.conf";
+    std::string reportPath = "test_core_startup_report.txt";
+    std::string cachePath = "test_core_manifests.cache";
+    std::remove(cachePath.c_str());
+    {
+        // The module is named without a path and found in search_paths.
+        std::ofstream configFile(configPath);
+        configFile << "[Modules]\nmodules_file = " << modulesPath << "\nstartup_report = " << reportPath
+                   << "\nsearch_paths = wave/tests/no_such_directory:wave/tests/dummy_module/build/lib\nmanifest_cache = "
+                   << cachePath << "\n";
+        std::ofstream modulesFile(modulesPath);
+        modulesFile << "[modules]\ndummylazy = dummy_lazy_module lazy\n";
+    }
+    auto isLoaded = [](wave::core::Core& core) {
+        for (const auto& info : core.getModuleLoaderSystem()->listModules()) {
+            if (info.name == "DummyLazy") return true;
+        }
+        return false;
+    };
+
+    {
+        // First use of a declared command loads the module.
+        wave::core::Core appCore;
+        appCore.initialize(configPath);
+        wave::core::cli::CLIEngine& engine = *appCore.getCLIEngine();
+        assert(!isLoaded(appCore));
+        assert(appCore.getLazyModuleActivator()->getPendingModules() == std::vector<std::string>{"DummyLazy"});
+        auto status = engine.executeCommand("core status");
+        assert(std::any_cast<size_t>(std::any_cast<const Record&>(*status.data).at("lazy_modules_pending")) == 1);
+
+        auto result = engine.executeCommand("dummylazy ping");
+        assert(isLoaded(appCore));
+        assert(appCore.getLazyModuleActivator()->getPendingModules().empty());
+        // The stand-in is gone and the module did not register the command it declared.
+        assert(result.status == Status::Error && result.message.find("did not register") != std::string::npos);
+        assert(engine.executeCommand("dummylazy ping").message.find("Command not found") != std::string::npos);
+
+        // Its load profile shows up in "module stats".
+        auto moduleStats = engine.executeCommand("module stats");
+        assert(moduleStats.status == Status::Success);
+        const auto& statRows = std::any_cast<const std::vector<wave::core::cli::StructuredData>&>(*moduleStats.data);
+        assert(statRows.size() == 1);
+        const Record& statRow = std::any_cast<const Record&>(statRows[0]);
+        assert(std::any_cast<std::string>(statRow.at("name")) == "DummyLazy");
+        assert(std::any_cast<double>(statRow.at("total_ms")) >= std::any_cast<double>(statRow.at("init_ms")));
+
+        // "module available" lists every library in the search paths, loaded or not.
+        auto available = engine.executeCommand("module available");
+        assert(available.status == Status::Success);
+        bool lazyListed = false;
+        for (const auto& row : std::any_cast<const std::vector<wave::core::cli::StructuredData>&>(*available.data)) {
+            const Record& record = std::any_cast<const Record&>(row);
+            if (std::any_cast<std::string>(record.at("name")) == "DummyLazy") {
+                lazyListed = std::any_cast<std::string>(record.at("path")) == lazyModulePath &&
+                             std::any_cast<bool>(record.at("loaded"));
+            }
+        }
+        assert(lazyListed);
+        appCore.shutdown();
+
+        // initialize() wrote the startup report (no module was loaded at startup).
+        std::ifstream report(reportPath);
+        std::string firstLine;
+        assert(std::getline(report, firstLine) && firstLine.find("Startup took") == 0);
+        assert(firstLine.find("0 module(s) loaded") != std::string::npos);
+    }
+    {
+        // An event on a declared topic loads it in the background.
+        wave::core::Core appCore;
+        appCore.initialize(configPath);
+        // The manifest came from the cache the first run wrote.
+        assert(appCore.getModuleLoaderSystem()->getModuleIndex().getLibraryReads() == 0);
+        appCore.getEventBus()->publish("dummylazy.wake", std::string("go"), wave::core::eventbus::DeliveryMode::Sync);
+        for (int i = 0; i < 200 && !isLoaded(appCore); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        assert(isLoaded(appCore));
+        appCore.shutdown();
+    }
+
+    std::remove(configPath.c_str());
+    std::remove(modulesPath.c_str());
+    std::remove(reportPath.c_str());
+    std::remove(cachePath.c_str());
+    std::cout << "Lazy Module Activation Test: PASSED" << std::endl;
+}
+
+void testIsolatedModules() {
+    printTestHeader("Isolated Module Test");
+    using Status = wave::core::cli::CommandResult::Status;
+    using Record = std::map<std::string, wave::core::cli::StructuredData>;
+
+    const std::string lazyModulePath = "wave/tests/dummy_module/build/lib/libdummy_lazy_module.so";
+    const char* host = std::getenv("WAVE_MODULE_HOST");
+    // Built by the module_host target of tests/dummy_module/CMakeLists.txt.
+    const std::string hostPath = host ? host : "wave/tests/dummy_module/build/bin/module_host";
+    if (!std::ifstream(lazyModulePath).good() || !std::ifstream(hostPath).good()) {
+        std::cerr << "!! Isolated Module Test: SKIPPED, " << lazyModulePath << " or " << hostPath
+                  << " not built (build tests/dummy_module, or set WAVE_MODULE_HOST)." << std::endl;
+        return;
+    }
+    std::string configPath = "test_core_isolated.ini";
+    std::string modulesPath = "test_core_isolated_modules.conf";
+    {
+        std::ofstream configFile(configPath);
+        configFile << "[Modules]\nmodules_file = " << modulesPath << "\nmodule_host = " << hostPath
+                   << "\nisolated_max_restarts = 1\n";
+        std::ofstream modulesFile(modulesPath);
+        modulesFile << "[modules]\ndummylazy = " << lazyModulePath << " isolated\n";
+    }
+
+    wave::core::Core appCore;
+    appCore.initialize(configPath);
+    wave::core::cli::CLIEngine& engine = *appCore.getCLIEngine();
+    auto modules = appCore.getModuleLoaderSystem()->listModules();
+    assert(modules.size() == 1 && modules[0].name == "DummyLazy" && modules[0].isolation);
+    assert(modules[0].isolation->hostExecutable == hostPath && modules[0].isolation->maxRestarts == 1);
+
+    // The declared command is forwarded to the host, whose engine does not know it either: the
+    // module registers nothing.
+    assert(engine.findCommand("dummylazy ping"));
+    auto result = engine.executeCommand("dummylazy ping \"two words\"");
+    assert(result.status == Status::Error && result.message.find("not found") != std::string::npos);
+    // Events are queued for the bridge's delivery thread; unloading and shutting down with
+    // deliveries still pending must neither block on them nor let one outlive the module.
+    for (int i = 0; i < 20; ++i) {
+        appCore.getEventBus()->publish("dummylazy.wake", std::string("go"));
+    }
+    auto wakeStats = engine.executeCommand("eventbus stats dummylazy.wake");
+    assert(std::any_cast<uint64_t>(std::any_cast<const Record&>(*wakeStats.data).at("sync_deliveries")) == 20);
+
+    // The forwarding goes with the module.
+    assert(engine.executeCommand("module unload DummyLazy").status == Status::Success);
+    assert(!engine.findCommand("dummylazy ping"));
+    appCore.shutdown();
+
+    std::remove(configPath.c_str());
+    std::remove(modulesPath.c_str());
+    std::cout << "Isolated Module Test: PASSED" << std::endl;
+}
+
+
 int main() {
     std::cout << "Starting Core Test Suite..." << std::endl;
 
     testCoreInstantiationAndAccess();
     testCoreWithModuleLoader(); // Very basic check
+    testBuiltinCommands();
+    testLazyModules();
+    testIsolatedModules();
 
     std::cout << "\nCore Test Suite: ALL TESTS COMPLETED." << std::endl;
     std::cout << "Note: Some tests rely on visual inspection of console output (e.g., log messages)." << std::endl;
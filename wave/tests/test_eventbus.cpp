@@ -203,6 +203,25 @@ void testThreadSafety() {
     std::cout << "Thread Safety Test: PASSED (heuristic check)" << std::endl;
 }
 
+void testTopicStats() {
+    printTestHeader("Topic Stats Test");
+    wave::core::eventbus::EventBus bus;
+    auto id = bus.subscribe("StatsEvent", [](const wave::core::eventbus::StructuredData&) {},
+                            wave::core::eventbus::DeliveryMode::Sync);
+    bus.publish("StatsEvent", 1, wave::core::eventbus::DeliveryMode::Sync);
+    bus.publish("StatsEvent", 2, wave::core::eventbus::DeliveryMode::Sync);
+    bus.publish("NobodyListens", 3);
+
+    auto stats = bus.getTopicStats();
+    assert(stats.size() == 2);
+    assert(stats[0].topic == "NobodyListens" && stats[0].published == 1 && stats[0].subscribers == 0);
+    assert(stats[1].topic == "StatsEvent" && stats[1].published == 2 && stats[1].syncDeliveries == 2);
+    assert(stats[1].subscribers == 1);
+    bus.unsubscribe(id);
+    assert(bus.getTopicStats()[1].subscribers == 0);
+    std::cout << "Topic Stats Test: PASSED" << std::endl;
+}
+
 
 int main() {
     std::cout << "Starting EventBus Test Suite..." << std::endl;
@@ -213,6 +232,7 @@ int main() {
     testUnsubscribe();
     testMultipleSubscribers();
     testDataIntegrity();
+    testTopicStats();
     // testThreadSafety(); // This test can be flaky and complex due to unsubscribe logic issues.
                         // The current unsubscribe has known limitations that affect this test's determinism.
                         // Re-enable if unsubscribe is made more robust.
@@ -215,6 +215,31 @@ void testThreadSafety() {
     std::remove(TEST_LOG_FILE_PATH.c_str());
 }
 
+void testRecentEntries() {
+    printTestHeader("Recent Entries Test");
+    wave::core::logging::LoggingSystem logger;
+    logger.setRecentEntryCapacity(3);
+    logger.setLogLevel("Quiet", wave::core::logging::LogLevel::Error);
+    for (int i = 0; i < 5; ++i) {
+        logger.log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Info, i % 2 ? "Odd" : "Even",
+                                                 "entry " + std::to_string(i)));
+    }
+    logger.log(wave::core::logging::LogEntry(wave::core::logging::LogLevel::Info, "Quiet", "filtered"));
+
+    auto entries = logger.getRecentEntries(0);
+    assert(entries.size() == 3); // Only the last 3 kept; the filtered entry is not among them
+    assert(entries.front().message == "entry 2" && entries.back().message == "entry 4");
+    auto newest = logger.getRecentEntries(1);
+    assert(newest.size() == 1 && newest[0].message == "entry 4");
+    auto odd = logger.getRecentEntries(0, "Odd");
+    assert(odd.size() == 1 && odd[0].message == "entry 3");
+
+    assert(wave::core::logging::LoggingSystem::logLevelFromString("warn") == wave::core::logging::LogLevel::Warning);
+    assert(!wave::core::logging::LoggingSystem::logLevelFromString("loud").has_value());
+    assert(logger.getLogLevels().count("Quiet") == 1);
+    std::cout << "Recent Entries Test: PASSED" << std::endl;
+}
+
 int main() {
     std::cout << "Starting LoggingSystem Test Suite..." << std::endl;
 
@@ -222,6 +247,7 @@ int main() {
     testLogEventSubscription();
     testFileLogging();
     testThreadSafety();
+    testRecentEntries();
 
     std::cout << "\nLoggingSystem Test Suite: ALL TESTS COMPLETED." << std::endl;
     std::cout << "Note: Some tests rely on visual inspection of console output for full verification." << std::endl;
@@ -1,4 +1,7 @@
 #include "core/moduleloader/module_loader.hpp"
+#include "core/moduleloader/module_index.hpp"
+#include "core/moduleloader/module_host.hpp"
+#include "core/moduleloader/core_services.hpp"
 #include <iostream>
 #include <cassert>
 #include <string>
@@ -7,21 +10,22 @@
 #include <thread>
 #include <chrono> // For sleep
 #include <cstdio> // For std::remove to clean up dummy module if copied
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <cstdlib>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Tests that could not run in this environment; reported again at the end of main().
+std::vector<std::string> skippedTests;
 
 // Helper function to print test headers
 void printTestHeader(const std::string& testName) {
     std::cout << "\n--- " << testName << " ---" << std::endl;
 }
 
-// Dummy ICoreAccess implementation for testing
-class DummyCoreAccess : public wave::core::moduleloader::ICoreAccess {
-public:
-    void placeholder() const override {
-        // std::cout << "[DummyCoreAccess] Placeholder method called." << std::endl;
-    }
-    // Add any methods modules might actually call if necessary for deeper testing
-};
-
 // Path to the dummy module (adjust if necessary based on build environment)
 // Assumes tests are run from the root directory of the project (/app)
 #ifdef _WIN32
@@ -29,14 +33,29 @@ public:
 #else
     const std::string DUMMY_MODULE_FILENAME = "libdummy_module.so";
 #endif
-const std::string DUMMY_MODULE_PATH = "wave/tests/dummy_module/build/lib/" + DUMMY_MODULE_FILENAME;
+const std::string DUMMY_MODULE_DIR = "wave/tests/dummy_module/build/lib";
+const std::string DUMMY_MODULE_PATH = DUMMY_MODULE_DIR + "/" + DUMMY_MODULE_FILENAME;
+// Built by the module_host target of dummy_module/CMakeLists.txt; WAVE_MODULE_HOST overrides it.
+const std::string MODULE_HOST_PATH = "wave/tests/dummy_module/build/bin/module_host";
 const std::string NON_EXISTENT_MODULE_PATH = "wave/tests/dummy_module/build/lib/non_existent_module.so";
+// Variants of the dummy module with manifest dependencies (see dummy_module/CMakeLists.txt)
+#ifdef _WIN32
+const std::string DUMMY_LIB_PREFIX = "wave/tests/dummy_module/build/lib/", DUMMY_LIB_SUFFIX = ".dll";
+#else
+const std::string DUMMY_LIB_PREFIX = "wave/tests/dummy_module/build/lib/lib", DUMMY_LIB_SUFFIX = ".so";
+#endif
+const std::string BASE_MODULE_PATH = DUMMY_LIB_PREFIX + "dummy_base_module" + DUMMY_LIB_SUFFIX;
+const std::string DEPENDENT_MODULE_PATH = DUMMY_LIB_PREFIX + "dummy_dependent_module" + DUMMY_LIB_SUFFIX;
+const std::string CYCLE_A_MODULE_PATH = DUMMY_LIB_PREFIX + "dummy_cycle_a_module" + DUMMY_LIB_SUFFIX;
+const std::string CYCLE_B_MODULE_PATH = DUMMY_LIB_PREFIX + "dummy_cycle_b_module" + DUMMY_LIB_SUFFIX;
+const std::string SLOW_MODULE_PATH = DUMMY_LIB_PREFIX + "dummy_slow_module" + DUMMY_LIB_SUFFIX; // 500 ms initialize()
+const std::string UNMANIFESTED_MODULE_PATH = DUMMY_LIB_PREFIX + "dummy_unmanifested_module" + DUMMY_LIB_SUFFIX; // No manifest
 
 
 void testModuleLoadUnloadList() {
     printTestHeader("Module Load, Unload, and List Test");
-    DummyCoreAccess coreAccess;
-    wave::core::moduleloader::ModuleLoaderSystem loader(&coreAccess);
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
 
     // 1. Test Loading a valid module
     std::cout << "Attempting to load module: " << DUMMY_MODULE_PATH << std::endl;
@@ -82,8 +101,8 @@ void testModuleLoadUnloadList() {
 
 void testModuleEvents() {
     printTestHeader("Module Event Subscription Test");
-    DummyCoreAccess coreAccess;
-    wave::core::moduleloader::ModuleLoaderSystem loader(&coreAccess);
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
 
     std::atomic<int> loadedEvents(0);
     std::atomic<int> unloadedEvents(0);
@@ -137,8 +156,8 @@ void testModuleEvents() {
 
 void testModuleReload() {
     printTestHeader("Module Reload Test");
-    DummyCoreAccess coreAccess;
-    wave::core::moduleloader::ModuleLoaderSystem loader(&coreAccess);
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
 
     std::atomic<int> loadedCount(0), unloadedCount(0), reloadedCount(0), errorCount(0);
     std::string last_module_name_event;
@@ -222,8 +241,8 @@ void testModuleReload() {
 
 void testErrorConditions() {
     printTestHeader("Error Conditions Test");
-    DummyCoreAccess coreAccess;
-    wave::core::moduleloader::ModuleLoaderSystem loader(&coreAccess);
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
 
     // 1. Load non-existent module file
     wave::core::moduleloader::ModuleResult res = loader.loadModule(NON_EXISTENT_MODULE_PATH);
@@ -240,17 +259,24 @@ void testErrorConditions() {
     res = loader.unloadModule("NeverLoadedModule");
     assert(res.status == wave::core::moduleloader::ModuleResult::Status::NotFound);
 
+    // 4. A library without a manifest is refused before its module is created: nothing says which
+    // interface its initialize() expects.
+    res = loader.loadModule(UNMANIFESTED_MODULE_PATH);
+    assert(res.status == wave::core::moduleloader::ModuleResult::Status::Error);
+    assert(res.message.find("wave_module_manifest") != std::string::npos);
+    assert(loader.listModules().empty());
+
     std::cout << "Error Conditions Test: PASSED (basic cases)" << std::endl;
 }
 
 
 void testThreadSafety() {
     printTestHeader("Thread Safety Test (Basic)");
-    DummyCoreAccess coreAccess;
-    wave::core::moduleloader::ModuleLoaderSystem loader(&coreAccess);
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
     
     std::atomic<int> successfulLoads(0);
-    std::atomic<int> successfulUnloads(0);
+    std::atomic<int> alreadyLoaded(0);
     std::atomic<int> eventCount(0);
 
     loader.subscribeToModuleEvents(
@@ -262,33 +288,26 @@ void testThreadSafety() {
     );
 
     const int numThreads = 5; // Reduced for faster test, can be increased
+    std::atomic<int> ready(0);
     std::vector<std::thread> threads;
 
     for (int i = 0; i < numThreads; ++i) {
         threads.emplace_back([&, i]() {
-            // Each thread tries to load, then unload the module.
-            // To make them operate on distinct "modules" if module names need to be unique,
-            // we'd need multiple dummy module files or a module that can change its name.
-            // The current DummyModule always has the same name.
-            // So, only one thread will successfully load "DummyModule" at a time.
-            // Others will fail to load if it's already loaded by name.
-            // This tests concurrent access to the load/unload logic and registry.
-
-            // Let's try loading the same module path. Only one should succeed.
+            // Every thread loads the same path at once. The DummyModule always has the same name,
+            // and the module stays loaded until all threads are done, so exactly one load succeeds;
+            // the others find the path (or the name) already loaded, or still being loaded.
+            ready++;
+            while (ready.load() < numThreads) {
+                std::this_thread::yield();
+            }
             wave::core::moduleloader::ModuleResult lRes = loader.loadModule(DUMMY_MODULE_PATH);
             if (lRes.status == wave::core::moduleloader::ModuleResult::Status::Success) {
                 successfulLoads++;
-                std::string moduleName = lRes.module.value().name;
-                std::this_thread::sleep_for(std::chrono::milliseconds(10 * i)); // Stagger unloads
-                
-                wave::core::moduleloader::ModuleResult uRes = loader.unloadModule(moduleName);
-                if (uRes.status == wave::core::moduleloader::ModuleResult::Status::Success) {
-                    successfulUnloads++;
-                }
+            } else if (lRes.status == wave::core::moduleloader::ModuleResult::Status::Error &&
+                       lRes.message.find("already loaded") != std::string::npos) {
+                alreadyLoaded++;
             } else {
-                // It might fail if another thread loaded it (by path or by name if name is fixed)
-                // Or if the file path was wrong, etc.
-                 std::cout << "[Thread " << i << "] Load failed: " << lRes.message << std::endl;
+                std::cout << "[Thread " << i << "] Unexpected load failure: " << lRes.message << std::endl;
             }
         });
     }
@@ -298,37 +317,613 @@ void testThreadSafety() {
     }
 
     std::cout << "Thread Safety Test: Successful loads: " << successfulLoads.load() << std::endl;
-    std::cout << "Thread Safety Test: Successful unloads: " << successfulUnloads.load() << std::endl;
+    std::cout << "Thread Safety Test: Refused as already loaded: " << alreadyLoaded.load() << std::endl;
+    assert(successfulLoads.load() == 1);
+    assert(alreadyLoaded.load() == numThreads - 1);
+    assert(loader.listModules().size() == 1);
+
+    wave::core::moduleloader::ModuleResult uRes = loader.unloadModule("DummyModule");
+    assert(uRes.status == wave::core::moduleloader::ModuleResult::Status::Success);
+    // Event counts are not checked: a refusal by name broadcasts ErrorLoading, one by path does not,
+    // and which of the two a losing thread hits depends on timing.
     std::cout << "Thread Safety Test: Total events: " << eventCount.load() << std::endl;
-
-    // Because the dummy module always has the name "DummyModule", and module paths are also unique for loading,
-    // only one thread can successfully load the module *by that path* at a time.
-    // And only one thread can have "DummyModule" loaded *by that name*.
-    // The current logic:
-    // - loadModule(path) checks if path is already loaded.
-    // - loadModule(path) then checks if moduleInstance->getName() is already loaded.
-    // So, only the first thread to pass both checks will load.
-    assert(successfulLoads.load() == 1); 
-    assert(successfulUnloads.load() == 1);
-    
-    // Events: 1 Load, 1 Unload from the successful thread.
-    // If other threads failed to load, they might trigger ErrorLoading events *if* the error
-    // occurs after the point where an event is broadcast (e.g. file not found error).
-    // The "module from this path is already loaded" error does not broadcast an event in current code.
-    // The "Module with name ... already loaded" error *does* broadcast ErrorLoading.
-    // So, (numThreads - 1) ErrorLoading events + 1 Loaded + 1 Unloaded = numThreads + 1 events.
-    // This needs to be precise based on implementation.
-
-    // Re-checking loadModule:
-    // 1. Path check: `return ModuleResult(ModuleResult::Status::Error, "Module from this path is already loaded: " + modulePath, pair.second);` -> NO EVENT
-    // 2. Name check: `broadcastEvent(ModuleEventType::ErrorLoading, errorInfo, errorMsg); return ModuleResult(...)` -> EVENT
-    // So, the first thread loads. Other N-1 threads will hit the "path already loaded" error if they try to load *before* the first one unloads.
-    // If they try to load *after* the first one unloads, one of them will succeed.
-    // This test is a bit racy for exact event counts.
-    // The key is that it doesn't crash and the final state is consistent (no modules loaded).
     
     assert(loader.listModules().empty()); // Ensure all modules are unloaded eventually.
-    std::cout << "Thread Safety Test (Basic): COMPLETED (check for crashes/deadlocks)" << std::endl;
+    std::cout << "Thread Safety Test (Basic): PASSED" << std::endl;
+}
+
+void testBatchLoad() {
+    printTestHeader("Batch (Parallel) Load Test");
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+
+    std::atomic<int> loadedEvents(0), errorEvents(0);
+    loader.subscribeToModuleEvents(
+        [&](wave::core::moduleloader::ModuleEventType type, const wave::core::moduleloader::ModuleInfo&, const std::string&) {
+            if (type == wave::core::moduleloader::ModuleEventType::Loaded) loadedEvents++;
+            if (type == wave::core::moduleloader::ModuleEventType::ErrorLoading) errorEvents++;
+        });
+
+    // One good module, the same path again, and a missing file: one result per path, in order.
+    std::vector<wave::core::moduleloader::ModuleResult> results =
+        loader.loadModules({DUMMY_MODULE_PATH, DUMMY_MODULE_PATH, NON_EXISTENT_MODULE_PATH}, 4);
+    assert(results.size() == 3);
+    assert(results[0].status == wave::core::moduleloader::ModuleResult::Status::Success);
+    assert(results[0].module.value().name == "DummyModule");
+    assert(results[1].status == wave::core::moduleloader::ModuleResult::Status::Error);
+    assert(results[1].message.find("already loaded") != std::string::npos);
+    assert(results[2].status == wave::core::moduleloader::ModuleResult::Status::Error);
+    assert(results[2].message.find("Failed to load library") != std::string::npos);
+    assert(loadedEvents.load() == 1);
+    assert(errorEvents.load() == 1); // Duplicate paths are rejected without an event, like loadModule
+    assert(loader.listModules().size() == 1);
+
+    // Already loaded before the batch.
+    results = loader.loadModules({DUMMY_MODULE_PATH});
+    assert(results.size() == 1 && results[0].status == wave::core::moduleloader::ModuleResult::Status::Error);
+    assert(loader.loadModules({}).empty());
+
+    loader.unloadModule("DummyModule");
+    std::cout << "Batch (Parallel) Load Test: PASSED" << std::endl;
+}
+
+void testDependencies() {
+    printTestHeader("Manifest and Dependency Order Test");
+    using wave::core::moduleloader::ModuleResult;
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+
+    // The manifest is readable without creating the module.
+    std::string error;
+    std::optional<wave::core::moduleloader::ModuleManifest> manifest =
+        wave::core::moduleloader::ModuleLoaderSystem::readModuleManifest(DEPENDENT_MODULE_PATH, &error);
+    assert(manifest.has_value());
+    assert(manifest->name == "DummyDependent");
+    assert(manifest->requirements == std::vector<std::string>{"dummy.storage"});
+    assert(!wave::core::moduleloader::ModuleLoaderSystem::readModuleManifest(NON_EXISTENT_MODULE_PATH, &error));
+    assert(!error.empty());
+
+    // A single load needs its requirements loaded already.
+    ModuleResult res = loader.loadModule(DEPENDENT_MODULE_PATH);
+    assert(res.status == ModuleResult::Status::Error);
+    assert(res.message.find("dummy.storage") != std::string::npos);
+
+    std::vector<std::string> loadedOrder, unloadedOrder;
+    loader.subscribeToModuleEvents(
+        [&](wave::core::moduleloader::ModuleEventType type, const wave::core::moduleloader::ModuleInfo& info, const std::string&) {
+            if (type == wave::core::moduleloader::ModuleEventType::Loaded) loadedOrder.push_back(info.name);
+            if (type == wave::core::moduleloader::ModuleEventType::Unloaded) unloadedOrder.push_back(info.name);
+        });
+
+    // Listed dependent first: the base is still initialized (and announced) first. The cycle is
+    // rejected without affecting the others.
+    std::vector<ModuleResult> results =
+        loader.loadModules({DEPENDENT_MODULE_PATH, CYCLE_A_MODULE_PATH, BASE_MODULE_PATH, CYCLE_B_MODULE_PATH}, 4);
+    assert(results.size() == 4);
+    assert(results[0].status == ModuleResult::Status::Success);
+    assert(results[0].module->requirements == std::vector<std::string>{"dummy.storage"});
+    assert(results[1].status == ModuleResult::Status::Error);
+    assert(results[1].message.find("cycle") != std::string::npos);
+    assert(results[2].status == ModuleResult::Status::Success);
+    assert(results[2].module->provides == std::vector<std::string>{"dummy.storage"});
+    assert(results[3].status == ModuleResult::Status::Error);
+    assert((loadedOrder == std::vector<std::string>{"DummyBase", "DummyDependent"}));
+
+    // The base cannot go while the dependent needs it.
+    res = loader.unloadModule("DummyBase");
+    assert(res.status == ModuleResult::Status::Error);
+    assert(res.message.find("DummyDependent") != std::string::npos);
+    assert(loader.listModules().size() == 2);
+
+    // Shutdown runs in reverse dependency order.
+    loader.unloadAllModules(2);
+    assert(loader.listModules().empty());
+    assert((unloadedOrder == std::vector<std::string>{"DummyDependent", "DummyBase"}));
+    std::cout << "Manifest and Dependency Order Test: PASSED" << std::endl;
+}
+
+void testSlowModuleDoesNotBlock() {
+    printTestHeader("Slow Module Concurrency Test");
+    using wave::core::moduleloader::ModuleResult;
+    using wave::core::moduleloader::ModuleState;
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+
+    auto stateOf = [&](const std::string& name) -> std::optional<ModuleState> {
+        for (const auto& info : loader.listModules()) {
+            if (info.name == name) return info.state;
+        }
+        return std::nullopt;
+    };
+
+    std::thread slowLoad([&]() {
+        ModuleResult res = loader.loadModule(SLOW_MODULE_PATH);
+        assert(res.status == ModuleResult::Status::Success);
+    });
+    // The slow module shows up as Loading while its initialize() runs.
+    while (stateOf("DummySlow") != ModuleState::Loading) {
+        std::this_thread::yield();
+    }
+
+    // Meanwhile other modules load and unload, and the slow one's name and path stay reserved.
+    auto start = std::chrono::steady_clock::now();
+    ModuleResult other = loader.loadModule(DUMMY_MODULE_PATH);
+    assert(other.status == ModuleResult::Status::Success);
+    assert(loader.unloadModule(other.module->name).status == ModuleResult::Status::Success);
+    assert(loader.loadModule(SLOW_MODULE_PATH).status == ModuleResult::Status::Error);
+    ModuleResult busy = loader.unloadModule("DummySlow");
+    assert(busy.status == ModuleResult::Status::Error);
+    assert(busy.message.find("still being loaded") != std::string::npos);
+    assert(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(400));
+    assert(stateOf("DummySlow") == ModuleState::Loading);
+
+    slowLoad.join();
+    assert(stateOf("DummySlow") == ModuleState::Ready);
+    // Its load profile puts the time where it went.
+    for (const auto& info : loader.listModules()) {
+        assert(info.profile.initialize >= std::chrono::milliseconds(500));
+        assert(info.profile.total() >= info.profile.initialize + info.profile.open);
+    }
+    assert(loader.unloadModule("DummySlow").status == ModuleResult::Status::Success);
+    assert(loader.listModules().empty());
+    std::cout << "Slow Module Concurrency Test: PASSED" << std::endl;
+}
+
+void testAsyncOperations() {
+    printTestHeader("Asynchronous Operations Test");
+    using wave::core::moduleloader::ModulePhase;
+    using wave::core::moduleloader::ModuleResult;
+    // Declared before the loader: its destructor still reports progress.
+    std::mutex progressMutex;
+    std::vector<wave::core::moduleloader::ModuleProgress> progress;
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+    loader.setAsyncWorkerCount(2);
+    loader.subscribeToModuleProgress([&](const wave::core::moduleloader::ModuleProgress& p) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress.push_back(p);
+    });
+    auto phasesOf = [&](const std::string& path) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        std::vector<ModulePhase> phases;
+        for (const auto& p : progress) {
+            if (p.path == path) phases.push_back(p.phase);
+        }
+        return phases;
+    };
+
+    // The slow module's initialize() does not hold up the other load.
+    std::future<ModuleResult> slow = loader.loadModuleAsync(SLOW_MODULE_PATH);
+    std::future<ModuleResult> quick = loader.loadModuleAsync(DUMMY_MODULE_PATH);
+    assert(quick.get().status == ModuleResult::Status::Success);
+    assert(slow.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready);
+    assert(slow.get().status == ModuleResult::Status::Success);
+
+    std::vector<ModulePhase> loadPhases = {ModulePhase::Opened, ModulePhase::SymbolsResolved, ModulePhase::Created,
+                                           ModulePhase::Initialized};
+    assert(phasesOf(DUMMY_MODULE_PATH) == loadPhases);
+    {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        for (const auto& p : progress) {
+            assert(p.elapsed >= p.phaseDuration);
+            if (p.path == SLOW_MODULE_PATH && p.phase == ModulePhase::Initialized) {
+                assert(p.name == "DummySlow");
+                assert(p.phaseDuration >= std::chrono::milliseconds(500));
+            }
+        }
+    }
+
+    assert(loader.reloadModuleAsync("DummyModule").get().status == ModuleResult::Status::Success);
+    std::vector<ModulePhase> reloadPhases = loadPhases;
+    reloadPhases.insert(reloadPhases.end(), {ModulePhase::ShutDown, ModulePhase::Closed});
+    reloadPhases.insert(reloadPhases.end(), loadPhases.begin(), loadPhases.end());
+    assert(phasesOf(DUMMY_MODULE_PATH) == reloadPhases);
+
+    assert(loader.unloadModuleAsync("DummyModule").get().status == ModuleResult::Status::Success);
+    assert(loader.unloadModuleAsync("DummyModule").get().status == ModuleResult::Status::NotFound);
+    assert(loader.listModules().size() == 1);
+    // DummySlow is still loaded; the loader's destructor unloads it.
+    std::cout << "Asynchronous Operations Test: PASSED" << std::endl;
+}
+
+void testHotReload() {
+    printTestHeader("Hot Reload Test");
+    using wave::core::moduleloader::ModuleEventType;
+    using wave::core::moduleloader::ModuleResult;
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+    std::atomic<int> reloaded(0), unloaded(0);
+    loader.subscribeToModuleEvents([&](ModuleEventType type, const wave::core::moduleloader::ModuleInfo&, const std::string&) {
+        if (type == ModuleEventType::Reloaded) reloaded++;
+        if (type == ModuleEventType::Unloaded) unloaded++;
+    });
+
+    assert(loader.loadModule(DUMMY_MODULE_PATH).status == ModuleResult::Status::Success);
+    wave::core::moduleloader::ModuleLoaderSystem::ModuleRef inFlight = loader.acquireModule("DummyModule");
+    assert(inFlight && inFlight->exportState() == "0");
+    wave::core::moduleloader::ILauncherModule* oldInstance = inFlight.get();
+
+    // The new instance takes over at once; the old one is retired when the last reference is gone.
+    std::atomic<bool> done(false);
+    std::optional<ModuleResult> result;
+    std::thread hotReload([&]() {
+        result = loader.hotReloadModule("DummyModule");
+        done = true;
+    });
+    for (int i = 0; i < 500 && loader.acquireModule("DummyModule").get() == oldInstance; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto current = loader.acquireModule("DummyModule");
+    assert(current && current.get() != oldInstance);
+    assert(current->exportState() == "1"); // State handed over
+    current.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!done);
+    assert(inFlight->getName() == "DummyModule"); // Still usable
+    inFlight.reset();
+    hotReload.join();
+    assert(result->status == ModuleResult::Status::Success);
+    assert(result->message.find("1 byte(s) of state") != std::string::npos);
+    assert(reloaded.load() == 1);
+
+    // The new version runs from a private copy of the library, replaced again by the next reload.
+    auto modules = loader.listModules();
+    assert(modules.size() == 1 && modules[0].path == DUMMY_MODULE_PATH);
+    std::string shadow = modules[0].shadowPath;
+    assert(!shadow.empty() && std::ifstream(shadow).good());
+    assert(loader.hotReloadModule("DummyModule").status == ModuleResult::Status::Success);
+    assert(loader.acquireModule("DummyModule")->exportState() == "2");
+    assert(!std::ifstream(shadow).good());
+    shadow = loader.listModules()[0].shadowPath;
+
+    assert(loader.hotReloadModule("NoSuchModule").status == ModuleResult::Status::NotFound);
+    assert(loader.unloadModule("DummyModule").status == ModuleResult::Status::Success);
+    assert(!std::ifstream(shadow).good());
+    assert(unloaded.load() == 1);
+    std::cout << "Hot Reload Test: PASSED" << std::endl;
+}
+
+void testInitializeScope() {
+    printTestHeader("Initialize Scope Test");
+    using wave::core::moduleloader::ModuleLoaderSystem;
+    using wave::core::moduleloader::ModuleResult;
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    ModuleLoaderSystem loader(coreServices.api());
+
+    // Core opens a cli::CommandOwnerScope here; the test keeps the pins to try them.
+    std::mutex pinsMutex;
+    std::vector<ModuleLoaderSystem::InstancePin> pins;
+    loader.setInitializeScope([&](const std::string& moduleName, ModuleLoaderSystem::InstancePin pin) {
+        assert(moduleName == "DummyModule");
+        assert(!pin()); // Not Ready while initialize() runs
+        std::lock_guard<std::mutex> lock(pinsMutex);
+        pins.push_back(pin);
+        return std::shared_ptr<void>();
+    });
+
+    assert(loader.loadModule(DUMMY_MODULE_PATH).status == ModuleResult::Status::Success);
+    assert(pins.size() == 1);
+    ModuleLoaderSystem::ModuleRef pinned = pins[0]();
+    assert(pinned && pinned == loader.acquireModule("DummyModule"));
+
+    // A pin holds the instance like any ModuleRef: the hot reload switches at once, but retires
+    // the old instance only when the pin is released. The old instance cannot be pinned again.
+    std::atomic<bool> done(false);
+    std::thread hotReload([&]() {
+        assert(loader.hotReloadModule("DummyModule").status == ModuleResult::Status::Success);
+        done = true;
+    });
+    for (int i = 0; i < 500 && loader.acquireModule("DummyModule") == pinned; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!done);
+    assert(!pins[0]());
+    {
+        std::lock_guard<std::mutex> lock(pinsMutex);
+        assert(pins.size() == 2);
+        assert(pins[1]() && pins[1]() == loader.acquireModule("DummyModule"));
+    }
+    pinned.reset();
+    hotReload.join();
+
+    // Unloading waits for a pin too, and ends it.
+    pinned = pins[1]();
+    done = false;
+    std::thread unload([&]() {
+        assert(loader.unloadModule("DummyModule").status == ModuleResult::Status::Success);
+        done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!done && !pins[1]());
+    pinned.reset();
+    unload.join();
+    assert(loader.listModules().empty());
+    std::cout << "Initialize Scope Test: PASSED" << std::endl;
+}
+
+void testSearchPathsAndManifestCache() {
+    printTestHeader("Search Paths and Manifest Cache Test");
+    using wave::core::moduleloader::ModuleIndex;
+    using wave::core::moduleloader::ModuleResult;
+    namespace fs = std::filesystem;
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+
+    // A bare name is found in the search paths, in order, as lib<name>.so.
+    loader.getModuleIndex().setSearchPaths({"wave/tests/no_such_directory", DUMMY_MODULE_DIR});
+    assert(loader.getModuleIndex().resolve("dummy_module") == DUMMY_MODULE_PATH);
+    assert(loader.getModuleIndex().resolve(DUMMY_MODULE_FILENAME) == DUMMY_MODULE_PATH);
+    assert(loader.getModuleIndex().resolve("./dummy_module") == "./dummy_module"); // A path is left alone
+    ModuleResult res = loader.loadModule("dummy_module");
+    assert(res.status == ModuleResult::Status::Success);
+    assert(res.module->path == DUMMY_MODULE_PATH);
+    assert(loader.loadModule(DUMMY_MODULE_PATH).status == ModuleResult::Status::Error); // Same library
+    assert(loader.loadModule("no_such_module").status != ModuleResult::Status::Success);
+    assert(loader.unloadModule("DummyModule").status == ModuleResult::Status::Success);
+
+    // Libraries are opened once; later lookups, in this process or the next, come from the cache.
+    fs::path scratch = fs::temp_directory_path() / "wave_test_module_index";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    fs::copy_file(DEPENDENT_MODULE_PATH, scratch / fs::path(DEPENDENT_MODULE_PATH).filename());
+    fs::copy_file(DUMMY_MODULE_PATH, scratch / DUMMY_MODULE_FILENAME);
+    std::ofstream(scratch / "notes.txt") << "not a library";
+    const std::string cacheFile = (scratch / "manifests.cache").string();
+    {
+        ModuleIndex index;
+        index.setSearchPaths({scratch.string()});
+        assert(index.setCacheFile(cacheFile)); // Missing file: empty cache
+        std::vector<ModuleIndex::Entry> found = index.discover();
+        assert(found.size() == 2 && index.getLibraryReads() == 2);
+        std::string error;
+        std::optional<wave::core::moduleloader::ModuleManifest> manifest = index.manifest("dummy_dependent_module", &error);
+        assert(manifest && manifest->name == "DummyDependent");
+        assert(manifest->requirements == std::vector<std::string>{"dummy.storage"});
+        assert(index.getLibraryReads() == 2 && index.getCacheHits() == 1);
+        assert(!index.manifest("no_such_module", &error) && !error.empty());
+        assert(index.save());
+    }
+    {
+        ModuleIndex index;
+        index.setSearchPaths({scratch.string()});
+        assert(index.setCacheFile(cacheFile));
+        std::vector<ModuleIndex::Entry> found = index.discover();
+        assert(found.size() == 2 && index.getLibraryReads() == 0);
+        assert(found[0].manifest && found[0].manifest->name == "DummyDependent");
+        assert(found[0].manifest->requirements == std::vector<std::string>{"dummy.storage"});
+        assert(found[1].manifest && found[1].manifest->name == "DummyModule" && found[1].manifest->version == "1.0.0");
+
+        // A changed library is read again.
+        fs::path changed = scratch / DUMMY_MODULE_FILENAME;
+        fs::last_write_time(changed, fs::last_write_time(changed) + std::chrono::hours(1));
+        assert(index.manifest(changed.string()) && index.getLibraryReads() == 1);
+        assert(index.save());
+    }
+    {
+        // A cached manifest the loader would refuse is not trusted: the library is read again.
+        std::ifstream in(cacheFile);
+        std::string header, line, cached;
+        std::getline(in, header);
+        const std::string current = "\t" + std::to_string(WAVE_MODULE_ABI_VERSION) + "\tDummyModule\t";
+        const std::string older = "\t" + std::to_string(WAVE_MODULE_MIN_ABI_VERSION - 1) + "\tDummyModule\t";
+        while (std::getline(in, line)) {
+            size_t at = line.find(current);
+            cached += (at == std::string::npos ? line : line.replace(at, current.size(), older)) + "\n";
+        }
+        in.close();
+        assert(cached.find(older) != std::string::npos);
+        std::ofstream(cacheFile) << header << "\n" << cached;
+        ModuleIndex index;
+        index.setSearchPaths({scratch.string()});
+        assert(index.setCacheFile(cacheFile));
+        std::optional<wave::core::moduleloader::ModuleManifest> manifest = index.manifest(DUMMY_MODULE_FILENAME);
+        assert(manifest && manifest->abiVersion == WAVE_MODULE_ABI_VERSION && index.getLibraryReads() == 1);
+
+        // So is a cache file of an older format.
+        std::ofstream(cacheFile) << "# wave module manifest cache, format 1\n" << cached;
+        ModuleIndex old;
+        old.setSearchPaths({scratch.string()});
+        assert(old.setCacheFile(cacheFile));
+        assert(old.discover().size() == 2 && old.getLibraryReads() == 2);
+    }
+    fs::remove_all(scratch);
+    std::cout << "Search Paths and Manifest Cache Test: PASSED" << std::endl;
+}
+
+void testAutoReload() {
+    printTestHeader("Auto Reload Test");
+    using wave::core::moduleloader::ModuleEventType;
+    using wave::core::moduleloader::ModuleResult;
+    namespace fs = std::filesystem;
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+    std::atomic<int> reloaded(0);
+    loader.subscribeToModuleEvents([&](ModuleEventType type, const wave::core::moduleloader::ModuleInfo&, const std::string&) {
+        if (type == ModuleEventType::Reloaded) reloaded++;
+    });
+#ifndef __linux__
+    assert(!loader.startWatching());
+    std::cout << "Auto Reload Test: SKIPPED (no inotify)" << std::endl;
+    return;
+#endif
+
+    // A scratch copy of the library plays the build output.
+    fs::path scratch = fs::temp_directory_path() / "wave_test_auto_reload";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    const std::string library = (scratch / DUMMY_MODULE_FILENAME).string();
+    fs::copy_file(DUMMY_MODULE_PATH, library);
+
+    assert(loader.startWatching(std::chrono::milliseconds(150)));
+    assert(loader.isWatching());
+    assert(loader.loadModule(library).status == ModuleResult::Status::Success);
+    std::string shadow = loader.listModules()[0].shadowPath;
+    assert(!shadow.empty() && shadow != library); // Loaded from a shadow copy
+
+    // Several writes in a row cause one reload, after the last one.
+    std::this_thread::sleep_for(std::chrono::milliseconds(250)); // Let the watcher pick up the directory
+    for (int i = 0; i < 3; ++i) {
+        fs::copy_file(DUMMY_MODULE_PATH, library, fs::copy_options::overwrite_existing);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    for (int i = 0; i < 300 && reloaded.load() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    assert(reloaded.load() == 1);
+    assert(loader.acquireModule("DummyModule")->exportState() == "1"); // Hot reloaded, state handed over
+    assert(!std::ifstream(shadow).good());
+    assert(loader.listModules()[0].shadowPath != shadow);
+
+    // Renaming a new build over the library counts too.
+    fs::copy_file(DUMMY_MODULE_PATH, scratch / "next.tmp");
+    fs::rename(scratch / "next.tmp", library);
+    for (int i = 0; i < 300 && reloaded.load() == 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(reloaded.load() == 2);
+
+    loader.stopWatching();
+    assert(!loader.isWatching());
+    fs::copy_file(DUMMY_MODULE_PATH, library, fs::copy_options::overwrite_existing);
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    assert(reloaded.load() == 2);
+
+    assert(loader.unloadModule("DummyModule").status == ModuleResult::Status::Success);
+    fs::remove_all(scratch);
+    std::cout << "Auto Reload Test: PASSED" << std::endl;
+}
+
+void testIsolatedModule() {
+    printTestHeader("Isolated Module Test");
+    using wave::core::moduleloader::HostedModule;
+    using wave::core::moduleloader::IsolationOptions;
+    using wave::core::moduleloader::ModuleResult;
+    // The module host executable (wave/module_host.cpp), built by dummy_module/CMakeLists.txt.
+    IsolationOptions options;
+    const char* host = std::getenv("WAVE_MODULE_HOST");
+    options.hostExecutable = host ? host : MODULE_HOST_PATH;
+#ifndef __linux__
+    std::cout << "Isolated Module Test: SKIPPED (Linux only)" << std::endl;
+    return;
+#endif
+    if (!std::ifstream(options.hostExecutable).good()) {
+        std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
+        std::cerr << "!! Isolated Module Test: SKIPPED, no module host at " << options.hostExecutable << std::endl;
+        std::cerr << "!! Build the module_host target of dummy_module, or set WAVE_MODULE_HOST." << std::endl;
+        std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
+        skippedTests.push_back("Isolated Module Test");
+        return;
+    }
+    wave::core::moduleloader::CoreServiceRegistry coreServices; // No services; modules get the table only
+    wave::core::moduleloader::ModuleLoaderSystem loader(coreServices.api());
+
+    ModuleResult res = loader.loadIsolatedModule(DUMMY_MODULE_PATH, options);
+    assert(res.status == ModuleResult::Status::Success);
+    assert(res.module->isolation && !res.module->libraryHandle);
+    auto module = loader.acquireModule("DummyModule");
+    auto* hosted = dynamic_cast<HostedModule*>(module.get());
+    assert(hosted && hosted->getHostPid() > 0 && hosted->getHostPid() != getpid());
+    assert(hosted->getManifest() && hosted->getManifest()->name == "DummyModule");
+
+    // A crash takes down the host, not this process; the call fails and the host is started again.
+    int firstHost = hosted->getHostPid();
+    bool threw = false;
+    try {
+        hosted->importState("crash");
+    } catch (const std::runtime_error& e) {
+        threw = true;
+        assert(std::string(e.what()).find("killed by signal") != std::string::npos);
+    }
+    assert(threw);
+    assert(hosted->getRestarts() == 1 && hosted->getHostPid() != firstHost);
+    assert(hosted->exportState() == "0"); // A fresh instance: the crashed one's state is lost
+
+    // A host restarted from a short-lived thread (an async event delivery, say) outlives it.
+    std::thread([hosted]() {
+        try {
+            hosted->importState("crash");
+        } catch (const std::runtime_error&) {
+        }
+    }).join();
+    assert(hosted->getRestarts() == 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    assert(hosted->exportState() == "0" && hosted->getRestarts() == 2);
+    module.reset();
+
+    // Reloads keep the module isolated.
+    assert(loader.hotReloadModule("DummyModule").status == ModuleResult::Status::Success);
+    module = loader.acquireModule("DummyModule");
+    hosted = dynamic_cast<HostedModule*>(module.get());
+    assert(hosted && hosted->exportState() == "1");
+    module.reset();
+    assert(loader.reloadModule("DummyModule").status == ModuleResult::Status::Success);
+    assert(loader.listModules()[0].isolation);
+    assert(loader.unloadModule("DummyModule").status == ModuleResult::Status::Success);
+
+    // The host refuses a library without a manifest, as the loader does.
+    res = loader.loadIsolatedModule(UNMANIFESTED_MODULE_PATH, options);
+    assert(res.status == ModuleResult::Status::Error);
+    assert(res.message.find("wave_module_manifest") != std::string::npos);
+
+    // A host that runs out of its memory limit fails the load, as does a missing host.
+    options.memoryLimitBytes = 1024 * 1024;
+    res = loader.loadIsolatedModule(DUMMY_MODULE_PATH, options);
+    assert(res.status == ModuleResult::Status::Error);
+    options.memoryLimitBytes = 0;
+    options.hostExecutable = "wave/tests/no_such_module_host";
+    res = loader.loadIsolatedModule(DUMMY_MODULE_PATH, options);
+    assert(res.status == ModuleResult::Status::Error);
+    assert(res.message.find("could not be started") != std::string::npos);
+    assert(loader.listModules().empty());
+    std::cout << "Isolated Module Test: PASSED" << std::endl;
+}
+
+void testCoreApi() {
+    printTestHeader("Core API Test");
+    using wave::core::moduleloader::CoreServiceRegistry;
+    CoreServiceRegistry coreServices;
+    const WaveCoreApi* api = coreServices.api();
+    assert(api->apiVersion == WAVE_CORE_API_VERSION && api->size == sizeof(WaveCoreApi));
+    assert(WAVE_CORE_API_HAS(api, getService) && WAVE_CORE_API_HAS(api, log));
+    const WaveCoreApi* none = nullptr;
+    assert(!WAVE_CORE_API_HAS(none, log));
+
+    // A table from an older core stops before the functions it does not have.
+    WaveCoreApi older = *api;
+    older.size = offsetof(WaveCoreApi, log);
+    assert(WAVE_CORE_API_HAS(&older, getService) && !WAVE_CORE_API_HAS(&older, log));
+
+    // Services come back as they were registered, and only in at least the version asked for.
+    std::string service = "the service";
+    coreServices.setService("test.service", &service, 2);
+    assert(api->serviceVersion(api->context, "test.service") == 2);
+    assert(api->serviceVersion(api->context, "test.absent") == 0);
+    assert(wave::core::moduleloader::coreService<std::string>(api, "test.service", 2) == &service);
+    assert(wave::core::moduleloader::coreService<std::string>(api, "test.service", 3) == nullptr);
+    assert(wave::core::moduleloader::coreService<std::string>(api, "test.absent") == nullptr);
+    assert(wave::core::moduleloader::coreService<std::string>(nullptr, "test.service") == nullptr);
+    assert(api->getService(api->context, nullptr, 0) == nullptr);
+    coreServices.setService("test.service", nullptr);
+    assert(api->serviceVersion(api->context, "test.service") == 0);
+
+    // Modules get the table in initialize(); the dummy module logs through it.
+    std::mutex logMutex;
+    std::vector<std::string> logged;
+    coreServices.setLogFunction([&](uint32_t level, const std::string& source, const std::string& message) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        logged.push_back(std::to_string(level) + " " + source + ": " + message);
+    });
+    wave::core::moduleloader::ModuleLoaderSystem loader(api);
+    assert(loader.loadModule(DUMMY_MODULE_PATH).status == wave::core::moduleloader::ModuleResult::Status::Success);
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        assert(logged.size() == 1);
+        assert(logged[0] == std::to_string(WAVE_LOG_INFO) + " DummyModule: DummyModule initialized");
+    }
+    loader.unloadModule("DummyModule");
+    std::cout << "Core API Test: PASSED" << std::endl;
 }
 
 
@@ -356,7 +951,20 @@ int main() {
     testModuleReload();
     testErrorConditions();
     testThreadSafety();
+    testBatchLoad();
+    testDependencies();
+    testSlowModuleDoesNotBlock();
+    testAsyncOperations();
+    testHotReload();
+    testInitializeScope();
+    testSearchPathsAndManifestCache();
+    testAutoReload();
+    testIsolatedModule();
+    testCoreApi();
 
     std::cout << "\nModuleLoaderSystem Test Suite: ALL TESTS COMPLETED." << std::endl;
+    for (const std::string& skipped : skippedTests) {
+        std::cerr << "!! SKIPPED: " << skipped << " (see above)" << std::endl;
+    }
     return 0;
 }
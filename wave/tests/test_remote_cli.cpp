@@ -0,0 +1,337 @@
+#include "core/cli/remote_server.hpp"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+// Helper function to print test headers
+void printTestHeader(const std::string& testName) {
+    std::cout << "\n--- " << testName << " ---" << std::endl;
+}
+
+// --- Test Commands ---
+
+// "rows N": emits N rows, then succeeds.
+class RowsCommand : public wave::core::cli::ICommand {
+public:
+    std::string getName() const override { return "rows"; }
+    std::string getHelp() const override { return "rows <n> - emits n rows."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>&) override {
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Error, "Needs a context.");
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>& args,
+                                                      wave::core::cli::CommandContext& context) override {
+        int count = args.empty() ? 0 : std::stoi(args[0]);
+        for (int i = 0; i < count; ++i) {
+            if (!context.emit(wave::core::cli::StructuredData(std::string("row ") + std::to_string(i)))) {
+                return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Warning, "Stopped early.");
+            }
+        }
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "Done.");
+    }
+};
+
+// "counter": increments a per-session value and returns it as string data.
+class CounterCommand : public wave::core::cli::ICommand {
+public:
+    std::string getName() const override { return "counter"; }
+    std::string getHelp() const override { return "counter - per-session counter."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>&) override {
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Error, "Needs a session.");
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>&,
+                                                      wave::core::cli::CommandContext& context) override {
+        if (!context.session) {
+            return execute({});
+        }
+        std::lock_guard<std::mutex> lock(context.session->mutex);
+        std::any& value = context.session->values["counter"];
+        int next = value.has_value() ? std::any_cast<int>(value) + 1 : 1;
+        value = next;
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "Counted.",
+                                              wave::core::cli::StructuredData(std::to_string(next)));
+    }
+};
+
+// "record [n]": emits the record n times as rows, then returns it as structured data.
+class RecordCommand : public wave::core::cli::ICommand {
+public:
+    std::string getName() const override { return "record"; }
+    std::string getHelp() const override { return "record [n] - emits and returns a record."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>&) override {
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Success, "Recorded.",
+                                              wave::core::cli::StructuredData(makeRecord()));
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>& args,
+                                                      wave::core::cli::CommandContext& context) override {
+        int count = args.empty() ? 0 : std::stoi(args[0]);
+        for (int i = 0; i < count; ++i) {
+            context.emit(wave::core::cli::StructuredData(makeRecord()));
+        }
+        return execute(args);
+    }
+
+private:
+    static std::map<std::string, wave::core::cli::StructuredData> makeRecord() {
+        return {{"name", std::string("wave")}, {"count", 2}};
+    }
+};
+
+// "block": emits rows until cancelled.
+class BlockCommand : public wave::core::cli::ICommand {
+public:
+    std::atomic<bool> finished{false};
+    std::string getName() const override { return "block"; }
+    std::string getHelp() const override { return "block - runs until cancelled."; }
+    wave::core::cli::CommandResult execute(const std::vector<std::string>&) override {
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Error, "Needs a context.");
+    }
+    wave::core::cli::CommandResult executeWithContext(const std::vector<std::string>&,
+                                                      wave::core::cli::CommandContext& context) override {
+        while (context.emit(wave::core::cli::StructuredData(std::string(1024, 'x')))) {
+        }
+        finished = true;
+        return wave::core::cli::CommandResult(wave::core::cli::CommandResult::Status::Warning, "Cancelled.");
+    }
+};
+
+// Minimal blocking client: sends lines, reads frames.
+class TestClient {
+public:
+    explicit TestClient(const std::string& uri) {
+        wave::core::cli::RemoteEndpoint endpoint;
+        bool parsed = wave::core::cli::parseRemoteUri(uri, endpoint);
+        assert(parsed);
+        (void)parsed;
+        CppFd = wave::core::cli::connectRemoteEndpoint(endpoint);
+        assert(CppFd >= 0);
+    }
+    ~TestClient() { disconnect(); }
+
+    void send(const std::string& text) {
+        ssize_t sent = ::send(CppFd, text.data(), text.size(), MSG_NOSIGNAL);
+        assert(sent == static_cast<ssize_t>(text.size()));
+        (void)sent;
+    }
+
+    // Returns false on EOF.
+    bool readFrame(std::string& frame) {
+        while (true) {
+            size_t newline = CppBuffer.find('\n');
+            if (newline != std::string::npos) {
+                frame = CppBuffer.substr(0, newline);
+                CppBuffer.erase(0, newline + 1);
+                return true;
+            }
+            char chunk[4096];
+            ssize_t received = ::recv(CppFd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            CppBuffer.append(chunk, static_cast<size_t>(received));
+        }
+    }
+
+    // Reads frames up to and including the next status frame.
+    std::vector<std::string> readReply() {
+        std::vector<std::string> frames;
+        std::string frame;
+        while (readFrame(frame)) {
+            frames.push_back(frame);
+            if (frame[0] == wave::core::cli::REMOTE_FRAME_STATUS) {
+                break;
+            }
+        }
+        return frames;
+    }
+
+    // Half-close: no more lines, but replies can still be read.
+    void finishSending() { ::shutdown(CppFd, SHUT_WR); }
+
+    void disconnect() {
+        if (CppFd >= 0) {
+            ::close(CppFd);
+            CppFd = -1;
+        }
+    }
+
+private:
+    int CppFd = -1;
+    std::string CppBuffer;
+};
+
+// --- Test Functions ---
+
+void testProtocolHelpers() {
+    printTestHeader("Protocol Helpers Test");
+    wave::core::cli::RemoteEndpoint endpoint;
+    assert(wave::core::cli::parseRemoteUri("unix:/tmp/x.sock", endpoint));
+    assert(endpoint.kind == wave::core::cli::RemoteEndpoint::Kind::Unix && endpoint.path == "/tmp/x.sock");
+    assert(wave::core::cli::parseRemoteUri("tcp://localhost:12345", endpoint));
+    assert(endpoint.kind == wave::core::cli::RemoteEndpoint::Kind::Tcp);
+    assert(endpoint.host == "127.0.0.1" && endpoint.port == 12345);
+    std::string error;
+    assert(!wave::core::cli::parseRemoteUri("http://x", endpoint, &error) && !error.empty());
+    assert(!wave::core::cli::parseRemoteUri("tcp://127.0.0.1:99999", endpoint));
+    // No authentication, so nothing but loopback.
+    assert(!wave::core::cli::parseRemoteUri("tcp://0.0.0.0:12345", endpoint, &error));
+    assert(error.find("loopback") != std::string::npos);
+    assert(!wave::core::cli::parseRemoteUri("tcp://192.168.1.5:12345", endpoint));
+    assert(wave::core::cli::parseRemoteUri("tcp://127.0.0.2:12345", endpoint));
+
+    std::string text = "a\\b\nc\rd";
+    assert(wave::core::cli::unescapeRemotePayload(wave::core::cli::escapeRemotePayload(text)) == text);
+    assert(wave::core::cli::escapeRemotePayload(text).find('\n') == std::string::npos);
+    std::cout << "Protocol helpers test passed." << std::endl;
+}
+
+void testUnixSessions() {
+    printTestHeader("Unix Socket Sessions Test");
+    wave::core::cli::CLIEngine engine(4, 64);
+    RowsCommand rowsCmd;
+    CounterCommand counterCmd;
+    RecordCommand recordCmd;
+    engine.registerCommand("rows", &rowsCmd);
+    engine.registerCommand("counter", &counterCmd);
+    engine.registerCommand("record", &recordCmd);
+
+    std::string uri = "unix:/tmp/wave_test_remote_" + std::to_string(::getpid()) + ".sock";
+    wave::core::cli::RemoteCLIServer server(engine);
+    std::string error;
+    bool started = server.start(uri, &error);
+    assert(started);
+    (void)started;
+    assert(server.isRunning() && server.getListenUri() == uri);
+    struct stat socketStat;
+    assert(::stat(uri.substr(5).c_str(), &socketStat) == 0);
+    assert(S_ISSOCK(socketStat.st_mode) && (socketStat.st_mode & 0777) == 0600);
+
+    TestClient first(uri);
+    TestClient second(uri);
+
+    // Streaming rows, then the status frame.
+    first.send("rows 3\n");
+    std::vector<std::string> reply = first.readReply();
+    assert(reply.size() == 4);
+    assert(reply[0] == "R row 0" && reply[2] == "R row 2");
+    assert(reply[3] == "S Success Done.");
+
+    // Per-session state: each connection counts on its own.
+    first.send("counter\n");
+    assert(first.readReply() == std::vector<std::string>({"D 1", "S Success Counted."}));
+    first.send("counter\n");
+    assert(first.readReply() == std::vector<std::string>({"D 2", "S Success Counted."}));
+    second.send("counter\n");
+    assert(second.readReply() == std::vector<std::string>({"D 1", "S Success Counted."}));
+    assert(server.getSessionCount() == 2);
+
+    // Structured data arrives too, rendered as the interactive session shows it.
+    first.send("record\n");
+    assert(first.readReply() == std::vector<std::string>({"D {\"count\":2,\"name\":\"wave\"}", "S Success Recorded."}));
+
+    // "--output" picks the encoding per command: the formatter's bytes come back as O frames.
+    first.send("rows 2 --output json\n");
+    assert(first.readReply() == std::vector<std::string>({"O {\"type\":\"row\",\"value\":\"row 0\"}\\n",
+                                                          "O {\"type\":\"row\",\"value\":\"row 1\"}\\n",
+                                                          "O {\"type\":\"result\",\"status\":\"Success\",\"message\":\"Done.\"}\\n",
+                                                          "S Success Done."}));
+    // tsv sends its header line together with the first object row.
+    first.send("record 2 --output tsv\n");
+    assert(first.readReply() == std::vector<std::string>({"O count\tname\\n2\twave\\n", "O 2\twave\\n",
+                                                          "O 2\twave\\n", "S Success Recorded."}));
+    // The next command without "--output" is back to text frames.
+    first.send("record 1\n");
+    assert(first.readReply() == std::vector<std::string>({"R {\"count\":2,\"name\":\"wave\"}",
+                                                          "D {\"count\":2,\"name\":\"wave\"}", "S Success Recorded."}));
+
+    // Pipelined lines are answered in order; blank lines get no reply; errors come back as status.
+    second.send("counter\n\nnosuchcommand\ncounter\n");
+    assert(second.readReply() == std::vector<std::string>({"D 2", "S Success Counted."}));
+    assert(second.readReply() == std::vector<std::string>({"S Error Command not found: nosuchcommand"}));
+    assert(second.readReply() == std::vector<std::string>({"D 3", "S Success Counted."}));
+
+    // exit closes the session after its reply.
+    second.send("exit\n");
+    assert(second.readReply() == std::vector<std::string>({"S Success Session closed."}));
+    std::string frame;
+    assert(!second.readFrame(frame));
+
+    // A client that half-closes right after its lines (printf ... | nc -N) still gets every reply,
+    // including one for a last line without its newline; then the session closes.
+    TestClient third(uri);
+    third.send("counter\nrows 2");
+    third.finishSending();
+    assert(third.readReply() == std::vector<std::string>({"D 1", "S Success Counted."}));
+    assert(third.readReply() == std::vector<std::string>({"R row 0", "R row 1", "S Success Done."}));
+    assert(!third.readFrame(frame));
+    TestClient silent(uri);
+    silent.finishSending();
+    assert(!silent.readFrame(frame));
+
+    server.stop();
+    assert(!server.isRunning());
+    assert(::access(uri.substr(5).c_str(), F_OK) != 0); // Socket file removed
+    std::cout << "Unix socket sessions test passed." << std::endl;
+}
+
+void testTcpAndDisconnectCancellation() {
+    printTestHeader("TCP and Disconnect Cancellation Test");
+    wave::core::cli::CLIEngine engine(2, 16);
+    BlockCommand blockCmd;
+    RowsCommand rowsCmd;
+    engine.registerCommand("block", &blockCmd);
+    engine.registerCommand("rows", &rowsCmd);
+
+    wave::core::cli::RemoteCLIServer server(engine, 1);
+    std::string error;
+    assert(!server.start("tcp://0.0.0.0:0", &error) && !server.isRunning());
+    bool started = server.start("tcp://127.0.0.1:0");
+    assert(started);
+    (void)started;
+    std::string uri = server.getListenUri();
+    assert(uri.rfind("tcp://127.0.0.1:", 0) == 0 && uri != "tcp://127.0.0.1:0");
+
+    {
+        TestClient client(uri);
+        client.send("block\n");
+        std::string frame;
+        assert(client.readFrame(frame) && frame[0] == wave::core::cli::REMOTE_FRAME_ROW);
+
+        // Session limit is 1: a second connection is turned away.
+        TestClient rejected(uri);
+        assert(rejected.readFrame(frame) && frame == "S Error Too many remote CLI sessions.");
+        assert(!rejected.readFrame(frame));
+        // Client goes away without reading the rest; the blocked command must be released.
+    }
+    for (int i = 0; i < 200 && !blockCmd.finished; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(blockCmd.finished);
+
+    for (int i = 0; i < 200 && server.getSessionCount() != 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TestClient client(uri);
+    client.send("rows 1\n");
+    assert(client.readReply() == std::vector<std::string>({"R row 0", "S Success Done."}));
+    server.stop();
+    std::cout << "TCP and disconnect cancellation test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting RemoteCLIServer Test Suite..." << std::endl;
+
+    testProtocolHelpers();
+    testUnixSessions();
+    testTcpAndDisconnectCancellation();
+
+    std::cout << "\nRemoteCLIServer Test Suite: ALL TESTS COMPLETED." << std::endl;
+    return 0;
+}